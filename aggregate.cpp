@@ -0,0 +1,321 @@
+#include <QtDebug>
+#include <algorithm>
+#include "aggregate.hpp"
+#include "http.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5pool_t::h5pool_t
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+h5pool_t::h5pool_t() :
+m_max_open(32),
+m_clock(0)
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5pool_t::~h5pool_t
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+h5pool_t::~h5pool_t()
+{
+  close();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5pool_t::close
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void h5pool_t::close()
+{
+  h5lock_t lock;
+  for(std::map<std::string, entry_t>::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+  {
+    H5Tclose(it->second.m_mtid);
+    H5Dclose(it->second.m_did);
+    H5Fclose(it->second.m_fid);
+  }
+  m_entries.clear();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5pool_t::get
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const h5pool_t::entry_t* h5pool_t::get(const std::string &file_name, const std::string &path)
+{
+  std::map<std::string, entry_t>::iterator it = m_entries.find(file_name);
+  if(it != m_entries.end())
+  {
+    it->second.m_used = ++m_clock;
+    return &it->second;
+  }
+
+  h5lock_t lock;
+
+  //make room
+  while(!m_entries.empty() && m_entries.size() >= std::max<size_t>(m_max_open, 1))
+  {
+    std::map<std::string, entry_t>::iterator oldest = m_entries.begin();
+    for(std::map<std::string, entry_t>::iterator it_entry = m_entries.begin(); it_entry != m_entries.end(); ++it_entry)
+    {
+      if(it_entry->second.m_used < oldest->second.m_used)
+        oldest = it_entry;
+    }
+    H5Tclose(oldest->second.m_mtid);
+    H5Dclose(oldest->second.m_did);
+    H5Fclose(oldest->second.m_fid);
+    m_entries.erase(oldest);
+  }
+
+  entry_t entry;
+  entry.m_fid = -1;
+  entry.m_did = -1;
+  entry.m_mtid = -1;
+  hid_t sid = -1;
+  hid_t ftid = -1;
+  bool valid = false;
+  H5E_BEGIN_TRY
+  {
+    if((entry.m_fid = h5file_open(file_name.c_str())) >= 0 &&
+      (entry.m_did = H5Dopen2(entry.m_fid, path.c_str(), H5P_DEFAULT)) >= 0 &&
+      (sid = H5Dget_space(entry.m_did)) >= 0 &&
+      (ftid = H5Dget_type(entry.m_did)) >= 0 &&
+      (entry.m_mtid = H5Tget_native_type(ftid, H5T_DIR_DEFAULT)) >= 0)
+    {
+      int rank = H5Sget_simple_extent_ndims(sid);
+      if(rank >= 0)
+      {
+        entry.m_dim.resize(rank);
+        H5Sget_simple_extent_dims(sid, rank > 0 ? &entry.m_dim[0] : NULL, NULL);
+        valid = true;
+      }
+    }
+    if(ftid >= 0)
+      H5Tclose(ftid);
+    if(sid >= 0)
+      H5Sclose(sid);
+    if(!valid)
+    {
+      if(entry.m_mtid >= 0)
+        H5Tclose(entry.m_mtid);
+      if(entry.m_did >= 0)
+        H5Dclose(entry.m_did);
+      if(entry.m_fid >= 0)
+        H5Fclose(entry.m_fid);
+    }
+  }
+  H5E_END_TRY;
+
+  if(!valid)
+  {
+    qDebug() << "cannot open" << path.c_str() << "in" << file_name.c_str();
+    return NULL;
+  }
+  entry.m_used = ++m_clock;
+  it = m_entries.insert(std::make_pair(file_name, entry)).first;
+  return &it->second;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5aggregate_t::h5aggregate_t
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+h5aggregate_t::h5aggregate_t() :
+m_stack(true),
+m_datatype_size(0),
+m_datatype_sign(H5T_SGN_NONE),
+m_datatype_class(H5T_NO_CLASS),
+m_native(H5NATIVE_NONE)
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5aggregate_t::open
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5aggregate_t::open(const std::vector<std::string> &file_names, const std::string &path, bool stack, h5progress_t *progress)
+{
+  m_file_names = file_names;
+  m_path = path;
+  m_stack = stack;
+  m_offsets.assign(1, 0);
+  m_dim.clear();
+  m_chunk.clear();
+  m_native = H5NATIVE_NONE;
+  if(file_names.empty())
+  {
+    return -1;
+  }
+
+  //stacked: the first file gives the dimensions of all
+  size_t nbr_open = stack ? 1 : file_names.size();
+  for(size_t idx = 0; idx < nbr_open; idx++)
+  {
+    h5slab_t slab;
+    int result;
+    {
+      h5lock_t lock;
+      H5E_BEGIN_TRY
+      {
+        result = slab.open(file_names[idx].c_str(), path.c_str());
+      }
+      H5E_END_TRY;
+    }
+    if(result < 0 || slab.m_native == H5NATIVE_NONE)
+    {
+      qDebug() << "cannot open" << path.c_str() << "in" << file_names[idx].c_str();
+      return -1;
+    }
+
+    if(idx == 0)
+    {
+      m_dim = slab.m_dim;
+      m_chunk = slab.m_chunk;
+      m_datatype_size = slab.m_datatype_size;
+      m_datatype_sign = slab.m_datatype_sign;
+      m_datatype_class = slab.m_datatype_class;
+      m_native = slab.m_native;
+      if(!stack && m_dim.empty())
+      {
+        return -1;
+      }
+    }
+    else if(slab.m_native != m_native || slab.m_dim.size() != m_dim.size() ||
+      !std::equal(slab.m_dim.begin() + 1, slab.m_dim.end(), m_dim.begin() + 1))
+    {
+      qDebug() << path.c_str() << "in" << file_names[idx].c_str() << "differs from the first file";
+      return -1;
+    }
+    if(!stack)
+    {
+      m_offsets.push_back(m_offsets.back() + slab.m_dim[0]);
+    }
+
+    if(progress && !progress->progress(idx + 1, nbr_open))
+    {
+      return 1;
+    }
+  }
+
+  if(stack)
+  {
+    for(size_t idx = 0; idx < file_names.size(); idx++)
+    {
+      m_offsets.push_back(idx + 1);
+    }
+    m_dim.insert(m_dim.begin(), file_names.size());
+    m_chunk.insert(m_chunk.begin(), 1);
+  }
+  else
+  {
+    m_dim[0] = m_offsets.back();
+  }
+  return 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5aggregate_t::file_of
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+size_t h5aggregate_t::file_of(hsize_t idx) const
+{
+  std::vector<hsize_t>::const_iterator it = std::upper_bound(m_offsets.begin(), m_offsets.end(), idx);
+  if(it == m_offsets.begin())
+  {
+    return 0;
+  }
+  return std::min(static_cast<size_t>(it - m_offsets.begin()) - 1, m_file_names.size() - 1);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5aggregate_t::read
+//the hyperslab is split along the first dimension at file boundaries; each part is contiguous in
+//'buf', since the first dimension is the outermost one
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5aggregate_t::read(const std::vector<hsize_t> &start, const std::vector<hsize_t> &count, void *buf, h5pool_t &pool) const
+{
+  size_t rank = m_dim.size();
+  if(rank == 0 || start.size() != rank || count.size() != rank)
+  {
+    return -1;
+  }
+  size_t row_bytes = m_datatype_size;
+  for(size_t idx = 0; idx < rank; idx++)
+  {
+    if(start[idx] + count[idx] > m_dim[idx])
+    {
+      return -1;
+    }
+    if(idx > 0)
+    {
+      row_bytes *= static_cast<size_t>(count[idx]);
+    }
+  }
+
+  h5lock_t lock;
+  char *out = static_cast<char*>(buf);
+  hsize_t first = start[0];
+  hsize_t last = start[0] + count[0];
+  for(size_t idx_file = file_of(first); first < last; idx_file++)
+  {
+    hsize_t nbr = std::min(last, m_offsets[idx_file + 1]) - first;
+    const h5pool_t::entry_t *entry = pool.get(m_file_names[idx_file], m_path);
+    if(entry == NULL)
+    {
+      return -1;
+    }
+
+    //part in the coordinates of the file
+    std::vector<hsize_t> file_start(start);
+    std::vector<hsize_t> file_count(count);
+    if(m_stack)
+    {
+      file_start.erase(file_start.begin());
+      file_count.erase(file_count.begin());
+    }
+    else
+    {
+      file_start[0] = first - m_offsets[idx_file];
+      file_count[0] = nbr;
+    }
+    bool valid = get_native(H5Tget_class(entry->m_mtid), H5Tget_size(entry->m_mtid), H5Tget_sign(entry->m_mtid)) == m_native &&
+      entry->m_dim.size() == file_start.size();
+    for(size_t idx = 0; valid && idx < file_start.size(); idx++)
+    {
+      valid = file_start[idx] + file_count[idx] <= entry->m_dim[idx];
+    }
+    if(!valid)
+    {
+      qDebug() << m_path.c_str() << "in" << m_file_names[idx_file].c_str() << "differs from the first file";
+      return -1;
+    }
+
+    herr_t status;
+    if(file_start.empty())
+    {
+      status = H5Dread(entry->m_did, entry->m_mtid, H5S_ALL, H5S_ALL, H5P_DEFAULT, out);
+    }
+    else
+    {
+      hid_t fsid = H5Dget_space(entry->m_did);
+      hid_t msid = H5Screate_simple(static_cast<int>(file_count.size()), &file_count[0], NULL);
+      status = H5Sselect_hyperslab(fsid, H5S_SELECT_SET, &file_start[0], NULL, &file_count[0], NULL);
+      if(status >= 0)
+      {
+        status = H5Dread(entry->m_did, entry->m_mtid, msid, fsid, H5P_DEFAULT, out);
+      }
+      H5Sclose(msid);
+      H5Sclose(fsid);
+    }
+    if(status < 0)
+    {
+      return -1;
+    }
+
+    out += static_cast<size_t>(nbr) * row_bytes;
+    first += nbr;
+  }
+  return 0;
+}
@@ -0,0 +1,88 @@
+#ifndef AGGREGATE_HPP
+#define AGGREGATE_HPP 1
+
+#include <map>
+#include <string>
+#include <vector>
+#include "hdf5.h"
+#include "slab.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5pool_t
+//datasets of several files kept open for reads, at most 'm_max_open' files at a time; the least
+//recently used file is closed to open another, so that a sequence of thousands of files is read
+//with a few descriptors
+//not thread safe; opens and reads take h5lock_t
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class h5pool_t
+{
+public:
+  h5pool_t();
+  ~h5pool_t();
+
+  struct entry_t
+  {
+    hid_t m_fid;
+    hid_t m_did;
+    hid_t m_mtid; // native memory type
+    std::vector<hsize_t> m_dim;
+    unsigned long m_used; // time of last use
+  };
+
+  //dataset 'path' of file 'file_name', opened if it is not in the pool; NULL if it cannot be opened
+  const entry_t* get(const std::string &file_name, const std::string &path);
+
+  //close all the files
+  void close();
+
+  size_t m_max_open;
+
+private:
+  std::map<std::string, entry_t> m_entries; // by file name
+  unsigned long m_clock;
+
+  h5pool_t(const h5pool_t&);
+  h5pool_t& operator=(const h5pool_t&);
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5aggregate_t
+//virtual variable made of a dataset of the same name in a sequence of files, one file after the
+//other along the first dimension; stacked, each file is one index of a new first dimension, else
+//the files are concatenated along the first dimension of their dataset
+//open() defines the variable: stacked, only the first file is opened, and the other files are checked
+//when they are read; concatenated, each file is opened once for its extent
+//read() routes each part of a hyperslab to the file that holds it, through a h5pool_t
+//the definition is plain data, so it can be copied to the grids that show it
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class h5aggregate_t
+{
+public:
+  h5aggregate_t();
+
+  //returns 0, 1 if canceled by progress (called for each file), -1 if a file cannot be opened,
+  //or if its dataset differs in rank, type, or dimensions other than the first
+  int open(const std::vector<std::string> &file_names, const std::string &path, bool stack, h5progress_t *progress);
+
+  //hyperslab 'start', 'count' in the native memory type of the first file, in 'buf'
+  //returns -1 if a file it needs cannot be read, or its dataset does not match the first one
+  int read(const std::vector<hsize_t> &start, const std::vector<hsize_t> &count, void *buf, h5pool_t &pool) const;
+
+  //file holding index 'idx' of the first dimension
+  size_t file_of(hsize_t idx) const;
+
+  std::vector<std::string> m_file_names;
+  std::string m_path;
+  bool m_stack;
+  std::vector<hsize_t> m_offsets; // first index of each file along the first dimension, and the total
+  std::vector<hsize_t> m_dim;
+  std::vector<hsize_t> m_chunk; // of the first file
+  size_t m_datatype_size;
+  H5T_sign_t m_datatype_sign;
+  H5T_class_t m_datatype_class;
+  h5native_t m_native;
+};
+
+#endif
@@ -0,0 +1,251 @@
+#include <QtDebug>
+#include <cmath>
+#include <limits>
+#include "cf.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//packed_lower, packed_upper
+//a valid_range bound as a packed value of type T: an integer bound is rounded inward and clipped
+//to the values of T, so that comparing packed values gives the same answer as in double
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+T packed_lower(double bound)
+{
+  if(!std::numeric_limits<T>::is_integer)
+    return static_cast<T>(bound);
+  bound = std::ceil(bound);
+  if(bound <= static_cast<double>(std::numeric_limits<T>::min()))
+    return std::numeric_limits<T>::min();
+  if(bound >= static_cast<double>(std::numeric_limits<T>::max()))
+    return std::numeric_limits<T>::max();
+  return static_cast<T>(bound);
+}
+
+template <typename T>
+T packed_upper(double bound)
+{
+  if(!std::numeric_limits<T>::is_integer)
+    return static_cast<T>(bound);
+  bound = std::floor(bound);
+  if(bound <= static_cast<double>(std::numeric_limits<T>::min()))
+    return std::numeric_limits<T>::min();
+  if(bound >= static_cast<double>(std::numeric_limits<T>::max()))
+    return std::numeric_limits<T>::max();
+  return static_cast<T>(bound);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//unpack_kernel_t
+//per range: physical value of each packed value, or NaN if missing
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename T, typename U>
+struct unpack_kernel_t
+{
+  const T *m_buf;
+  U *m_out;
+  U m_scale;
+  U m_offset;
+  bool m_has_fill;
+  T m_fill;
+  bool m_has_missing;
+  T m_missing;
+  T m_valid_min;
+  T m_valid_max;
+
+  void run(const h5range_t &range)
+  {
+    const U nan = std::numeric_limits<U>::quiet_NaN();
+    for(size_t idx = range.begin; idx < range.end; idx++)
+    {
+      T value = m_buf[idx];
+      U unpacked = static_cast<U>(value) * m_scale + m_offset;
+      bool missing = (m_has_fill & (value == m_fill)) | (m_has_missing & (value == m_missing)) |
+        (value < m_valid_min) | (value > m_valid_max);
+      m_out[idx] = missing ? nan : unpacked;
+    }
+  }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//unpack_block_t
+//functor for dispatch(): unpacks a buffer on the thread pool
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct unpack_block_t
+{
+  const h5cf_t *m_cf;
+  const void *m_buf;
+  size_t m_nbr_elements;
+  void *m_out;
+
+  template <typename T, typename U>
+  void run()
+  {
+    unpack_kernel_t<T, U> kernel;
+    kernel.m_buf = static_cast<const T*>(m_buf);
+    kernel.m_out = static_cast<U*>(m_out);
+    kernel.m_scale = static_cast<U>(m_cf->m_scale);
+    kernel.m_offset = static_cast<U>(m_cf->m_offset);
+    kernel.m_has_fill = m_cf->m_has_fill;
+    kernel.m_fill = m_cf->m_has_fill ? static_cast<T>(m_cf->m_fill) : 0;
+    kernel.m_has_missing = m_cf->m_has_missing;
+    kernel.m_missing = m_cf->m_has_missing ? static_cast<T>(m_cf->m_missing) : 0;
+    kernel.m_valid_min = packed_lower<T>(m_cf->m_valid_min);
+    kernel.m_valid_max = packed_upper<T>(m_cf->m_valid_max);
+    std::vector<h5range_t> ranges = make_ranges(m_nbr_elements, 64 * 1024);
+    parallel_for(ranges, kernel);
+  }
+
+  template <typename T>
+  void apply()
+  {
+    if(m_cf->m_unpacked == H5NATIVE_FLOAT)
+      run<T, float>();
+    else
+      run<T, double>();
+  }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//read_attribute
+//up to 'max_values' values of attribute 'name' of 'did', as double; returns the number read, 0 if the
+//attribute is missing or not numeric; 'is_float' tells if it is a 4 byte float
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static size_t read_attribute(hid_t did, const char *name, double *values, size_t max_values, bool *is_float)
+{
+  size_t nbr_values = 0;
+
+  H5E_BEGIN_TRY
+  {
+    if(H5Aexists(did, name) > 0)
+    {
+      hid_t aid = H5Aopen(did, name, H5P_DEFAULT);
+      hid_t sid = H5Aget_space(aid);
+      hid_t ftid = H5Aget_type(aid);
+      hssize_t npoints = H5Sget_simple_extent_npoints(sid);
+      H5T_class_t datatype_class = H5Tget_class(ftid);
+      if(npoints >= 1 && static_cast<size_t>(npoints) <= max_values &&
+        (datatype_class == H5T_INTEGER || datatype_class == H5T_FLOAT) &&
+        H5Aread(aid, H5T_NATIVE_DOUBLE, values) >= 0)
+      {
+        nbr_values = static_cast<size_t>(npoints);
+        if(is_float)
+        {
+          *is_float = datatype_class == H5T_FLOAT && H5Tget_size(ftid) == sizeof(float);
+        }
+      }
+      H5Tclose(ftid);
+      H5Sclose(sid);
+      H5Aclose(aid);
+    }
+  }
+  H5E_END_TRY;
+
+  return nbr_values;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5cf_t::h5cf_t
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+h5cf_t::h5cf_t() :
+m_native(H5NATIVE_NONE),
+m_unpacked(H5NATIVE_DOUBLE),
+m_scale(1),
+m_offset(0),
+m_has_fill(false),
+m_fill(0),
+m_has_missing(false),
+m_missing(0),
+m_valid_min(-std::numeric_limits<double>::infinity()),
+m_valid_max(std::numeric_limits<double>::infinity())
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5cf_t::read
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool h5cf_t::read(hid_t did, h5native_t native)
+{
+  double values[2];
+  bool scale_float = false;
+  bool offset_float = false;
+
+  *this = h5cf_t();
+  m_native = native;
+  if(native == H5NATIVE_NONE)
+  {
+    return false;
+  }
+
+  bool has_scale = read_attribute(did, "scale_factor", values, 1, &scale_float) == 1;
+  if(has_scale)
+  {
+    m_scale = values[0];
+  }
+  bool has_offset = read_attribute(did, "add_offset", values, 1, &offset_float) == 1;
+  if(has_offset)
+  {
+    m_offset = values[0];
+  }
+  if((m_has_fill = read_attribute(did, "_FillValue", values, 1, NULL) == 1))
+  {
+    m_fill = values[0];
+  }
+  if((m_has_missing = read_attribute(did, "missing_value", values, 1, NULL) == 1))
+  {
+    m_missing = values[0];
+  }
+  bool has_valid = false;
+  if(read_attribute(did, "valid_range", values, 2, NULL) == 2)
+  {
+    m_valid_min = values[0];
+    m_valid_max = values[1];
+    has_valid = true;
+  }
+  else
+  {
+    if(read_attribute(did, "valid_min", values, 1, NULL) == 1)
+    {
+      m_valid_min = values[0];
+      has_valid = true;
+    }
+    if(read_attribute(did, "valid_max", values, 1, NULL) == 1)
+    {
+      m_valid_max = values[0];
+      has_valid = true;
+    }
+  }
+
+  if(has_scale || has_offset)
+  {
+    m_unpacked = ((!has_scale || scale_float) && (!has_offset || offset_float)) ? H5NATIVE_FLOAT : H5NATIVE_DOUBLE;
+  }
+  else
+  {
+    bool small = native == H5NATIVE_SCHAR || native == H5NATIVE_UCHAR || native == H5NATIVE_SHORT || native == H5NATIVE_USHORT;
+    m_unpacked = (small || native == H5NATIVE_FLOAT) ? H5NATIVE_FLOAT : H5NATIVE_DOUBLE;
+  }
+  return has_scale || has_offset || m_has_fill || m_has_missing || has_valid;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5cf_t::unpack
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void h5cf_t::unpack(const void *buf, size_t nbr_elements, void *out) const
+{
+  unpack_block_t block;
+  block.m_cf = this;
+  block.m_buf = buf;
+  block.m_nbr_elements = nbr_elements;
+  block.m_out = out;
+  if(nbr_elements > 0)
+  {
+    dispatch(m_native, block);
+  }
+}
@@ -0,0 +1,46 @@
+#ifndef CF_HPP
+#define CF_HPP 1
+
+#include "hdf5.h"
+#include "kernel.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5cf_t
+//CF (netCDF) attributes that give the physical values of a dataset: values stored packed, usually
+//as 16 bit integers, are 'packed * scale_factor + add_offset'; _FillValue, missing_value, and values
+//out of valid_range (or valid_min, valid_max), compared packed, are missing
+//the physical values are float if scale_factor or add_offset is float, or if there are none and
+//the dataset is float or an integer of at most 16 bits; double otherwise
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class h5cf_t
+{
+public:
+  h5cf_t();
+
+  //read the attributes of dataset 'did' of memory type 'native', with h5lock_t held
+  //returns false if the dataset has none of them
+  bool read(hid_t did, h5native_t native);
+
+  //physical values of 'nbr_elements' packed values, in 'out' of type 'm_unpacked', missing values NaN
+  //the loop has no branches so that it vectorizes
+  void unpack(const void *buf, size_t nbr_elements, void *out) const;
+
+  size_t unpacked_size() const
+  {
+    return m_unpacked == H5NATIVE_FLOAT ? sizeof(float) : sizeof(double);
+  }
+
+  h5native_t m_native; // packed
+  h5native_t m_unpacked; // H5NATIVE_FLOAT or H5NATIVE_DOUBLE
+  double m_scale; // 1 if no scale_factor
+  double m_offset; // 0 if no add_offset
+  bool m_has_fill;
+  double m_fill;
+  bool m_has_missing;
+  double m_missing;
+  double m_valid_min; // -inf if not set
+  double m_valid_max; // inf if not set
+};
+
+#endif
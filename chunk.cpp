@@ -0,0 +1,453 @@
+#include <QtDebug>
+#include <cstring>
+#include <zlib.h>
+#include "chunk.hpp"
+#include "slab.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//fletcher32
+//same as H5_checksum_fletcher32: 16 bit big endian words, an odd last byte is the high byte of a word
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static unsigned int fletcher32(const unsigned char *data, size_t len)
+{
+  size_t nbr = len / 2;
+  unsigned int sum1 = 0;
+  unsigned int sum2 = 0;
+
+  while(nbr)
+  {
+    size_t tlen = nbr > 360 ? 360 : nbr;
+    nbr -= tlen;
+    do
+    {
+      sum1 += (static_cast<unsigned int>(data[0]) << 8) | static_cast<unsigned int>(data[1]);
+      data += 2;
+      sum2 += sum1;
+    } while(--tlen);
+    sum1 = (sum1 & 0xffff) + (sum1 >> 16);
+    sum2 = (sum2 & 0xffff) + (sum2 >> 16);
+  }
+
+  if(len % 2)
+  {
+    sum1 += static_cast<unsigned int>(*data) << 8;
+    sum2 += sum1;
+    sum1 = (sum1 & 0xffff) + (sum1 >> 16);
+    sum2 = (sum2 & 0xffff) + (sum2 >> 16);
+  }
+
+  sum1 = (sum1 & 0xffff) + (sum1 >> 16);
+  sum2 = (sum2 & 0xffff) + (sum2 >> 16);
+  return (sum2 << 16) | sum1;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5chunk_t::h5chunk_t
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+h5chunk_t::h5chunk_t() :
+m_supported(false),
+m_verify(true),
+m_datatype_size(0)
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5chunk_t::init
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool h5chunk_t::init(hid_t did)
+{
+  m_supported = false;
+  m_filters.clear();
+  m_chunk.clear();
+  m_fill.clear();
+
+#if H5_VERSION_GE(1,10,3)
+  h5lock_t lock;
+  hid_t dcpl;
+  hid_t ftid;
+  hid_t mtid;
+  hid_t sid;
+  hsize_t chunk[H5S_MAX_RANK];
+  int rank;
+  bool supported = true;
+
+  if((sid = H5Dget_space(did)) < 0)
+  {
+    return false;
+  }
+  rank = H5Sget_simple_extent_ndims(sid);
+  H5Sclose(sid);
+  if(rank <= 0)
+  {
+    return false;
+  }
+
+  //the chunks are copied as stored: the file type must be the memory type
+  if((ftid = H5Dget_type(did)) < 0)
+  {
+    return false;
+  }
+  if((mtid = H5Tget_native_type(ftid, H5T_DIR_DEFAULT)) < 0)
+  {
+    H5Tclose(ftid);
+    return false;
+  }
+  if(H5Tequal(ftid, mtid) <= 0 || H5Tget_class(mtid) == H5T_VLEN || H5Tis_variable_str(mtid) != 0)
+  {
+    supported = false;
+  }
+  m_datatype_size = H5Tget_size(mtid);
+  H5Tclose(ftid);
+
+  if((dcpl = H5Dget_create_plist(did)) < 0)
+  {
+    H5Tclose(mtid);
+    return false;
+  }
+
+  if(supported && H5Pget_layout(dcpl) == H5D_CHUNKED && H5Pget_chunk(dcpl, rank, chunk) == rank)
+  {
+    m_chunk.assign(chunk, chunk + rank);
+    int nbr_filters = H5Pget_nfilters(dcpl);
+    for(int idx = 0; idx < nbr_filters; idx++)
+    {
+      h5filter_t filter;
+      unsigned int values[8];
+      size_t nbr_values = 8;
+      filter.m_id = H5Pget_filter2(dcpl, static_cast<unsigned>(idx), &filter.m_flags, &nbr_values, values, 0, NULL, NULL);
+      if(filter.m_id != H5Z_FILTER_DEFLATE && filter.m_id != H5Z_FILTER_SHUFFLE && filter.m_id != H5Z_FILTER_FLETCHER32)
+      {
+        supported = false;
+        break;
+      }
+      m_filters.push_back(filter);
+    }
+
+    m_fill.assign(m_datatype_size, 0);
+    H5D_fill_value_t fill_status;
+    if(H5Pfill_value_defined(dcpl, &fill_status) >= 0 && fill_status != H5D_FILL_VALUE_UNDEFINED)
+    {
+      if(H5Pget_fill_value(dcpl, mtid, &m_fill[0]) < 0)
+      {
+        supported = false;
+      }
+    }
+    m_supported = supported;
+  }
+
+  H5Pclose(dcpl);
+  H5Tclose(mtid);
+#else
+  (void)did;
+#endif
+
+  return m_supported;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5chunk_t::decode
+//run the filters in reverse order, skipping those set in the chunk filter mask
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5chunk_t::decode(std::vector<char> &raw, unsigned int filter_mask, std::vector<char> &out) const
+{
+  size_t chunk_bytes = m_datatype_size;
+  for(size_t idx = 0; idx < m_chunk.size(); idx++)
+  {
+    chunk_bytes *= static_cast<size_t>(m_chunk[idx]);
+  }
+
+  std::vector<char> tmp;
+  for(size_t idx = m_filters.size(); idx-- > 0;)
+  {
+    if(filter_mask & (1u << idx))
+    {
+      continue;
+    }
+
+    switch(m_filters[idx].m_id)
+    {
+    case H5Z_FILTER_FLETCHER32:
+      {
+        if(raw.size() < 4)
+        {
+          return -1;
+        }
+        size_t len = raw.size() - 4;
+        if(m_verify)
+        {
+          const unsigned char *p = reinterpret_cast<const unsigned char*>(&raw[len]);
+          unsigned int stored = p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<unsigned int>(p[3]) << 24);
+          unsigned int sum = fletcher32(reinterpret_cast<const unsigned char*>(&raw[0]), len);
+          //files written before 1.6.3 have the checksum bytes reversed
+          unsigned int reversed = ((sum & 0xff) << 24) | ((sum & 0xff00) << 8) | ((sum >> 8) & 0xff00) | (sum >> 24);
+          if(stored != sum && stored != reversed)
+          {
+            qDebug() << "fletcher32 checksum mismatch";
+            return -1;
+          }
+        }
+        raw.resize(len);
+      }
+      break;
+
+    case H5Z_FILTER_DEFLATE:
+      {
+        uLongf len = static_cast<uLongf>(chunk_bytes);
+        tmp.resize(chunk_bytes);
+        if(uncompress(reinterpret_cast<Bytef*>(&tmp[0]), &len,
+          reinterpret_cast<const Bytef*>(raw.empty() ? NULL : &raw[0]), static_cast<uLong>(raw.size())) != Z_OK)
+        {
+          return -1;
+        }
+        tmp.resize(len);
+        raw.swap(tmp);
+      }
+      break;
+
+    case H5Z_FILTER_SHUFFLE:
+      {
+        size_t size = m_datatype_size;
+        size_t nbr = raw.size() / size;
+        if(size > 1 && nbr > 1)
+        {
+          tmp.resize(raw.size());
+          for(size_t byte = 0; byte < size; byte++)
+          {
+            const char *src = &raw[byte * nbr];
+            char *dst = &tmp[byte];
+            for(size_t k = 0; k < nbr; k++, dst += size)
+            {
+              *dst = src[k];
+            }
+          }
+          //bytes past the last whole element are not shuffled
+          if(raw.size() > nbr * size)
+          {
+            memcpy(&tmp[nbr * size], &raw[nbr * size], raw.size() - nbr * size);
+          }
+          raw.swap(tmp);
+        }
+      }
+      break;
+
+    default:
+      return -1;
+    }
+  }
+
+  if(raw.size() != chunk_bytes)
+  {
+    return -1;
+  }
+  out.swap(raw);
+  return 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5chunk_item_t
+//one chunk of the hyperslab: its offset in the dataset and, once read, its raw bytes
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct h5chunk_item_t
+{
+  std::vector<hsize_t> m_offset;
+  std::vector<char> m_raw;
+  unsigned int m_filter_mask;
+  bool m_allocated;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//decode_kernel_t
+//decodes the chunks of a range and copies their intersection with the hyperslab to the destination,
+//one run of the last dimension at a time
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct decode_kernel_t
+{
+  const h5chunk_t *m_chunk;
+  std::vector<h5chunk_item_t> *m_items;
+  const std::vector<hsize_t> *m_start;
+  const std::vector<hsize_t> *m_count;
+  char *m_buf;
+  std::vector<int> *m_result;
+
+  void run(const h5range_t &range)
+  {
+    const std::vector<hsize_t> &chunk = m_chunk->m_chunk;
+    const std::vector<hsize_t> &start = *m_start;
+    const std::vector<hsize_t> &count = *m_count;
+    size_t rank = chunk.size();
+    size_t size = m_chunk->m_datatype_size;
+    std::vector<char> data;
+    std::vector<hsize_t> lo(rank);
+    std::vector<hsize_t> hi(rank);
+    std::vector<hsize_t> pos(rank);
+
+    for(size_t idx_item = range.begin; idx_item < range.end; idx_item++)
+    {
+      h5chunk_item_t &item = (*m_items)[idx_item];
+      if(item.m_allocated)
+      {
+        if(m_chunk->decode(item.m_raw, item.m_filter_mask, data) < 0)
+        {
+          (*m_result)[range.idx] = -1;
+          return;
+        }
+      }
+      std::vector<char>().swap(item.m_raw);
+
+      for(size_t idx = 0; idx < rank; idx++)
+      {
+        lo[idx] = std::max(item.m_offset[idx], start[idx]);
+        hi[idx] = std::min(item.m_offset[idx] + chunk[idx], start[idx] + count[idx]);
+      }
+      size_t run_bytes = static_cast<size_t>(hi[rank - 1] - lo[rank - 1]) * size;
+
+      pos = lo;
+      for(;;)
+      {
+        size_t src = 0;
+        size_t dst = 0;
+        for(size_t idx = 0; idx < rank; idx++)
+        {
+          src = src * static_cast<size_t>(chunk[idx]) + static_cast<size_t>(pos[idx] - item.m_offset[idx]);
+          dst = dst * static_cast<size_t>(count[idx]) + static_cast<size_t>(pos[idx] - start[idx]);
+        }
+        if(item.m_allocated)
+        {
+          memcpy(m_buf + dst * size, &data[src * size], run_bytes);
+        }
+        else
+        {
+          for(size_t k = 0; k < run_bytes; k += size)
+          {
+            memcpy(m_buf + dst * size + k, &m_chunk->m_fill[0], size);
+          }
+        }
+
+        //next run: increment the position in all dimensions but the last
+        size_t dmn = rank - 1;
+        while(dmn > 0 && ++pos[dmn - 1] == hi[dmn - 1])
+        {
+          pos[dmn - 1] = lo[dmn - 1];
+          dmn--;
+        }
+        if(dmn == 0)
+          break;
+      }
+    }
+  }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5chunk_t::read
+//the chunks are processed in batches of about 64MB so that the raw data held in memory is bounded
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5chunk_t::read(hid_t did, const std::vector<hsize_t> &start, const std::vector<hsize_t> &count, void *buf)
+{
+  size_t rank = m_chunk.size();
+  if(!m_supported || start.size() != rank || count.size() != rank)
+  {
+    return -1;
+  }
+
+#if H5_VERSION_GE(1,10,3)
+  size_t chunk_bytes = m_datatype_size;
+  std::vector<hsize_t> first(rank);
+  std::vector<hsize_t> nbr(rank);
+  size_t nbr_chunks = 1;
+  for(size_t idx = 0; idx < rank; idx++)
+  {
+    if(count[idx] == 0)
+    {
+      return 0;
+    }
+    chunk_bytes *= static_cast<size_t>(m_chunk[idx]);
+    first[idx] = start[idx] / m_chunk[idx];
+    nbr[idx] = (start[idx] + count[idx] - 1) / m_chunk[idx] - first[idx] + 1;
+    nbr_chunks *= static_cast<size_t>(nbr[idx]);
+  }
+
+  const size_t batch_bytes = 64 * 1024 * 1024;
+  size_t batch_size = std::max(batch_bytes / std::max(chunk_bytes, static_cast<size_t>(1)), static_cast<size_t>(1));
+
+  for(size_t idx_first = 0; idx_first < nbr_chunks; idx_first += batch_size)
+  {
+    size_t idx_last = std::min(idx_first + batch_size, nbr_chunks);
+    std::vector<h5chunk_item_t> items(idx_last - idx_first);
+
+    //raw reads, in chunk order
+    {
+      h5lock_t lock;
+      for(size_t idx_chunk = idx_first; idx_chunk < idx_last; idx_chunk++)
+      {
+        h5chunk_item_t &item = items[idx_chunk - idx_first];
+        size_t k = idx_chunk;
+        item.m_offset.resize(rank);
+        for(size_t idx = rank; idx-- > 0;)
+        {
+          item.m_offset[idx] = (first[idx] + k % nbr[idx]) * m_chunk[idx];
+          k /= static_cast<size_t>(nbr[idx]);
+        }
+
+        //a chunk never written is an error for the 1.10 library, and holds the fill value
+        hsize_t nbr_bytes = 0;
+        herr_t status;
+        H5E_BEGIN_TRY
+        {
+          status = H5Dget_chunk_storage_size(did, &item.m_offset[0], &nbr_bytes);
+        }
+        H5E_END_TRY;
+        if(status < 0)
+        {
+          nbr_bytes = 0;
+        }
+        item.m_allocated = (nbr_bytes > 0);
+        item.m_filter_mask = 0;
+        if(item.m_allocated)
+        {
+          item.m_raw.resize(static_cast<size_t>(nbr_bytes));
+          uint32_t filter_mask = 0;
+          if(H5Dread_chunk(did, H5P_DEFAULT, &item.m_offset[0], &filter_mask, &item.m_raw[0]) < 0)
+          {
+            qDebug() << "H5Dread_chunk failed";
+            return -1;
+          }
+          item.m_filter_mask = filter_mask;
+        }
+      }
+    }
+
+    //decode and scatter on the thread pool
+    decode_kernel_t kernel;
+    std::vector<h5range_t> ranges = make_ranges(items.size(), 1);
+    std::vector<int> result(ranges.size(), 0);
+    kernel.m_chunk = this;
+    kernel.m_items = &items;
+    kernel.m_start = &start;
+    kernel.m_count = &count;
+    kernel.m_buf = static_cast<char*>(buf);
+    kernel.m_result = &result;
+    parallel_for(ranges, kernel);
+    for(size_t idx = 0; idx < result.size(); idx++)
+    {
+      if(result[idx] < 0)
+      {
+        qDebug() << "chunk decode failed";
+        return -1;
+      }
+    }
+  }
+
+  return 0;
+#else
+  (void)did;
+  (void)buf;
+  return -1;
+#endif
+}
@@ -0,0 +1,49 @@
+#ifndef CHUNK_HPP
+#define CHUNK_HPP 1
+
+#include <vector>
+#include "hdf5.h"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5filter_t
+//a filter of the pipeline of a dataset
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct h5filter_t
+{
+  H5Z_filter_t m_id;
+  unsigned int m_flags;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5chunk_t
+//reads a hyperslab of a chunked dataset with direct chunk reads
+//H5Dread decompresses one chunk at a time in the calling thread; here the raw chunks are fetched
+//serially with H5Dread_chunk (holding h5lock_t) and the filter pipeline (fletcher32, deflate, shuffle)
+//is run on the thread pool, each task scattering its decoded chunk into the destination buffer
+//only datasets whose filters are all supported and whose file type is the native type can be read
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class h5chunk_t
+{
+public:
+  h5chunk_t();
+
+  //inspect dataset 'did'; returns true if read() can be used
+  bool init(hid_t did);
+
+  //read hyperslab 'start', 'count' into 'buf', stored in row major order with dimensions 'count'
+  int read(hid_t did, const std::vector<hsize_t> &start, const std::vector<hsize_t> &count, void *buf);
+
+  bool m_supported; // set by init()
+  bool m_verify; // verify fletcher32 checksums
+  std::vector<hsize_t> m_chunk; // chunk dimensions
+  size_t m_datatype_size;
+  std::vector<h5filter_t> m_filters; // in the order applied when writing
+  std::vector<char> m_fill; // fill value, for chunks not allocated
+
+  //decode one raw chunk into 'out' (chunk size bytes); returns -1 on error
+  int decode(std::vector<char> &raw, unsigned int filter_mask, std::vector<char> &out) const;
+};
+
+#endif
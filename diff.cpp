@@ -0,0 +1,770 @@
+#include <QtDebug>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include "diff.hpp"
+#include "http.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//append_note
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void append_note(std::string &note, const std::string &str)
+{
+  if(!note.empty())
+  {
+    note += "; ";
+  }
+  note += str;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//join_path
+//path of an object found at 'relative' under group 'path'
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static std::string join_path(const std::string &path, const std::string &relative)
+{
+  if(relative.empty())
+    return path;
+  if(!path.empty() && path[path.size() - 1] == '/')
+    return path + relative;
+  return path + "/" + relative;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//get_coord
+//dataset coordinates of element 'offset' of a block
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void get_coord(size_t offset, const std::vector<hsize_t> &start, const std::vector<hsize_t> &count, std::vector<hsize_t> &coord)
+{
+  size_t rank = count.size();
+  coord.resize(rank);
+  for(size_t dmn = rank; dmn-- > 0;)
+  {
+    size_t n = static_cast<size_t>(count[dmn]);
+    coord[dmn] = start[dmn] + offset % n;
+    offset /= n;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//to_double_t
+//functor for dispatch(): converts a block to double, to compare datasets of different types
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct to_double_t
+{
+  const void *m_buf;
+  size_t m_nbr_elements;
+  std::vector<double> *m_out;
+
+  template <typename T>
+  void apply()
+  {
+    const T *buf = static_cast<const T*>(m_buf);
+    m_out->resize(m_nbr_elements);
+    for(size_t idx = 0; idx < m_nbr_elements; idx++)
+    {
+      (*m_out)[idx] = static_cast<double>(buf[idx]);
+    }
+  }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//diff_kernel_t
+//per range: count the values out of tolerance and find the largest errors, then, only if needed,
+//collect the block offsets of the differences and of the largest absolute error
+//the first loop has no branches so that it vectorizes
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+struct diff_kernel_t
+{
+  const T *m_a;
+  const T *m_b;
+  double m_abs_tol;
+  double m_rel_tol;
+  size_t m_max_locations;
+  std::vector<size_t> m_count; // per range
+  std::vector<double> m_max_abs;
+  std::vector<double> m_max_rel;
+  std::vector<size_t> m_max_offset;
+  std::vector< std::vector<size_t> > m_offset;
+
+  static bool differ(double a, double b, double d, double abs_tol, double rel_tol)
+  {
+    //inf == inf gives d NaN, and NaN == NaN is not a difference
+    return (d > abs_tol + rel_tol * std::fabs(a)) | ((a != a) != (b != b));
+  }
+
+  void run(const h5range_t &range)
+  {
+    const T *buf_a = m_a;
+    const T *buf_b = m_b;
+    double abs_tol = m_abs_tol;
+    double rel_tol = m_rel_tol;
+    size_t nbr = 0;
+    double max_abs = 0;
+    double max_rel = 0;
+
+    for(size_t idx = range.begin; idx < range.end; idx++)
+    {
+      double a = static_cast<double>(buf_a[idx]);
+      double b = static_cast<double>(buf_b[idx]);
+      double d = std::fabs(a - b);
+      double r = (a != 0) ? d / std::fabs(a) : 0;
+      nbr += differ(a, b, d, abs_tol, rel_tol);
+      max_abs = d > max_abs ? d : max_abs;
+      max_rel = r > max_rel ? r : max_rel;
+    }
+
+    m_count[range.idx] = nbr;
+    m_max_abs[range.idx] = max_abs;
+    m_max_rel[range.idx] = max_rel;
+    if(nbr == 0 && max_abs == 0)
+    {
+      return;
+    }
+
+    std::vector<size_t> &offset = m_offset[range.idx];
+    bool found = false;
+    for(size_t idx = range.begin; idx < range.end; idx++)
+    {
+      double a = static_cast<double>(buf_a[idx]);
+      double b = static_cast<double>(buf_b[idx]);
+      double d = std::fabs(a - b);
+      if(!found && d == max_abs)
+      {
+        m_max_offset[range.idx] = idx;
+        found = true;
+      }
+      if(offset.size() < m_max_locations && differ(a, b, d, abs_tol, rel_tol))
+      {
+        offset.push_back(idx);
+      }
+      if(found && (offset.size() >= m_max_locations || nbr == 0))
+      {
+        break;
+      }
+    }
+  }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//diff_block_t
+//functor for dispatch(): runs the kernel of type T on a pair of blocks and merges the results
+//into the object
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct diff_block_t
+{
+  h5diff_object_t *m_object;
+  double m_abs_tol;
+  double m_rel_tol;
+  size_t m_max_locations;
+  const void *m_a;
+  const void *m_b;
+  size_t m_nbr_elements;
+  const std::vector<hsize_t> *m_start;
+  const std::vector<hsize_t> *m_count;
+
+  template <typename T>
+  void apply()
+  {
+    diff_kernel_t<T> kernel;
+    std::vector<h5range_t> ranges = make_ranges(m_nbr_elements, 64 * 1024);
+
+    kernel.m_a = static_cast<const T*>(m_a);
+    kernel.m_b = static_cast<const T*>(m_b);
+    kernel.m_abs_tol = m_abs_tol;
+    kernel.m_rel_tol = m_rel_tol;
+    kernel.m_max_locations = m_max_locations > m_object->m_locations.size() ? m_max_locations - m_object->m_locations.size() : 0;
+    kernel.m_count.assign(ranges.size(), 0);
+    kernel.m_max_abs.assign(ranges.size(), 0);
+    kernel.m_max_rel.assign(ranges.size(), 0);
+    kernel.m_max_offset.assign(ranges.size(), 0);
+    kernel.m_offset.resize(ranges.size());
+
+    parallel_for(ranges, kernel);
+
+    //merge in range order, which is row major order inside the block
+    for(size_t idx_range = 0; idx_range < ranges.size(); idx_range++)
+    {
+      m_object->m_nbr_diff += kernel.m_count[idx_range];
+      if(kernel.m_max_abs[idx_range] > m_object->m_max_abs)
+      {
+        m_object->m_max_abs = kernel.m_max_abs[idx_range];
+        get_coord(kernel.m_max_offset[idx_range], *m_start, *m_count, m_object->m_max_coord);
+      }
+      if(kernel.m_max_rel[idx_range] > m_object->m_max_rel)
+      {
+        m_object->m_max_rel = kernel.m_max_rel[idx_range];
+      }
+      const std::vector<size_t> &offset = kernel.m_offset[idx_range];
+      for(size_t idx = 0; idx < offset.size() && m_object->m_locations.size() < m_max_locations; idx++)
+      {
+        h5diff_location_t location;
+        get_coord(offset[idx], *m_start, *m_count, location.m_coord);
+        location.m_value_a = static_cast<double>(kernel.m_a[offset[idx]]);
+        location.m_value_b = static_cast<double>(kernel.m_b[offset[idx]]);
+        m_object->m_locations.push_back(location);
+      }
+    }
+  }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5diff_t::compare
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5diff_t::compare(const char* file_a, const char* path_a, const char* file_b, const char* path_b, h5progress_t *progress)
+{
+  std::map<std::string, H5O_type_t> objects_a; // relative path to type
+  std::map<std::string, H5O_type_t> objects_b;
+  std::vector<size_t> values; // objects whose values are compared
+  int result = 0;
+
+  m_objects.clear();
+  m_nbr_different = 0;
+  m_nbr_done = 0;
+  m_nbr_total = 0;
+
+  {
+    h5lock_t lock;
+    H5O_info_t oinfo_a;
+    H5O_info_t oinfo_b;
+
+    if((m_fid_a = h5file_open(file_a)) < 0)
+    {
+      return -1;
+    }
+    if((m_fid_b = h5file_open(file_b)) < 0)
+    {
+      H5Fclose(m_fid_a);
+      return -1;
+    }
+    if(H5Oget_info_by_name(m_fid_a, path_a, &oinfo_a, H5P_DEFAULT) < 0 ||
+      H5Oget_info_by_name(m_fid_b, path_b, &oinfo_b, H5P_DEFAULT) < 0)
+    {
+      H5Fclose(m_fid_a);
+      H5Fclose(m_fid_b);
+      return -1;
+    }
+
+    //list the objects under both; a dataset compared with a group is a type difference
+    objects_a[""] = oinfo_a.type;
+    objects_b[""] = oinfo_b.type;
+    if(oinfo_a.type == H5O_TYPE_GROUP && oinfo_b.type == H5O_TYPE_GROUP)
+    {
+      H5Lvisit_by_name(m_fid_a, path_a, H5_INDEX_NAME, H5_ITER_INC, visit_link_cb, &objects_a, H5P_DEFAULT);
+      H5Lvisit_by_name(m_fid_b, path_b, H5_INDEX_NAME, H5_ITER_INC, visit_link_cb, &objects_b, H5P_DEFAULT);
+    }
+  }
+
+  //match by relative path
+  std::map<std::string, H5O_type_t>::const_iterator it_a = objects_a.begin();
+  std::map<std::string, H5O_type_t>::const_iterator it_b = objects_b.begin();
+  while(it_a != objects_a.end() || it_b != objects_b.end())
+  {
+    h5diff_object_t object;
+    object.m_nbr_elements = 0;
+    object.m_nbr_diff = 0;
+    object.m_max_abs = 0;
+    object.m_max_rel = 0;
+
+    if(it_b == objects_b.end() || (it_a != objects_a.end() && it_a->first < it_b->first))
+    {
+      object.m_path_a = join_path(path_a, it_a->first);
+      object.m_type = it_a->second;
+      object.m_status = DIFF_ONLY_A;
+      ++it_a;
+    }
+    else if(it_a == objects_a.end() || it_b->first < it_a->first)
+    {
+      object.m_path_b = join_path(path_b, it_b->first);
+      object.m_type = it_b->second;
+      object.m_status = DIFF_ONLY_B;
+      ++it_b;
+    }
+    else
+    {
+      object.m_path_a = join_path(path_a, it_a->first);
+      object.m_path_b = join_path(path_b, it_b->first);
+      object.m_type = it_a->second;
+      object.m_status = DIFF_EQUAL;
+      if(it_a->second != it_b->second)
+      {
+        object.m_status = DIFF_METADATA;
+        object.m_note = "object type";
+      }
+      else if(compare_metadata(object) > 0)
+      {
+        values.push_back(m_objects.size());
+        m_nbr_total += object.m_nbr_elements;
+      }
+      ++it_a;
+      ++it_b;
+    }
+    m_objects.push_back(object);
+  }
+
+  {
+    h5lock_t lock;
+    H5Fclose(m_fid_a);
+    H5Fclose(m_fid_b);
+  }
+
+  for(size_t idx = 0; idx < values.size() && result == 0; idx++)
+  {
+    h5diff_object_t &object = m_objects[values[idx]];
+    if((result = compare_values(file_a, file_b, object, progress)) < 0)
+    {
+      append_note(object.m_note, "values cannot be read");
+      object.m_status = DIFF_VALUES;
+      result = 0;
+    }
+  }
+
+  for(size_t idx = 0; idx < m_objects.size(); idx++)
+  {
+    if(m_objects[idx].m_status != DIFF_EQUAL)
+    {
+      m_nbr_different++;
+    }
+  }
+  return result;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5diff_t::compare_metadata
+//returns 1 if the values of the datasets are to be compared, 0 if not
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5diff_t::compare_metadata(h5diff_object_t &object)
+{
+  h5lock_t lock;
+  int result = 0;
+
+  if(object.m_type == H5O_TYPE_DATASET)
+  {
+    hid_t did_a;
+    hid_t did_b;
+    if((did_a = H5Dopen2(m_fid_a, object.m_path_a.c_str(), H5P_DEFAULT)) < 0)
+    {
+      object.m_status = DIFF_METADATA;
+      object.m_note = "cannot open";
+      return 0;
+    }
+    if((did_b = H5Dopen2(m_fid_b, object.m_path_b.c_str(), H5P_DEFAULT)) < 0)
+    {
+      H5Dclose(did_a);
+      object.m_status = DIFF_METADATA;
+      object.m_note = "cannot open";
+      return 0;
+    }
+
+    hid_t ftid_a = H5Dget_type(did_a);
+    hid_t ftid_b = H5Dget_type(did_b);
+    hid_t sid_a = H5Dget_space(did_a);
+    hid_t sid_b = H5Dget_space(did_b);
+    hsize_t dims_a[H5S_MAX_RANK];
+    hsize_t dims_b[H5S_MAX_RANK];
+    int rank_a = H5Sget_simple_extent_dims(sid_a, dims_a, NULL);
+    int rank_b = H5Sget_simple_extent_dims(sid_b, dims_b, NULL);
+    bool same_dims = rank_a >= 0 && rank_a == rank_b &&
+      std::equal(dims_a, dims_a + rank_a, dims_b);
+    bool numeric = false;
+
+    if(H5Tequal(ftid_a, ftid_b) <= 0)
+    {
+      append_note(object.m_note, "datatype");
+    }
+    if(!same_dims)
+    {
+      append_note(object.m_note, "dimensions");
+    }
+
+    hid_t mtid_a = H5Tget_native_type(ftid_a, H5T_DIR_DEFAULT);
+    hid_t mtid_b = H5Tget_native_type(ftid_b, H5T_DIR_DEFAULT);
+    if(mtid_a >= 0 && mtid_b >= 0)
+    {
+      numeric = get_native(H5Tget_class(mtid_a), H5Tget_size(mtid_a), H5Tget_sign(mtid_a)) != H5NATIVE_NONE &&
+        get_native(H5Tget_class(mtid_b), H5Tget_size(mtid_b), H5Tget_sign(mtid_b)) != H5NATIVE_NONE;
+    }
+    if(mtid_a >= 0)
+      H5Tclose(mtid_a);
+    if(mtid_b >= 0)
+      H5Tclose(mtid_b);
+
+    if(same_dims && numeric)
+    {
+      hssize_t nbr_elements = H5Sget_simple_extent_npoints(sid_a);
+      object.m_nbr_elements = nbr_elements > 0 ? static_cast<hsize_t>(nbr_elements) : 0;
+      result = object.m_nbr_elements > 0 ? 1 : 0;
+    }
+
+    compare_attributes(did_a, did_b, object.m_note);
+    if(!object.m_note.empty())
+    {
+      object.m_status = DIFF_METADATA;
+    }
+    if(same_dims && !numeric)
+    {
+      append_note(object.m_note, "values not compared (not numeric)");
+    }
+
+    H5Sclose(sid_a);
+    H5Sclose(sid_b);
+    H5Tclose(ftid_a);
+    H5Tclose(ftid_b);
+    H5Dclose(did_a);
+    H5Dclose(did_b);
+  }
+  else
+  {
+    hid_t oid_a;
+    hid_t oid_b;
+    if((oid_a = H5Oopen(m_fid_a, object.m_path_a.c_str(), H5P_DEFAULT)) >= 0)
+    {
+      if((oid_b = H5Oopen(m_fid_b, object.m_path_b.c_str(), H5P_DEFAULT)) >= 0)
+      {
+        compare_attributes(oid_a, oid_b, object.m_note);
+        H5Oclose(oid_b);
+      }
+      H5Oclose(oid_a);
+    }
+    if(!object.m_note.empty())
+    {
+      object.m_status = DIFF_METADATA;
+    }
+  }
+
+  return result;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5diff_t::compare_attributes
+//attributes of the same name must have the same type, dimensions and values; variable length
+//strings are compared as strings, other variable length values are not compared
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void h5diff_t::compare_attributes(hid_t oid_a, hid_t oid_b, std::string &note)
+{
+  std::vector<std::string> names_a;
+  std::vector<std::string> names_b;
+  hsize_t idx = 0;
+
+  H5Aiterate2(oid_a, H5_INDEX_NAME, H5_ITER_INC, &idx, attribute_cb, &names_a);
+  idx = 0;
+  H5Aiterate2(oid_b, H5_INDEX_NAME, H5_ITER_INC, &idx, attribute_cb, &names_b);
+
+  size_t idx_a = 0;
+  size_t idx_b = 0;
+  while(idx_a < names_a.size() || idx_b < names_b.size())
+  {
+    if(idx_b == names_b.size() || (idx_a < names_a.size() && names_a[idx_a] < names_b[idx_b]))
+    {
+      append_note(note, "attribute " + names_a[idx_a++] + " only in first");
+      continue;
+    }
+    if(idx_a == names_a.size() || names_b[idx_b] < names_a[idx_a])
+    {
+      append_note(note, "attribute " + names_b[idx_b++] + " only in second");
+      continue;
+    }
+
+    const std::string &name = names_a[idx_a];
+    bool same = false;
+
+    //attributes that cannot be read are reported as different
+    H5E_BEGIN_TRY
+    {
+      hid_t aid_a = H5Aopen(oid_a, name.c_str(), H5P_DEFAULT);
+      hid_t aid_b = H5Aopen(oid_b, name.c_str(), H5P_DEFAULT);
+      if(aid_a >= 0 && aid_b >= 0)
+      {
+        hid_t ftid_a = H5Aget_type(aid_a);
+        hid_t ftid_b = H5Aget_type(aid_b);
+        hid_t sid_a = H5Aget_space(aid_a);
+        hid_t sid_b = H5Aget_space(aid_b);
+        hssize_t nbr_elements = H5Sget_simple_extent_npoints(sid_a);
+        if(H5Tequal(ftid_a, ftid_b) > 0 && H5Sextent_equal(sid_a, sid_b) > 0 && nbr_elements >= 0)
+        {
+          size_t nbr = static_cast<size_t>(nbr_elements);
+          if(H5Tis_variable_str(ftid_a) > 0)
+          {
+            hid_t mtid = H5Tcopy(H5T_C_S1);
+            H5Tset_size(mtid, H5T_VARIABLE);
+            H5Tset_cset(mtid, H5Tget_cset(ftid_a));
+            std::vector<char*> str_a(nbr + 1, (char*)NULL);
+            std::vector<char*> str_b(nbr + 1, (char*)NULL);
+            if(H5Aread(aid_a, mtid, &str_a[0]) >= 0 && H5Aread(aid_b, mtid, &str_b[0]) >= 0)
+            {
+              same = true;
+              for(size_t idx_str = 0; idx_str < nbr && same; idx_str++)
+              {
+                same = strcmp(str_a[idx_str] ? str_a[idx_str] : "", str_b[idx_str] ? str_b[idx_str] : "") == 0;
+              }
+            }
+            H5Dvlen_reclaim(mtid, sid_a, H5P_DEFAULT, &str_a[0]);
+            H5Dvlen_reclaim(mtid, sid_b, H5P_DEFAULT, &str_b[0]);
+            H5Tclose(mtid);
+          }
+          else if(H5Tdetect_class(ftid_a, H5T_VLEN) > 0)
+          {
+            same = true;
+          }
+          else
+          {
+            hid_t mtid = H5Tget_native_type(ftid_a, H5T_DIR_DEFAULT);
+            size_t size = mtid >= 0 ? H5Tget_size(mtid) : 0;
+            std::vector<char> buf_a(nbr * size + 1);
+            std::vector<char> buf_b(nbr * size + 1);
+            if(mtid >= 0 && H5Aread(aid_a, mtid, &buf_a[0]) >= 0 && H5Aread(aid_b, mtid, &buf_b[0]) >= 0)
+            {
+              same = memcmp(&buf_a[0], &buf_b[0], nbr * size) == 0;
+            }
+            if(mtid >= 0)
+              H5Tclose(mtid);
+          }
+        }
+        H5Sclose(sid_a);
+        H5Sclose(sid_b);
+        H5Tclose(ftid_a);
+        H5Tclose(ftid_b);
+      }
+      if(aid_a >= 0)
+        H5Aclose(aid_a);
+      if(aid_b >= 0)
+        H5Aclose(aid_b);
+    }
+    H5E_END_TRY;
+    if(!same)
+    {
+      append_note(note, "attribute " + name);
+    }
+    idx_a++;
+    idx_b++;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5diff_t::compare_values
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5diff_t::compare_values(const char* file_a, const char* file_b, h5diff_object_t &object, h5progress_t *progress)
+{
+  h5slab_t slab_a;
+  h5slab_t slab_b;
+  int result = 0;
+
+  if(slab_a.open(file_a, object.m_path_a.c_str()) < 0 || slab_b.open(file_b, object.m_path_b.c_str()) < 0)
+  {
+    return -1;
+  }
+
+  std::vector<char> buf_b(slab_a.max_block_elements() * slab_b.m_datatype_size);
+  std::vector<double> double_a;
+  std::vector<double> double_b;
+  h5queue_t<h5block_t*> queue(2);
+  h5reader_t reader(&slab_a, &queue);
+  reader.start();
+
+  h5block_t *block;
+  while(queue.pop(block))
+  {
+    if(slab_b.read(block->m_start, block->m_count, &buf_b[0]) < 0)
+    {
+      delete block;
+      result = -1;
+      break;
+    }
+
+    diff_block_t diff_block;
+    diff_block.m_object = &object;
+    diff_block.m_abs_tol = m_abs_tol;
+    diff_block.m_rel_tol = m_rel_tol;
+    diff_block.m_max_locations = m_max_locations;
+    diff_block.m_nbr_elements = block->m_nbr_elements;
+    diff_block.m_start = &block->m_start;
+    diff_block.m_count = &block->m_count;
+    if(slab_a.m_native == slab_b.m_native)
+    {
+      diff_block.m_a = &block->m_buf[0];
+      diff_block.m_b = &buf_b[0];
+      dispatch(slab_a.m_native, diff_block);
+    }
+    else
+    {
+      to_double_t convert;
+      convert.m_nbr_elements = block->m_nbr_elements;
+      convert.m_buf = &block->m_buf[0];
+      convert.m_out = &double_a;
+      dispatch(slab_a.m_native, convert);
+      convert.m_buf = &buf_b[0];
+      convert.m_out = &double_b;
+      dispatch(slab_b.m_native, convert);
+      diff_block.m_a = &double_a[0];
+      diff_block.m_b = &double_b[0];
+      diff_block.apply<double>();
+    }
+
+    m_nbr_done += block->m_nbr_elements;
+    delete block;
+    if(progress && !progress->progress(m_nbr_done, m_nbr_total))
+    {
+      result = 1;
+      break;
+    }
+  }
+
+  queue.close();
+  reader.wait();
+  while(queue.pop(block))
+  {
+    delete block;
+  }
+  if(reader.m_result < 0)
+  {
+    result = -1;
+  }
+
+  if(result == 0 && object.m_nbr_diff > 0)
+  {
+    object.m_status = DIFF_VALUES;
+  }
+  return result;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5diff_t::difference
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5diff_t::difference(const char* file_a, const char* path_a, const char* file_b, const char* path_b,
+  std::vector<hsize_t> &dim, void **buf, h5progress_t *progress)
+{
+  h5slab_t slab_a;
+  h5slab_t slab_b;
+  std::vector<hsize_t> start;
+  std::vector<hsize_t> count;
+
+  if(slab_a.open(file_a, path_a) < 0 || slab_b.open(file_b, path_b) < 0)
+  {
+    return -1;
+  }
+  if(slab_a.m_native == H5NATIVE_NONE || slab_b.m_native == H5NATIVE_NONE || slab_a.m_dim != slab_b.m_dim)
+  {
+    return -1;
+  }
+
+  dim = slab_a.m_dim;
+  size_t nbr_total = static_cast<size_t>(slab_a.nbr_elements());
+  double *out = (double*)malloc((nbr_total > 0 ? nbr_total : 1) * sizeof(double));
+  if(out == NULL)
+  {
+    return -1;
+  }
+  *buf = out;
+
+  size_t rank = slab_a.m_dim.size();
+  std::vector<size_t> stride(rank, 1);
+  for(size_t idx = rank; idx-- > 1;)
+  {
+    stride[idx - 1] = stride[idx] * static_cast<size_t>(slab_a.m_dim[idx]);
+  }
+
+  size_t nbr_blocks = slab_a.nbr_blocks();
+  std::vector<char> buf_a(slab_a.max_block_elements() * slab_a.m_datatype_size);
+  std::vector<char> buf_b(slab_a.max_block_elements() * slab_b.m_datatype_size);
+  std::vector<double> double_a;
+  std::vector<double> double_b;
+
+  for(size_t idx_block = 0; idx_block < nbr_blocks; idx_block++)
+  {
+    if(slab_a.read(idx_block, &buf_a[0], start, count) < 0 || slab_b.read(start, count, &buf_b[0]) < 0)
+    {
+      return -1;
+    }
+
+    size_t nbr_elements = 1;
+    for(size_t idx = 0; idx < count.size(); idx++)
+    {
+      nbr_elements *= static_cast<size_t>(count[idx]);
+    }
+
+    to_double_t convert;
+    convert.m_nbr_elements = nbr_elements;
+    convert.m_buf = &buf_a[0];
+    convert.m_out = &double_a;
+    dispatch(slab_a.m_native, convert);
+    convert.m_buf = &buf_b[0];
+    convert.m_out = &double_b;
+    dispatch(slab_b.m_native, convert);
+
+    //scatter the block, one row of its last dimension at a time
+    if(rank == 0)
+    {
+      out[0] = double_a[0] - double_b[0];
+    }
+    else
+    {
+      size_t nbr_cols = static_cast<size_t>(count[rank - 1]);
+      std::vector<hsize_t> pos(rank, 0);
+      for(size_t off = 0; off < nbr_elements; off += nbr_cols)
+      {
+        size_t first = 0;
+        for(size_t dmn = 0; dmn < rank; dmn++)
+        {
+          first += static_cast<size_t>(start[dmn] + pos[dmn]) * stride[dmn];
+        }
+        for(size_t idx = 0; idx < nbr_cols; idx++)
+        {
+          out[first + idx] = double_a[off + idx] - double_b[off + idx];
+        }
+        for(size_t dmn = rank - 1; dmn-- > 0;)
+        {
+          if(++pos[dmn] < count[dmn])
+            break;
+          pos[dmn] = 0;
+        }
+      }
+    }
+
+    if(progress && !progress->progress(idx_block + 1, nbr_blocks))
+    {
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5diff_t::visit_link_cb
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+herr_t h5diff_t::visit_link_cb(hid_t loc_id, const char *name, const H5L_info_t *linfo, void *_op_data)
+{
+  std::map<std::string, H5O_type_t> *objects = (std::map<std::string, H5O_type_t>*)_op_data;
+  H5O_info_t oinfo;
+
+  //soft and external links are not followed
+  if(linfo->type == H5L_TYPE_HARD && H5Oget_info_by_name(loc_id, name, &oinfo, H5P_DEFAULT) >= 0)
+  {
+    (*objects)[name] = oinfo.type;
+  }
+  return(H5_ITER_CONT);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5diff_t::attribute_cb
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+herr_t h5diff_t::attribute_cb(hid_t, const char *name, const H5A_info_t *, void *_op_data)
+{
+  std::vector<std::string> *names = (std::vector<std::string>*)_op_data;
+  names->push_back(name);
+  return(H5_ITER_CONT);
+}
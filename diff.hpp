@@ -0,0 +1,107 @@
+#ifndef DIFF_HPP
+#define DIFF_HPP 1
+
+#include <map>
+#include <string>
+#include <vector>
+#include "hdf5.h"
+#include "slab.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5diff_status_t
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+enum h5diff_status_t
+{
+  DIFF_EQUAL,     // same metadata, values within tolerance
+  DIFF_VALUES,    // same metadata, values that differ
+  DIFF_METADATA,  // object type, datatype, dimensions or attributes differ
+  DIFF_ONLY_A,    // object in the first file only
+  DIFF_ONLY_B     // object in the second file only
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5diff_location_t
+//a cell where the values differ
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct h5diff_location_t
+{
+  std::vector<hsize_t> m_coord;
+  double m_value_a;
+  double m_value_b;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5diff_object_t
+//result of the comparison of one pair of objects with the same relative path
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct h5diff_object_t
+{
+  std::string m_path_a; // empty if DIFF_ONLY_B
+  std::string m_path_b; // empty if DIFF_ONLY_A
+  H5O_type_t m_type;
+  h5diff_status_t m_status;
+  std::string m_note; // metadata differences, or why the values were not compared
+  hsize_t m_nbr_elements; // values compared
+  hsize_t m_nbr_diff; // values out of tolerance
+  double m_max_abs; // largest |a - b|
+  std::vector<hsize_t> m_max_coord; // where it is
+  double m_max_rel; // largest |a - b| / |a|, for a != 0
+  std::vector<h5diff_location_t> m_locations; // first cells that differ, in row major order
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5diff_t
+//compares two datasets, or two groups (a file is its root group) and all the objects under them,
+//matched by path relative to the compared groups
+//metadata is compared first: object type, datatype, dimensions, attribute names, types and values;
+//the values of two numeric datasets with the same dimensions are then streamed in blocks aligned
+//to the chunks of the first one (h5slab_t, read ahead in a h5reader_t), the same hyperslab being read
+//from the second; each pair of blocks is compared on the thread pool, so memory is bounded by a few
+//blocks whatever the size of the datasets
+//two values are equal if |a - b| <= m_abs_tol + m_rel_tol * |a|, or if both are NaN
+//datasets of different numeric types are compared in double
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class h5diff_t
+{
+public:
+  h5diff_t() :
+    m_abs_tol(0),
+    m_rel_tol(0),
+    m_max_locations(1000),
+    m_nbr_different(0)
+  {
+  }
+
+  //returns 0, 1 if canceled by progress, -1 if either object cannot be opened
+  int compare(const char* file_a, const char* path_a, const char* file_b, const char* path_b, h5progress_t *progress);
+
+  //a - b for two numeric datasets with the same dimensions 'dim', in '*buf' (one double per element,
+  //allocated with malloc, to be freed by the caller also on error or cancel)
+  //returns 0, 1 if canceled by progress, -1 on error
+  static int difference(const char* file_a, const char* path_a, const char* file_b, const char* path_b,
+    std::vector<hsize_t> &dim, void **buf, h5progress_t *progress);
+
+  double m_abs_tol;
+  double m_rel_tol;
+  size_t m_max_locations; // per dataset
+  std::vector<h5diff_object_t> m_objects; // in path order
+  size_t m_nbr_different; // objects not DIFF_EQUAL
+
+private:
+  hid_t m_fid_a;
+  hid_t m_fid_b;
+  hsize_t m_nbr_done; // elements compared so far, for progress
+  hsize_t m_nbr_total;
+
+  int compare_metadata(h5diff_object_t &object);
+  int compare_values(const char* file_a, const char* file_b, h5diff_object_t &object, h5progress_t *progress);
+  static void compare_attributes(hid_t oid_a, hid_t oid_b, std::string &note);
+  static herr_t visit_link_cb(hid_t loc_id, const char *name, const H5L_info_t *linfo, void *_op_data);
+  static herr_t attribute_cb(hid_t loc_id, const char *name, const H5A_info_t *ainfo, void *_op_data);
+};
+
+#endif
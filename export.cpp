@@ -0,0 +1,426 @@
+#include <QtDebug>
+#include <cstdio>
+#include <cstdlib>
+#include <locale.h>
+#include <string>
+#include "export.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//c_locale
+//reals are written with a '.' whatever the locale of the program, which Qt sets from the
+//environment on Unix (a decimal ',' would be the CSV separator); the formatting threads switch to
+//it with uselocale(), which is per thread
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static const locale_t c_locale = newlocale(LC_ALL_MASK, "C", static_cast<locale_t>(0));
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//format_value
+//integers are formatted by hand; reals with the shortest of two precisions that reads back
+//to the same value (7 or 9 digits for float, 15 or 17 for double), in the locale of the thread
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+inline size_t format_value(char *p, T v)
+{
+  char tmp[24];
+  size_t nbr = 0;
+  size_t len = 0;
+  bool neg = static_cast<double>(v) < 0;
+  unsigned long long u = neg ? 0ULL - static_cast<unsigned long long>(v) : static_cast<unsigned long long>(v);
+  do
+  {
+    tmp[nbr++] = static_cast<char>('0' + u % 10);
+    u /= 10;
+  } while(u);
+  if(neg)
+    p[len++] = '-';
+  while(nbr)
+    p[len++] = tmp[--nbr];
+  return len;
+}
+
+template <>
+inline size_t format_value(char *p, float v)
+{
+  int len = snprintf(p, 32, "%.7g", v);
+  if(strtof(p, NULL) != v)
+    len = snprintf(p, 32, "%.9g", v);
+  return static_cast<size_t>(len);
+}
+
+template <>
+inline size_t format_value(char *p, double v)
+{
+  int len = snprintf(p, 32, "%.15g", v);
+  if(strtod(p, NULL) != v)
+    len = snprintf(p, 32, "%.17g", v);
+  return static_cast<size_t>(len);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//export_item_t
+//unit of work of the writer: a block written as is, or the text of a block
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct export_item_t
+{
+  export_item_t() : m_block(NULL), m_nbr_bytes(0)
+  {
+  }
+  ~export_item_t()
+  {
+    delete m_block;
+  }
+  h5block_t *m_block;
+  size_t m_nbr_bytes; // of m_block
+  std::vector<std::string> m_text;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//writer_t
+//last stage of the export pipeline; writes to a file, or appends to a memory buffer
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class writer_t : public QThread
+{
+public:
+  writer_t(FILE *fp, std::string *text, h5queue_t<export_item_t*> *queue) :
+    m_fp(fp),
+    m_text(text),
+    m_queue(queue),
+    m_result(0),
+    m_nbr_bytes(0)
+  {
+  }
+
+  FILE *m_fp;
+  std::string *m_text;
+  h5queue_t<export_item_t*> *m_queue;
+  int m_result;
+  hsize_t m_nbr_bytes;
+
+protected:
+  void run()
+  {
+    export_item_t *item;
+    while(m_queue->pop(item))
+    {
+      if(m_result == 0)
+      {
+        if(item->m_block)
+        {
+          write(&item->m_block->m_buf[0], item->m_nbr_bytes);
+        }
+        for(size_t idx = 0; idx < item->m_text.size(); idx++)
+        {
+          write(item->m_text[idx].data(), item->m_text[idx].size());
+        }
+        if(m_result < 0)
+        {
+          //stop the producer
+          m_queue->close();
+        }
+      }
+      delete item;
+    }
+  }
+
+  void write(const void *buf, size_t nbr_bytes)
+  {
+    if(m_text)
+    {
+      m_text->append(static_cast<const char*>(buf), nbr_bytes);
+    }
+    else if(nbr_bytes && fwrite(buf, 1, nbr_bytes, m_fp) != nbr_bytes)
+    {
+      m_result = -1;
+    }
+    m_nbr_bytes += nbr_bytes;
+  }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//format_kernel_t
+//CSV or TSV text of the range of a block, in the C locale; 'm_first' is the position in the
+//selection of the block first element, which gives the column of the range first element, then
+//the column is counted
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+struct format_kernel_t
+{
+  const T *m_buf;
+  hsize_t m_first;
+  hsize_t m_nbr_cols;
+  char m_separator;
+  std::vector<std::string> *m_text;
+
+  void run(const h5range_t &range)
+  {
+    std::string &text = (*m_text)[range.idx];
+    char tmp[64];
+    locale_t locale = uselocale(c_locale);
+    hsize_t col = (m_first + range.begin) % m_nbr_cols;
+    text.reserve((range.end - range.begin) * 12);
+    for(size_t idx = range.begin; idx < range.end; idx++)
+    {
+      size_t len = format_value(tmp, m_buf[idx]);
+      if(++col == m_nbr_cols)
+      {
+        col = 0;
+        tmp[len++] = '\n';
+      }
+      else
+      {
+        tmp[len++] = m_separator;
+      }
+      text.append(tmp, len);
+    }
+    uselocale(locale);
+  }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//format_block_t
+//functor for dispatch()
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct format_block_t
+{
+  const h5block_t *m_block;
+  hsize_t m_first;
+  hsize_t m_nbr_cols;
+  char m_separator;
+  std::vector<std::string> *m_text;
+
+  template <typename T>
+  void apply()
+  {
+    format_kernel_t<T> kernel;
+    std::vector<h5range_t> ranges = make_ranges(m_block->m_nbr_elements, 16 * 1024);
+    kernel.m_buf = reinterpret_cast<const T*>(&m_block->m_buf[0]);
+    kernel.m_first = m_first;
+    kernel.m_nbr_cols = m_nbr_cols;
+    kernel.m_separator = m_separator;
+    kernel.m_text = m_text;
+    m_text->resize(ranges.size());
+    parallel_for(ranges, kernel);
+  }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//npy_header
+//format version 1.0: magic, version, little endian header length, python dict padded with spaces
+//so that the data starts at a multiple of 64 bytes
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static std::string npy_header(const h5slab_t &slab)
+{
+  std::string dict;
+  char tmp[64];
+  H5T_order_t order;
+  {
+    h5lock_t lock;
+    order = H5Tget_order(slab.m_mtid);
+  }
+
+  dict = "{'descr': '";
+  if(slab.m_datatype_size == 1)
+    dict += "|";
+  else
+    dict += (order == H5T_ORDER_BE) ? ">" : "<";
+  if(slab.m_datatype_class == H5T_FLOAT)
+    dict += "f";
+  else
+    dict += (slab.m_datatype_sign == H5T_SGN_NONE) ? "u" : "i";
+  snprintf(tmp, sizeof(tmp), "%u", static_cast<unsigned int>(slab.m_datatype_size));
+  dict += tmp;
+  dict += "', 'fortran_order': False, 'shape': (";
+  for(size_t idx = 0; idx < slab.m_count.size(); idx++)
+  {
+    snprintf(tmp, sizeof(tmp), "%llu", static_cast<unsigned long long>(slab.m_count[idx]));
+    dict += tmp;
+    if(idx + 1 < slab.m_count.size() || slab.m_count.size() == 1)
+      dict += ",";
+    if(idx + 1 < slab.m_count.size())
+      dict += " ";
+  }
+  dict += "), }";
+
+  size_t len = 10 + dict.size() + 1;
+  size_t pad = (64 - len % 64) % 64;
+  dict.append(pad, ' ');
+  dict += "\n";
+
+  std::string header("\x93NUMPY\x01\x00", 8);
+  header += static_cast<char>(dict.size() & 0xff);
+  header += static_cast<char>((dict.size() >> 8) & 0xff);
+  header += dict;
+  return header;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5export_t::run
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5export_t::run(const char* file_name, const char* path,
+  const std::vector<hsize_t> &start, const std::vector<hsize_t> &count,
+  h5format_t format, const char* out_name, h5progress_t *progress)
+{
+  FILE *fp;
+  int result;
+
+  if((fp = fopen(out_name, "wb")) == NULL)
+  {
+    return -1;
+  }
+  setvbuf(fp, NULL, _IOFBF, 4 * 1024 * 1024);
+
+  result = stream(file_name, path, start, count, format, fp, NULL, progress);
+
+  if(fclose(fp) != 0 && result == 0)
+  {
+    result = -1;
+  }
+  if(result != 0)
+  {
+    remove(out_name);
+  }
+  return result;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5export_t::copy
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5export_t::copy(const char* file_name, const char* path,
+  const std::vector<hsize_t> &start, const std::vector<hsize_t> &count,
+  std::string &text, h5progress_t *progress)
+{
+  text.clear();
+  int result = stream(file_name, path, start, count, FORMAT_TSV, NULL, &text, progress);
+  if(result != 0)
+  {
+    std::string().swap(text);
+  }
+  return result;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5export_t::stream
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5export_t::stream(const char* file_name, const char* path,
+  const std::vector<hsize_t> &start, const std::vector<hsize_t> &count,
+  h5format_t format, FILE *fp, std::string *text, h5progress_t *progress)
+{
+  h5slab_t slab;
+  int result = 0;
+  bool is_text = (format == FORMAT_CSV || format == FORMAT_TSV);
+
+  m_nbr_bytes = 0;
+
+  if(slab.open(file_name, path) < 0)
+  {
+    return -1;
+  }
+
+  if(slab.m_native == H5NATIVE_NONE)
+  {
+    return -1;
+  }
+
+  if(start.size() && slab.select(start, count) < 0)
+  {
+    return -1;
+  }
+
+  if(slab.set_row_major(true) < 0)
+  {
+    return -1;
+  }
+
+  //position of the first element of each block in the selection
+  size_t rank = slab.m_count.size();
+  std::vector<hsize_t> stride(rank, 1);
+  for(size_t idx = rank; idx-- > 1;)
+  {
+    stride[idx - 1] = stride[idx] * slab.m_count[idx];
+  }
+  hsize_t nbr_cols = rank ? slab.m_count[rank - 1] : 1;
+
+  h5queue_t<h5block_t*> read_queue(2);
+  h5queue_t<export_item_t*> write_queue(4);
+  h5reader_t reader(&slab, &read_queue);
+  writer_t writer(fp, text, &write_queue);
+
+  if(format == FORMAT_NPY)
+  {
+    std::string header = npy_header(slab);
+    export_item_t *item = new export_item_t;
+    item->m_text.push_back(header);
+    write_queue.push(item);
+  }
+
+  reader.start();
+  writer.start();
+
+  size_t nbr_blocks = slab.nbr_blocks();
+  size_t nbr_done = 0;
+  h5block_t *block;
+  while(read_queue.pop(block))
+  {
+    export_item_t *item = new export_item_t;
+    if(is_text)
+    {
+      format_block_t format_block;
+      format_block.m_block = block;
+      format_block.m_first = 0;
+      for(size_t idx = 0; idx < rank; idx++)
+      {
+        format_block.m_first += (block->m_start[idx] - slab.m_start[idx]) * stride[idx];
+      }
+      format_block.m_nbr_cols = nbr_cols;
+      format_block.m_separator = (format == FORMAT_TSV) ? '\t' : ',';
+      format_block.m_text = &item->m_text;
+      dispatch(slab.m_native, format_block);
+      delete block;
+    }
+    else
+    {
+      item->m_block = block;
+      item->m_nbr_bytes = block->m_nbr_elements * slab.m_datatype_size;
+    }
+
+    if(!write_queue.push(item))
+    {
+      //writer failed
+      delete item;
+      break;
+    }
+
+    nbr_done++;
+    if(progress && !progress->progress(nbr_done, nbr_blocks))
+    {
+      result = 1;
+      break;
+    }
+  }
+
+  read_queue.close();
+  write_queue.close();
+  reader.wait();
+  writer.wait();
+  while(read_queue.pop(block))
+  {
+    delete block;
+  }
+
+  m_nbr_bytes = writer.m_nbr_bytes;
+  if(reader.m_result < 0 || writer.m_result < 0)
+  {
+    result = -1;
+  }
+  return result;
+}
@@ -0,0 +1,59 @@
+#ifndef EXPORT_HPP
+#define EXPORT_HPP 1
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "hdf5.h"
+#include "slab.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5format_t
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+enum h5format_t
+{
+  FORMAT_CSV,   // one line per row of the last dimension
+  FORMAT_NPY,   // NumPy .npy, native type, C order
+  FORMAT_RAW,   // native type, C order, no header
+  FORMAT_TSV    // tab separated, one line per row of the last dimension (clipboard)
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5export_t
+//writes a dataset, or a hyperslab of it, to a file
+//the selection is streamed in row major blocks through a three stage pipeline:
+//a h5reader_t thread reads blocks, the calling thread formats them on the thread pool (text formats)
+//and a writer thread writes them with a large stdio buffer; the queues between the stages are
+//bounded, so memory use is a few blocks whatever the dataset size
+//binary formats write the blocks as read, without conversion
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class h5export_t
+{
+public:
+  h5export_t() :
+    m_nbr_bytes(0)
+  {
+  }
+
+  //'start' and 'count' empty export all the dataset
+  //returns 0, 1 if canceled by progress (the output is removed), -1 on error
+  int run(const char* file_name, const char* path,
+    const std::vector<hsize_t> &start, const std::vector<hsize_t> &count,
+    h5format_t format, const char* out_name, h5progress_t *progress);
+
+  //same as run() with the TSV text of the selection in the memory buffer 'text'
+  int copy(const char* file_name, const char* path,
+    const std::vector<hsize_t> &start, const std::vector<hsize_t> &count,
+    std::string &text, h5progress_t *progress);
+
+  hsize_t m_nbr_bytes; // bytes written
+
+private:
+  int stream(const char* file_name, const char* path,
+    const std::vector<hsize_t> &start, const std::vector<hsize_t> &count,
+    h5format_t format, FILE *fp, std::string *text, h5progress_t *progress);
+};
+
+#endif
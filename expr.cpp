@@ -0,0 +1,554 @@
+#include <QtDebug>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include "expr.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//elements evaluated at a time by a task; the stack of a batch stays in cache
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static const size_t batch_size = 1024;
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//functions
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct function_t
+{
+  const char *m_name;
+  h5expr_t::op_code_t m_code;
+  int m_nbr_args;
+};
+
+static const function_t functions[] =
+{
+  { "sqrt", h5expr_t::op_sqrt, 1 },
+  { "abs", h5expr_t::op_abs, 1 },
+  { "exp", h5expr_t::op_exp, 1 },
+  { "log", h5expr_t::op_log, 1 },
+  { "log10", h5expr_t::op_log10, 1 },
+  { "sin", h5expr_t::op_sin, 1 },
+  { "cos", h5expr_t::op_cos, 1 },
+  { "tan", h5expr_t::op_tan, 1 },
+  { "asin", h5expr_t::op_asin, 1 },
+  { "acos", h5expr_t::op_acos, 1 },
+  { "atan", h5expr_t::op_atan, 1 },
+  { "floor", h5expr_t::op_floor, 1 },
+  { "ceil", h5expr_t::op_ceil, 1 },
+  { "pow", h5expr_t::op_pow, 2 },
+  { "atan2", h5expr_t::op_atan2, 2 },
+  { "min", h5expr_t::op_min, 2 },
+  { "max", h5expr_t::op_max, 2 }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5expr_t::h5expr_t
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+h5expr_t::h5expr_t() :
+m_depth(0),
+m_pos(0)
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5expr_t::compile
+//recursive descent, emitting each operation after its operands
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool h5expr_t::compile(const std::string &text, std::string &error)
+{
+  m_text = text;
+  m_variables.clear();
+  m_program.clear();
+  m_depth = 0;
+  m_pos = 0;
+  m_error.clear();
+
+  bool ok = parse_sum();
+  skip_space();
+  if(ok && m_pos < m_text.size())
+  {
+    m_error = "unexpected '" + m_text.substr(m_pos, 1) + "'";
+    ok = false;
+  }
+  if(!ok)
+  {
+    std::string::size_type pos = std::min(m_pos, m_text.size());
+    char buf[32];
+    sprintf(buf, " at position %d", static_cast<int>(pos) + 1);
+    error = m_error + buf;
+    m_program.clear();
+    m_variables.clear();
+    return false;
+  }
+
+  //stack depth
+  size_t size = 0;
+  for(size_t idx = 0; idx < m_program.size(); idx++)
+  {
+    switch(m_program[idx].m_code)
+    {
+    case op_variable:
+    case op_number:
+      size++;
+      m_depth = std::max(m_depth, size);
+      break;
+    case op_add:
+    case op_sub:
+    case op_mul:
+    case op_div:
+    case op_pow:
+    case op_atan2:
+    case op_min:
+    case op_max:
+      size--;
+      break;
+    default:
+      break;
+    }
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5expr_t::skip_space
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void h5expr_t::skip_space()
+{
+  while(m_pos < m_text.size() && isspace(static_cast<unsigned char>(m_text[m_pos])))
+  {
+    m_pos++;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5expr_t::emit
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void h5expr_t::emit(op_code_t code, size_t variable, double value)
+{
+  op_t op;
+  op.m_code = code;
+  op.m_variable = variable;
+  op.m_value = value;
+  m_program.push_back(op);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5expr_t::parse_sum
+//sum := product (('+' | '-') product)*
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool h5expr_t::parse_sum()
+{
+  if(!parse_product())
+  {
+    return false;
+  }
+  for(;;)
+  {
+    skip_space();
+    if(m_pos >= m_text.size() || (m_text[m_pos] != '+' && m_text[m_pos] != '-'))
+    {
+      return true;
+    }
+    char c = m_text[m_pos++];
+    if(!parse_product())
+    {
+      return false;
+    }
+    emit(c == '+' ? op_add : op_sub);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5expr_t::parse_product
+//product := unary (('*' | '/') unary)*
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool h5expr_t::parse_product()
+{
+  if(!parse_unary())
+  {
+    return false;
+  }
+  for(;;)
+  {
+    skip_space();
+    if(m_pos >= m_text.size() || (m_text[m_pos] != '*' && m_text[m_pos] != '/'))
+    {
+      return true;
+    }
+    char c = m_text[m_pos++];
+    if(!parse_unary())
+    {
+      return false;
+    }
+    emit(c == '*' ? op_mul : op_div);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5expr_t::parse_unary
+//unary := ('-' | '+') unary | power; so that -x^2 is -(x^2)
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool h5expr_t::parse_unary()
+{
+  skip_space();
+  if(m_pos < m_text.size() && (m_text[m_pos] == '-' || m_text[m_pos] == '+'))
+  {
+    char c = m_text[m_pos++];
+    if(!parse_unary())
+    {
+      return false;
+    }
+    if(c == '-')
+    {
+      emit(op_neg);
+    }
+    return true;
+  }
+  return parse_power();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5expr_t::parse_power
+//power := primary ('^' unary)?; right associative, 2^3^2 is 2^(3^2)
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool h5expr_t::parse_power()
+{
+  if(!parse_primary())
+  {
+    return false;
+  }
+  skip_space();
+  if(m_pos < m_text.size() && m_text[m_pos] == '^')
+  {
+    m_pos++;
+    if(!parse_unary())
+    {
+      return false;
+    }
+    emit(op_pow);
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5expr_t::parse_primary
+//primary := number | '(' sum ')' | '{' path '}' | name | name '(' sum (',' sum)* ')'
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool h5expr_t::parse_primary()
+{
+  skip_space();
+  if(m_pos >= m_text.size())
+  {
+    m_error = "unexpected end of expression";
+    return false;
+  }
+  char c = m_text[m_pos];
+
+  //number
+  if(isdigit(static_cast<unsigned char>(c)) || c == '.')
+  {
+    const char *begin = m_text.c_str() + m_pos;
+    char *end;
+    double value = strtod(begin, &end);
+    if(end == begin)
+    {
+      m_error = "invalid number";
+      return false;
+    }
+    m_pos += end - begin;
+    emit(op_number, 0, value);
+    return true;
+  }
+
+  //parentheses
+  if(c == '(')
+  {
+    m_pos++;
+    if(!parse_sum())
+    {
+      return false;
+    }
+    skip_space();
+    if(m_pos >= m_text.size() || m_text[m_pos] != ')')
+    {
+      m_error = "missing ')'";
+      return false;
+    }
+    m_pos++;
+    return true;
+  }
+
+  //dataset name
+  std::string path;
+  if(c == '{')
+  {
+    std::string::size_type end = m_text.find('}', m_pos);
+    if(end == std::string::npos || end == m_pos + 1)
+    {
+      m_error = "missing dataset path in braces";
+      return false;
+    }
+    path = m_text.substr(m_pos + 1, end - m_pos - 1);
+    if(path[0] != '/')
+    {
+      path = "/" + path;
+    }
+    m_pos = end + 1;
+  }
+  else if(isalpha(static_cast<unsigned char>(c)) || c == '_')
+  {
+    std::string::size_type begin = m_pos;
+    while(m_pos < m_text.size() && (isalnum(static_cast<unsigned char>(m_text[m_pos])) || m_text[m_pos] == '_'))
+    {
+      m_pos++;
+    }
+    std::string name = m_text.substr(begin, m_pos - begin);
+    skip_space();
+
+    //function call
+    if(m_pos < m_text.size() && m_text[m_pos] == '(')
+    {
+      const function_t *function = NULL;
+      for(size_t idx = 0; idx < sizeof(functions) / sizeof(functions[0]); idx++)
+      {
+        if(name == functions[idx].m_name)
+        {
+          function = &functions[idx];
+        }
+      }
+      if(function == NULL)
+      {
+        m_pos = begin;
+        m_error = "unknown function '" + name + "'";
+        return false;
+      }
+      m_pos++;
+      for(int idx_arg = 0; idx_arg < function->m_nbr_args; idx_arg++)
+      {
+        if(!parse_sum())
+        {
+          return false;
+        }
+        skip_space();
+        char expected = idx_arg + 1 < function->m_nbr_args ? ',' : ')';
+        if(m_pos >= m_text.size() || m_text[m_pos] != expected)
+        {
+          m_error = std::string("expected '") + expected + "' in " + name + "()";
+          return false;
+        }
+        m_pos++;
+      }
+      emit(function->m_code);
+      return true;
+    }
+
+    if(name == "pi")
+    {
+      emit(op_number, 0, 3.14159265358979323846);
+      return true;
+    }
+    if(name == "e")
+    {
+      emit(op_number, 0, 2.71828182845904523536);
+      return true;
+    }
+    path = "/" + name;
+  }
+  else
+  {
+    m_error = "unexpected '" + m_text.substr(m_pos, 1) + "'";
+    return false;
+  }
+
+  size_t idx_variable = 0;
+  while(idx_variable < m_variables.size() && m_variables[idx_variable] != path)
+  {
+    idx_variable++;
+  }
+  if(idx_variable == m_variables.size())
+  {
+    m_variables.push_back(path);
+  }
+  emit(op_variable, idx_variable);
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//eval_kernel_t
+//per range: the program run on batches of elements; slot 'top' of the stack is an array of a batch
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct eval_kernel_t
+{
+  const h5expr_t *m_expr;
+  const std::vector<const double*> *m_inputs;
+  double *m_out;
+
+  void run(const h5range_t &range)
+  {
+    const std::vector<h5expr_t::op_t> &program = m_expr->m_program;
+    std::vector<double> stack(std::max<size_t>(m_expr->m_depth, 1) * batch_size);
+    for(size_t begin = range.begin; begin < range.end; begin += batch_size)
+    {
+      size_t n = std::min(batch_size, range.end - begin);
+      size_t top = 0; // number of slots used
+      for(size_t idx_op = 0; idx_op < program.size(); idx_op++)
+      {
+        const h5expr_t::op_t &op = program[idx_op];
+        double *a = top > 0 ? &stack[(top - 1) * batch_size] : NULL; // top slot
+        double *b = top > 1 ? a - batch_size : NULL; // slot below, first operand of a binary operation
+        switch(op.m_code)
+        {
+        case h5expr_t::op_variable:
+          {
+            const double *in = (*m_inputs)[op.m_variable] + begin;
+            double *r = &stack[0] + top * batch_size;
+            for(size_t idx = 0; idx < n; idx++)
+              r[idx] = in[idx];
+            top++;
+          }
+          break;
+        case h5expr_t::op_number:
+          {
+            double *r = &stack[0] + top * batch_size;
+            for(size_t idx = 0; idx < n; idx++)
+              r[idx] = op.m_value;
+            top++;
+          }
+          break;
+        case h5expr_t::op_add:
+          for(size_t idx = 0; idx < n; idx++)
+            b[idx] = b[idx] + a[idx];
+          top--;
+          break;
+        case h5expr_t::op_sub:
+          for(size_t idx = 0; idx < n; idx++)
+            b[idx] = b[idx] - a[idx];
+          top--;
+          break;
+        case h5expr_t::op_mul:
+          for(size_t idx = 0; idx < n; idx++)
+            b[idx] = b[idx] * a[idx];
+          top--;
+          break;
+        case h5expr_t::op_div:
+          for(size_t idx = 0; idx < n; idx++)
+            b[idx] = b[idx] / a[idx];
+          top--;
+          break;
+        case h5expr_t::op_pow:
+          for(size_t idx = 0; idx < n; idx++)
+            b[idx] = std::pow(b[idx], a[idx]);
+          top--;
+          break;
+        case h5expr_t::op_atan2:
+          for(size_t idx = 0; idx < n; idx++)
+            b[idx] = std::atan2(b[idx], a[idx]);
+          top--;
+          break;
+        case h5expr_t::op_min:
+          //NaN if either is NaN
+          for(size_t idx = 0; idx < n; idx++)
+            b[idx] = (a[idx] != a[idx] || a[idx] < b[idx]) ? a[idx] : b[idx];
+          top--;
+          break;
+        case h5expr_t::op_max:
+          for(size_t idx = 0; idx < n; idx++)
+            b[idx] = (a[idx] != a[idx] || a[idx] > b[idx]) ? a[idx] : b[idx];
+          top--;
+          break;
+        case h5expr_t::op_neg:
+          for(size_t idx = 0; idx < n; idx++)
+            a[idx] = -a[idx];
+          break;
+        case h5expr_t::op_sqrt:
+          for(size_t idx = 0; idx < n; idx++)
+            a[idx] = std::sqrt(a[idx]);
+          break;
+        case h5expr_t::op_abs:
+          for(size_t idx = 0; idx < n; idx++)
+            a[idx] = std::fabs(a[idx]);
+          break;
+        case h5expr_t::op_exp:
+          for(size_t idx = 0; idx < n; idx++)
+            a[idx] = std::exp(a[idx]);
+          break;
+        case h5expr_t::op_log:
+          for(size_t idx = 0; idx < n; idx++)
+            a[idx] = std::log(a[idx]);
+          break;
+        case h5expr_t::op_log10:
+          for(size_t idx = 0; idx < n; idx++)
+            a[idx] = std::log10(a[idx]);
+          break;
+        case h5expr_t::op_sin:
+          for(size_t idx = 0; idx < n; idx++)
+            a[idx] = std::sin(a[idx]);
+          break;
+        case h5expr_t::op_cos:
+          for(size_t idx = 0; idx < n; idx++)
+            a[idx] = std::cos(a[idx]);
+          break;
+        case h5expr_t::op_tan:
+          for(size_t idx = 0; idx < n; idx++)
+            a[idx] = std::tan(a[idx]);
+          break;
+        case h5expr_t::op_asin:
+          for(size_t idx = 0; idx < n; idx++)
+            a[idx] = std::asin(a[idx]);
+          break;
+        case h5expr_t::op_acos:
+          for(size_t idx = 0; idx < n; idx++)
+            a[idx] = std::acos(a[idx]);
+          break;
+        case h5expr_t::op_atan:
+          for(size_t idx = 0; idx < n; idx++)
+            a[idx] = std::atan(a[idx]);
+          break;
+        case h5expr_t::op_floor:
+          for(size_t idx = 0; idx < n; idx++)
+            a[idx] = std::floor(a[idx]);
+          break;
+        case h5expr_t::op_ceil:
+          for(size_t idx = 0; idx < n; idx++)
+            a[idx] = std::ceil(a[idx]);
+          break;
+        }
+      }
+      for(size_t idx = 0; idx < n; idx++)
+      {
+        m_out[begin + idx] = stack[idx];
+      }
+    }
+  }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5expr_t::evaluate
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void h5expr_t::evaluate(const std::vector<const double*> &inputs, size_t nbr_elements, double *out) const
+{
+  if(m_program.empty() || inputs.size() != m_variables.size() || nbr_elements == 0)
+  {
+    return;
+  }
+  eval_kernel_t kernel;
+  kernel.m_expr = this;
+  kernel.m_inputs = &inputs;
+  kernel.m_out = out;
+  std::vector<h5range_t> ranges = make_ranges(nbr_elements, 16 * batch_size);
+  parallel_for(ranges, kernel);
+}
@@ -0,0 +1,86 @@
+#ifndef EXPR_HPP
+#define EXPR_HPP 1
+
+#include <string>
+#include <vector>
+#include "kernel.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5expr_t
+//arithmetic expression over datasets of the same shape, such as 'sqrt(u*u+v*v)' or 'T - 273.15'
+//a name is a dataset in the root group; any other path is written in braces, '{/grid/T}'
+//operators + - * / ^ (power), unary minus, parentheses, numbers, the constants pi and e, and the
+//functions sqrt abs exp log log10 sin cos tan asin acos atan floor ceil (one argument)
+//and pow atan2 min max (two arguments)
+//compile() translates the text once into a postfix program; evaluate() runs it element-wise on the
+//thread pool, each range by batches of elements, one operation at a time over the whole batch,
+//so that each operation is a simple loop that vectorizes
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class h5expr_t
+{
+public:
+  h5expr_t();
+
+  //returns false with 'error' set if 'text' is not a valid expression
+  bool compile(const std::string &text, std::string &error);
+
+  //'inputs' holds 'nbr_elements' values of each of 'm_variables', in that order
+  void evaluate(const std::vector<const double*> &inputs, size_t nbr_elements, double *out) const;
+
+  std::string m_text;
+  std::vector<std::string> m_variables; // dataset paths, each once
+
+  enum op_code_t
+  {
+    op_variable,
+    op_number,
+    op_add,
+    op_sub,
+    op_mul,
+    op_div,
+    op_pow,
+    op_neg,
+    op_sqrt,
+    op_abs,
+    op_exp,
+    op_log,
+    op_log10,
+    op_sin,
+    op_cos,
+    op_tan,
+    op_asin,
+    op_acos,
+    op_atan,
+    op_floor,
+    op_ceil,
+    op_atan2,
+    op_min,
+    op_max
+  };
+
+  struct op_t
+  {
+    op_code_t m_code;
+    size_t m_variable; // op_variable
+    double m_value; // op_number
+  };
+
+  std::vector<op_t> m_program;
+  size_t m_depth; // stack depth the program needs
+
+private:
+  //parser state
+  std::string::size_type m_pos;
+  std::string m_error;
+
+  void skip_space();
+  bool parse_sum();
+  bool parse_product();
+  bool parse_unary();
+  bool parse_power();
+  bool parse_primary();
+  void emit(op_code_t code, size_t variable = 0, double value = 0);
+};
+
+#endif
@@ -0,0 +1,402 @@
+#include <QtDebug>
+#include <cstdlib>
+#include <cstring>
+#include "follow.hpp"
+#include "http.hpp"
+#include "slab.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5follow_t::h5follow_t
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+h5follow_t::h5follow_t() :
+m_fid(-1),
+m_did(-1),
+m_mtid(-1),
+m_datatype_size(0),
+m_swmr(false),
+m_nbr_read(0)
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5follow_t::~h5follow_t
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+h5follow_t::~h5follow_t()
+{
+  close();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5follow_t::open
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5follow_t::open(const char* file_name, const char* path)
+{
+  h5lock_t lock;
+
+  close();
+  m_file_name = file_name;
+  m_path = path;
+  m_nbr_read = 0;
+
+#ifdef H5F_ACC_SWMR_READ
+  //fails for files not in the SWMR format, or already open in plain read only mode
+  H5E_BEGIN_TRY
+  {
+    m_fid = H5Fopen(file_name, H5F_ACC_RDONLY | H5F_ACC_SWMR_READ, H5P_DEFAULT);
+  }
+  H5E_END_TRY;
+  if(m_fid >= 0)
+  {
+    //older superblocks are accepted, but the writer cannot be in SWMR mode
+    H5F_info2_t finfo;
+    if(H5Fget_info2(m_fid, &finfo) >= 0 && finfo.super.version >= 3)
+    {
+      m_swmr = true;
+    }
+    else
+    {
+      H5Fclose(m_fid);
+      m_fid = -1;
+    }
+  }
+#endif
+
+  if(!m_swmr && (m_fid = h5file_open(file_name)) < 0)
+  {
+    close();
+    return -1;
+  }
+
+  if(open_dataset() < 0)
+  {
+    close();
+    return -1;
+  }
+  release();
+  return 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5follow_t::open_dataset
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5follow_t::open_dataset()
+{
+  hid_t ftid;
+
+  if((m_did = H5Dopen2(m_fid, m_path.c_str(), H5P_DEFAULT)) < 0)
+  {
+    return -1;
+  }
+  if((ftid = H5Dget_type(m_did)) < 0)
+  {
+    return -1;
+  }
+  m_mtid = H5Tget_native_type(ftid, H5T_DIR_DEFAULT);
+  H5Tclose(ftid);
+  if(m_mtid < 0)
+  {
+    return -1;
+  }
+  m_datatype_size = H5Tget_size(m_mtid);
+  return 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5follow_t::close
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void h5follow_t::close()
+{
+  close_handles();
+  m_file_name.clear();
+  m_path.clear();
+  m_swmr = false;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5follow_t::close_handles
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void h5follow_t::close_handles()
+{
+  h5lock_t lock;
+
+  if(m_mtid >= 0)
+  {
+    H5Tclose(m_mtid);
+    m_mtid = -1;
+  }
+  if(m_did >= 0)
+  {
+    H5Dclose(m_did);
+    m_did = -1;
+  }
+  if(m_fid >= 0)
+  {
+    H5Fclose(m_fid);
+    m_fid = -1;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5follow_t::release
+//without SWMR, the file is closed between polls: the library drops its cached metadata only when
+//the file is closed, and a writer cannot lock a file that is kept open
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void h5follow_t::release()
+{
+  if(!m_swmr)
+  {
+    close_handles();
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5follow_t::poll
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5follow_t::poll(std::vector<hsize_t> &dim)
+{
+  h5lock_t lock;
+  hsize_t dims[H5S_MAX_RANK];
+  hid_t sid;
+  int rank;
+
+  if(m_path.empty() || (m_swmr && m_did < 0))
+  {
+    return -1;
+  }
+
+#ifdef H5F_ACC_SWMR_READ
+  if(m_swmr)
+  {
+    if(H5Drefresh(m_did) < 0)
+    {
+      return -1;
+    }
+  }
+#endif
+  if(m_fid < 0)
+  {
+    //file released since the last poll
+    if((m_fid = h5file_open(m_file_name.c_str())) < 0 || open_dataset() < 0)
+    {
+      release();
+      return -1;
+    }
+  }
+
+  if((sid = H5Dget_space(m_did)) < 0)
+  {
+    release();
+    return -1;
+  }
+  rank = H5Sget_simple_extent_dims(sid, dims, NULL);
+  H5Sclose(sid);
+
+  std::vector<hsize_t> new_dim(dims, dims + (rank > 0 ? rank : 0));
+  if(rank < 0 || new_dim == dim)
+  {
+    release();
+    return rank < 0 ? -1 : 0;
+  }
+  //kept open for update()
+  dim = new_dim;
+  return 1;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5follow_t::update
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5follow_t::update(const std::vector<hsize_t> &old_dim, const std::vector<hsize_t> &new_dim, void **buf)
+{
+  h5lock_t lock;
+  int result = read_new(old_dim, new_dim, buf);
+  release();
+  return result;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5follow_t::read_new
+//the elements added are the union of one region per grown dimension 'k': the old extent in the
+//dimensions before 'k', the new part of 'k', and the new extent after 'k'; the regions do not
+//overlap, and each is read straight into its place in the buffer with the same hyperslab
+//selected in the file and in a memory space of the new dimensions
+//when only the first dimension grew, the old data stays in place and the buffer is reallocated;
+//otherwise the old data is moved to a new buffer, which replaces '*buf' once all regions are read
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5follow_t::read_new(const std::vector<hsize_t> &old_dim, const std::vector<hsize_t> &new_dim, void **buf)
+{
+  size_t rank = new_dim.size();
+  hsize_t nbr_elements = 1;
+  bool shrank = old_dim.size() != rank;
+  bool outer_only = true; // only the first dimension grew: the old data stays in place
+  char *new_buf;
+  hid_t fsid;
+  hid_t msid;
+  int result = 0;
+
+  for(size_t idx = 0; idx < rank; idx++)
+  {
+    nbr_elements *= new_dim[idx];
+    if(!shrank && new_dim[idx] < old_dim[idx])
+    {
+      shrank = true;
+    }
+    if(!shrank && idx > 0 && new_dim[idx] != old_dim[idx])
+    {
+      outer_only = false;
+    }
+  }
+  if(m_did < 0 || nbr_elements == 0)
+  {
+    return m_did < 0 ? -1 : 0;
+  }
+
+  if(shrank)
+  {
+    if((new_buf = (char*)malloc(static_cast<size_t>(nbr_elements) * m_datatype_size)) == NULL)
+    {
+      return -1;
+    }
+    if(H5Dread(m_did, m_mtid, H5S_ALL, H5S_ALL, H5P_DEFAULT, new_buf) < 0)
+    {
+      free(new_buf);
+      return -1;
+    }
+    free(*buf);
+    *buf = new_buf;
+    m_nbr_read += nbr_elements;
+    return 0;
+  }
+
+  if(outer_only)
+  {
+    if((new_buf = (char*)realloc(*buf, static_cast<size_t>(nbr_elements) * m_datatype_size)) == NULL)
+    {
+      return -1;
+    }
+    *buf = new_buf;
+  }
+  else
+  {
+    //move the rows (last dimension) of the old data to their new place
+    if((new_buf = (char*)malloc(static_cast<size_t>(nbr_elements) * m_datatype_size)) == NULL)
+    {
+      return -1;
+    }
+    memset(new_buf, 0, static_cast<size_t>(nbr_elements) * m_datatype_size);
+    size_t row_bytes = static_cast<size_t>(old_dim[rank - 1]) * m_datatype_size;
+    std::vector<hsize_t> pos(rank - 1, 0);
+    hsize_t nbr_rows = 1;
+    for(size_t idx = 0; idx + 1 < rank; idx++)
+    {
+      nbr_rows *= old_dim[idx];
+    }
+    for(hsize_t idx_row = 0; idx_row < nbr_rows && row_bytes; idx_row++)
+    {
+      hsize_t new_row = 0;
+      for(size_t idx = 0; idx + 1 < rank; idx++)
+      {
+        new_row = new_row * new_dim[idx] + pos[idx];
+      }
+      memcpy(new_buf + static_cast<size_t>(new_row * new_dim[rank - 1]) * m_datatype_size,
+        static_cast<char*>(*buf) + static_cast<size_t>(idx_row) * row_bytes, row_bytes);
+      for(size_t idx = rank - 1; idx-- > 0;)
+      {
+        if(++pos[idx] < old_dim[idx])
+          break;
+        pos[idx] = 0;
+      }
+    }
+  }
+
+  if((fsid = H5Dget_space(m_did)) < 0)
+  {
+    result = -1;
+  }
+  else if((msid = H5Screate_simple(static_cast<int>(rank), &new_dim[0], NULL)) < 0)
+  {
+    H5Sclose(fsid);
+    result = -1;
+  }
+  if(result < 0)
+  {
+    if(!outer_only)
+    {
+      free(new_buf);
+    }
+    return -1;
+  }
+
+  for(size_t k = 0; k < rank && result == 0; k++)
+  {
+    if(new_dim[k] == old_dim[k])
+    {
+      continue;
+    }
+    std::vector<hsize_t> start(rank, 0);
+    std::vector<hsize_t> count(new_dim);
+    for(size_t idx = 0; idx < k; idx++)
+    {
+      count[idx] = old_dim[idx];
+    }
+    start[k] = old_dim[k];
+    count[k] = new_dim[k] - old_dim[k];
+    result = read_region(fsid, msid, start, count, new_buf);
+  }
+
+  H5Sclose(msid);
+  H5Sclose(fsid);
+  if(!outer_only)
+  {
+    if(result < 0)
+    {
+      free(new_buf);
+    }
+    else
+    {
+      free(*buf);
+      *buf = new_buf;
+    }
+  }
+  return result;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5follow_t::read_region
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5follow_t::read_region(hid_t fsid, hid_t msid, const std::vector<hsize_t> &start, const std::vector<hsize_t> &count, void *buf)
+{
+  hsize_t nbr_elements = 1;
+
+  for(size_t idx = 0; idx < count.size(); idx++)
+  {
+    nbr_elements *= count[idx];
+  }
+  if(nbr_elements == 0)
+  {
+    return 0;
+  }
+
+  if(H5Sselect_hyperslab(fsid, H5S_SELECT_SET, &start[0], NULL, &count[0], NULL) < 0 ||
+    H5Sselect_hyperslab(msid, H5S_SELECT_SET, &start[0], NULL, &count[0], NULL) < 0)
+  {
+    return -1;
+  }
+  if(H5Dread(m_did, m_mtid, msid, fsid, H5P_DEFAULT, buf) < 0)
+  {
+    qDebug() << "cannot read appended data" << m_path.c_str();
+    return -1;
+  }
+  m_nbr_read += nbr_elements;
+  return 0;
+}
@@ -0,0 +1,59 @@
+#ifndef FOLLOW_HPP
+#define FOLLOW_HPP 1
+
+#include <string>
+#include <vector>
+#include "hdf5.h"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5follow_t
+//keeps a dataset of a file being written open, to follow its growth
+//the file is opened for SWMR read when it allows it (1.10 file format), so that H5Drefresh sees
+//the extents written by the writer; other files are opened read only at each poll and closed in between
+//poll() refreshes the dataset and reports new dimensions; update() grows a buffer holding the
+//whole dataset to the new dimensions, reading only the elements added
+//while a file is followed in SWMR mode, it cannot be opened again in plain read only mode
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class h5follow_t
+{
+public:
+  h5follow_t();
+  ~h5follow_t();
+
+  int open(const char* file_name, const char* path);
+  void close();
+  bool is_open() const
+  {
+    return !m_path.empty();
+  }
+
+  //returns 1 if the dimensions changed (new ones in 'dim'), 0 if not, -1 on error
+  //after 1, update() must be called
+  int poll(std::vector<hsize_t> &dim);
+
+  //'*buf' holds the dataset with dimensions 'old_dim' in native type, in row major order; it is
+  //reallocated (malloc) for 'new_dim' and the elements outside 'old_dim' are read
+  //if a dimension shrank, the whole dataset is read again
+  //on error, '*buf' still holds the dataset with dimensions 'old_dim' (in a larger block if only the
+  //first dimension grew)
+  int update(const std::vector<hsize_t> &old_dim, const std::vector<hsize_t> &new_dim, void **buf);
+
+  std::string m_file_name;
+  std::string m_path;
+  hid_t m_fid;
+  hid_t m_did;
+  hid_t m_mtid; // native memory type
+  size_t m_datatype_size;
+  bool m_swmr; // file opened for SWMR read
+  hsize_t m_nbr_read; // elements read by update() since open()
+
+private:
+  int open_dataset();
+  void close_handles();
+  void release();
+  int read_new(const std::vector<hsize_t> &old_dim, const std::vector<hsize_t> &new_dim, void **buf);
+  int read_region(hid_t fsid, hid_t msid, const std::vector<hsize_t> &start, const std::vector<hsize_t> &count, void *buf);
+};
+
+#endif
@@ -11,9 +11,23 @@
 #include <cassert>
 #include <vector>
 #include <algorithm>
+#include <limits>
+#include <cmath>
+#include <climits>
+#include <cstring>
 #include "hdf_explorer.hpp"
 
 static const char app_name[] = "HDF Explorer";
+static const int follow_interval = 500; // follow mode poll period, in ms
+static const int startup_timeout = 2000; // command line files opened then if the window is not painted, in ms
+static const int difference_role = Qt::UserRole + 1; // compare results: file and path of both datasets
+static const hsize_t max_load_bytes = 256 * 1024 * 1024; // larger datasets are read by tiles, not loaded
+static const int grid_row_height = 24; // grid sections, in pixels
+static const int grid_col_width = 96;
+static const hsize_t max_scroll = 1 << 30; // largest grid scrollbar position
+static const int heat_lut_size = 256; // colors of the heat map
+static const hsize_t max_stats_cells = 256 * 1024; // larger selections: statistics on a thread
+static const int stats_delay = 200; // a large selection unchanged that long has its statistics computed, in ms
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 //main
@@ -21,28 +35,27 @@ static const char app_name[] = "HDF Explorer";
 
 int main(int argc, char *argv[])
 {
+  QElapsedTimer startup_timer;
+  startup_timer.start();
   Q_INIT_RESOURCE(hdf_explorer);
   QApplication app(argc, argv);
   QCoreApplication::setApplicationVersion("1.0");
   QCoreApplication::setApplicationName(app_name);
+  QStringList args;
 #if QT_VERSION >= 0x050000
   QCommandLineParser parser;
   parser.addHelpOption();
   parser.addVersionOption();
   parser.addPositionalArgument("file", "The file to open.");
   parser.process(app);
-  const QStringList args = parser.positionalArguments();
+  args = parser.positionalArguments();
 #endif
 
   MainWindow window;
-#if QT_VERSION >= 0x050000
-  if(args.size())
-  {
-    QString file_name = args.at(0);
-    window.read_file(file_name);
-  }
-#endif
   window.showMaximized();
+
+  //the window is painted first, the file is opened from the event loop
+  window.startup(args.mid(0, 1), startup_timer);
   return app.exec();
 }
 
@@ -111,14 +124,20 @@ public:
     Root,
     Group,
     Variable,
-    Attribute
+    Attribute,
+    Difference,
+    Derived,
+    Aggregate,
+    Link
   };
 
   ItemData(ItemKind kind, const std::string& file_name, const std::string& item_nm, hdf_dataset_t *dataset) :
     m_file_name(file_name),
     m_item_nm(item_nm),
     m_kind(kind),
-    m_dataset(dataset)
+    m_dataset(dataset),
+    m_resolved(false),
+    m_linked(false)
   {
   }
   ~ItemData()
@@ -127,8 +146,13 @@ public:
   }
   std::string m_file_name;  // (Root/Variable/Group/Attribute) file name
   std::string m_item_nm; // (Root/Variable/Group/Attribute ) item name to display on tree
-  ItemKind m_kind; // (Root/Variable/Group/Attribute) type of item 
-  hdf_dataset_t *m_dataset; // (Variable) HDF variable to display
+  ItemKind m_kind; // (Root/Variable/Group/Attribute/Difference/Derived/Aggregate/Link) type of item; a difference grid is in no tree
+  hdf_dataset_t *m_dataset; // (Variable/Difference/Derived/Aggregate) HDF variable to display; no buffer for a derived variable or an aggregate
+  h5expr_t m_expr; // (Derived) compiled expression, evaluated by tiles
+  h5aggregate_t m_aggregate; // (Aggregate) files and their extents, read by tiles
+  h5link_t m_link; // (Link) soft or external link, or a group of a linked file, listed when it is expanded
+  bool m_resolved; // (Link) target listed
+  bool m_linked; // item listed from a link, not from the scan of its file
 };
 
 Q_DECLARE_METATYPE(ItemData*);
@@ -144,22 +168,14 @@ ItemData* get_item_data(QTreeWidgetItem *item)
   return item_data;
 }
 
-///////////////////////////////////////////////////////////////////////////////////////
-//name_type_t
-//struct to get name and type of an object
-///////////////////////////////////////////////////////////////////////////////////////
-
-struct name_type_t
-{
-  char *name;
-  int type;
-};
-
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 //MainWindow::MainWindow
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
-MainWindow::MainWindow()
+MainWindow::MainWindow() :
+m_startup_painted(false),
+m_startup_opened(false),
+m_startup_shown(-1)
 {
   ///////////////////////////////////////////////////////////////////////////////////////
   //mdi area
@@ -175,6 +191,9 @@ MainWindow::MainWindow()
   ///////////////////////////////////////////////////////////////////////////////////////
 
   statusBar()->showMessage(tr("Ready"));
+  m_label_stats = new QLabel(this);
+  statusBar()->addPermanentWidget(m_label_stats);
+  connect(m_mdi_area, SIGNAL(subWindowActivated(QMdiSubWindow*)), this, SLOT(window_activated(QMdiSubWindow*)));
 
   ///////////////////////////////////////////////////////////////////////////////////////
   //dock for tree
@@ -190,20 +209,41 @@ MainWindow::MainWindow()
   m_tree = new FileTreeWidget();
   m_tree->setHeaderHidden(1);
   m_tree->set_main_window(this);
-  QStringList str_style = QStyleFactory::keys();
-  qDebug() << str_style;
-  for(int i = 0; i < str_style.size(); ++i)
+  QStyle *style = QStyleFactory::create("Windows");
+  if(style)
   {
-    if("Windows" == str_style[i])
-    {
-      QStyle *style = QStyleFactory::create(str_style[i]);
-      m_tree->setStyle(style);
-    }
+    m_tree->setStyle(style);
   }
   //add dock
   m_tree_dock->setWidget(m_tree);
   addDockWidget(Qt::LeftDockWidgetArea, m_tree_dock);
 
+  ///////////////////////////////////////////////////////////////////////////////////////
+  //dock for search results
+  ///////////////////////////////////////////////////////////////////////////////////////
+
+  m_search_dock = new QDockWidget(tr("Search results"), this);
+  m_search_tree = new QTreeWidget();
+  m_search_tree->setColumnCount(2);
+  m_search_tree->setHeaderLabels(QStringList() << tr("Cell") << tr("Value"));
+  connect(m_search_tree, SIGNAL(itemClicked(QTreeWidgetItem*, int)), this, SLOT(search_result_clicked(QTreeWidgetItem*, int)));
+  m_search_dock->setWidget(m_search_tree);
+  addDockWidget(Qt::BottomDockWidgetArea, m_search_dock);
+  m_search_dock->hide();
+
+  ///////////////////////////////////////////////////////////////////////////////////////
+  //dock for dataset properties, follows the tree selection while visible
+  ///////////////////////////////////////////////////////////////////////////////////////
+
+  m_properties_dock = new QDockWidget(tr("Properties"), this);
+  m_properties_tree = new QTreeWidget();
+  m_properties_tree->setColumnCount(2);
+  m_properties_tree->setHeaderLabels(QStringList() << tr("Property") << tr("Value"));
+  m_properties_dock->setWidget(m_properties_tree);
+  addDockWidget(Qt::RightDockWidgetArea, m_properties_dock);
+  m_properties_dock->hide();
+  connect(m_tree, SIGNAL(currentItemChanged(QTreeWidgetItem*, QTreeWidgetItem*)), this, SLOT(show_properties(QTreeWidgetItem*)));
+
   ///////////////////////////////////////////////////////////////////////////////////////
   //actions
   ///////////////////////////////////////////////////////////////////////////////////////
@@ -218,6 +258,28 @@ MainWindow::MainWindow()
   m_action_open->setStatusTip(tr("Open a file"));
   connect(m_action_open, SIGNAL(triggered()), this, SLOT(open_file()));
 
+  m_action_open_url = new QAction(tr("Open &URL..."), this);
+  m_action_open_url->setIcon(QIcon(":/images/open_dap.png"));
+  m_action_open_url->setStatusTip(tr("Open a file served over HTTP"));
+  connect(m_action_open_url, SIGNAL(triggered()), this, SLOT(open_url()));
+
+  ///////////////////////////////////////////////////////////////////////////////////////
+  //reload
+  ///////////////////////////////////////////////////////////////////////////////////////
+
+  m_action_reload = new QAction(tr("&Reload"), this);
+  m_action_reload->setShortcut(QKeySequence::Refresh);
+  m_action_reload->setStatusTip(tr("Read the changes of the selected file"));
+  connect(m_action_reload, SIGNAL(triggered()), this, SLOT(reload()));
+
+  ///////////////////////////////////////////////////////////////////////////////////////
+  //aggregate
+  ///////////////////////////////////////////////////////////////////////////////////////
+
+  m_action_aggregate = new QAction(tr("&Aggregate files..."), this);
+  m_action_aggregate->setStatusTip(tr("Show a dataset of a sequence of files as one variable"));
+  connect(m_action_aggregate, SIGNAL(triggered()), this, SLOT(aggregate_files()));
+
   ///////////////////////////////////////////////////////////////////////////////////////
   //exit
   ///////////////////////////////////////////////////////////////////////////////////////
@@ -264,6 +326,9 @@ MainWindow::MainWindow()
 
   m_menu_file = menuBar()->addMenu(tr("&File"));
   m_menu_file->addAction(m_action_open);
+  m_menu_file->addAction(m_action_open_url);
+  m_menu_file->addAction(m_action_reload);
+  m_menu_file->addAction(m_action_aggregate);
   m_action_separator_recent = m_menu_file->addSeparator();
   for(int i = 0; i < max_recent_files; ++i)
   {
@@ -275,6 +340,9 @@ MainWindow::MainWindow()
   m_menu_windows = menuBar()->addMenu(tr("&Window"));
   m_menu_windows->addAction(m_action_tile);
   m_menu_windows->addAction(m_action_close_all);
+  m_menu_windows->addSeparator();
+  m_menu_windows->addAction(m_search_dock->toggleViewAction());
+  m_menu_windows->addAction(m_properties_dock->toggleViewAction());
 
   m_menu_help = menuBar()->addMenu(tr("&Help"));
   m_menu_help->addAction(m_action_about);
@@ -289,14 +357,6 @@ MainWindow::MainWindow()
   //avoid popup on toolbar
   setContextMenuPolicy(Qt::NoContextMenu);
 
-  ///////////////////////////////////////////////////////////////////////////////////////
-  //settings
-  ///////////////////////////////////////////////////////////////////////////////////////
-
-  QSettings settings("space", "hdf_explorer");
-  m_sl_recent_files = settings.value("recentFiles").toStringList();
-  update_recent_file_actions();
-
   ///////////////////////////////////////////////////////////////////////////////////////
   //icons
   ///////////////////////////////////////////////////////////////////////////////////////
@@ -315,6 +375,85 @@ MainWindow::MainWindow()
   setWindowIcon(m_icon_main);
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::startup
+//the files are opened after the first paint of the window, seen by the filter of the mdi area
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void MainWindow::startup(const QStringList &file_names, const QElapsedTimer &timer)
+{
+  m_startup_files = file_names;
+  m_startup_timer = timer;
+  m_mdi_area->viewport()->installEventFilter(this);
+  QTimer::singleShot(startup_timeout, this, SLOT(startup_deferred()));
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::eventFilter
+//the window is on screen once its first paint is done: startup_deferred is queued after it
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool MainWindow::eventFilter(QObject *object, QEvent *event)
+{
+  if(object == m_mdi_area->viewport() && event->type() == QEvent::Paint && !m_startup_painted)
+  {
+    m_startup_painted = true;
+    QTimer::singleShot(0, this, SLOT(startup_deferred()));
+  }
+  return QMainWindow::eventFilter(object, event);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::startup_deferred
+//what the window does not need to be shown: the settings, and the files of the command line,
+//which are scanned in the background like the files opened from the menu; called once, after the
+//first paint, or after 'startup_timeout' if the window is not painted (minimized)
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void MainWindow::startup_deferred()
+{
+  if(m_startup_opened)
+  {
+    return;
+  }
+  m_startup_opened = true;
+  m_mdi_area->viewport()->removeEventFilter(this);
+  if(m_startup_painted)
+  {
+    m_startup_shown = m_startup_timer.elapsed();
+  }
+
+  QSettings settings("space", "hdf_explorer");
+  m_sl_recent_files = settings.value("recentFiles").toStringList();
+  update_recent_file_actions();
+
+  //blocks of the files opened by URL
+#if QT_VERSION >= 0x050000
+  QString dir_name = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+#else
+  QString dir_name = QDesktopServices::storageLocation(QDesktopServices::CacheLocation);
+#endif
+  if(!dir_name.isEmpty() && QDir().mkpath(dir_name + "/http"))
+  {
+    h5http_t::instance()->m_cache_dir = (dir_name + "/http").toLocal8Bit().data();
+  }
+
+  for(int idx = 0; idx < m_startup_files.size(); idx++)
+  {
+    if(read_file(m_startup_files.at(idx)) < 0)
+    {
+      statusBar()->showMessage(tr("Cannot open %1").arg(m_startup_files.at(idx)));
+      continue;
+    }
+    ScanThread *scan = find_scan(m_startup_files.at(idx).toLatin1().data());
+    if(scan)
+    {
+      m_startup_scans.append(scan);
+    }
+  }
+  m_startup_files.clear();
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 //MainWindow::about
 /////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -332,8 +471,24 @@ void MainWindow::about()
 
 void MainWindow::closeEvent(QCloseEvent *eve)
 {
-  QSettings settings("space", "hdf_explorer");
-  settings.setValue("recentFiles", m_sl_recent_files);
+  //the list is loaded by startup_deferred: closed before, it would be written empty
+  if(m_startup_opened)
+  {
+    QSettings settings("space", "hdf_explorer");
+    settings.setValue("recentFiles", m_sl_recent_files);
+  }
+
+  //stop the scans, searches and other worker threads still running
+  QList<ProgressThread*> threads = findChildren<ProgressThread*>();
+  for(int idx = 0; idx < threads.size(); idx++)
+  {
+    threads[idx]->cancel();
+  }
+  for(int idx = 0; idx < threads.size(); idx++)
+  {
+    threads[idx]->wait();
+  }
+  h5file_cache_t::instance()->close();
   eve->accept();
 }
 
@@ -356,7 +511,7 @@ void MainWindow::update_recent_file_actions()
   while(i.hasNext())
   {
     QString file_name = i.next();
-    if(!QFile::exists(file_name))
+    if(!h5http_is_url(file_name.toStdString()) && !QFile::exists(file_name))
     {
       i.remove();
     }
@@ -372,7 +527,10 @@ void MainWindow::update_recent_file_actions()
 
       QString file_name;
 
-      file_name = last_component(m_sl_recent_files[j]);
+      if(h5http_is_url(m_sl_recent_files[j].toStdString()))
+        file_name = m_sl_recent_files[j];
+      else
+        file_name = last_component(m_sl_recent_files[j]);
       QString text = tr("&%1 %2")
         .arg(j + 1)
         .arg(file_name);
@@ -412,20 +570,48 @@ void MainWindow::set_current_file(const QString &file_name)
 
 void MainWindow::open_file()
 {
-  QString file_name = QFileDialog::getOpenFileName(this,
+  QStringList file_names = QFileDialog::getOpenFileNames(this,
     tr("Open File"), ".",
     tr("HDF Files (*.h5);;All files (*.*)"));
 
-  if(file_name.isEmpty())
-    return;
-
-  if(this->read_file(file_name) == 0)
+  //each file is scanned in its own thread
+  for(int idx = 0; idx < file_names.size(); idx++)
   {
-    this->set_current_file(file_name);
+    if(this->read_file(file_names[idx]) == 0)
+    {
+      this->set_current_file(file_names[idx]);
+    }
   }
 }
 
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::open_url
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void MainWindow::open_url()
+{
+  bool ok;
+  QString url = QInputDialog::getText(this, tr("Open URL"), tr("URL of a HDF5 file:"), QLineEdit::Normal, "http://", &ok).trimmed();
+  if(!ok || url.isEmpty())
+  {
+    return;
+  }
+  if(!h5http_is_url(url.toStdString()))
+  {
+    QMessageBox::warning(this, tr(app_name), tr("%1 is not a http:// or https:// URL").arg(url));
+    return;
+  }
+  if(read_file(url) == 0)
+  {
+    set_current_file(url);
+  }
+  else
+  {
+    QMessageBox::warning(this, tr(app_name), tr("Cannot open %1").arg(url));
+  }
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 //MainWindow::open_recent_file
 /////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -439,19 +625,50 @@ void MainWindow::open_recent_file()
   }
 }
 
+///////////////////////////////////////////////////////////////////////////////////////
+//catalog_cache_name
+//catalog cache of a file: a file named after the SHA-1 of the absolute file path, in the
+//'catalog' directory of the user cache location; empty if the directory cannot be made
+///////////////////////////////////////////////////////////////////////////////////////
+
+QString catalog_cache_name(const QString &file_name)
+{
+  //the catalog of a file is checked with stat(), which a URL does not have
+  if(h5http_is_url(file_name.toStdString()))
+  {
+    return QString();
+  }
+#if QT_VERSION >= 0x050000
+  QString dir_name = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+#else
+  QString dir_name = QDesktopServices::storageLocation(QDesktopServices::CacheLocation);
+#endif
+  if(dir_name.isEmpty())
+  {
+    return QString();
+  }
+  dir_name += "/catalog";
+  if(!QDir().mkpath(dir_name))
+  {
+    return QString();
+  }
+  QByteArray path = QFileInfo(file_name).absoluteFilePath().toUtf8();
+  QString hash = QCryptographicHash::hash(path, QCryptographicHash::Sha1).toHex();
+  return dir_name + "/" + hash;
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////
 //MainWindow::read_file
+//adds the file node and starts a scan of the file; the tree fills in as the scan goes
 ///////////////////////////////////////////////////////////////////////////////////////
 
 int MainWindow::read_file(QString file_name)
 {
   QByteArray ba;
-  std::string path;
   std::string str_file_name;
   QString name;
   int index;
   int len;
-  hid_t fid;
 
   //convert QString to char*
   ba = file_name.toLatin1();
@@ -459,19 +676,20 @@ int MainWindow::read_file(QString file_name)
   //convert to std::string
   str_file_name = ba.data();
 
-  ///////////////////////////////////////////////////////////////////////////////////////
-  //construct list of objects
-  ///////////////////////////////////////////////////////////////////////////////////////
-
-  m_visit.visit(str_file_name.c_str());
-
-  ///////////////////////////////////////////////////////////////////////////////////////
-  //populate objects
-  ///////////////////////////////////////////////////////////////////////////////////////
-
-  if((fid = H5Fopen(str_file_name.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT)) < 0)
+  //a URL is a request to the server: it is probed by the scan thread, and a failure shown by scan_finished
+  if(!h5http_is_url(str_file_name))
   {
-    return -1;
+    h5lock_t lock;
+    htri_t is_hdf5;
+    H5E_BEGIN_TRY
+    {
+      is_hdf5 = H5Fis_hdf5(str_file_name.c_str());
+    }
+    H5E_END_TRY;
+    if(is_hdf5 <= 0)
+    {
+      return -1;
+    }
   }
 
   //item data group item
@@ -482,433 +700,588 @@ int MainWindow::read_file(QString file_name)
   index = file_name.lastIndexOf(QChar('/'));
   len = file_name.length();
   name = file_name.right(len - index - 1);
-  root_item->setText(0, name);
+  root_item->setText(0, tr("%1 (scanning)").arg(name));
   root_item->setIcon(0, m_icon_group);
   //add data
   QVariant data;
   data.setValue(item_data_grp);
   root_item->setData(0, Qt::UserRole, data);
 
-  if(iterate(str_file_name, "/", fid, root_item) < 0)
-  {
+  ///////////////////////////////////////////////////////////////////////////////////////
+  //populate objects
+  ///////////////////////////////////////////////////////////////////////////////////////
 
+  ScanThread *thread = new ScanThread(this, str_file_name, root_item);
+  thread->setObjectName(name);
+  thread->m_cache_name = catalog_cache_name(file_name).toLocal8Bit().data();
+  connect(thread, SIGNAL(batch_ready()), this, SLOT(scan_batch()));
+  connect(thread, SIGNAL(finished()), this, SLOT(scan_finished()));
+  m_scans.append(thread);
+  if(thread->load_cache())
+  {
+    //unchanged since the last scan: show the cached tree now, check it in the background
+    insert_entries(thread);
+    root_item->setText(0, tr("%1 (checking)").arg(name));
+    statusBar()->showMessage(tr("Checking %1...").arg(name));
   }
-
-  if(H5Fclose(fid) < 0)
+  else
   {
-
+    statusBar()->showMessage(tr("Scanning %1...").arg(name));
   }
-
+  thread->start();
   return 0;
 }
 
+///////////////////////////////////////////////////////////////////////////////////////
+//ScanThread::ScanThread
+///////////////////////////////////////////////////////////////////////////////////////
+
+ScanThread::ScanThread(QObject *parent, const std::string &file_name, QTreeWidgetItem *root_item) :
+ProgressThread(parent),
+m_file_name(file_name),
+m_root_item(root_item),
+m_verify(false),
+m_changed(false),
+m_complete(false),
+m_first(0),
+m_nbr_done(0)
+{
+}
 
 ///////////////////////////////////////////////////////////////////////////////////////
-//count_objects_cb
-//callback function function for H5Literate
+//ScanThread::run
 ///////////////////////////////////////////////////////////////////////////////////////
 
-static herr_t count_objects_cb(hid_t, const char *, const H5L_info_t *, void *_op_data)
+void ScanThread::run()
 {
-  hsize_t *op_data = (hsize_t *)_op_data;
+  if(!m_verify && h5http_is_url(m_file_name))
+  {
+    //the first block, which has the superblock, is kept for the scan
+    h5lock_t lock;
+    hid_t fid;
+    H5E_BEGIN_TRY
+    {
+      fid = h5file_open(m_file_name.c_str());
+    }
+    H5E_END_TRY;
+    if(fid < 0)
+    {
+      m_result = -1;
+      return;
+    }
+    H5Fclose(fid);
+  }
+
+  if(m_verify)
+  {
+    h5scan_key_t key;
+    if(m_complete && key.get(m_file_name.c_str()) == 0 && key == m_scan.m_key)
+    {
+      m_result = 0;
+      return;
+    }
+    m_changed = true;
+    m_result = m_scan.rescan(m_file_name.c_str(), this);
+  }
+  else
+  {
+    m_result = m_scan.scan(m_file_name.c_str(), this);
+  }
+
+  if(m_result == 0)
+  {
+    m_complete = true;
+    if(!m_cache_name.empty() && m_scan.save(m_cache_name.c_str()) < 0)
+    {
+      qDebug() << "cannot write catalog cache" << m_cache_name.c_str();
+    }
+  }
+}
 
-  (*op_data)++;
+///////////////////////////////////////////////////////////////////////////////////////
+//ScanThread::restart
+///////////////////////////////////////////////////////////////////////////////////////
 
-  return(H5_ITER_CONT);
+void ScanThread::restart()
+{
+  m_verify = true;
+  m_changed = false;
+  m_cancel.store(0);
+  start();
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////
-//get_name_type_cb
-//callback function function for H5Literate
-//////////////////////////////////////////////////////////////////////////////////////
+//ScanThread::load_cache
+///////////////////////////////////////////////////////////////////////////////////////
 
-static herr_t get_name_type_cb(hid_t loc_id, const char *name, const H5L_info_t *, void *op_data)
+bool ScanThread::load_cache()
 {
-  H5G_stat_t stat_buf;
+  h5scan_key_t key;
 
-  if(H5Gget_objinfo(loc_id, name, 0, &stat_buf) < 0)
+  if(m_cache_name.empty() || key.stat(m_file_name.c_str()) < 0)
   {
-
+    return false;
+  }
+  if(m_scan.load(m_cache_name.c_str(), key) < 0)
+  {
+    return false;
   }
+  m_verify = true;
+  m_complete = true;
+  reset();
+  return true;
+}
 
-  ((name_type_t *)op_data)->type = stat_buf.type;
-  ((name_type_t *)op_data)->name = (char *)strdup(name);
+///////////////////////////////////////////////////////////////////////////////////////
+//ScanThread::reset
+///////////////////////////////////////////////////////////////////////////////////////
 
-  // define H5_ITER_STOP for return. This will cause the iterator to stop 
-  return H5_ITER_STOP;
+void ScanThread::reset()
+{
+  QMutexLocker locker(&m_mutex);
+  m_items.clear();
+  m_batch = m_scan.m_entries;
+  m_first = 0;
+  m_nbr_done = m_batch.size();
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////
-//MainWindow::find_object
-//////////////////////////////////////////////////////////////////////////////////////
+//ScanThread::progress
+//called in the worker thread after each group, with the number of entries so far
+///////////////////////////////////////////////////////////////////////////////////////
 
-H5O_info_added_t* MainWindow::find_object(haddr_t addr)
+bool ScanThread::progress(hsize_t done, hsize_t)
 {
-  for(size_t idx = 0; idx < m_visit.visit_info.size(); idx++)
+  bool was_empty;
+  if(m_verify)
   {
-    if(addr == m_visit.visit_info[idx].oinfo.addr)
-    {
-      return &(m_visit.visit_info[idx]);
-    }
+    //rescan of a changed file: the tree is rebuilt at the end
+    return m_cancel.load() == 0;
   }
-  return NULL;
+  {
+    QMutexLocker locker(&m_mutex);
+    was_empty = m_batch.empty();
+    m_batch.insert(m_batch.end(), m_scan.m_entries.begin() + m_nbr_done, m_scan.m_entries.begin() + static_cast<size_t>(done));
+    m_nbr_done = static_cast<size_t>(done);
+  }
+  if(was_empty && m_nbr_done > m_first)
+  {
+    emit batch_ready();
+  }
+  return m_cancel.load() == 0;
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////
-//MainWindow::iterate
-//iterates in group specified by location id 'loc_id'
-//full group name is used to recursevely construct a dataset path
-//QTreeWidgetItem * is used to build the tree item hierarchy 
-//passing new QTreeWidgetItem for group as parent
-//for datasets, sizes and metadata are stored
+//ScanThread::take
 ///////////////////////////////////////////////////////////////////////////////////////
 
-int MainWindow::iterate(const std::string& file_name, const std::string& grp_path, const hid_t loc_id, QTreeWidgetItem *tree_item_parent)
+size_t ScanThread::take(std::vector<h5entry_t> &entries)
 {
-  hsize_t nbr_objects = 0;
-  QTreeWidgetItem *item_grp = NULL;
-  QTreeWidgetItem *item_var = NULL;
-  hsize_t index;
-  name_type_t info;
+  QMutexLocker locker(&m_mutex);
+  size_t first = m_first;
+  entries.clear();
+  entries.swap(m_batch);
+  m_first += entries.size();
+  return first;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::new_item
+///////////////////////////////////////////////////////////////////////////////////////
+
+QTreeWidgetItem* MainWindow::new_item(const h5entry_t &entry, const std::string &file_name)
+{
+  QTreeWidgetItem *item = new QTreeWidgetItem();
   ItemData *item_data;
   QVariant data;
-  std::string path;
-  bool do_iterate;
-  size_t datatype_size;
-  H5T_sign_t datatype_sign;
-  H5T_class_t datatype_class;
-  hid_t gid;
-  hid_t did;
-  hid_t sid;
-  hid_t ftid;
-  hid_t mtid;
-  hsize_t dims[H5S_MAX_RANK];
-  int rank;
 
-  if(H5Literate(loc_id, H5_INDEX_NAME, H5_ITER_INC, NULL, count_objects_cb, &nbr_objects) < 0)
+  item->setText(0, entry.m_name.c_str());
+  if(entry.m_kind == ENTRY_GROUP)
   {
-
+    item->setIcon(0, m_icon_group);
+    item_data = new ItemData(ItemData::Group, file_name, entry.m_name, (hdf_dataset_t*)NULL);
   }
-
-  for(hsize_t idx_obj = 0; idx_obj < nbr_objects; idx_obj++)
+  else if(entry.m_kind == ENTRY_LINK)
   {
-
-    index = idx_obj;
-
-    //'index' allows an interrupted iteration to be resumed; it is passed in by the application with a starting point 
-    //and returned by the library with the point at which the iteration stopped
-
-    if(H5Literate(loc_id, H5_INDEX_NAME, H5_ITER_INC, &index, get_name_type_cb, &info) < 0)
+    //its target is listed when it is expanded
+    item_data = new ItemData(ItemData::Link, file_name, entry.m_name, (hdf_dataset_t*)NULL);
+    item_data->m_link = entry.m_link;
+    item->setChildIndicatorPolicy(QTreeWidgetItem::ShowIndicator);
+    if(entry.m_link.m_type == H5L_TYPE_HARD)
     {
-
+      item->setIcon(0, m_icon_group);
     }
-
-    // initialize path 
-    path = grp_path;
-    if(grp_path != "/")
-      path += "/";
-    path += info.name;
-
-    switch(info.type)
+    else if(entry.m_link.m_type == H5L_TYPE_SOFT)
     {
-      ///////////////////////////////////////////////////////////////////////////////////////
-      //H5G_GROUP
-      //////////////////////////////////////////////////////////////////////////////////////
-
-    case H5G_GROUP:
+      item->setToolTip(0, tr("Soft link to %1").arg(entry.m_link.m_path.c_str()));
+    }
+    else
+    {
+      item->setToolTip(0, tr("External link to %1 in %2").arg(entry.m_link.m_path.c_str()).arg(entry.m_link.m_file_name.c_str()));
+    }
+  }
+  else
+  {
+    //store a hdf_dataset_t with full path, dimensions and metadata
+    hdf_dataset_t *dataset = new hdf_dataset_t(
+      entry.m_path.c_str(),
+      entry.m_dim,
+      entry.m_datatype_size,
+      entry.m_datatype_sign,
+      entry.m_datatype_class);
 
-      if((gid = H5Gopen2(loc_id, info.name, H5P_DEFAULT)) < 0)
-      {
+    if(entry.m_kind == ENTRY_DATASET)
+    {
+      item->setIcon(0, m_icon_dataset);
+      item_data = new ItemData(ItemData::Variable, file_name, entry.m_name, dataset);
+    }
+    else
+    {
+      item->setIcon(0, m_icon_attribute);
+      item_data = new ItemData(ItemData::Attribute, file_name, entry.m_name, dataset);
+    }
+  }
+  data.setValue(item_data);
+  item->setData(0, Qt::UserRole, data);
+  return item;
+}
 
-      }
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::insert_entries
+//children are collected per parent item and added with one addChildren() each,
+//instead of one row insertion per item
+///////////////////////////////////////////////////////////////////////////////////////
 
-      H5O_info_t oinfo_buf;
-      do_iterate = true;
+void MainWindow::insert_entries(ScanThread *thread)
+{
+  std::vector<h5entry_t> entries;
+  size_t first = thread->take(entries);
+  QMap<QTreeWidgetItem*, QList<QTreeWidgetItem*> > children;
 
-      //get object info
-      if(H5Oget_info(gid, &oinfo_buf) < 0)
-      {
+  for(size_t idx = 0; idx < entries.size(); idx++)
+  {
+    if(first + idx == 0)
+    {
+      //root group
+      thread->m_items.push_back(thread->m_root_item);
+      continue;
+    }
+    QTreeWidgetItem *item = new_item(entries[idx], thread->m_file_name);
+    thread->m_items.push_back(item);
+    children[thread->m_items[entries[idx].m_parent]].append(item);
+  }
 
-      }
+  QMap<QTreeWidgetItem*, QList<QTreeWidgetItem*> >::iterator it;
+  for(it = children.begin(); it != children.end(); ++it)
+  {
+    it.key()->addChildren(it.value());
+  }
+}
 
-      //group item
-      item_grp = new QTreeWidgetItem(tree_item_parent);
-      item_grp->setText(0, info.name);
-      item_grp->setIcon(0, m_icon_group);
-      //item data
-      item_data = new ItemData(ItemData::Group, file_name, info.name, (hdf_dataset_t*)NULL);
-      data.setValue(item_data);
-      item_grp->setData(0, Qt::UserRole, data);
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::update_items
+///////////////////////////////////////////////////////////////////////////////////////
 
-      if(oinfo_buf.rc > 1)
-      {
-        H5O_info_added_t *oinfo_added = find_object(oinfo_buf.addr);
+void MainWindow::update_items(ScanThread *thread)
+{
+  const std::vector<h5entry_t> &entries = thread->m_scan.m_entries;
+  const std::vector<size_t> &previous = thread->m_scan.m_previous;
+  std::vector<QTreeWidgetItem*> &old_items = thread->m_items;
+  std::vector<QTreeWidgetItem*> items(entries.size(), NULL);
+  std::vector<bool> kept(old_items.size(), false);
 
-        if(oinfo_added->added > 0)
-        {
-          //avoid infinite recursion due to a circular path in the file.
-          do_iterate = false;
-        }
-        else
-        {
-          oinfo_added->added++;
-        }
-      }
-
-      //iterate in sub group passing QTreeWidgetItem for group as parent
-      if(do_iterate && iterate(file_name, path, gid, item_grp) < 0)
-      {
-
-      }
-
-      if(get_attributes(file_name, path, gid, item_grp) < 0)
-      {
-
-      }
-
-      if(H5Gclose(gid) < 0)
-      {
-
-      }
-
-      free(info.name);
-      break;
-
-      ///////////////////////////////////////////////////////////////////////////////////////
-      //H5G_DATASET
-      //////////////////////////////////////////////////////////////////////////////////////
-
-    case H5G_DATASET:
-
-      if((did = H5Dopen2(loc_id, info.name, H5P_DEFAULT)) < 0)
-      {
-
-      }
-
-      if((sid = H5Dget_space(did)) < 0)
-      {
-
-      }
-
-      if((rank = H5Sget_simple_extent_dims(sid, dims, NULL)) < 0)
-      {
-
-      }
-
-      if((ftid = H5Dget_type(did)) < 0)
-      {
-
-      }
-
-      if((mtid = H5Tget_native_type(ftid, H5T_DIR_DEFAULT)) < 0)
-      {
-
-      }
-
-      ///////////////////////////////////////////////////////////////////////////////////////
-      //store datatype sizes and metadata needed to display HDF5 buffer data
-      ///////////////////////////////////////////////////////////////////////////////////////
-
-      if((datatype_size = H5Tget_size(mtid)) == 0)
-      {
-
-      }
-
-      if((datatype_sign = H5Tget_sign(mtid)) < 0)
-      {
-
-      }
-
-      if((datatype_class = H5Tget_class(mtid)) < 0)
-      {
-
-      }
-
-      if(H5Sclose(sid) < 0)
-      {
-
-      }
-
-      if(H5Tclose(ftid) < 0)
-      {
-
-      }
-
-      if(H5Tclose(mtid) < 0)
-      {
-
-      }
+  for(size_t idx = 0; idx < entries.size(); idx++)
+  {
+    if(idx == 0)
+    {
+      items[idx] = thread->m_root_item;
+    }
+    else if(previous[idx] != h5scan_t::npos && previous[idx] < old_items.size())
+    {
+      items[idx] = old_items[previous[idx]];
+      kept[previous[idx]] = true;
+    }
+    else
+    {
+      items[idx] = new_item(entries[idx], thread->m_file_name);
+    }
+  }
 
-      //store dimensions in ItemData
-      std::vector< hsize_t> dim; //dataset dimensions
-      for(int idx = 0; idx < rank; ++idx)
+  //items removed: none of their descendants is kept, so only the topmost ones are deleted
+  QSet<QTreeWidgetItem*> kept_items;
+  kept_items.insert(thread->m_root_item);
+  for(size_t idx = 1; idx < old_items.size(); idx++)
+  {
+    if(kept[idx])
+    {
+      kept_items.insert(old_items[idx]);
+    }
+  }
+  QList<QTreeWidgetItem*> removed;
+  for(size_t idx = 1; idx < old_items.size(); idx++)
+  {
+    if(!kept[idx])
+    {
+      if(kept_items.contains(old_items[idx]->parent()))
       {
-        dim.push_back(dims[idx]);
+        removed.append(old_items[idx]);
       }
+      release_item(old_items[idx]);
+    }
+  }
+  qDeleteAll(removed);
 
-      //store a hdf_dataset_t with full path, dimensions and metadata
-      hdf_dataset_t *dataset = new hdf_dataset_t(
-        path.c_str(),
-        dim,
-        datatype_size,
-        datatype_sign,
-        datatype_class);
-
-      //append item
-      item_var = new QTreeWidgetItem(tree_item_parent);
-      item_var->setText(0, info.name);
-      item_var->setIcon(0, m_icon_dataset);
-      //item data
-      item_data = new ItemData(ItemData::Variable, file_name, info.name, dataset);
-      data.setValue(item_data);
-      item_var->setData(0, Qt::UserRole, data);
-
-      if(get_attributes(file_name, path, did, item_var) < 0)
+  //children in the order of the entries; a kept item stays in place unless its siblings moved
+  QMap<QTreeWidgetItem*, QList<QTreeWidgetItem*> > children;
+  for(size_t idx = 1; idx < entries.size(); idx++)
+  {
+    children[items[entries[idx].m_parent]].append(items[idx]);
+  }
+  QMap<QTreeWidgetItem*, QList<QTreeWidgetItem*> >::iterator it;
+  for(it = children.begin(); it != children.end(); ++it)
+  {
+    QTreeWidgetItem *parent = it.key();
+    const QList<QTreeWidgetItem*> &list = it.value();
+    if(parent->childCount() == 0)
+    {
+      parent->addChildren(list);
+      continue;
+    }
+    for(int pos = 0; pos < list.size(); pos++)
+    {
+      if(parent->child(pos) == list.at(pos))
       {
-
+        continue;
       }
-
-      if(H5Dclose(did) < 0)
+      if(list.at(pos)->parent() == parent)
       {
-
+        parent->removeChild(list.at(pos));
       }
-
-      break;
+      parent->insertChild(pos, list.at(pos));
     }
-
   }
 
-  return 0;
+  old_items.swap(items);
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////
-//MainWindow::get_attributes
-// it is assumed that loc_id is either from 
-// loc_id = H5Gopen( fid, name);
-// loc_id = H5Dopen( fid, name);
-// loc_id = H5Topen( fid, name);
+//MainWindow::release_item
 ///////////////////////////////////////////////////////////////////////////////////////
 
-int MainWindow::get_attributes(const std::string& file_name, const std::string& path, const hid_t loc_id, QTreeWidgetItem *tree_item_parent)
+void MainWindow::release_item(QTreeWidgetItem *item)
 {
-  H5O_info_t oinfo;
-  hid_t aid;
-  size_t datatype_size;
-  H5T_sign_t datatype_sign;
-  H5T_class_t datatype_class;
-  hid_t sid;
-  hid_t ftid;
-  hid_t mtid;
-  hsize_t dims[H5S_MAX_RANK];
-  char name[1024];
-  int rank;
-  ItemData *item_data;
-  QVariant data;
-  QTreeWidgetItem *item = NULL;
+  ItemData *item_data = get_item_data(item);
 
-  //get object info
-  if(H5Oget_info(loc_id, &oinfo) < 0)
+  //the items listed from a link are not entries of the scan: they go with it
+  for(int idx = 0; idx < item->childCount(); idx++)
   {
-
+    ItemData *child_data = get_item_data(item->child(idx));
+    if(child_data && child_data->m_linked)
+    {
+      release_item(item->child(idx));
+    }
   }
 
-  for(hsize_t idx = 0; idx < oinfo.num_attrs; idx++)
+  QList<QMdiSubWindow *> list = m_mdi_area->subWindowList();
+  for(int idx = 0; idx < list.size(); idx++)
   {
-    if((aid = H5Aopen_by_idx(loc_id, ".", H5_INDEX_CRT_ORDER, H5_ITER_INC, idx, H5P_DEFAULT, H5P_DEFAULT)) < 0)
+    ChildWindow *window = qobject_cast<ChildWindow *>(list.at(idx)->widget());
+    if(window && window->m_item_data == item_data)
     {
-
+      //the window is deleted later, the item data below
+      window->stop_stats();
+      list.at(idx)->close();
     }
+  }
 
-    if(H5Aget_name(aid, (size_t)1024, name) < 0)
+  for(int idx = m_search_tree->topLevelItemCount(); idx-- > 0;)
+  {
+    QTreeWidgetItem *item_search = m_search_tree->topLevelItem(idx);
+    if(item_search->data(0, Qt::UserRole).value<void*>() == static_cast<void*>(item))
     {
-
+      delete item_search;
     }
+  }
 
-    if((sid = H5Aget_space(aid)) < 0)
-    {
+  delete item_data;
+  item->setData(0, Qt::UserRole, QVariant());
+}
 
-    }
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::scan_batch
+///////////////////////////////////////////////////////////////////////////////////////
 
-    if((rank = H5Sget_simple_extent_dims(sid, dims, NULL)) < 0)
-    {
+void MainWindow::scan_batch()
+{
+  ScanThread *thread = qobject_cast<ScanThread *>(sender());
+  if(thread == NULL)
+  {
+    return;
+  }
+  insert_entries(thread);
+  thread->m_root_item->setText(0, tr("%1 (scanning, %2 items)").arg(thread->objectName()).arg(thread->m_items.size()));
+}
 
-    }
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::scan_finished
+///////////////////////////////////////////////////////////////////////////////////////
 
-    if((ftid = H5Aget_type(aid)) < 0)
-    {
+void MainWindow::scan_finished()
+{
+  ScanThread *thread = qobject_cast<ScanThread *>(sender());
+  if(thread == NULL)
+  {
+    return;
+  }
+  bool startup = m_startup_scans.removeAll(thread) > 0;
 
-    }
+  if(thread->m_changed && thread->m_result == 0)
+  {
+    //the tree is out of date
+    h5scale_cache_t::instance()->clear(thread->m_file_name);
+    update_items(thread);
+  }
+  insert_entries(thread);
 
-    if((mtid = H5Tget_native_type(ftid, H5T_DIR_DEFAULT)) < 0)
+  if(thread->m_result < 0)
+  {
+    QMessageBox::warning(this, tr(app_name), tr("Cannot read %1").arg(thread->m_file_name.c_str()));
+    statusBar()->showMessage(tr("Ready"));
+    if(thread->m_root_item->childCount() == 0)
     {
-
+      m_scans.removeAll(thread);
+      delete get_item_data(thread->m_root_item);
+      delete thread->m_root_item;
+      thread->deleteLater();
     }
-
-    ///////////////////////////////////////////////////////////////////////////////////////
-    //store datatype sizes and metadata needed to display HDF5 buffer data
-    ///////////////////////////////////////////////////////////////////////////////////////
-
-    if((datatype_size = H5Tget_size(mtid)) == 0)
+    else
     {
-
+      thread->m_root_item->setText(0, thread->objectName());
     }
-
-    if((datatype_sign = H5Tget_sign(mtid)) < 0)
+  }
+  else if(thread->m_result == 1)
+  {
+    thread->m_root_item->setText(0, tr("%1 (scan canceled)").arg(thread->objectName()));
+    statusBar()->showMessage(tr("Scan of %1 canceled").arg(thread->objectName()));
+  }
+  else if(thread->m_changed)
+  {
+    size_t nbr_read = 0;
+    for(size_t idx = 0; idx < thread->m_scan.m_previous.size(); idx++)
     {
-
+      if(thread->m_scan.m_previous[idx] == h5scan_t::npos)
+        nbr_read++;
     }
+    thread->m_root_item->setText(0, thread->objectName());
+    statusBar()->showMessage(tr("%1 reloaded: %2 of %3 items read again").arg(thread->objectName())
+      .arg(nbr_read).arg(thread->m_scan.m_entries.size()));
+  }
+  else
+  {
+    thread->m_root_item->setText(0, thread->objectName());
+    statusBar()->showMessage(thread->m_verify ? tr("%1 unchanged").arg(thread->objectName()) : tr("Ready"));
+  }
 
-    if((datatype_class = H5Tget_class(mtid)) < 0)
+  //startup time, from the start of the program
+  if(startup && thread->m_result == 0)
+  {
+    QString listed = tr("%1 listed in %2 ms").arg(thread->objectName()).arg(m_startup_timer.elapsed());
+    if(m_startup_shown >= 0)
     {
-
+      listed += tr(", window shown in %1 ms").arg(m_startup_shown);
     }
+    statusBar()->showMessage(listed);
+  }
+}
 
-    if(H5Sclose(sid) < 0)
-    {
-
-    }
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::find_scan
+//the last scan of the file, the one read_file just made for it
+///////////////////////////////////////////////////////////////////////////////////////
 
-    if(H5Tclose(ftid) < 0)
+ScanThread* MainWindow::find_scan(const std::string &file_name)
+{
+  for(int idx = m_scans.size() - 1; idx >= 0; idx--)
+  {
+    if(m_scans.at(idx)->m_file_name == file_name)
     {
-
+      return m_scans.at(idx);
     }
+  }
+  return NULL;
+}
 
-    if(H5Tclose(mtid) < 0)
-    {
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::is_scanning
+///////////////////////////////////////////////////////////////////////////////////////
 
+bool MainWindow::is_scanning(QTreeWidgetItem *root_item)
+{
+  for(int idx = 0; idx < m_scans.size(); idx++)
+  {
+    if(m_scans[idx]->m_root_item == root_item && m_scans[idx]->isRunning())
+    {
+      return true;
     }
+  }
+  return false;
+}
 
-    if(H5Aclose(aid) < 0)
-    {
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::cancel_scan
+///////////////////////////////////////////////////////////////////////////////////////
 
+void MainWindow::cancel_scan(QTreeWidgetItem *root_item)
+{
+  for(int idx = 0; idx < m_scans.size(); idx++)
+  {
+    if(m_scans[idx]->m_root_item == root_item)
+    {
+      m_scans[idx]->cancel();
     }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::reload_file
+///////////////////////////////////////////////////////////////////////////////////////
 
-    //store dimensions in ItemData
-    std::vector< hsize_t> dim; //dataset dimensions
-    for(int idx = 0; idx < rank; ++idx)
+void MainWindow::reload_file(QTreeWidgetItem *root_item)
+{
+  for(int idx = 0; idx < m_scans.size(); idx++)
+  {
+    ScanThread *thread = m_scans[idx];
+    if(thread->m_root_item == root_item && !thread->isRunning())
     {
-      dim.push_back(dims[idx]);
+      if(h5http_is_url(thread->m_file_name))
+      {
+        //read the file again, not the blocks kept
+        h5http_t::instance()->clear(thread->m_file_name);
+      }
+      root_item->setText(0, tr("%1 (checking)").arg(thread->objectName()));
+      statusBar()->showMessage(tr("Checking %1...").arg(thread->objectName()));
+      thread->restart();
     }
-
-    //store a hdf_dataset_t with full path, dimensions and metadata
-    hdf_dataset_t *dataset = new hdf_dataset_t(
-      path.c_str(),
-      dim,
-      datatype_size,
-      datatype_sign,
-      datatype_class);
-
-    //append item
-    item = new QTreeWidgetItem(tree_item_parent);
-    item->setText(0, name);
-    item->setIcon(0, m_icon_attribute);
-    //item data
-    item_data = new ItemData(ItemData::Attribute, file_name, name, dataset);
-    data.setValue(item_data);
-    item->setData(0, Qt::UserRole, data);
   }
+}
 
-  return 0;
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::reload
+//reload the file of the current tree item
+///////////////////////////////////////////////////////////////////////////////////////
+
+void MainWindow::reload()
+{
+  QTreeWidgetItem *item = m_tree->currentItem();
+  if(item == NULL)
+  {
+    return;
+  }
+  while(item->parent())
+  {
+    item = item->parent();
+  }
+  reload_file(item);
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////
@@ -924,6 +1297,9 @@ FileTreeWidget::FileTreeWidget(QWidget *parent) : QTreeWidget(parent)
 
   //double click
   connect(this, SIGNAL(itemDoubleClicked(QTreeWidgetItem*, int)), this, SLOT(add_grid()));
+
+  //links are resolved when they are expanded
+  connect(this, SIGNAL(itemExpanded(QTreeWidgetItem*)), this, SLOT(expand_item(QTreeWidgetItem*)));
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////
@@ -959,6 +1335,7 @@ void FileTreeWidget::load_item(QTreeWidgetItem  *item)
   H5T_class_t datatype_class;
   hsize_t dims[H5S_MAX_RANK];
   hsize_t nbr_elements = 1;
+  h5lock_t lock;
 
   ItemData *item_data = get_item_data(item);
   assert(item_data->m_kind == ItemData::Variable);
@@ -969,7 +1346,7 @@ void FileTreeWidget::load_item(QTreeWidgetItem  *item)
     return;
   }
 
-  if((fid = H5Fopen(item_data->m_file_name.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT)) < 0)
+  if((fid = h5file_open(item_data->m_file_name.c_str())) < 0)
   {
 
   }
@@ -1019,11 +1396,37 @@ void FileTreeWidget::load_item(QTreeWidgetItem  *item)
     nbr_elements *= dims[idx];
   }
 
-  item_data->m_dataset->m_buf = malloc(static_cast<size_t>(datatype_size * nbr_elements));
+  //virtual datasets are not loaded either: a read of all of it opens every source, while a
+  //tile opens only the sources it overlaps
+  bool is_virtual = false;
+#if H5_VERSION_GE(1,10,0)
+  hid_t dcpl = H5Dget_create_plist(did);
+  if(dcpl >= 0)
+  {
+    is_virtual = H5Pget_layout(dcpl) == H5D_VIRTUAL;
+    H5Pclose(dcpl);
+  }
+#endif
 
-  if(H5Dread(did, mtid, H5S_ALL, H5S_ALL, H5P_DEFAULT, item_data->m_dataset->m_buf) < 0)
+  //larger datasets are not loaded: the grid reads the cells it shows by tiles
+  if(!is_virtual && datatype_size * nbr_elements <= max_load_bytes)
   {
-    qDebug() << item_data->m_dataset->m_path.c_str();
+    item_data->m_dataset->m_buf = malloc(static_cast<size_t>(datatype_size * nbr_elements));
+
+    //compressed datasets are decompressed on the thread pool, falling back to H5Dread
+    h5chunk_t direct;
+    int direct_result = -1;
+    if(rank > 0 && direct.init(did) && direct.m_filters.size())
+    {
+      std::vector<hsize_t> start(rank, 0);
+      std::vector<hsize_t> count(dims, dims + rank);
+      direct_result = direct.read(did, start, count, item_data->m_dataset->m_buf);
+    }
+
+    if(direct_result < 0 && H5Dread(did, mtid, H5S_ALL, H5S_ALL, H5P_DEFAULT, item_data->m_dataset->m_buf) < 0)
+    {
+      qDebug() << item_data->m_dataset->m_path.c_str();
+    }
   }
 
   if(H5Dclose(did) < 0)
@@ -1073,6 +1476,7 @@ void FileTreeWidget::load_item_attribute(QTreeWidgetItem  *item)
   hsize_t dims[H5S_MAX_RANK];
   hsize_t nbr_elements = 1;
   H5O_info_t oinfo;
+  h5lock_t lock;
   ItemData *item_data = get_item_data(item);
   assert(item_data->m_kind == ItemData::Attribute);
   const char* path = item_data->m_dataset->m_path.c_str();
@@ -1084,7 +1488,7 @@ void FileTreeWidget::load_item_attribute(QTreeWidgetItem  *item)
     return;
   }
 
-  if((fid = H5Fopen(item_data->m_file_name.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT)) < 0)
+  if((fid = h5file_open(item_data->m_file_name.c_str())) < 0)
   {
 
   }
@@ -1230,9 +1634,45 @@ void FileTreeWidget::load_item_attribute(QTreeWidgetItem  *item)
 void FileTreeWidget::show_context_menu(const QPoint &p)
 {
   QTreeWidgetItem *item = static_cast <QTreeWidgetItem*> (itemAt(p));
+  if(item == NULL)
+  {
+    return;
+  }
   ItemData *item_data = get_item_data(item);
-  if(item_data->m_kind == ItemData::Group)
+  if(item_data->m_kind == ItemData::Group || item_data->m_kind == ItemData::Link)
   {
+    //file node
+    if(item->parent() == NULL)
+    {
+      QMenu menu;
+      QAction *action_report = new QAction("File report...", this);
+      connect(action_report, SIGNAL(triggered()), this, SLOT(add_report()));
+      menu.addAction(action_report);
+      QAction *action_compare = new QAction("Compare with...", this);
+      connect(action_compare, SIGNAL(triggered()), this, SLOT(add_compare()));
+      menu.addAction(action_compare);
+      QAction *action_derived = new QAction("New derived variable...", this);
+      connect(action_derived, SIGNAL(triggered()), this, SLOT(add_derived()));
+      menu.addAction(action_derived);
+      QAction *action_reload = new QAction("Reload", this);
+      action_reload->setEnabled(!m_main_window->is_scanning(item));
+      connect(action_reload, SIGNAL(triggered()), this, SLOT(reload_file()));
+      menu.addAction(action_reload);
+      QAction *action_cancel = new QAction("Cancel scan", this);
+      action_cancel->setEnabled(m_main_window->is_scanning(item));
+      connect(action_cancel, SIGNAL(triggered()), this, SLOT(cancel_scan()));
+      menu.addAction(action_cancel);
+      menu.exec(QCursor::pos());
+    }
+    else
+    {
+      QMenu menu;
+      QAction *action_compare = new QAction("Compare with...", this);
+      action_compare->setEnabled(item_data->m_kind == ItemData::Group || item_data->m_resolved);
+      connect(action_compare, SIGNAL(triggered()), this, SLOT(add_compare()));
+      menu.addAction(action_compare);
+      menu.exec(QCursor::pos());
+    }
     return;
   }
   QMenu menu;
@@ -1244,6 +1684,62 @@ void FileTreeWidget::show_context_menu(const QPoint &p)
   }
   connect(action_grid, SIGNAL(triggered()), this, SLOT(add_grid()));
   menu.addAction(action_grid);
+  QAction *action_plot = new QAction("Plot...", this);
+  if(item_data->m_kind != ItemData::Variable || item_data->m_dataset->m_dim.size() != 1 ||
+    (item_data->m_dataset->m_datatype_class != H5T_INTEGER &&
+    item_data->m_dataset->m_datatype_class != H5T_FLOAT))
+  {
+    action_plot->setEnabled(false);
+  }
+  connect(action_plot, SIGNAL(triggered()), this, SLOT(add_plot()));
+  menu.addAction(action_plot);
+  QAction *action_histogram = new QAction("Histogram...", this);
+  if(item_data->m_kind != ItemData::Variable ||
+    (item_data->m_dataset->m_datatype_class != H5T_INTEGER &&
+    item_data->m_dataset->m_datatype_class != H5T_FLOAT))
+  {
+    action_histogram->setEnabled(false);
+  }
+  connect(action_histogram, SIGNAL(triggered()), this, SLOT(add_histogram()));
+  menu.addAction(action_histogram);
+  QAction *action_search = new QAction("Find...", this);
+  if(item_data->m_kind != ItemData::Variable ||
+    (item_data->m_dataset->m_datatype_class != H5T_INTEGER &&
+    item_data->m_dataset->m_datatype_class != H5T_FLOAT))
+  {
+    action_search->setEnabled(false);
+  }
+  connect(action_search, SIGNAL(triggered()), this, SLOT(add_search()));
+  menu.addAction(action_search);
+  QAction *action_export = new QAction("Export...", this);
+  if(item_data->m_kind != ItemData::Variable ||
+    (item_data->m_dataset->m_datatype_class != H5T_INTEGER &&
+    item_data->m_dataset->m_datatype_class != H5T_FLOAT))
+  {
+    action_export->setEnabled(false);
+  }
+  connect(action_export, SIGNAL(triggered()), this, SLOT(add_export()));
+  menu.addAction(action_export);
+  QAction *action_compare = new QAction("Compare with...", this);
+  if(item_data->m_kind != ItemData::Variable)
+  {
+    action_compare->setEnabled(false);
+  }
+  connect(action_compare, SIGNAL(triggered()), this, SLOT(add_compare()));
+  menu.addAction(action_compare);
+  QAction *action_properties = new QAction("Properties...", this);
+  if(item_data->m_kind != ItemData::Variable)
+  {
+    action_properties->setEnabled(false);
+  }
+  connect(action_properties, SIGNAL(triggered()), this, SLOT(add_properties()));
+  menu.addAction(action_properties);
+  if(item_data->m_kind == ItemData::Derived || item_data->m_kind == ItemData::Aggregate)
+  {
+    QAction *action_remove = new QAction("Remove", this);
+    connect(action_remove, SIGNAL(triggered()), this, SLOT(remove_item()));
+    menu.addAction(action_remove);
+  }
   menu.exec(QCursor::pos());
 }
 
@@ -1255,7 +1751,18 @@ void FileTreeWidget::add_grid()
 {
   QTreeWidgetItem *item = static_cast <QTreeWidgetItem*> (currentItem());
   ItemData *item_data = get_item_data(item);
-  assert(item_data->m_kind == ItemData::Variable || item_data->m_kind == ItemData::Attribute);
+  if(item_data->m_kind == ItemData::Link)
+  {
+    //a link to a dataset becomes the dataset
+    m_main_window->resolve_link(item);
+    item_data = get_item_data(item);
+  }
+  if(item_data->m_kind == ItemData::Group || item_data->m_kind == ItemData::Link)
+  {
+    return;
+  }
+  assert(item_data->m_kind == ItemData::Variable || item_data->m_kind == ItemData::Attribute ||
+    item_data->m_kind == ItemData::Derived || item_data->m_kind == ItemData::Aggregate);
   if(item_data->m_dataset->m_datatype_class != H5T_INTEGER &&
     item_data->m_dataset->m_datatype_class != H5T_FLOAT)
   {
@@ -1273,25 +1780,235 @@ void FileTreeWidget::add_grid()
 
 }
 
-/////////////////////////////////////////////////////////////////////////////////////////////////////
-//TableModel
-/////////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////
+//FileTreeWidget::add_derived
+///////////////////////////////////////////////////////////////////////////////////////
 
-class TableModel : public QAbstractTableModel
+void FileTreeWidget::add_derived()
 {
-public:
-  TableModel(QObject *parent, ItemData *item_data);
-  int rowCount(const QModelIndex &parent = QModelIndex()) const;
+  QTreeWidgetItem *item = static_cast <QTreeWidgetItem*> (currentItem());
+  if(item == NULL || item->parent() != NULL)
+  {
+    return;
+  }
+  m_main_window->add_derived(item);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//FileTreeWidget::remove_item
+//derived variables and aggregates, which are not in a file
+///////////////////////////////////////////////////////////////////////////////////////
+
+void FileTreeWidget::remove_item()
+{
+  QTreeWidgetItem *item = static_cast <QTreeWidgetItem*> (currentItem());
+  ItemData *item_data = get_item_data(item);
+  if(item_data->m_kind != ItemData::Derived && item_data->m_kind != ItemData::Aggregate)
+  {
+    return;
+  }
+  m_main_window->remove_item(item);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//FileTreeWidget::add_search
+///////////////////////////////////////////////////////////////////////////////////////
+
+void FileTreeWidget::add_search()
+{
+  QTreeWidgetItem *item = static_cast <QTreeWidgetItem*> (currentItem());
+  ItemData *item_data = get_item_data(item);
+  if(item_data->m_kind != ItemData::Variable)
+  {
+    return;
+  }
+  m_main_window->add_search(item);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//FileTreeWidget::add_export
+///////////////////////////////////////////////////////////////////////////////////////
+
+void FileTreeWidget::add_export()
+{
+  QTreeWidgetItem *item = static_cast <QTreeWidgetItem*> (currentItem());
+  ItemData *item_data = get_item_data(item);
+  if(item_data->m_kind != ItemData::Variable)
+  {
+    return;
+  }
+  m_main_window->add_export(item_data, std::vector<hsize_t>(), std::vector<hsize_t>());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//FileTreeWidget::add_properties
+///////////////////////////////////////////////////////////////////////////////////////
+
+void FileTreeWidget::add_properties()
+{
+  QTreeWidgetItem *item = static_cast <QTreeWidgetItem*> (currentItem());
+  m_main_window->add_properties(item);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//FileTreeWidget::add_compare
+///////////////////////////////////////////////////////////////////////////////////////
+
+void FileTreeWidget::add_compare()
+{
+  QTreeWidgetItem *item = static_cast <QTreeWidgetItem*> (currentItem());
+  ItemData *item_data = get_item_data(item);
+  if(item_data->m_kind != ItemData::Variable && item_data->m_kind != ItemData::Group &&
+    !(item_data->m_kind == ItemData::Link && item_data->m_resolved))
+  {
+    return;
+  }
+  m_main_window->add_compare(item);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//FileTreeWidget::add_plot
+//1-D datasets; rows and columns of other datasets are plotted from their grid
+///////////////////////////////////////////////////////////////////////////////////////
+
+void FileTreeWidget::add_plot()
+{
+  QTreeWidgetItem *item = static_cast <QTreeWidgetItem*> (currentItem());
+  ItemData *item_data = get_item_data(item);
+  if(item_data->m_kind != ItemData::Variable || item_data->m_dataset->m_dim.size() != 1)
+  {
+    return;
+  }
+  m_main_window->add_plot(item_data->m_file_name, item_data->m_dataset->m_path, std::vector<hsize_t>(1, 0), 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//FileTreeWidget::add_histogram
+///////////////////////////////////////////////////////////////////////////////////////
+
+void FileTreeWidget::add_histogram()
+{
+  QTreeWidgetItem *item = static_cast <QTreeWidgetItem*> (currentItem());
+  ItemData *item_data = get_item_data(item);
+  if(item_data->m_kind != ItemData::Variable)
+  {
+    return;
+  }
+  m_main_window->add_histogram(item_data->m_file_name, item_data->m_dataset->m_path, std::vector<hsize_t>(), std::vector<hsize_t>());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//FileTreeWidget::cancel_scan
+///////////////////////////////////////////////////////////////////////////////////////
+
+void FileTreeWidget::cancel_scan()
+{
+  QTreeWidgetItem *item = static_cast <QTreeWidgetItem*> (currentItem());
+  m_main_window->cancel_scan(item);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//FileTreeWidget::reload_file
+///////////////////////////////////////////////////////////////////////////////////////
+
+void FileTreeWidget::reload_file()
+{
+  QTreeWidgetItem *item = static_cast <QTreeWidgetItem*> (currentItem());
+  m_main_window->reload_file(item);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//FileTreeWidget::expand_item
+///////////////////////////////////////////////////////////////////////////////////////
+
+void FileTreeWidget::expand_item(QTreeWidgetItem *item)
+{
+  ItemData *item_data = get_item_data(item);
+  if(item_data && item_data->m_kind == ItemData::Link)
+  {
+    m_main_window->resolve_link(item);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//FileTreeWidget::add_report
+///////////////////////////////////////////////////////////////////////////////////////
+
+void FileTreeWidget::add_report()
+{
+  QTreeWidgetItem *item = static_cast <QTreeWidgetItem*> (currentItem());
+  ItemData *item_data = get_item_data(item);
+  m_main_window->add_report(item_data->m_file_name);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//TableModel
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class TableModel : public QAbstractTableModel
+{
+public:
+  TableModel(QObject *parent, ItemData *item_data);
+  int rowCount(const QModelIndex &parent = QModelIndex()) const;
   int columnCount(const QModelIndex &parent = QModelIndex()) const;
   QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+  QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
 
   hdf_dataset_t *m_dataset; // HDF variable to display (convenience pointer to data in ItemData) 
   ChildWindow* m_widget; //get layers in toolbar
-  int m_nbr_rows;   // number of rows
-  int m_nbr_cols;   // number of columns
-  void data_changed(); //update table view when change of layer
+  GridView *m_view; //moves the page
+  hsize_t m_nbr_rows;   // number of rows of the grid
+  hsize_t m_nbr_cols;   // number of columns of the grid
+  hsize_t m_first_row;  // grid row of the first row of the model (page)
+  hsize_t m_first_col;  // grid column of the first column of the model (page)
+  int m_page_rows;  // number of rows of the model
+  int m_page_cols;  // number of columns of the model
+  mutable h5tiles_t m_tiles; // read cells, when the dataset is too large to be loaded
+  void set_page(hsize_t first_row, hsize_t first_col, int page_rows, int page_cols);
+  int set_physical(bool physical); //CF physical values, read by tiles; see h5tiles_t::set_physical
+  void data_changed(); //update table view and statistics of the selection when change of layer
+  void repaint(); //update table view, same values (page moved, heat map)
+  void extent_changed(const std::vector<hsize_t> &old_dim); //update table view when the dataset grew from 'old_dim' (follow mode)
+
+  //rows sorted by a column (h5sort_t): grid row 'idx' shows dataset row m_order[idx]
+  std::vector<hsize_t> m_order; // empty for the dataset order
+  std::vector<hsize_t> m_inverse; // grid row of each dataset row
+  hsize_t m_sort_col;
+  bool m_sort_ascending;
+  unsigned long m_sort_id; // counted at each sort and each change of the values: only the last sort is applied
+  void set_order(hsize_t col, bool ascending, std::vector<hsize_t> &order, std::vector<hsize_t> &inverse); //takes both
+  void clear_order();
+  hsize_t dataset_row(hsize_t row) const
+  {
+    return m_order.empty() ? row : m_order[row];
+  }
+  hsize_t grid_row(hsize_t row) const;
+
+  //hyperslab of grid column 'col' in the current layer, and its values if the dataset is loaded
+  void get_column(hsize_t col, std::vector<hsize_t> &start, std::vector<hsize_t> &count, std::vector<char> &values) const;
+
+  //add the values of the cells of 'ranges' (grid rows and columns) to 'stats'
+  void add_stats(const std::vector<grid_range_t> &ranges, h5stats_t &stats) const;
+
+  //the cells of 'ranges' are too many to be added in the GUI thread
+  bool stats_on_thread(const std::vector<grid_range_t> &ranges) const;
+
+  //input of a job of 'thread': 'ranges' clipped to the grid, and if it is sorted, the dataset rows of
+  //the rows of each in turn; the layer, and the loaded buffer if the values are read from it
+  void stats_input(const std::vector<grid_range_t> &ranges, StatsThread *thread) const;
+
+  //heat map: cell backgrounds from heat_lut() over the range of the values of the layer
+  bool m_heat_map;
+  bool m_heat_valid; // range of the current layer known
+  double m_heat_min;
+  double m_heat_scale; // colors per unit
+  std::map<std::vector<hsize_t>, h5stats_t> m_heat_ranges; // by layer start; no values while computed
+  void set_heat_range(const h5stats_t &stats); //of the current layer
+  bool layer_stats(h5stats_t &stats) const; //of the current layer of a loaded dataset; false if not loaded
 private:
   ItemData *m_item_data; // the tree item that generated this grid 
+  void get_grid(hsize_t &nbr_rows, hsize_t &nbr_cols) const;
+  hsize_t layer_offset() const;
 };
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1302,28 +2019,67 @@ TableModel::TableModel(QObject *parent, ItemData *item_data) :
 QAbstractTableModel(parent),
 m_dataset(item_data->m_dataset),
 m_widget(NULL),
+m_view(NULL),
+m_first_row(0),
+m_first_col(0),
+m_page_rows(0),
+m_page_cols(0),
+m_sort_col(0),
+m_sort_ascending(true),
+m_sort_id(0),
+m_heat_map(false),
+m_heat_valid(false),
+m_heat_min(0),
+m_heat_scale(0),
 m_item_data(item_data)
 {
   assert(m_dataset->m_dim.size() <= H5S_MAX_RANK);
+  get_grid(m_nbr_rows, m_nbr_cols);
+  if(m_dataset->m_buf == NULL && item_data->m_kind == ItemData::Variable)
+  {
+    m_tiles.set_dataset(item_data->m_file_name, m_dataset->m_path);
+  }
+  else if(item_data->m_kind == ItemData::Derived)
+  {
+    m_tiles.set_expression(item_data->m_file_name, item_data->m_expr);
+  }
+  else if(item_data->m_kind == ItemData::Aggregate)
+  {
+    m_tiles.set_aggregate(item_data->m_aggregate);
+  }
+}
 
-  /////////////////////////////////////////////////////////////////////////////////////////////////////
-  //define grid
-  /////////////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//TableModel::get_grid
+//define grid
+/////////////////////////////////////////////////////////////////////////////////////////////////////
 
+void TableModel::get_grid(hsize_t &nbr_rows, hsize_t &nbr_cols) const
+{
+  for(size_t idx = 0; idx + 2 < m_dataset->m_dim.size(); idx++)
+  {
+    if(m_dataset->m_dim[idx] == 0)
+    {
+      //no layers (a dimension shrank to 0 in follow mode)
+      nbr_rows = 0;
+      nbr_cols = 0;
+      return;
+    }
+  }
   if(m_dataset->m_dim.size() == 0)
   {
-    m_nbr_rows = 1;
-    m_nbr_cols = 1;
+    nbr_rows = 1;
+    nbr_cols = 1;
   }
   else if(m_dataset->m_dim.size() == 1)
   {
-    m_nbr_rows = m_dataset->m_dim[0];
-    m_nbr_cols = 1;
+    nbr_rows = m_dataset->m_dim[0];
+    nbr_cols = 1;
   }
   else
   {
-    m_nbr_rows = m_dataset->m_dim[m_dataset->m_dim.size() - 2]; //index 1 for 3D
-    m_nbr_cols = m_dataset->m_dim[m_dataset->m_dim.size() - 1]; //index 2 for 3D
+    nbr_rows = m_dataset->m_dim[m_dataset->m_dim.size() - 2]; //index 1 for 3D
+    nbr_cols = m_dataset->m_dim[m_dataset->m_dim.size() - 1]; //index 2 for 3D
   }
 }
 
@@ -1333,7 +2089,7 @@ m_item_data(item_data)
 
 int TableModel::rowCount(const QModelIndex &) const
 {
-  return m_nbr_rows;
+  return m_page_rows;
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1342,92 +2098,718 @@ int TableModel::rowCount(const QModelIndex &) const
 
 int TableModel::columnCount(const QModelIndex &) const
 {
-  return m_nbr_cols;
+  return m_page_cols;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//TableModel::set_page
+//the model is the part of the grid in the view: 'page_rows' rows from grid row 'first_row' and
+//'page_cols' columns from grid column 'first_col'; rows and columns are inserted or removed at the
+//end when the view is resized, and the cells change when the page moves
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TableModel::set_page(hsize_t first_row, hsize_t first_col, int page_rows, int page_cols)
+{
+  bool moved = first_row != m_first_row || first_col != m_first_col;
+  m_first_row = first_row;
+  m_first_col = first_col;
+
+  if(page_rows < m_page_rows)
+  {
+    beginRemoveRows(QModelIndex(), page_rows, m_page_rows - 1);
+    m_page_rows = page_rows;
+    endRemoveRows();
+  }
+  else if(page_rows > m_page_rows)
+  {
+    beginInsertRows(QModelIndex(), m_page_rows, page_rows - 1);
+    m_page_rows = page_rows;
+    endInsertRows();
+  }
+
+  if(page_cols < m_page_cols)
+  {
+    beginRemoveColumns(QModelIndex(), page_cols, m_page_cols - 1);
+    m_page_cols = page_cols;
+    endRemoveColumns();
+  }
+  else if(page_cols > m_page_cols)
+  {
+    beginInsertColumns(QModelIndex(), m_page_cols, page_cols - 1);
+    m_page_cols = page_cols;
+    endInsertColumns();
+  }
+
+  if(moved && m_page_rows > 0 && m_page_cols > 0)
+  {
+    repaint();
+    emit headerDataChanged(Qt::Vertical, 0, m_page_rows - 1);
+    emit headerDataChanged(Qt::Horizontal, 0, m_page_cols - 1);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//TableModel::set_physical
+//physical values are read by tiles, unpacked one tile at a time, also when the dataset is loaded
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int TableModel::set_physical(bool physical)
+{
+  if(!m_tiles.is_set())
+  {
+    if(!physical)
+    {
+      return 1;
+    }
+    m_tiles.set_dataset(m_item_data->m_file_name, m_dataset->m_path);
+  }
+  int result = m_tiles.set_physical(physical);
+  data_changed();
+  return result;
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 //TableModel::data_changed
-//update table view when change of layer
+//update table view when change of layer; the selected cells have other values
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
 void TableModel::data_changed()
 {
+  m_sort_id++;
+  repaint();
+  if(m_view)
+  {
+    m_view->update_stats();
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//TableModel::repaint
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TableModel::repaint()
+{
+  if(m_page_rows == 0 || m_page_cols == 0)
+  {
+    return;
+  }
   QModelIndex top = index(0, 0, QModelIndex());
-  QModelIndex bottom = index(m_nbr_rows, m_nbr_cols, QModelIndex());
+  QModelIndex bottom = index(m_page_rows - 1, m_page_cols - 1, QModelIndex());
   dataChanged(top, bottom);
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
-//TableModel::data
+//TableModel::extent_changed
+//the view keeps its position and selection; it grows its page if the grid was smaller than the view
+//a dataset that was loaded and became too large is read by tiles from now on
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
-QVariant TableModel::data(const QModelIndex &index, int role) const
+void TableModel::extent_changed(const std::vector<hsize_t> &old_dim)
 {
-  ChildWindow* parent = m_widget;
-  QString str;
-  size_t idx_buf = 0;
+  get_grid(m_nbr_rows, m_nbr_cols);
+  if(m_dataset->m_buf == NULL && !m_tiles.is_set() && m_item_data->m_kind == ItemData::Variable)
+  {
+    m_tiles.set_dataset(m_item_data->m_file_name, m_dataset->m_path);
+  }
+  //reopened at the next read, with the new dimensions
+  m_tiles.close();
+  m_tiles.grown(old_dim, m_dataset->m_dim);
+  m_order.clear();
+  m_inverse.clear();
+  if(m_view)
+  {
+    m_view->extent_changed();
+  }
+  if(m_widget)
+  {
+    m_widget->order_changed();
+  }
+
+  //new layers: the current one is unchanged, but its offset in the buffer may have moved
+  data_changed();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//TableModel::set_order
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TableModel::set_order(hsize_t col, bool ascending, std::vector<hsize_t> &order, std::vector<hsize_t> &inverse)
+{
+  m_order.swap(order);
+  m_inverse.swap(inverse);
+  m_sort_col = col;
+  m_sort_ascending = ascending;
+  data_changed();
+  if(m_page_rows > 0)
+  {
+    emit headerDataChanged(Qt::Vertical, 0, m_page_rows - 1);
+  }
+  if(m_view)
+  {
+    m_view->order_changed();
+  }
+  if(m_widget)
+  {
+    m_widget->order_changed();
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//TableModel::clear_order
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TableModel::clear_order()
+{
+  if(m_order.empty())
+  {
+    return;
+  }
+  std::vector<hsize_t> order;
+  std::vector<hsize_t> inverse;
+  set_order(0, true, order, inverse);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//TableModel::grid_row
+//grid row of dataset row 'row', from the inverse of the order
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+hsize_t TableModel::grid_row(hsize_t row) const
+{
+  if(m_inverse.empty() || row >= m_inverse.size())
+  {
+    return row;
+  }
+  return m_inverse[static_cast<size_t>(row)];
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//TableModel::layer_offset
+//offset in the loaded buffer of the current layer
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+hsize_t TableModel::layer_offset() const
+{
+  const std::vector<int> &layer = m_widget->m_layer;
+  hsize_t idx_buf = 0;
 
-  //start of offset
   //3D
-  if(parent->m_layer.size() == 1)
+  if(layer.size() == 1)
   {
-    idx_buf = parent->m_layer[0] * m_nbr_rows * m_nbr_cols;
+    idx_buf = layer[0] * m_nbr_rows * m_nbr_cols;
   }
   //4D
-  else if(parent->m_layer.size() == 2)
+  else if(layer.size() == 2)
   {
-    idx_buf = parent->m_layer[0] * m_dataset->m_dim[1] + parent->m_layer[1];
+    idx_buf = layer[0] * m_dataset->m_dim[1] + layer[1];
     idx_buf *= m_nbr_rows * m_nbr_cols;
   }
   //5D
-  else if(parent->m_layer.size() == 3)
+  else if(layer.size() == 3)
   {
-    idx_buf = parent->m_layer[0] * m_dataset->m_dim[1] * m_dataset->m_dim[2]
-      + parent->m_layer[1] * m_dataset->m_dim[2]
-      + parent->m_layer[2];
+    idx_buf = layer[0] * m_dataset->m_dim[1] * m_dataset->m_dim[2]
+      + layer[1] * m_dataset->m_dim[2]
+      + layer[2];
     idx_buf *= m_nbr_rows * m_nbr_cols;
   }
+  return idx_buf;
+}
 
-  //into current index
-  idx_buf += index.row() * m_nbr_cols + index.column();
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//TableModel::get_column
+//the values are copied from a loaded dataset shown as stored, so that the sort does not read the file
+/////////////////////////////////////////////////////////////////////////////////////////////////////
 
-  if(role != Qt::DisplayRole)
+void TableModel::get_column(hsize_t col, std::vector<hsize_t> &start, std::vector<hsize_t> &count, std::vector<char> &values) const
+{
+  start.assign(m_widget->m_layer.begin(), m_widget->m_layer.end());
+  count.assign(start.size(), 1);
+  start.push_back(0);
+  count.push_back(m_nbr_rows);
+  if(m_dataset->m_dim.size() > 1)
   {
-    return QVariant();
+    start.push_back(col);
+    count.push_back(1);
   }
 
-  switch(m_dataset->m_datatype_class)
+  values.clear();
+  if(m_dataset->m_buf == NULL || m_tiles.m_physical)
   {
-    ///////////////////////////////////////////////////////////////////////////////////////
-    //H5T_STRING
-    ///////////////////////////////////////////////////////////////////////////////////////
-
-  case H5T_STRING:
-
-    break;
+    return;
+  }
+  size_t size = m_dataset->m_datatype_size;
+  const char *buf = static_cast<const char*>(m_dataset->m_buf) + (layer_offset() + col) * size;
+  values.resize(static_cast<size_t>(m_nbr_rows) * size);
+  for(hsize_t row = 0; row < m_nbr_rows; row++)
+  {
+    memcpy(&values[row * size], buf + row * m_nbr_cols * size, size);
+  }
+}
 
-    ///////////////////////////////////////////////////////////////////////////////////////
-    //H5T_FLOAT
-    ///////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//add_tile_row
+//add the cells of columns 'first_col' to 'last_col' of dataset row 'row' to 'stats', a run of a tile at
+//a time; 'coord' is the layer, then the row and column as the rank allows; cells shown empty (NaN,
+//missing source of a virtual dataset) are not counted; false if a tile cannot be read
+/////////////////////////////////////////////////////////////////////////////////////////////////////
 
-  case H5T_FLOAT:
-    if(sizeof(float) == m_dataset->m_datatype_size)
+static bool add_tile_row(h5tiles_t &tiles, h5native_t native, std::vector<hsize_t> &coord, hsize_t row,
+  hsize_t first_col, hsize_t last_col, h5stats_t &stats)
+{
+  size_t rank = coord.size();
+  if(rank > 0)
+  {
+    coord[rank > 1 ? rank - 2 : 0] = row;
+  }
+  for(hsize_t col = first_col; col <= last_col;)
+  {
+    if(rank > 1)
     {
-      float *buf_ = static_cast<float*> (m_dataset->m_buf);
-      str.sprintf("%g", buf_[idx_buf]);
+      coord[rank - 1] = col;
+    }
+    size_t nbr_run;
+    const char *run = static_cast<const char*>(tiles.get(coord, &nbr_run));
+    if(run == NULL)
+    {
+      return false;
+    }
+    nbr_run = static_cast<size_t>(std::min(static_cast<hsize_t>(nbr_run), last_col - col + 1));
+    if(tiles.m_virtual)
+    {
+      for(size_t idx_run = 0; idx_run < nbr_run; idx_run++)
+      {
+        if(rank > 1)
+        {
+          coord[rank - 1] = col + idx_run;
+        }
+        if(tiles.missing(coord) < 0)
+        {
+          stats.add(run + idx_run * tiles.element_size(), native, 1);
+        }
+      }
+    }
+    else
+    {
+      stats.add(run, native, nbr_run);
+    }
+    col += nbr_run;
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//tiles_native
+//type of the elements of 'tiles', whose stored values are of type 'native'
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static h5native_t tiles_native(const h5tiles_t &tiles, h5native_t native)
+{
+  if(tiles.m_physical || tiles.m_derived)
+  {
+    return tiles.element_size() == sizeof(float) ? H5NATIVE_FLOAT : H5NATIVE_DOUBLE;
+  }
+  return native;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//TableModel::add_stats
+//each range of a loaded buffer is reduced in one pass on the thread pool, its rows permuted if sorted;
+//else each selected part of a grid row is added from the tiles
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TableModel::add_stats(const std::vector<grid_range_t> &ranges, h5stats_t &stats) const
+{
+  const char *buf = static_cast<const char*>(m_dataset->m_buf);
+  h5native_t native = get_native(m_dataset->m_datatype_class, m_dataset->m_datatype_size, m_dataset->m_datatype_sign);
+  size_t size = m_dataset->m_datatype_size;
+  size_t rank = m_dataset->m_dim.size();
+
+  if(buf != NULL && !m_tiles.m_physical)
+  {
+    buf += layer_offset() * size;
+  }
+  else if(m_tiles.is_set())
+  {
+    buf = NULL;
+    native = tiles_native(m_tiles, native);
+  }
+  else
+  {
+    return;
+  }
+  if(native == H5NATIVE_NONE)
+  {
+    return;
+  }
+
+  std::vector<hsize_t> coord(m_widget->m_layer.begin(), m_widget->m_layer.end());
+  if(rank > 0)
+  {
+    coord.push_back(0);
+  }
+  if(rank > 1)
+  {
+    coord.push_back(0);
+  }
+  for(size_t idx = 0; idx < ranges.size(); idx++)
+  {
+    const grid_range_t &range = ranges[idx];
+    if(range.top >= m_nbr_rows || range.left >= m_nbr_cols)
+    {
+      continue;
+    }
+    hsize_t last_row = std::min(range.bottom, m_nbr_rows - 1);
+    hsize_t last_col = std::min(range.right, m_nbr_cols - 1);
+    if(buf != NULL)
+    {
+      stats.add_rows(buf, native, static_cast<size_t>(m_nbr_cols), m_order.empty() ? NULL : &m_order[range.top],
+        static_cast<size_t>(range.top), static_cast<size_t>(last_row - range.top + 1), static_cast<size_t>(range.left),
+        static_cast<size_t>(last_col - range.left + 1));
+      continue;
+    }
+    for(hsize_t row = range.top; row <= last_row; row++)
+    {
+      if(!add_tile_row(m_tiles, native, coord, dataset_row(row), range.left, last_col, stats))
+      {
+        break;
+      }
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//TableModel::stats_on_thread
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool TableModel::stats_on_thread(const std::vector<grid_range_t> &ranges) const
+{
+  if((m_dataset->m_buf == NULL || m_tiles.m_physical) && !m_tiles.is_set())
+  {
+    return false;
+  }
+  double nbr_cells = 0;
+  for(size_t idx = 0; idx < ranges.size(); idx++)
+  {
+    const grid_range_t &range = ranges[idx];
+    if(range.top < m_nbr_rows && range.left < m_nbr_cols)
+    {
+      nbr_cells += static_cast<double>(std::min(range.bottom, m_nbr_rows - 1) - range.top + 1) *
+        static_cast<double>(std::min(range.right, m_nbr_cols - 1) - range.left + 1);
+    }
+  }
+  return nbr_cells > static_cast<double>(max_stats_cells);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//TableModel::stats_input
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TableModel::stats_input(const std::vector<grid_range_t> &ranges, StatsThread *thread) const
+{
+  std::vector<grid_range_t> &clipped = thread->m_ranges;
+  std::vector<hsize_t> &rows = thread->m_rows;
+  clipped.clear();
+  rows.clear();
+  for(size_t idx = 0; idx < ranges.size(); idx++)
+  {
+    grid_range_t range = ranges[idx];
+    if(range.top >= m_nbr_rows || range.left >= m_nbr_cols)
+    {
+      continue;
+    }
+    range.bottom = std::min(range.bottom, m_nbr_rows - 1);
+    range.right = std::min(range.right, m_nbr_cols - 1);
+    clipped.push_back(range);
+    if(!m_order.empty())
+    {
+      rows.insert(rows.end(), m_order.begin() + static_cast<size_t>(range.top), m_order.begin() + static_cast<size_t>(range.bottom + 1));
+    }
+  }
+  size_t rank = m_dataset->m_dim.size();
+  thread->m_coord.assign(m_widget->m_layer.begin(), m_widget->m_layer.end());
+  thread->m_coord.resize(thread->m_coord.size() + std::min(rank, static_cast<size_t>(2)), 0);
+  thread->m_physical = m_tiles.m_physical;
+  thread->m_buf = NULL;
+  thread->m_nbr_cols = static_cast<size_t>(m_nbr_cols);
+  if(m_dataset->m_buf != NULL && !m_tiles.m_physical)
+  {
+    thread->m_buf = static_cast<const char*>(m_dataset->m_buf) + layer_offset() * m_dataset->m_datatype_size;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//TableModel::set_heat_range
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TableModel::set_heat_range(const h5stats_t &stats)
+{
+  m_heat_valid = stats.m_count > 0;
+  m_heat_min = stats.m_min;
+  m_heat_scale = stats.m_max > stats.m_min ? (heat_lut_size - 1) / (stats.m_max - stats.m_min) : 0;
+  repaint();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//TableModel::layer_stats
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool TableModel::layer_stats(h5stats_t &stats) const
+{
+  if(m_dataset->m_buf == NULL || m_tiles.m_physical)
+  {
+    return false;
+  }
+  const char *buf = static_cast<const char*>(m_dataset->m_buf) + layer_offset() * m_dataset->m_datatype_size;
+  stats.clear();
+  stats.add(buf, get_native(m_dataset->m_datatype_class, m_dataset->m_datatype_size, m_dataset->m_datatype_sign),
+    static_cast<size_t>(m_nbr_rows * m_nbr_cols));
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//heat_lut
+//'heat_lut_size' colors from light yellow to red, light enough for the text of the cells
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static const std::vector<QBrush>& heat_lut()
+{
+  static std::vector<QBrush> lut;
+  if(lut.empty())
+  {
+    static const int stops[][3] = { { 255, 255, 204 }, { 254, 217, 118 }, { 253, 141, 60 }, { 227, 26, 28 } };
+    const int nbr_stops = sizeof(stops) / sizeof(stops[0]);
+    for(int idx = 0; idx < heat_lut_size; idx++)
+    {
+      double position = static_cast<double>(idx) * (nbr_stops - 1) / (heat_lut_size - 1);
+      int stop = std::min(static_cast<int>(position), nbr_stops - 2);
+      double fraction = position - stop;
+      int rgb[3];
+      for(int idx_rgb = 0; idx_rgb < 3; idx_rgb++)
+      {
+        rgb[idx_rgb] = static_cast<int>(stops[stop][idx_rgb] + fraction * (stops[stop + 1][idx_rgb] - stops[stop][idx_rgb]) + 0.5);
+      }
+      lut.push_back(QBrush(QColor(rgb[0], rgb[1], rgb[2])));
+    }
+  }
+  return lut;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//cell_value_t
+//functor for dispatch(): element 'm_idx' of a buffer as a double
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct cell_value_t
+{
+  const void *m_buf;
+  hsize_t m_idx;
+  double m_value;
+
+  template <typename T>
+  void apply()
+  {
+    m_value = static_cast<double>(static_cast<const T*>(m_buf)[m_idx]);
+  }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//TableModel::headerData
+//values of the dimension scales of the rows and columns, read when the header shows them
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+QVariant TableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+  size_t rank = m_dataset->m_dim.size();
+  size_t dim = 0;
+  bool scale = false;
+
+  if(role != Qt::DisplayRole && role != Qt::ToolTipRole)
+  {
+    return QAbstractTableModel::headerData(section, orientation, role);
+  }
+
+  //index in the dataset, not in the page
+  hsize_t idx = static_cast<hsize_t>(section) + (orientation == Qt::Vertical ? m_first_row : m_first_col);
+  if(orientation == Qt::Vertical && idx < m_nbr_rows)
+  {
+    idx = dataset_row(idx);
+  }
+  if(m_widget != NULL && rank > 0)
+  {
+    if(orientation == Qt::Vertical)
+    {
+      dim = rank == 1 ? 0 : rank - 2;
+      scale = m_widget->m_scales.has_scale(dim);
+    }
+    else if(rank > 1)
+    {
+      dim = rank - 1;
+      scale = m_widget->m_scales.has_scale(dim);
+    }
+  }
+
+  if(!scale)
+  {
+    if(role == Qt::ToolTipRole)
+    {
+      return QVariant();
+    }
+    return QString::number(static_cast<qulonglong>(idx + 1));
+  }
+  const h5scales_t &scales = m_widget->m_scales;
+  if(role == Qt::ToolTipRole)
+  {
+    return QString("%1 %2").arg(scales.m_axes[dim].m_name.c_str()).arg(static_cast<qulonglong>(idx + 1));
+  }
+  std::string label = scales.label(dim, idx);
+  if(label.empty())
+  {
+    return QString::number(static_cast<qulonglong>(idx + 1));
+  }
+  return QString::fromUtf8(label.c_str());
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//TableModel::data
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+QVariant TableModel::data(const QModelIndex &index, int role) const
+{
+  ChildWindow* parent = m_widget;
+  QString str;
+  hsize_t idx_buf = 0;
+  const void *buf = m_dataset->m_buf;
+  H5T_class_t datatype_class = m_dataset->m_datatype_class;
+  size_t datatype_size = m_dataset->m_datatype_size;
+  H5T_sign_t datatype_sign = m_dataset->m_datatype_sign;
+
+  if((role != Qt::DisplayRole && role != Qt::ToolTipRole && role != Qt::BackgroundRole) || !index.isValid())
+  {
+    return QVariant();
+  }
+  if(role == Qt::BackgroundRole && !(m_heat_map && m_heat_valid))
+  {
+    return QVariant();
+  }
+  if(role == Qt::ToolTipRole && !m_tiles.m_virtual)
+  {
+    return QVariant();
+  }
+
+  //cell in the grid
+  hsize_t row = m_first_row + index.row();
+  hsize_t col = m_first_col + index.column();
+  if(row >= m_nbr_rows || col >= m_nbr_cols)
+  {
+    return QVariant();
+  }
+  row = dataset_row(row);
+
+  if(buf != NULL && !m_tiles.m_physical)
+  {
+    //start of offset, into current index
+    idx_buf = layer_offset() + row * m_nbr_cols + col;
+  }
+  else if(m_tiles.is_set())
+  {
+    //dataset not loaded: the cell is read with its tile
+    std::vector<hsize_t> coord(parent->m_layer.begin(), parent->m_layer.end());
+    if(m_dataset->m_dim.size() > 0)
+    {
+      coord.push_back(row);
+    }
+    if(m_dataset->m_dim.size() > 1)
+    {
+      coord.push_back(col);
+    }
+    if((buf = m_tiles.get(coord)) == NULL)
+    {
+      return QVariant();
+    }
+
+    //virtual dataset: a cell of a missing source is empty, not its fill value
+    if(m_tiles.m_virtual)
+    {
+      int mapping = m_tiles.missing(coord);
+      if(role == Qt::ToolTipRole)
+      {
+        if(mapping < 0)
+        {
+          return QVariant();
+        }
+        const h5vds_t::mapping_t &source = m_tiles.m_vds.m_mappings[mapping];
+        return tr("Missing source: %1 in %2").arg(source.m_path.c_str()).arg(source.m_resolved.c_str());
+      }
+      if(mapping >= 0)
+      {
+        return QVariant();
+      }
+    }
+
+    //physical values or derived variable: float or double, missing values (NaN) shown empty
+    if(m_tiles.m_physical || m_tiles.m_derived)
+    {
+      datatype_class = H5T_FLOAT;
+      datatype_size = m_tiles.element_size();
+      if(datatype_size == sizeof(float) ? *static_cast<const float*>(buf) != *static_cast<const float*>(buf) :
+        *static_cast<const double*>(buf) != *static_cast<const double*>(buf))
+      {
+        return QVariant();
+      }
+    }
+  }
+  else
+  {
+    return QVariant();
+  }
+
+  //heat map: the LUT entry of the value in the range of the layer
+  if(role == Qt::BackgroundRole)
+  {
+    cell_value_t cell;
+    cell.m_buf = buf;
+    cell.m_idx = idx_buf;
+    if(!dispatch(get_native(datatype_class, datatype_size, datatype_sign), cell) || cell.m_value != cell.m_value)
+    {
+      return QVariant();
+    }
+    double position = (cell.m_value - m_heat_min) * m_heat_scale;
+    int entry = position <= 0 ? 0 : position >= heat_lut_size - 1 ? heat_lut_size - 1 : static_cast<int>(position);
+    return heat_lut()[entry];
+  }
+
+  switch(datatype_class)
+  {
+    ///////////////////////////////////////////////////////////////////////////////////////
+    //H5T_STRING
+    ///////////////////////////////////////////////////////////////////////////////////////
+
+  case H5T_STRING:
+
+    break;
+
+    ///////////////////////////////////////////////////////////////////////////////////////
+    //H5T_FLOAT
+    ///////////////////////////////////////////////////////////////////////////////////////
+
+  case H5T_FLOAT:
+    if(sizeof(float) == datatype_size)
+    {
+      const float *buf_ = static_cast<const float*> (buf);
+      str.sprintf("%g", buf_[idx_buf]);
       return str;
     }
-    else if(sizeof(double) == m_dataset->m_datatype_size)
+    else if(sizeof(double) == datatype_size)
     {
-      double *buf_ = static_cast<double*> (m_dataset->m_buf);
+      const double *buf_ = static_cast<const double*> (buf);
       str.sprintf("%g", buf_[idx_buf]);
       return str;
     }
 #if H5_SIZEOF_LONG_DOUBLE !=0
-    else if(sizeof(long double) == m_dataset->m_datatype_size)
+    else if(sizeof(long double) == datatype_size)
     {
-      long double *buf_;
-      buf_ = static_cast<long double*> (m_dataset->m_buf);
+      const long double *buf_;
+      buf_ = static_cast<const long double*> (buf);
       str.sprintf("%Lf", buf_[idx_buf]);
       return str;
     }
@@ -1444,17 +2826,17 @@ QVariant TableModel::data(const QModelIndex &index, int role) const
     //H5T_NATIVE_SCHAR H5T_NATIVE_UCHAR
     ///////////////////////////////////////////////////////////////////////////////////////
 
-    if(sizeof(char) == m_dataset->m_datatype_size)
+    if(sizeof(char) == datatype_size)
     {
-      if(H5T_SGN_NONE == m_dataset->m_datatype_sign)
+      if(H5T_SGN_NONE == datatype_sign)
       {
-        unsigned char *buf_ = static_cast<unsigned char*> (m_dataset->m_buf);
+        const unsigned char *buf_ = static_cast<const unsigned char*> (buf);
         str.sprintf("%u", buf_[idx_buf]);
         return str;
       }
       else
       {
-        signed char *buf_ = static_cast<signed char*> (m_dataset->m_buf);
+        const signed char *buf_ = static_cast<const signed char*> (buf);
         str.sprintf("%hhd", buf_[idx_buf]);
         return str;
       }
@@ -1464,18 +2846,18 @@ QVariant TableModel::data(const QModelIndex &index, int role) const
     //H5T_NATIVE_SHORT H5T_NATIVE_USHORT
     ///////////////////////////////////////////////////////////////////////////////////////
 
-    else if(sizeof(short) == m_dataset->m_datatype_size)
+    else if(sizeof(short) == datatype_size)
     {
-      if(H5T_SGN_NONE == m_dataset->m_datatype_sign)
+      if(H5T_SGN_NONE == datatype_sign)
       {
-        unsigned short *buf_ = static_cast<unsigned short*> (m_dataset->m_buf);
+        const unsigned short *buf_ = static_cast<const unsigned short*> (buf);
         str.sprintf("%u", buf_[idx_buf]);
         return str;
 
       }
       else
       {
-        short *buf_ = static_cast<short*> (m_dataset->m_buf);
+        const short *buf_ = static_cast<const short*> (buf);
         str.sprintf("%d", buf_[idx_buf]);
         return str;
 
@@ -1487,18 +2869,18 @@ QVariant TableModel::data(const QModelIndex &index, int role) const
     //H5T_NATIVE_INT H5T_NATIVE_UINT
     ///////////////////////////////////////////////////////////////////////////////////////
 
-    else if(sizeof(int) == m_dataset->m_datatype_size)
+    else if(sizeof(int) == datatype_size)
     {
-      if(H5T_SGN_NONE == m_dataset->m_datatype_sign)
+      if(H5T_SGN_NONE == datatype_sign)
       {
-        unsigned int* buf_ = static_cast<unsigned int*> (m_dataset->m_buf);
+        const unsigned int* buf_ = static_cast<const unsigned int*> (buf);
         str.sprintf("%u", buf_[idx_buf]);
         return str;
 
       }
       else
       {
-        int* buf_ = static_cast<int*> (m_dataset->m_buf);
+        const int* buf_ = static_cast<const int*> (buf);
         str.sprintf("%d", buf_[idx_buf]);
         return str;
       }
@@ -1508,19 +2890,19 @@ QVariant TableModel::data(const QModelIndex &index, int role) const
     //H5T_NATIVE_LONG H5T_NATIVE_ULONG
     ///////////////////////////////////////////////////////////////////////////////////////
 
-    else if(sizeof(long) == m_dataset->m_datatype_size)
+    else if(sizeof(long) == datatype_size)
     {
 
-      if(H5T_SGN_NONE == m_dataset->m_datatype_sign)
+      if(H5T_SGN_NONE == datatype_sign)
       {
-        unsigned long* buf_ = static_cast<unsigned long*> (m_dataset->m_buf);
+        const unsigned long* buf_ = static_cast<const unsigned long*> (buf);
         str.sprintf("%lu", buf_[idx_buf]);
         return str;
 
       }
       else
       {
-        long* buf_ = static_cast<long*> (m_dataset->m_buf);
+        const long* buf_ = static_cast<const long*> (buf);
         str.sprintf("%ld", buf_[idx_buf]);
         return str;
 
@@ -1532,19 +2914,19 @@ QVariant TableModel::data(const QModelIndex &index, int role) const
     //H5T_NATIVE_LLONG H5T_NATIVE_ULLONG
     ///////////////////////////////////////////////////////////////////////////////////////
 
-    else if(sizeof(long long) == m_dataset->m_datatype_size)
+    else if(sizeof(long long) == datatype_size)
     {
 
-      if(H5T_SGN_NONE == m_dataset->m_datatype_sign)
+      if(H5T_SGN_NONE == datatype_sign)
       {
-        unsigned long long* buf_ = static_cast<unsigned long long*> (m_dataset->m_buf);
+        const unsigned long long* buf_ = static_cast<const unsigned long long*> (buf);
         str.sprintf("%llu", buf_[idx_buf]);
         return str;
 
       }
       else
       {
-        long long* buf_ = static_cast<long long*> (m_dataset->m_buf);
+        const long long* buf_ = static_cast<const long long*> (buf);
         str.sprintf("%lld", buf_[idx_buf]);
         return str;
 
@@ -1615,70 +2997,3748 @@ QVariant TableModel::data(const QModelIndex &index, int role) const
 
 }
 
-/////////////////////////////////////////////////////////////////////////////////////////////////////
-//ChildWindowTable
-//model/view
-/////////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////
+//GridView::GridView
+//the sections have one size, so the page is the number of rows and columns that fit in the viewport
+//the table selects nothing itself: its selection is only the part of the grid selection in the page
+///////////////////////////////////////////////////////////////////////////////////////
 
-class ChildWindowTable : public ChildWindow
+GridView::GridView(QWidget *parent, TableModel *model) :
+QWidget(parent),
+m_model(model),
+m_stats_id(0),
+m_stats_thread(NULL),
+m_stats_running(false),
+m_stats_stopped(false),
+m_anchor_row(0),
+m_anchor_col(0),
+m_current_row(0),
+m_current_col(0),
+m_has_current(false)
 {
-public:
-  ChildWindowTable(QWidget *parent, ItemData *item_data) :
-    ChildWindow(parent, item_data)
-  {
-    //each new table widget has its own model
-    m_model = new TableModel(this, item_data);
-    m_model->m_widget = this;
-    m_table = new QTableView(this);
-    m_table->setModel(m_model);
-
-    //set default row height
-    QHeaderView *verticalHeader = m_table->verticalHeader();
+  m_table = new QTableView(this);
+  m_table->setModel(m_model);
+  m_table->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+  m_table->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+  m_table->setSelectionMode(QAbstractItemView::NoSelection);
+  m_table->setTabKeyNavigation(false);
+
+  QHeaderView *verticalHeader = m_table->verticalHeader();
+  QHeaderView *horizontalHeader = m_table->horizontalHeader();
 #if QT_VERSION >= 0x050000
-    verticalHeader->sectionResizeMode(QHeaderView::Fixed);
+  verticalHeader->setSectionResizeMode(QHeaderView::Fixed);
+  horizontalHeader->setSectionResizeMode(QHeaderView::Fixed);
 #else
-    verticalHeader->setResizeMode(QHeaderView::Fixed);
+  verticalHeader->setResizeMode(QHeaderView::Fixed);
+  horizontalHeader->setResizeMode(QHeaderView::Fixed);
 #endif
-    verticalHeader->setDefaultSectionSize(24);
-    setCentralWidget(m_table);
-  }
-private:
-  QTableView *m_table;
-};
-
+  verticalHeader->setDefaultSectionSize(grid_row_height);
+  horizontalHeader->setDefaultSectionSize(grid_col_width);
+
+  m_scroll_rows = new QScrollBar(Qt::Vertical, this);
+  m_scroll_cols = new QScrollBar(Qt::Horizontal, this);
+  connect(m_scroll_rows, SIGNAL(valueChanged(int)), this, SLOT(scroll_rows(int)));
+  connect(m_scroll_cols, SIGNAL(valueChanged(int)), this, SLOT(scroll_cols(int)));
+  connect(horizontalHeader, SIGNAL(sectionClicked(int)), this, SLOT(sort_section(int)));
+  connect(verticalHeader, SIGNAL(sectionPressed(int)), this, SLOT(select_row(int)));
+
+  m_stats_timer = new QTimer(this);
+  m_stats_timer->setSingleShot(true);
+  m_stats_timer->setInterval(stats_delay);
+  connect(m_stats_timer, SIGNAL(timeout()), this, SLOT(run_stats()));
+
+  QGridLayout *layout = new QGridLayout(this);
+  layout->setContentsMargins(0, 0, 0, 0);
+  layout->setSpacing(0);
+  layout->addWidget(m_table, 0, 0);
+  layout->addWidget(m_scroll_rows, 0, 1);
+  layout->addWidget(m_scroll_cols, 1, 0);
+
+  m_table->viewport()->installEventFilter(this);
+  m_table->installEventFilter(this);
+  update_page();
+}
 
 ///////////////////////////////////////////////////////////////////////////////////////
-//MainWindow::add_table
+//GridView::~GridView
+//a job reading tiles is not waited for: the thread deletes itself when it finishes
 ///////////////////////////////////////////////////////////////////////////////////////
 
-void MainWindow::add_table(ItemData *item_data)
+GridView::~GridView()
 {
-  ChildWindowTable *window = new ChildWindowTable(this, item_data);
-  m_mdi_area->addSubWindow(window);
-  window->show();
+  stop_stats();
+  if(m_stats_thread)
+  {
+    connect(m_stats_thread, SIGNAL(finished()), m_stats_thread, SLOT(deleteLater()));
+    if(!m_stats_thread->isRunning())
+    {
+      delete m_stats_thread;
+    }
+  }
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////
-//MainWindow::add_image
+//GridView::visible
+//rows and columns that fit whole in the viewport
 ///////////////////////////////////////////////////////////////////////////////////////
 
-void MainWindow::add_image(ItemData *)
+void GridView::visible(hsize_t &nbr_rows, hsize_t &nbr_cols) const
 {
-
+  QSize size = m_table->viewport()->size();
+  nbr_rows = std::max(1, size.height() / grid_row_height);
+  nbr_cols = std::max(1, size.width() / grid_col_width);
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////
-//ChildWindow::ChildWindow
+//to_scroll, from_scroll
+//scrollbar position of a first row or column, exact up to 'max_scroll', scaled above
 ///////////////////////////////////////////////////////////////////////////////////////
 
-ChildWindow::ChildWindow(QWidget *parent, ItemData *item_data) :
-QMainWindow(parent),
-m_dataset(item_data->m_dataset)
+static int to_scroll(hsize_t first, hsize_t max_first)
 {
-  QString str;
+  if(max_first <= max_scroll)
+  {
+    return static_cast<int>(first);
+  }
+  return static_cast<int>(static_cast<double>(first) / static_cast<double>(max_first) * max_scroll);
+}
+
+static hsize_t from_scroll(int value, hsize_t max_first)
+{
+  if(max_first <= max_scroll)
+  {
+    return static_cast<hsize_t>(value);
+  }
+  if(static_cast<hsize_t>(value) >= max_scroll)
+  {
+    return max_first;
+  }
+  return static_cast<hsize_t>(static_cast<double>(value) / max_scroll * static_cast<double>(max_first));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//GridView::set_first
+//move the page so that it starts at grid row 'first_row' and column 'first_col', as far as the
+//grid allows; the selection and current cell are grid cells, shown where they fall in the page
+///////////////////////////////////////////////////////////////////////////////////////
+
+void GridView::set_first(hsize_t first_row, hsize_t first_col)
+{
+  hsize_t nbr_rows;
+  hsize_t nbr_cols;
+  visible(nbr_rows, nbr_cols);
+  hsize_t max_first_row = m_model->m_nbr_rows > nbr_rows ? m_model->m_nbr_rows - nbr_rows : 0;
+  hsize_t max_first_col = m_model->m_nbr_cols > nbr_cols ? m_model->m_nbr_cols - nbr_cols : 0;
+  first_row = std::min(first_row, max_first_row);
+  first_col = std::min(first_col, max_first_col);
+  int page_rows = static_cast<int>(std::min(nbr_rows, m_model->m_nbr_rows - first_row));
+  int page_cols = static_cast<int>(std::min(nbr_cols, m_model->m_nbr_cols - first_col));
+
+  m_model->set_page(first_row, first_col, page_rows, page_cols);
+  show_selection();
+
+  m_scroll_rows->blockSignals(true);
+  m_scroll_rows->setRange(0, to_scroll(max_first_row, max_first_row));
+  m_scroll_rows->setPageStep(static_cast<int>(std::min(nbr_rows, max_scroll)));
+  m_scroll_rows->setValue(to_scroll(first_row, max_first_row));
+  m_scroll_rows->blockSignals(false);
+  m_scroll_cols->blockSignals(true);
+  m_scroll_cols->setRange(0, to_scroll(max_first_col, max_first_col));
+  m_scroll_cols->setPageStep(static_cast<int>(std::min(nbr_cols, max_scroll)));
+  m_scroll_cols->setValue(to_scroll(first_col, max_first_col));
+  m_scroll_cols->blockSignals(false);
+
+  //sort indicator on the sorted column, when it is in the page
+  QHeaderView *header = m_table->horizontalHeader();
+  bool sorted = !m_model->m_order.empty() && m_model->m_sort_col >= first_col && m_model->m_sort_col < first_col + page_cols;
+  header->setSortIndicatorShown(sorted);
+  if(sorted)
+  {
+    header->setSortIndicator(static_cast<int>(m_model->m_sort_col - first_col), m_model->m_sort_ascending ? Qt::AscendingOrder : Qt::DescendingOrder);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//GridView::update_page
+//the viewport or the grid changed size
+///////////////////////////////////////////////////////////////////////////////////////
+
+void GridView::update_page()
+{
+  set_first(m_model->m_first_row, m_model->m_first_col);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//GridView::extent_changed
+//the selection is clipped to the grid
+///////////////////////////////////////////////////////////////////////////////////////
+
+void GridView::extent_changed()
+{
+  hsize_t nbr_rows = m_model->m_nbr_rows;
+  hsize_t nbr_cols = m_model->m_nbr_cols;
+  std::vector<grid_range_t> selection;
+  for(size_t idx = 0; idx < m_selection.size(); idx++)
+  {
+    grid_range_t range = m_selection[idx];
+    if(range.top >= nbr_rows || range.left >= nbr_cols)
+    {
+      continue;
+    }
+    range.bottom = std::min(range.bottom, nbr_rows - 1);
+    range.right = std::min(range.right, nbr_cols - 1);
+    selection.push_back(range);
+  }
+  m_selection.swap(selection);
+  if(nbr_rows > 0 && nbr_cols > 0)
+  {
+    m_anchor_row = std::min(m_anchor_row, nbr_rows - 1);
+    m_anchor_col = std::min(m_anchor_col, nbr_cols - 1);
+  }
+  if(m_current_row >= nbr_rows || m_current_col >= nbr_cols)
+  {
+    m_has_current = false;
+  }
+  update_page();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//GridView::order_changed
+///////////////////////////////////////////////////////////////////////////////////////
+
+void GridView::order_changed()
+{
+  update_page();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//GridView::sort_section
+//a click on a column header sorts the rows by that column, a second click reverses the order
+///////////////////////////////////////////////////////////////////////////////////////
+
+void GridView::sort_section(int section)
+{
+  //the press on the header moved the current index of the table
+  show_selection();
+  if(m_model->m_widget)
+  {
+    m_model->m_widget->sort_column(m_model->m_first_col + section);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//GridView::select_row
+//a press on a row header selects the grid row; shift extends the selection to it, control adds it
+///////////////////////////////////////////////////////////////////////////////////////
+
+void GridView::select_row(int section)
+{
+  hsize_t row = m_model->m_first_row + section;
+  if(section < 0 || row >= m_model->m_nbr_rows || m_model->m_nbr_cols == 0)
+  {
+    return;
+  }
+  Qt::KeyboardModifiers modifiers = QApplication::keyboardModifiers();
+  grid_range_t range;
+  range.left = 0;
+  range.right = m_model->m_nbr_cols - 1;
+  if((modifiers & Qt::ShiftModifier) && !m_selection.empty())
+  {
+    range.top = std::min(m_anchor_row, row);
+    range.bottom = std::max(m_anchor_row, row);
+  }
+  else
+  {
+    range.top = row;
+    range.bottom = row;
+    m_anchor_row = row;
+    m_anchor_col = 0;
+  }
+  m_current_row = row;
+  m_current_col = m_model->m_first_col;
+  m_has_current = true;
+  select_range(range, modifiers);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//GridView::select_cell
+//a click or a key made cell 'row', 'col' current: shift extends the last range from the anchor to
+//it, control adds it as a range, else it is the selection
+///////////////////////////////////////////////////////////////////////////////////////
+
+void GridView::select_cell(hsize_t row, hsize_t col, Qt::KeyboardModifiers modifiers)
+{
+  grid_range_t range;
+  if((modifiers & Qt::ShiftModifier) && !m_selection.empty())
+  {
+    range.top = std::min(m_anchor_row, row);
+    range.left = std::min(m_anchor_col, col);
+    range.bottom = std::max(m_anchor_row, row);
+    range.right = std::max(m_anchor_col, col);
+  }
+  else
+  {
+    range.top = row;
+    range.left = col;
+    range.bottom = row;
+    range.right = col;
+    m_anchor_row = row;
+    m_anchor_col = col;
+  }
+  m_current_row = row;
+  m_current_col = col;
+  m_has_current = true;
+  ensure_visible(row, col);
+  select_range(range, modifiers);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//GridView::select_range
+//shift makes 'range' the last range of the selection, control adds it, else it is the selection;
+//when the selection only grew, the statistics add the new cells, else they are computed again
+///////////////////////////////////////////////////////////////////////////////////////
+
+void GridView::select_range(const grid_range_t &range, Qt::KeyboardModifiers modifiers)
+{
+  std::vector<grid_range_t> added;
+  bool grown = true;
+  if((modifiers & Qt::ShiftModifier) && !m_selection.empty())
+  {
+    grid_range_t last = m_selection.back();
+    grown = range.top <= last.top && range.left <= last.left && range.bottom >= last.bottom && range.right >= last.right;
+    if(grown)
+    {
+      //the rows above and below the last range, then the columns left and right of it
+      grid_range_t part = range;
+      if(range.top < last.top)
+      {
+        part.bottom = last.top - 1;
+        added.push_back(part);
+      }
+      if(range.bottom > last.bottom)
+      {
+        part.top = last.bottom + 1;
+        part.bottom = range.bottom;
+        added.push_back(part);
+      }
+      part.top = last.top;
+      part.bottom = last.bottom;
+      if(range.left < last.left)
+      {
+        part.left = range.left;
+        part.right = last.left - 1;
+        added.push_back(part);
+      }
+      if(range.right > last.right)
+      {
+        part.left = last.right + 1;
+        part.right = range.right;
+        added.push_back(part);
+      }
+    }
+    m_selection.back() = range;
+  }
+  else
+  {
+    if(!(modifiers & Qt::ControlModifier))
+    {
+      m_selection.clear();
+      grown = false;
+    }
+    m_selection.push_back(range);
+    added.push_back(range);
+  }
+  show_selection();
+  if(grown)
+  {
+    add_stats(added);
+  }
+  else
+  {
+    update_stats();
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//GridView::ensure_visible
+//move the page as little as needed to show cell 'row', 'col'
+///////////////////////////////////////////////////////////////////////////////////////
+
+void GridView::ensure_visible(hsize_t row, hsize_t col)
+{
+  hsize_t nbr_rows;
+  hsize_t nbr_cols;
+  visible(nbr_rows, nbr_cols);
+  hsize_t first_row = m_model->m_first_row;
+  hsize_t first_col = m_model->m_first_col;
+  if(row < first_row)
+  {
+    first_row = row;
+  }
+  else if(row >= first_row + nbr_rows)
+  {
+    first_row = row - nbr_rows + 1;
+  }
+  if(col < first_col)
+  {
+    first_col = col;
+  }
+  else if(col >= first_col + nbr_cols)
+  {
+    first_col = col - nbr_cols + 1;
+  }
+  if(first_row != m_model->m_first_row || first_col != m_model->m_first_col)
+  {
+    set_first(first_row, first_col);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//GridView::show_selection
+//the ranges of the selection that cross the page, and the current cell if it is in it, are given
+//to the selection model of the table, in page indices
+///////////////////////////////////////////////////////////////////////////////////////
+
+void GridView::show_selection()
+{
+  QItemSelection selection;
+  QModelIndex current;
+  hsize_t first_row = m_model->m_first_row;
+  hsize_t first_col = m_model->m_first_col;
+  if(m_model->m_page_rows > 0 && m_model->m_page_cols > 0)
+  {
+    hsize_t last_row = first_row + m_model->m_page_rows - 1;
+    hsize_t last_col = first_col + m_model->m_page_cols - 1;
+    for(size_t idx = 0; idx < m_selection.size(); idx++)
+    {
+      const grid_range_t &range = m_selection[idx];
+      if(range.top > last_row || range.left > last_col || range.bottom < first_row || range.right < first_col)
+      {
+        continue;
+      }
+      QModelIndex top_left = m_model->index(static_cast<int>(std::max(range.top, first_row) - first_row),
+        static_cast<int>(std::max(range.left, first_col) - first_col));
+      QModelIndex bottom_right = m_model->index(static_cast<int>(std::min(range.bottom, last_row) - first_row),
+        static_cast<int>(std::min(range.right, last_col) - first_col));
+      selection.select(top_left, bottom_right);
+    }
+    if(m_has_current && m_current_row >= first_row && m_current_row <= last_row && m_current_col >= first_col && m_current_col <= last_col)
+    {
+      current = m_model->index(static_cast<int>(m_current_row - first_row), static_cast<int>(m_current_col - first_col));
+    }
+  }
+  QItemSelectionModel *selection_model = m_table->selectionModel();
+  selection_model->select(selection, QItemSelectionModel::ClearAndSelect);
+  selection_model->setCurrentIndex(current, QItemSelectionModel::NoUpdate);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//GridView::update_stats
+//the job running for the previous statistics is canceled, and its result ignored
+///////////////////////////////////////////////////////////////////////////////////////
+
+void GridView::update_stats()
+{
+  m_stats_id++;
+  if(m_stats_running)
+  {
+    m_stats_thread->cancel();
+  }
+  m_stats.clear();
+  m_stats_todo = m_selection;
+  m_stats_stopped = false;
+  schedule_stats();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//GridView::add_stats
+//cells were added to the selection
+///////////////////////////////////////////////////////////////////////////////////////
+
+void GridView::add_stats(const std::vector<grid_range_t> &ranges)
+{
+  if(m_stats_stopped)
+  {
+    update_stats();
+    return;
+  }
+  m_stats_todo.insert(m_stats_todo.end(), ranges.begin(), ranges.end());
+  schedule_stats();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//GridView::schedule_stats
+//a few cells are added at once; many wait for the selection to stop changing, and for the job
+//running to finish
+///////////////////////////////////////////////////////////////////////////////////////
+
+void GridView::schedule_stats()
+{
+  if(m_stats_todo.empty())
+  {
+    m_stats_timer->stop();
+  }
+  else if(!m_stats_running)
+  {
+    if(m_model->stats_on_thread(m_stats_todo))
+    {
+      m_stats_timer->start();
+    }
+    else
+    {
+      m_stats_timer->stop();
+      m_model->add_stats(m_stats_todo, m_stats);
+      m_stats_todo.clear();
+    }
+  }
+  show_stats();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//GridView::run_stats
+///////////////////////////////////////////////////////////////////////////////////////
+
+void GridView::run_stats()
+{
+  ChildWindow *window = m_model->m_widget;
+  if(m_stats_running || m_stats_todo.empty() || window == NULL)
+  {
+    return;
+  }
+  if(m_stats_thread == NULL)
+  {
+    //a child of the main window, which cancels and waits for it when it closes
+    m_stats_thread = new StatsThread(window->m_main_window, window->m_item_data);
+    connect(m_stats_thread, SIGNAL(finished()), this, SLOT(stats_finished()));
+  }
+  m_model->stats_input(m_stats_todo, m_stats_thread);
+  m_stats_todo.clear();
+  m_stats_thread->m_id = m_stats_id;
+  m_stats_running = true;
+  m_stats_thread->start_job();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//GridView::stats_finished
+///////////////////////////////////////////////////////////////////////////////////////
+
+void GridView::stats_finished()
+{
+  m_stats_running = false;
+  if(m_stats_thread->m_id == m_stats_id)
+  {
+    if(m_stats_thread->m_result == 0)
+    {
+      m_stats.merge(m_stats_thread->m_stats);
+    }
+    else if(m_stats_thread->m_result < 0 && m_model->m_widget && m_model->m_widget->m_main_window)
+    {
+      m_model->m_widget->m_main_window->statusBar()->showMessage(tr("Cannot read %1").arg(m_stats_thread->m_path.c_str()));
+    }
+  }
+  schedule_stats();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//GridView::stop_stats
+//the statistics are unknown until the next update_stats, and the model is not used until then: the
+//item data may be about to be deleted
+///////////////////////////////////////////////////////////////////////////////////////
+
+void GridView::stop_stats()
+{
+  m_stats_id++;
+  m_stats.clear();
+  m_stats_todo.clear();
+  m_stats_stopped = true;
+  m_stats_timer->stop();
+  if(m_stats_running)
+  {
+    m_stats_thread->cancel();
+    if(m_stats_thread->m_buf != NULL)
+    {
+      m_stats_thread->wait();
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//GridView::show_stats
+///////////////////////////////////////////////////////////////////////////////////////
+
+void GridView::show_stats()
+{
+  ChildWindow *window = m_model->m_widget;
+  if(window == NULL)
+  {
+    return;
+  }
+  window->m_stats.clear();
+  if(m_stats_running || !m_stats_todo.empty())
+  {
+    window->m_stats = tr("Computing statistics...");
+  }
+  else if(m_stats.m_count > 0)
+  {
+    window->m_stats = tr("Sum: %1  Mean: %2  Min: %3  Max: %4  Count: %5").arg(m_stats.m_sum).arg(m_stats.mean())
+      .arg(m_stats.m_min).arg(m_stats.m_max).arg(static_cast<qulonglong>(m_stats.m_count));
+  }
+  if(window->m_main_window)
+  {
+    window->m_main_window->show_stats(window);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//GridView::scroll_by
+///////////////////////////////////////////////////////////////////////////////////////
+
+void GridView::scroll_by(hssize_t nbr_rows, hssize_t nbr_cols)
+{
+  hsize_t first_row = m_model->m_first_row;
+  hsize_t first_col = m_model->m_first_col;
+  if(nbr_rows < 0)
+  {
+    first_row -= std::min(first_row, static_cast<hsize_t>(-nbr_rows));
+  }
+  else
+  {
+    first_row += nbr_rows;
+  }
+  if(nbr_cols < 0)
+  {
+    first_col -= std::min(first_col, static_cast<hsize_t>(-nbr_cols));
+  }
+  else
+  {
+    first_col += nbr_cols;
+  }
+  set_first(first_row, first_col);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//GridView::scroll_rows
+///////////////////////////////////////////////////////////////////////////////////////
+
+void GridView::scroll_rows(int value)
+{
+  hsize_t nbr_rows;
+  hsize_t nbr_cols;
+  visible(nbr_rows, nbr_cols);
+  hsize_t max_first_row = m_model->m_nbr_rows > nbr_rows ? m_model->m_nbr_rows - nbr_rows : 0;
+  set_first(from_scroll(value, max_first_row), m_model->m_first_col);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//GridView::scroll_cols
+///////////////////////////////////////////////////////////////////////////////////////
+
+void GridView::scroll_cols(int value)
+{
+  hsize_t nbr_rows;
+  hsize_t nbr_cols;
+  visible(nbr_rows, nbr_cols);
+  hsize_t max_first_col = m_model->m_nbr_cols > nbr_cols ? m_model->m_nbr_cols - nbr_cols : 0;
+  set_first(m_model->m_first_row, from_scroll(value, max_first_col));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//GridView::goto_cell
+//the page is centered on the cell, which is the selection
+///////////////////////////////////////////////////////////////////////////////////////
+
+void GridView::goto_cell(hsize_t row, hsize_t col)
+{
+  hsize_t nbr_rows;
+  hsize_t nbr_cols;
+  visible(nbr_rows, nbr_cols);
+  set_first(row - std::min(row, nbr_rows / 2), col - std::min(col, nbr_cols / 2));
+  if(row >= m_model->m_nbr_rows || col >= m_model->m_nbr_cols)
+  {
+    return;
+  }
+  select_cell(row, col, Qt::NoModifier);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//GridView::get_selection
+///////////////////////////////////////////////////////////////////////////////////////
+
+bool GridView::get_selection(std::vector<grid_range_t> &ranges) const
+{
+  ranges = m_selection;
+  return !ranges.empty();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//GridView::eventFilter
+//the view has no rows or columns past the page: the wheel moves the page instead, and clicks and
+//keys change the grid selection and current cell, moving the page to show it
+///////////////////////////////////////////////////////////////////////////////////////
+
+bool GridView::eventFilter(QObject *object, QEvent *event)
+{
+  hsize_t nbr_rows;
+  hsize_t nbr_cols;
+  visible(nbr_rows, nbr_cols);
+
+  if(object == m_table->viewport() && event->type() == QEvent::Resize)
+  {
+    update_page();
+    return false;
+  }
+
+  if(object == m_table->viewport() && event->type() == QEvent::Wheel)
+  {
+    QWheelEvent *wheel = static_cast<QWheelEvent*>(event);
+#if QT_VERSION >= 0x050000
+    int delta_rows = wheel->angleDelta().y();
+    int delta_cols = wheel->angleDelta().x();
+#else
+    int delta_rows = wheel->orientation() == Qt::Vertical ? wheel->delta() : 0;
+    int delta_cols = wheel->orientation() == Qt::Horizontal ? wheel->delta() : 0;
+#endif
+    if(wheel->modifiers() & Qt::ShiftModifier)
+    {
+      std::swap(delta_rows, delta_cols);
+    }
+    //120 is one step of the wheel, 3 lines
+    scroll_by(-delta_rows / 40, -delta_cols / 40);
+    return true;
+  }
+
+  if(object == m_table->viewport() && (event->type() == QEvent::MouseButtonPress ||
+    event->type() == QEvent::MouseButtonDblClick || event->type() == QEvent::MouseMove))
+  {
+    QMouseEvent *mouse = static_cast<QMouseEvent*>(event);
+    bool press = event->type() != QEvent::MouseMove;
+    if(press ? mouse->button() != Qt::LeftButton : !(mouse->buttons() & Qt::LeftButton))
+    {
+      return press;
+    }
+    if(m_model->m_page_rows == 0 || m_model->m_page_cols == 0)
+    {
+      return true;
+    }
+    QPoint pos = mouse->pos();
+    if(!press)
+    {
+      //a drag past the viewport scrolls it
+      QSize size = m_table->viewport()->size();
+      scroll_by(pos.y() < 0 ? -1 : (pos.y() >= size.height() ? 1 : 0), pos.x() < 0 ? -1 : (pos.x() >= size.width() ? 1 : 0));
+    }
+    int row = m_table->rowAt(pos.y());
+    int col = m_table->columnAt(pos.x());
+    if(press && (row < 0 || col < 0))
+    {
+      return true;
+    }
+    if(row < 0)
+    {
+      row = pos.y() < 0 ? 0 : m_model->m_page_rows - 1;
+    }
+    if(col < 0)
+    {
+      col = pos.x() < 0 ? 0 : m_model->m_page_cols - 1;
+    }
+    m_table->setFocus();
+    select_cell(m_model->m_first_row + row, m_model->m_first_col + col, press ? mouse->modifiers() : Qt::KeyboardModifiers(Qt::ShiftModifier));
+    return true;
+  }
+
+  if(object == m_table && event->type() == QEvent::KeyPress)
+  {
+    QKeyEvent *key = static_cast<QKeyEvent*>(event);
+    if(m_model->m_nbr_rows == 0 || m_model->m_nbr_cols == 0)
+    {
+      return false;
+    }
+    if(key->matches(QKeySequence::SelectAll))
+    {
+      grid_range_t range;
+      range.top = 0;
+      range.left = 0;
+      range.bottom = m_model->m_nbr_rows - 1;
+      range.right = m_model->m_nbr_cols - 1;
+      m_selection.assign(1, range);
+      show_selection();
+      update_stats();
+      return true;
+    }
+
+    hsize_t row = m_has_current ? m_current_row : m_model->m_first_row;
+    hsize_t col = m_has_current ? m_current_col : m_model->m_first_col;
+    hsize_t last_row = m_model->m_nbr_rows - 1;
+    hsize_t last_col = m_model->m_nbr_cols - 1;
+    bool control = (key->modifiers() & Qt::ControlModifier) != 0;
+
+    switch(key->key())
+    {
+    case Qt::Key_Up:
+      row -= std::min(row, static_cast<hsize_t>(1));
+      break;
+    case Qt::Key_Down:
+      row = std::min(row + 1, last_row);
+      break;
+    case Qt::Key_Left:
+      col -= std::min(col, static_cast<hsize_t>(1));
+      break;
+    case Qt::Key_Right:
+      col = std::min(col + 1, last_col);
+      break;
+    case Qt::Key_PageUp:
+      //the page moves by a page, the current cell keeps its place in it
+      scroll_by(-static_cast<hssize_t>(nbr_rows), 0);
+      row -= std::min(row, nbr_rows);
+      break;
+    case Qt::Key_PageDown:
+      scroll_by(static_cast<hssize_t>(nbr_rows), 0);
+      row = std::min(row + nbr_rows, last_row);
+      break;
+    case Qt::Key_Home:
+      col = 0;
+      if(control)
+      {
+        row = 0;
+      }
+      break;
+    case Qt::Key_End:
+      col = last_col;
+      if(control)
+      {
+        row = last_row;
+      }
+      break;
+    default:
+      return false;
+    }
+
+    select_cell(row, col, key->modifiers() & Qt::ShiftModifier);
+    return true;
+  }
+
+  return QWidget::eventFilter(object, event);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//ChildWindowTable
+//model/view
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class ChildWindowTable : public ChildWindow
+{
+public:
+  ChildWindowTable(QWidget *parent, ItemData *item_data) :
+    ChildWindow(parent, item_data)
+  {
+    //each new table widget has its own model
+    m_model = new TableModel(this, item_data);
+    m_model->m_widget = this;
+    m_grid = new GridView(this, m_model);
+    m_model->m_view = m_grid;
+    m_table = m_grid->m_table;
+    setCentralWidget(m_grid);
+
+    //right click menu
+    m_table->setContextMenuPolicy(Qt::ActionsContextMenu);
+    if(item_data->m_kind == ItemData::Variable)
+    {
+      QAction *action_copy = new QAction(tr("&Copy"), this);
+      action_copy->setShortcut(QKeySequence::Copy);
+      action_copy->setShortcutContext(Qt::WidgetWithChildrenShortcut);
+      connect(action_copy, SIGNAL(triggered()), this, SLOT(copy_selection()));
+      m_table->addAction(action_copy);
+      QAction *action_export = new QAction(tr("Export selection..."), this);
+      connect(action_export, SIGNAL(triggered()), this, SLOT(export_selection()));
+      m_table->addAction(action_export);
+      if(m_dataset->m_dim.size() > 1)
+      {
+        QAction *action_plot_row = new QAction(tr("Plot row"), this);
+        connect(action_plot_row, SIGNAL(triggered()), this, SLOT(plot_row()));
+        m_table->addAction(action_plot_row);
+      }
+      if(m_dataset->m_dim.size() > 0)
+      {
+        QAction *action_plot_column = new QAction(tr("Plot column"), this);
+        connect(action_plot_column, SIGNAL(triggered()), this, SLOT(plot_column()));
+        m_table->addAction(action_plot_column);
+      }
+      QAction *action_histogram = new QAction(tr("Histogram of selection"), this);
+      connect(action_histogram, SIGNAL(triggered()), this, SLOT(histogram_selection()));
+      m_table->addAction(action_histogram);
+      m_selection_actions << action_copy << action_export << action_histogram;
+      QAction *action_physical = new QAction(tr("Physical values"), this);
+      action_physical->setCheckable(true);
+      action_physical->setStatusTip(tr("Apply scale_factor and add_offset, and hide fill and missing values"));
+      connect(action_physical, SIGNAL(toggled(bool)), this, SLOT(physical_values(bool)));
+      m_table->addAction(action_physical);
+      QAction *action_follow = new QAction(tr("Follow"), this);
+      action_follow->setCheckable(true);
+      action_follow->setStatusTip(tr("Show the data appended to the dataset while the file is written"));
+      connect(action_follow, SIGNAL(toggled(bool)), this, SLOT(follow(bool)));
+      m_table->addAction(action_follow);
+      QAction *action_heat_map = new QAction(tr("Heat map"), this);
+      action_heat_map->setCheckable(true);
+      action_heat_map->setStatusTip(tr("Color the cells by their value in the range of the layer"));
+      connect(action_heat_map, SIGNAL(toggled(bool)), this, SLOT(heat_map(bool)));
+      m_table->addAction(action_heat_map);
+      QAction *action_original_order = new QAction(tr("Original order"), this);
+      action_original_order->setStatusTip(tr("Show the rows in the order of the dataset, after a sort by a column"));
+      connect(action_original_order, SIGNAL(triggered()), this, SLOT(original_order()));
+      m_table->addAction(action_original_order);
+    }
+  }
+
+  //bounding box of the selected cells in the current layer; rows sorted, the dataset row of the
+  //first selected row only (the row plotted), as the selected rows are not a hyperslab
+  void get_selection(std::vector<hsize_t> &start, std::vector<hsize_t> &count)
+  {
+    ChildWindow::get_selection(start, count);
+    size_t rank = start.size();
+    std::vector<grid_range_t> ranges;
+    if(rank == 0 || !m_grid->get_selection(ranges))
+    {
+      return;
+    }
+    hsize_t top = ranges[0].top;
+    hsize_t left = ranges[0].left;
+    hsize_t bottom = ranges[0].bottom;
+    hsize_t right = ranges[0].right;
+    for(size_t idx = 1; idx < ranges.size(); idx++)
+    {
+      top = std::min(top, ranges[idx].top);
+      left = std::min(left, ranges[idx].left);
+      bottom = std::max(bottom, ranges[idx].bottom);
+      right = std::max(right, ranges[idx].right);
+    }
+    if(!m_model->m_order.empty())
+    {
+      top = m_model->dataset_row(top);
+      bottom = top;
+    }
+    if(rank == 1)
+    {
+      start[0] = top;
+      count[0] = bottom - top + 1;
+    }
+    else
+    {
+      start[rank - 2] = top;
+      count[rank - 2] = bottom - top + 1;
+      start[rank - 1] = left;
+      count[rank - 1] = right - left + 1;
+    }
+  }
+
+  void goto_cell(const std::vector<hsize_t> &coord)
+  {
+    ChildWindow::goto_cell(coord);
+    size_t rank = coord.size();
+    hsize_t row = 0;
+    hsize_t col = 0;
+    if(rank == 1)
+    {
+      row = coord[0];
+    }
+    else if(rank > 1)
+    {
+      row = coord[rank - 2];
+      col = coord[rank - 1];
+    }
+    m_grid->goto_cell(m_model->grid_row(row), col);
+  }
+
+private:
+  GridView *m_grid;
+  QTableView *m_table;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::add_table
+///////////////////////////////////////////////////////////////////////////////////////
+
+ChildWindow* MainWindow::add_table(ItemData *item_data)
+{
+  ChildWindowTable *window = new ChildWindowTable(this, item_data);
+  m_mdi_area->addSubWindow(window);
+  window->show();
+  return window;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::show_stats
+///////////////////////////////////////////////////////////////////////////////////////
+
+void MainWindow::show_stats(ChildWindow *window)
+{
+  QMdiSubWindow *sub_window = m_mdi_area->activeSubWindow();
+  if(sub_window && sub_window->widget() == window)
+  {
+    m_label_stats->setText(window->m_stats);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::window_activated
+//the status bar shows the statistics of the selection of the active grid
+///////////////////////////////////////////////////////////////////////////////////////
+
+void MainWindow::window_activated(QMdiSubWindow *sub_window)
+{
+  ChildWindow *window = sub_window ? qobject_cast<ChildWindow *>(sub_window->widget()) : NULL;
+  m_label_stats->setText(window ? window->m_stats : QString());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::add_image
+///////////////////////////////////////////////////////////////////////////////////////
+
+void MainWindow::add_image(ItemData *)
+{
+
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::find_window
+///////////////////////////////////////////////////////////////////////////////////////
+
+ChildWindow* MainWindow::find_window(ItemData *item_data)
+{
+  QList<QMdiSubWindow *> list = m_mdi_area->subWindowList();
+  for(int idx = 0; idx < list.size(); idx++)
+  {
+    ChildWindow *window = qobject_cast<ChildWindow *>(list.at(idx)->widget());
+    if(window && window->m_item_data == item_data)
+    {
+      m_mdi_area->setActiveSubWindow(list.at(idx));
+      return window;
+    }
+  }
+  return NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::extent_changed
+///////////////////////////////////////////////////////////////////////////////////////
+
+void MainWindow::extent_changed(ItemData *item_data, const std::vector<hsize_t> &old_dim)
+{
+  QList<QMdiSubWindow *> list = m_mdi_area->subWindowList();
+  for(int idx = 0; idx < list.size(); idx++)
+  {
+    ChildWindow *window = qobject_cast<ChildWindow *>(list.at(idx)->widget());
+    if(window && window->m_item_data == item_data)
+    {
+      window->extent_changed(old_dim);
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::find_item
+///////////////////////////////////////////////////////////////////////////////////////
+
+QTreeWidgetItem* MainWindow::find_item(const std::string &file_name, const std::string &path)
+{
+  for(int idx = 0; idx < m_scans.size(); idx++)
+  {
+    ScanThread *thread = m_scans[idx];
+    if(thread->m_file_name != file_name)
+    {
+      continue;
+    }
+    for(size_t idx_item = 0; idx_item < thread->m_items.size(); idx_item++)
+    {
+      ItemData *item_data = get_item_data(thread->m_items[idx_item]);
+      if(item_data && item_data->m_kind == ItemData::Variable && item_data->m_dataset->m_path == path)
+      {
+        return thread->m_items[idx_item];
+      }
+    }
+  }
+  return NULL;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//SearchDialog
+//predicate and value(s) for a search
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class SearchDialog : public QDialog
+{
+public:
+  SearchDialog(QWidget *parent) : QDialog(parent)
+  {
+    setWindowTitle(tr("Find"));
+    m_combo = new QComboBox;
+    m_combo->addItems(QStringList() << "==" << "!=" << "<" << "<=" << ">" << ">=" << tr("in range") << tr("is NaN"));
+    m_edit_value = new QLineEdit;
+    m_edit_value_hi = new QLineEdit;
+    m_edit_value_hi->setPlaceholderText(tr("upper value (range)"));
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+    connect(buttons, SIGNAL(accepted()), this, SLOT(accept()));
+    connect(buttons, SIGNAL(rejected()), this, SLOT(reject()));
+    QFormLayout *layout = new QFormLayout;
+    layout->addRow(tr("Cells where value"), m_combo);
+    layout->addRow(tr("Value"), m_edit_value);
+    layout->addRow(tr("Upper value"), m_edit_value_hi);
+    layout->addRow(buttons);
+    setLayout(layout);
+  }
+
+  h5predicate_t predicate() const
+  {
+    return static_cast<h5predicate_t>(m_combo->currentIndex());
+  }
+
+  QString description() const
+  {
+    if(predicate() == PREDICATE_NAN)
+      return m_combo->currentText();
+    if(predicate() == PREDICATE_RANGE)
+      return QString("[%1, %2]").arg(value()).arg(value_hi());
+    return QString("%1 %2").arg(m_combo->currentText()).arg(value());
+  }
+
+  double value() const
+  {
+    return m_edit_value->text().toDouble();
+  }
+
+  double value_hi() const
+  {
+    return m_edit_value_hi->text().toDouble();
+  }
+
+private:
+  QComboBox *m_combo;
+  QLineEdit *m_edit_value;
+  QLineEdit *m_edit_value_hi;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////
+//ProgressThread::ProgressThread
+///////////////////////////////////////////////////////////////////////////////////////
+
+ProgressThread::ProgressThread(QObject *parent) :
+QThread(parent),
+m_result(-1),
+m_cancel(0)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//ProgressThread::progress
+//called in the worker thread
+///////////////////////////////////////////////////////////////////////////////////////
+
+bool ProgressThread::progress(hsize_t done, hsize_t total)
+{
+  if(total > 0)
+  {
+    emit progress_changed(static_cast<int>((100 * done) / total));
+  }
+  return m_cancel.load() == 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//ProgressThread::cancel
+///////////////////////////////////////////////////////////////////////////////////////
+
+void ProgressThread::cancel()
+{
+  m_cancel.store(1);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::start_thread
+///////////////////////////////////////////////////////////////////////////////////////
+
+void MainWindow::start_thread(ProgressThread *thread, const QString &label, const char *slot_finished)
+{
+  QProgressDialog *progress = new QProgressDialog(label, tr("Cancel"), 0, 100, this);
+  progress->setMinimumDuration(500);
+  connect(thread, SIGNAL(progress_changed(int)), progress, SLOT(setValue(int)));
+  connect(progress, SIGNAL(canceled()), thread, SLOT(cancel()));
+  connect(thread, SIGNAL(finished()), progress, SLOT(deleteLater()));
+  connect(thread, SIGNAL(finished()), this, slot_finished);
+  statusBar()->showMessage(label);
+  thread->start();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//SearchThread::SearchThread
+///////////////////////////////////////////////////////////////////////////////////////
+
+SearchThread::SearchThread(QObject *parent, ItemData *item_data, h5predicate_t predicate, double value, double value_hi) :
+ProgressThread(parent),
+m_file_name(item_data->m_file_name),
+m_path(item_data->m_dataset->m_path),
+m_item_nm(item_data->m_item_nm),
+m_predicate(predicate),
+m_value(value),
+m_value_hi(value_hi)
+{
+  //a tree can show only so many items
+  m_search.m_max_hits = 10000;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//SearchThread::run
+///////////////////////////////////////////////////////////////////////////////////////
+
+void SearchThread::run()
+{
+  m_result = m_search.search(m_file_name.c_str(), m_path.c_str(), m_predicate, m_value, m_value_hi, this);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::add_search
+///////////////////////////////////////////////////////////////////////////////////////
+
+void MainWindow::add_search(QTreeWidgetItem *item)
+{
+  SearchDialog dialog(this);
+  if(dialog.exec() != QDialog::Accepted)
+  {
+    return;
+  }
+
+  SearchThread *thread = new SearchThread(this, get_item_data(item), dialog.predicate(), dialog.value(), dialog.value_hi());
+  thread->setObjectName(dialog.description());
+  start_thread(thread, tr("Searching..."), SLOT(search_finished()));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::search_finished
+//one top level item per search, with the file and path of the dataset, and one child item per hit
+///////////////////////////////////////////////////////////////////////////////////////
+
+void MainWindow::search_finished()
+{
+  SearchThread *thread = qobject_cast<SearchThread *>(sender());
+  if(thread == NULL)
+  {
+    return;
+  }
+
+  const h5search_t &search = thread->m_search;
+  QString str;
+
+  QTreeWidgetItem *item_search = new QTreeWidgetItem(m_search_tree);
+  item_search->setText(0, QString("%1 %2").arg(thread->m_item_nm.c_str()).arg(thread->objectName()));
+  if(thread->m_result < 0)
+  {
+    str = tr("error");
+  }
+  else
+  {
+    str = tr("%1 cells").arg(search.m_nbr_hits);
+    if(search.m_nbr_hits > search.m_hits.size())
+      str += tr(" (%1 shown)").arg(search.m_hits.size());
+    if(thread->m_result == 1)
+      str += tr(" (canceled)");
+  }
+  item_search->setText(1, str);
+  item_search->setData(0, Qt::UserRole, QStringList() << thread->m_file_name.c_str() << thread->m_path.c_str());
+
+  QList<QTreeWidgetItem *> items;
+  for(size_t idx = 0; idx < search.m_hits.size(); idx++)
+  {
+    const h5hit_t &hit = search.m_hits[idx];
+    QStringList sl;
+    QList<QVariant> coord;
+    for(size_t dmn = 0; dmn < hit.m_coord.size(); dmn++)
+    {
+      sl.append(QString::number(hit.m_coord[dmn]));
+      coord.append(static_cast<qulonglong>(hit.m_coord[dmn]));
+    }
+    QTreeWidgetItem *item_hit = new QTreeWidgetItem;
+    item_hit->setText(0, "[" + sl.join(", ") + "]");
+    item_hit->setText(1, QString::number(hit.m_value, 'g'));
+    item_hit->setData(0, Qt::UserRole, coord);
+    items.append(item_hit);
+  }
+  item_search->addChildren(items);
+  item_search->setExpanded(true);
+
+  m_search_dock->show();
+  statusBar()->showMessage(tr("Ready"));
+  thread->deleteLater();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//ExportThread::ExportThread
+///////////////////////////////////////////////////////////////////////////////////////
+
+ExportThread::ExportThread(QObject *parent, ItemData *item_data, const std::vector<hsize_t> &start, const std::vector<hsize_t> &count,
+  h5format_t format, const QString &out_name) :
+  ProgressThread(parent),
+  m_file_name(item_data->m_file_name),
+  m_path(item_data->m_dataset->m_path),
+  m_start(start),
+  m_count(count),
+  m_format(format),
+  m_out_name(out_name)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//ExportThread::run
+///////////////////////////////////////////////////////////////////////////////////////
+
+void ExportThread::run()
+{
+  m_result = m_export.run(m_file_name.c_str(), m_path.c_str(),
+    m_start, m_count, m_format, QFile::encodeName(m_out_name).constData(), this);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::add_export
+//export a dataset, or the hyperslab 'start', 'count' of it; the format is given by the file filter
+///////////////////////////////////////////////////////////////////////////////////////
+
+void MainWindow::add_export(ItemData *item_data, const std::vector<hsize_t> &start, const std::vector<hsize_t> &count)
+{
+  QString filter_csv = tr("CSV (*.csv)");
+  QString filter_npy = tr("NumPy (*.npy)");
+  QString filter_raw = tr("Raw binary (*.bin *.raw)");
+  QString filter;
+  QString out_name = QFileDialog::getSaveFileName(this,
+    tr("Export"), QString(item_data->m_item_nm.c_str()),
+    filter_csv + ";;" + filter_npy + ";;" + filter_raw, &filter);
+
+  if(out_name.isEmpty())
+    return;
+
+  h5format_t format = FORMAT_CSV;
+  if(filter == filter_npy)
+    format = FORMAT_NPY;
+  else if(filter == filter_raw)
+    format = FORMAT_RAW;
+
+  ExportThread *thread = new ExportThread(this, item_data, start, count, format, out_name);
+  start_thread(thread, tr("Exporting..."), SLOT(export_finished()));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::export_finished
+///////////////////////////////////////////////////////////////////////////////////////
+
+void MainWindow::export_finished()
+{
+  ExportThread *thread = qobject_cast<ExportThread *>(sender());
+  if(thread == NULL)
+  {
+    return;
+  }
+
+  if(thread->m_result < 0)
+  {
+    QMessageBox::warning(this, tr(app_name), tr("Cannot export to %1").arg(thread->m_out_name));
+    statusBar()->showMessage(tr("Ready"));
+  }
+  else if(thread->m_result == 1)
+  {
+    statusBar()->showMessage(tr("Export canceled"));
+  }
+  else
+  {
+    statusBar()->showMessage(tr("Exported %1 bytes to %2").arg(thread->m_export.m_nbr_bytes).arg(thread->m_out_name));
+  }
+  thread->deleteLater();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//CopyThread::CopyThread
+///////////////////////////////////////////////////////////////////////////////////////
+
+CopyThread::CopyThread(QObject *parent, ItemData *item_data, const std::vector<hsize_t> &start, const std::vector<hsize_t> &count) :
+  ProgressThread(parent),
+  m_file_name(item_data->m_file_name),
+  m_path(item_data->m_dataset->m_path),
+  m_start(start),
+  m_count(count)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//CopyThread::run
+///////////////////////////////////////////////////////////////////////////////////////
+
+void CopyThread::run()
+{
+  m_result = m_export.copy(m_file_name.c_str(), m_path.c_str(),
+    m_start, m_count, m_text, this);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::add_copy
+//the selection is read once and formatted on the thread pool, instead of
+//one TableModel::data call per cell in the GUI thread
+///////////////////////////////////////////////////////////////////////////////////////
+
+void MainWindow::add_copy(ItemData *item_data, const std::vector<hsize_t> &start, const std::vector<hsize_t> &count)
+{
+  CopyThread *thread = new CopyThread(this, item_data, start, count);
+  start_thread(thread, tr("Copying..."), SLOT(copy_finished()));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::copy_finished
+///////////////////////////////////////////////////////////////////////////////////////
+
+void MainWindow::copy_finished()
+{
+  CopyThread *thread = qobject_cast<CopyThread *>(sender());
+  if(thread == NULL)
+  {
+    return;
+  }
+
+  if(thread->m_result < 0)
+  {
+    QMessageBox::warning(this, tr(app_name), tr("Cannot copy selection"));
+    statusBar()->showMessage(tr("Ready"));
+  }
+  else if(thread->m_result == 1)
+  {
+    statusBar()->showMessage(tr("Copy canceled"));
+  }
+  else if(thread->m_text.size() > static_cast<size_t>(INT_MAX))
+  {
+    QMessageBox::warning(this, tr(app_name), tr("Selection too large for the clipboard, use Export selection"));
+    statusBar()->showMessage(tr("Ready"));
+  }
+  else
+  {
+    QApplication::clipboard()->setText(QString::fromLatin1(thread->m_text.data(), static_cast<int>(thread->m_text.size())));
+    statusBar()->showMessage(tr("Copied %1 bytes").arg(thread->m_text.size()));
+  }
+  thread->deleteLater();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::search_result_clicked
+//open the grid of the dataset, or use the one already open, and show the cell
+///////////////////////////////////////////////////////////////////////////////////////
+
+void MainWindow::search_result_clicked(QTreeWidgetItem *item, int)
+{
+  if(item->parent() == NULL)
+  {
+    return;
+  }
+
+  //compare results: a dataset, or a cell of a dataset
+  QVariant difference = item->data(0, difference_role);
+  if(!difference.isValid() && item->parent()->parent() != NULL)
+  {
+    difference = item->parent()->data(0, difference_role);
+  }
+  if(difference.isValid())
+  {
+    QStringList names = difference.toStringList();
+    QList<QVariant> list = item->data(0, Qt::UserRole).toList();
+    std::vector<hsize_t> coord;
+    for(int idx = 0; idx < list.size(); idx++)
+    {
+      coord.push_back(list.at(idx).toULongLong());
+    }
+    if(names.size() == 4)
+    {
+      show_difference(names, coord);
+    }
+    return;
+  }
+
+  QStringList names = item->parent()->data(0, Qt::UserRole).toStringList();
+  QTreeWidgetItem *tree_item = names.size() == 2 ? find_item(names.at(0).toStdString(), names.at(1).toStdString()) : NULL;
+  if(tree_item == NULL)
+  {
+    statusBar()->showMessage(tr("The dataset is no longer in the file"));
+    return;
+  }
+  ItemData *item_data = get_item_data(tree_item);
+  QList<QVariant> list = item->data(0, Qt::UserRole).toList();
+  std::vector<hsize_t> coord;
+  for(int idx = 0; idx < list.size(); idx++)
+  {
+    coord.push_back(list.at(idx).toULongLong());
+  }
+
+  ChildWindow *window = find_window(item_data);
+  if(window == NULL)
+  {
+    m_tree->load_item(tree_item);
+    window = add_table(item_data);
+  }
+  window->goto_cell(coord);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::add_properties
+///////////////////////////////////////////////////////////////////////////////////////
+
+void MainWindow::add_properties(QTreeWidgetItem *item)
+{
+  m_properties_dock->show();
+  show_properties(item);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//add_property
+///////////////////////////////////////////////////////////////////////////////////////
+
+static QTreeWidgetItem* add_property(QTreeWidget *tree, QTreeWidgetItem *parent, const QString &name, const QString &value)
+{
+  QTreeWidgetItem *item = parent ? new QTreeWidgetItem(parent) : new QTreeWidgetItem(tree);
+  item->setText(0, name);
+  item->setText(1, value);
+  return item;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::show_properties
+//storage layout of the dataset selected in the tree (h5layout_t); nothing is read
+//while the dock is hidden
+///////////////////////////////////////////////////////////////////////////////////////
+
+void MainWindow::show_properties(QTreeWidgetItem *item)
+{
+  if(m_properties_dock->isHidden())
+  {
+    return;
+  }
+  m_properties_tree->clear();
+  if(item == NULL)
+  {
+    return;
+  }
+  ItemData *item_data = get_item_data(item);
+  if(item_data == NULL || item_data->m_kind != ItemData::Variable)
+  {
+    return;
+  }
+
+  h5layout_t layout;
+  if(layout.get(item_data->m_file_name.c_str(), item_data->m_dataset->m_path.c_str()) < 0)
+  {
+    statusBar()->showMessage(tr("Cannot read the layout of %1").arg(item_data->m_dataset->m_path.c_str()));
+    return;
+  }
+
+  QString str;
+  QTreeWidget *tree = m_properties_tree;
+  add_property(tree, NULL, tr("Dataset"), item_data->m_dataset->m_path.c_str());
+
+  switch(layout.m_layout)
+  {
+  case H5D_COMPACT: str = tr("compact"); break;
+  case H5D_CONTIGUOUS: str = tr("contiguous"); break;
+  case H5D_CHUNKED: str = tr("chunked"); break;
+#if H5_VERSION_GE(1,10,0)
+  case H5D_VIRTUAL: str = tr("virtual"); break;
+#endif
+  default: str = tr("unknown"); break;
+  }
+  add_property(tree, NULL, tr("Layout"), str);
+
+  //source of each mapping of a virtual dataset; the first ones are checked
+  h5vds_t vds;
+  if(vds.open(item_data->m_file_name, item_data->m_dataset->m_path) > 0)
+  {
+    const size_t max_shown = 256;
+    h5pool_t pool;
+    QTreeWidgetItem *item_mappings = add_property(tree, NULL, tr("Mappings"), QString::number(vds.m_mappings.size()));
+    for(size_t idx = 0; idx < vds.m_mappings.size() && idx < max_shown; idx++)
+    {
+      const h5vds_t::mapping_t &mapping = vds.m_mappings[idx];
+      str.clear();
+      for(size_t idx_dim = 0; idx_dim < mapping.m_start.size(); idx_dim++)
+      {
+        str += idx_dim ? "," : "";
+        if(mapping.m_end[idx_dim] == std::numeric_limits<hsize_t>::max())
+          str += QString("%1:").arg(mapping.m_start[idx_dim] + 1);
+        else
+          str += QString("%1:%2").arg(mapping.m_start[idx_dim] + 1).arg(mapping.m_end[idx_dim] + 1);
+      }
+      QString source = QString("%1:%2").arg(mapping.m_file_name.c_str()).arg(mapping.m_path.c_str());
+      if(!vds.check(idx, pool))
+      {
+        source += tr(" (missing)");
+      }
+      QTreeWidgetItem *item_mapping = add_property(tree, item_mappings, QString("[%1]").arg(str), source);
+      item_mapping->setToolTip(1, mapping.m_resolved.c_str());
+    }
+    if(vds.m_nbr_missing > 0)
+    {
+      item_mappings->setText(1, tr("%1, %2 sources missing").arg(vds.m_mappings.size()).arg(vds.m_nbr_missing));
+    }
+  }
+
+  str.clear();
+  for(size_t idx = 0; idx < layout.m_dim.size(); idx++)
+  {
+    str += (idx ? " x " : "") + QString::number(layout.m_dim[idx]);
+  }
+  add_property(tree, NULL, tr("Dimensions"), layout.m_dim.size() ? str : tr("scalar"));
+
+  if(layout.m_chunk.size())
+  {
+    hsize_t chunk_bytes = layout.m_datatype_size;
+    str.clear();
+    for(size_t idx = 0; idx < layout.m_chunk.size(); idx++)
+    {
+      str += (idx ? " x " : "") + QString::number(layout.m_chunk[idx]);
+      chunk_bytes *= layout.m_chunk[idx];
+    }
+    add_property(tree, NULL, tr("Chunk"), str + " (" + format_size(static_cast<double>(chunk_bytes)).c_str() + ")");
+  }
+
+  QTreeWidgetItem *item_filters = add_property(tree, NULL, tr("Filters"),
+    layout.m_filters.size() ? QString::number(layout.m_filters.size()) : tr("none"));
+  for(size_t idx = 0; idx < layout.m_filters.size(); idx++)
+  {
+    add_property(tree, item_filters, QString::number(idx), layout.m_filters[idx].c_str());
+  }
+
+  add_property(tree, NULL, tr("Logical size"), format_size(static_cast<double>(layout.m_logical_size)).c_str());
+  add_property(tree, NULL, tr("Allocated size"), format_size(static_cast<double>(layout.m_storage_size)).c_str());
+  if(layout.m_storage_size > 0)
+  {
+    add_property(tree, NULL, tr("Compression ratio"),
+      QString::number(static_cast<double>(layout.m_logical_size) / static_cast<double>(layout.m_storage_size), 'f', 2));
+  }
+
+  if(layout.m_chunk.size())
+  {
+    add_property(tree, NULL, tr("Allocated chunks"), tr("%1 of %2").arg(layout.m_nbr_allocated).arg(layout.m_nbr_chunks));
+    if(layout.m_chunk_stats)
+    {
+      add_property(tree, NULL, tr("Stored chunk size"), tr("%1 to %2")
+        .arg(format_size(static_cast<double>(layout.m_min_chunk_bytes)).c_str())
+        .arg(format_size(static_cast<double>(layout.m_max_chunk_bytes)).c_str()));
+    }
+    add_property(tree, NULL, tr("Chunk cache"), tr("%1, %2 slots")
+      .arg(format_size(static_cast<double>(layout.m_cache_nbytes)).c_str()).arg(layout.m_cache_nslots));
+    str = tr("%1 chunks, %2").arg(layout.m_layer_chunks).arg(format_size(static_cast<double>(layout.m_layer_bytes)).c_str());
+    str += (layout.m_layer_bytes <= layout.m_cache_nbytes) ? tr(", fits the cache") : tr(", does not fit the cache");
+    add_property(tree, NULL, tr("One layer"), str);
+    add_property(tree, NULL, tr("Layer read amplification"), QString::number(layout.m_layer_amplification, 'f', 1));
+  }
+
+  QTreeWidgetItem *item_warnings = add_property(tree, NULL, tr("Warnings"),
+    layout.m_warnings.size() ? QString::number(layout.m_warnings.size()) : tr("none"));
+  for(size_t idx = 0; idx < layout.m_warnings.size(); idx++)
+  {
+    QTreeWidgetItem *item_warning = add_property(tree, item_warnings, QString(), layout.m_warnings[idx].c_str());
+    item_warning->setToolTip(1, layout.m_warnings[idx].c_str());
+  }
+
+  m_properties_tree->expandAll();
+  m_properties_tree->resizeColumnToContents(0);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//ReportThread::ReportThread
+///////////////////////////////////////////////////////////////////////////////////////
+
+ReportThread::ReportThread(QObject *parent, const std::string &file_name) :
+ProgressThread(parent),
+m_file_name(file_name)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//ReportThread::run
+///////////////////////////////////////////////////////////////////////////////////////
+
+void ReportThread::run()
+{
+  m_result = m_report.run(m_file_name.c_str(), this);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//SizeTableItem
+//table cell showing a size (or a ratio) that sorts by its value
+///////////////////////////////////////////////////////////////////////////////////////
+
+class SizeTableItem : public QTableWidgetItem
+{
+public:
+  SizeTableItem(double value, const QString &text) :
+    QTableWidgetItem(text),
+    m_value(value)
+  {
+    setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+  }
+
+  bool operator<(const QTableWidgetItem &other) const
+  {
+    const SizeTableItem *item = dynamic_cast<const SizeTableItem*>(&other);
+    return item ? m_value < item->m_value : QTableWidgetItem::operator<(other);
+  }
+
+  double m_value;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////
+//TreemapWidget
+//squarified treemap of the file: one tile per object, sized by its total storage,
+//plus tiles for free space and file metadata
+///////////////////////////////////////////////////////////////////////////////////////
+
+class TreemapWidget : public QWidget
+{
+public:
+  struct tile_t
+  {
+    QString m_name;
+    double m_value;
+    QColor m_color;
+    QRectF m_rect;
+  };
+
+  TreemapWidget(QWidget *parent) : QWidget(parent)
+  {
+    setMinimumHeight(120);
+  }
+
+  std::vector<tile_t> m_tiles; // by decreasing value
+
+  static bool greater(const tile_t &a, const tile_t &b)
+  {
+    return a.m_value > b.m_value;
+  }
+
+protected:
+  void resizeEvent(QResizeEvent *)
+  {
+    squarify();
+  }
+
+  void paintEvent(QPaintEvent *)
+  {
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().color(QPalette::Base));
+    for(size_t idx = 0; idx < m_tiles.size(); idx++)
+    {
+      const tile_t &tile = m_tiles[idx];
+      painter.fillRect(tile.m_rect, tile.m_color);
+      painter.setPen(palette().color(QPalette::Base));
+      painter.drawRect(tile.m_rect);
+      if(tile.m_rect.width() > 40 && tile.m_rect.height() > 14)
+      {
+        painter.setPen(Qt::black);
+        painter.drawText(tile.m_rect.adjusted(2, 1, -2, -1), Qt::AlignLeft | Qt::AlignTop,
+          painter.fontMetrics().elidedText(tile.m_name, Qt::ElideLeft, static_cast<int>(tile.m_rect.width()) - 4));
+      }
+    }
+  }
+
+  bool event(QEvent *eve)
+  {
+    if(eve->type() == QEvent::ToolTip)
+    {
+      QHelpEvent *help = static_cast<QHelpEvent*>(eve);
+      for(size_t idx = 0; idx < m_tiles.size(); idx++)
+      {
+        if(m_tiles[idx].m_rect.contains(help->pos()))
+        {
+          QToolTip::showText(help->globalPos(), m_tiles[idx].m_name + "\n" + format_size(m_tiles[idx].m_value).c_str());
+          return true;
+        }
+      }
+      QToolTip::hideText();
+      return true;
+    }
+    return QWidget::event(eve);
+  }
+
+  //rows of tiles along the short side of the remaining rectangle, each row grown while
+  //it improves its worst aspect ratio (Bruls, Huizing, van Wijk)
+  void squarify()
+  {
+    QRectF area(0, 0, width(), height());
+    double total = 0;
+    for(size_t idx = 0; idx < m_tiles.size(); idx++)
+    {
+      total += m_tiles[idx].m_value;
+      m_tiles[idx].m_rect = QRectF();
+    }
+    if(total <= 0 || area.isEmpty())
+    {
+      return;
+    }
+    double scale = area.width() * area.height() / total;
+
+    size_t first = 0;
+    while(first < m_tiles.size() && m_tiles[first].m_value > 0)
+    {
+      double side = std::min(area.width(), area.height());
+      double row = 0;
+      double worst_row = 0;
+      size_t last = first;
+      while(last < m_tiles.size() && m_tiles[last].m_value > 0)
+      {
+        double sum = row + m_tiles[last].m_value * scale;
+        double max_area = m_tiles[first].m_value * scale;
+        double min_area = m_tiles[last].m_value * scale;
+        double worst = std::max(side * side * max_area / (sum * sum), sum * sum / (side * side * min_area));
+        if(last > first && worst > worst_row)
+          break;
+        worst_row = worst;
+        row = sum;
+        last++;
+      }
+
+      double thick = row / side;
+      double pos = 0;
+      bool vertical = area.width() >= area.height();
+      for(size_t idx = first; idx < last; idx++)
+      {
+        double len = m_tiles[idx].m_value * scale / thick;
+        if(vertical)
+          m_tiles[idx].m_rect = QRectF(area.left(), area.top() + pos, thick, len);
+        else
+          m_tiles[idx].m_rect = QRectF(area.left() + pos, area.top(), len, thick);
+        pos += len;
+      }
+      if(vertical)
+        area.setLeft(area.left() + thick);
+      else
+        area.setTop(area.top() + thick);
+      first = last;
+    }
+  }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////
+//ReportWindow
+//summary of the file totals, treemap and a sortable table of the objects
+///////////////////////////////////////////////////////////////////////////////////////
+
+class ReportWindow : public QWidget
+{
+public:
+  ReportWindow(QWidget *parent, const std::string &file_name, const h5report_t &report);
+};
+
+ReportWindow::ReportWindow(QWidget *parent, const std::string &file_name, const h5report_t &report) :
+QWidget(parent)
+{
+  setAttribute(Qt::WA_DeleteOnClose);
+  setWindowTitle(tr("File report: %1").arg(file_name.c_str()));
+
+  ///////////////////////////////////////////////////////////////////////////////////////
+  //totals
+  ///////////////////////////////////////////////////////////////////////////////////////
+
+  double file_size = report.m_file_size > 0 ? static_cast<double>(report.m_file_size) : 1;
+  hsize_t file_meta = report.m_superblock_size + report.m_free_meta_size + report.m_sohm_size;
+  struct
+  {
+    const char *name;
+    hsize_t value;
+  } totals[] =
+  {
+    { "raw data", report.m_storage_size },
+    { "object headers", report.m_header_size },
+    { "indexes and heaps", report.m_index_size },
+    { "attributes", report.m_attribute_size },
+    { "file metadata", file_meta },
+    { "free space", report.m_free_space },
+    { "unaccounted", report.m_other_size }
+  };
+  QString summary = tr("%1 objects, file size %2").arg(report.m_objects.size()).arg(format_size(static_cast<double>(report.m_file_size)).c_str());
+  for(size_t idx = 0; idx < sizeof(totals) / sizeof(totals[0]); idx++)
+  {
+    summary += tr("; %1 %2 (%3%)").arg(totals[idx].name).arg(format_size(static_cast<double>(totals[idx].value)).c_str())
+      .arg(100.0 * static_cast<double>(totals[idx].value) / file_size, 0, 'f', 1);
+  }
+  QLabel *label = new QLabel(summary);
+  label->setWordWrap(true);
+
+  ///////////////////////////////////////////////////////////////////////////////////////
+  //treemap: datasets in blue, darker the more compressed; objects mostly metadata in orange
+  ///////////////////////////////////////////////////////////////////////////////////////
+
+  TreemapWidget *treemap = new TreemapWidget(this);
+  for(size_t idx = 0; idx < report.m_objects.size(); idx++)
+  {
+    const h5object_size_t &object = report.m_objects[idx];
+    TreemapWidget::tile_t tile;
+    tile.m_name = object.m_path.c_str();
+    tile.m_value = static_cast<double>(object.total());
+    if(object.m_storage_size * 2 < object.total())
+      tile.m_color = QColor(240, 170, 90);
+    else if(object.m_storage_size < object.m_logical_size)
+      tile.m_color = QColor(90, 140, 210);
+    else
+      tile.m_color = QColor(140, 180, 230);
+    treemap->m_tiles.push_back(tile);
+  }
+  const size_t max_tiles = 500;
+  std::sort(treemap->m_tiles.begin(), treemap->m_tiles.end(), TreemapWidget::greater);
+  if(treemap->m_tiles.size() > max_tiles)
+  {
+    TreemapWidget::tile_t tile;
+    tile.m_name = tr("%1 other objects").arg(treemap->m_tiles.size() - max_tiles + 1);
+    tile.m_value = 0;
+    for(size_t idx = max_tiles - 1; idx < treemap->m_tiles.size(); idx++)
+    {
+      tile.m_value += treemap->m_tiles[idx].m_value;
+    }
+    tile.m_color = QColor(190, 190, 190);
+    treemap->m_tiles.resize(max_tiles - 1);
+    treemap->m_tiles.push_back(tile);
+  }
+  TreemapWidget::tile_t tile;
+  tile.m_name = tr("free space");
+  tile.m_value = static_cast<double>(report.m_free_space);
+  tile.m_color = QColor(220, 220, 220);
+  treemap->m_tiles.push_back(tile);
+  tile.m_name = tr("file metadata");
+  tile.m_value = static_cast<double>(file_meta + report.m_other_size);
+  tile.m_color = QColor(180, 150, 210);
+  treemap->m_tiles.push_back(tile);
+  std::sort(treemap->m_tiles.begin(), treemap->m_tiles.end(), TreemapWidget::greater);
+
+  ///////////////////////////////////////////////////////////////////////////////////////
+  //table
+  ///////////////////////////////////////////////////////////////////////////////////////
+
+  QStringList labels;
+  labels << tr("Object") << tr("Type") << tr("Layout") << tr("Filters") << tr("Logical size") << tr("Allocated size")
+    << tr("Compression ratio") << tr("Header") << tr("Index and heap") << tr("Attributes") << tr("Total") << tr("Overhead %");
+  QTableWidget *table = new QTableWidget(static_cast<int>(report.m_objects.size()), labels.size(), this);
+  table->setHorizontalHeaderLabels(labels);
+  table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+  table->setSelectionBehavior(QAbstractItemView::SelectRows);
+  for(size_t idx = 0; idx < report.m_objects.size(); idx++)
+  {
+    const h5object_size_t &object = report.m_objects[idx];
+    int row = static_cast<int>(idx);
+    QString type;
+    QString layout;
+    switch(object.m_type)
+    {
+    case H5O_TYPE_GROUP: type = tr("group"); break;
+    case H5O_TYPE_DATASET: type = tr("dataset"); break;
+    case H5O_TYPE_NAMED_DATATYPE: type = tr("datatype"); break;
+    default: type = tr("unknown"); break;
+    }
+    switch(object.m_layout)
+    {
+    case H5D_COMPACT: layout = tr("compact"); break;
+    case H5D_CONTIGUOUS: layout = tr("contiguous"); break;
+    case H5D_CHUNKED: layout = tr("chunked"); break;
+    default: break;
+    }
+    double total = static_cast<double>(object.total());
+    double ratio = object.m_storage_size ? static_cast<double>(object.m_logical_size) / static_cast<double>(object.m_storage_size) : 0;
+    double overhead = total > 0 ? 100.0 * (total - static_cast<double>(object.m_storage_size)) / total : 0;
+
+    table->setItem(row, 0, new QTableWidgetItem(object.m_path.c_str()));
+    table->setItem(row, 1, new QTableWidgetItem(type));
+    table->setItem(row, 2, new QTableWidgetItem(layout));
+    table->setItem(row, 3, new SizeTableItem(object.m_nbr_filters, object.m_type == H5O_TYPE_DATASET ? QString::number(object.m_nbr_filters) : QString()));
+    table->setItem(row, 4, new SizeTableItem(static_cast<double>(object.m_logical_size), format_size(static_cast<double>(object.m_logical_size)).c_str()));
+    table->setItem(row, 5, new SizeTableItem(static_cast<double>(object.m_storage_size), format_size(static_cast<double>(object.m_storage_size)).c_str()));
+    table->setItem(row, 6, new SizeTableItem(ratio, ratio > 0 ? QString::number(ratio, 'f', 2) : QString()));
+    table->setItem(row, 7, new SizeTableItem(static_cast<double>(object.m_header_size), format_size(static_cast<double>(object.m_header_size)).c_str()));
+    table->setItem(row, 8, new SizeTableItem(static_cast<double>(object.m_index_size), format_size(static_cast<double>(object.m_index_size)).c_str()));
+    table->setItem(row, 9, new SizeTableItem(static_cast<double>(object.m_attribute_size), format_size(static_cast<double>(object.m_attribute_size)).c_str()));
+    table->setItem(row, 10, new SizeTableItem(total, format_size(total).c_str()));
+    table->setItem(row, 11, new SizeTableItem(overhead, QString::number(overhead, 'f', 1)));
+  }
+  table->setSortingEnabled(true);
+  table->sortItems(10, Qt::DescendingOrder);
+  table->resizeColumnsToContents();
+
+  QSplitter *splitter = new QSplitter(Qt::Vertical, this);
+  splitter->addWidget(treemap);
+  splitter->addWidget(table);
+  QVBoxLayout *layout = new QVBoxLayout(this);
+  layout->addWidget(label);
+  layout->addWidget(splitter);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::add_report
+///////////////////////////////////////////////////////////////////////////////////////
+
+void MainWindow::add_report(const std::string &file_name)
+{
+  ReportThread *thread = new ReportThread(this, file_name);
+  start_thread(thread, tr("Analyzing file..."), SLOT(report_finished()));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::report_finished
+///////////////////////////////////////////////////////////////////////////////////////
+
+void MainWindow::report_finished()
+{
+  ReportThread *thread = qobject_cast<ReportThread *>(sender());
+  if(thread == NULL)
+  {
+    return;
+  }
+
+  if(thread->m_result < 0)
+  {
+    QMessageBox::warning(this, tr(app_name), tr("Cannot analyze %1").arg(thread->m_file_name.c_str()));
+    statusBar()->showMessage(tr("Ready"));
+  }
+  else if(thread->m_result == 1)
+  {
+    statusBar()->showMessage(tr("File report canceled"));
+  }
+  else
+  {
+    ReportWindow *window = new ReportWindow(this, thread->m_file_name, thread->m_report);
+    m_mdi_area->addSubWindow(window);
+    window->show();
+    statusBar()->showMessage(tr("Ready"));
+  }
+  thread->deleteLater();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//CompareDialog
+//other file and object to compare an item with, and the tolerances
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class CompareDialog : public QDialog
+{
+public:
+  CompareDialog(QWidget *parent, const QStringList &file_names, const QString &path) : QDialog(parent)
+  {
+    setWindowTitle(tr("Compare"));
+    m_combo_file = new QComboBox;
+    m_combo_file->setEditable(true);
+    m_combo_file->addItems(file_names);
+    m_combo_file->setMinimumContentsLength(40);
+    m_edit_path = new QLineEdit(path);
+    m_edit_abs = new QLineEdit("0");
+    m_edit_rel = new QLineEdit("0");
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+    connect(buttons, SIGNAL(accepted()), this, SLOT(accept()));
+    connect(buttons, SIGNAL(rejected()), this, SLOT(reject()));
+    QFormLayout *layout = new QFormLayout;
+    layout->addRow(tr("With file"), m_combo_file);
+    layout->addRow(tr("Object"), m_edit_path);
+    layout->addRow(tr("Absolute tolerance"), m_edit_abs);
+    layout->addRow(tr("Relative tolerance"), m_edit_rel);
+    layout->addRow(buttons);
+    setLayout(layout);
+  }
+
+  QString file_name() const
+  {
+    return m_combo_file->currentText();
+  }
+
+  QString path() const
+  {
+    return m_edit_path->text();
+  }
+
+  double abs_tol() const
+  {
+    return m_edit_abs->text().toDouble();
+  }
+
+  double rel_tol() const
+  {
+    return m_edit_rel->text().toDouble();
+  }
+
+private:
+  QComboBox *m_combo_file;
+  QLineEdit *m_edit_path;
+  QLineEdit *m_edit_abs;
+  QLineEdit *m_edit_rel;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////
+//item_path
+//object path of a group or dataset tree item; group items store their link name only
+///////////////////////////////////////////////////////////////////////////////////////
+
+static std::string item_path(QTreeWidgetItem *item)
+{
+  ItemData *item_data = get_item_data(item);
+  if(item_data->m_kind == ItemData::Variable)
+  {
+    return item_data->m_dataset->m_path;
+  }
+  if(item_data->m_kind == ItemData::Link)
+  {
+    return item_data->m_link.m_path;
+  }
+  std::string path;
+  for(; item->parent() != NULL; item = item->parent())
+  {
+    path = "/" + get_item_data(item)->m_item_nm + path;
+  }
+  return path.empty() ? "/" : path;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//CompareThread::CompareThread
+///////////////////////////////////////////////////////////////////////////////////////
+
+CompareThread::CompareThread(QObject *parent, QTreeWidgetItem *tree_item, const std::string &file_a, const std::string &path_a,
+  const std::string &file_b, const std::string &path_b) :
+  ProgressThread(parent),
+  m_tree_item(tree_item),
+  m_file_a(file_a),
+  m_path_a(path_a),
+  m_file_b(file_b),
+  m_path_b(path_b)
+{
+  //a tree can show only so many items
+  m_diff.m_max_locations = 100;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//CompareThread::run
+///////////////////////////////////////////////////////////////////////////////////////
+
+void CompareThread::run()
+{
+  m_result = m_diff.compare(m_file_a.c_str(), m_path_a.c_str(), m_file_b.c_str(), m_path_b.c_str(), this);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::add_compare
+///////////////////////////////////////////////////////////////////////////////////////
+
+void MainWindow::add_compare(QTreeWidgetItem *item)
+{
+  ItemData *item_data = get_item_data(item);
+  std::string path = item_path(item);
+
+  //the other files open first, then the recent ones
+  QStringList file_names;
+  for(int idx = 0; idx < m_scans.size(); idx++)
+  {
+    QString file_name = QString::fromStdString(m_scans.at(idx)->m_file_name);
+    if(file_name != QString::fromStdString(item_data->m_file_name) && !file_names.contains(file_name))
+      file_names.append(file_name);
+  }
+  for(int idx = 0; idx < m_sl_recent_files.size(); idx++)
+  {
+    if(!file_names.contains(m_sl_recent_files.at(idx)))
+      file_names.append(m_sl_recent_files.at(idx));
+  }
+
+  CompareDialog dialog(this, file_names, QString::fromStdString(path));
+  if(dialog.exec() != QDialog::Accepted || dialog.file_name().isEmpty())
+  {
+    return;
+  }
+
+  CompareThread *thread = new CompareThread(this, item, item_data->m_file_name, path,
+    dialog.file_name().toStdString(), dialog.path().toStdString());
+  thread->m_diff.m_abs_tol = dialog.abs_tol();
+  thread->m_diff.m_rel_tol = dialog.rel_tol();
+  start_thread(thread, tr("Comparing..."), SLOT(compare_finished()));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::compare_finished
+//one top level item per comparison in the search results, with one child item per object that
+//differs, and one item per cell that differs under the datasets; clicking a dataset or a cell
+//opens the difference grid
+///////////////////////////////////////////////////////////////////////////////////////
+
+void MainWindow::compare_finished()
+{
+  CompareThread *thread = qobject_cast<CompareThread *>(sender());
+  if(thread == NULL)
+  {
+    return;
+  }
+
+  const h5diff_t &diff = thread->m_diff;
+  QString name_a = last_component(thread->m_file_a.c_str());
+  QString name_b = last_component(thread->m_file_b.c_str());
+  QString str;
+
+  QTreeWidgetItem *item_compare = new QTreeWidgetItem(m_search_tree);
+  item_compare->setText(0, QString("%1:%2 / %3:%4").arg(name_a).arg(thread->m_path_a.c_str())
+    .arg(name_b).arg(thread->m_path_b.c_str()));
+  if(thread->m_result < 0)
+  {
+    str = tr("error");
+  }
+  else
+  {
+    str = tr("%1 of %2 objects differ").arg(diff.m_nbr_different).arg(diff.m_objects.size());
+    if(thread->m_result == 1)
+      str += tr(" (canceled)");
+  }
+  item_compare->setText(1, str);
+  item_compare->setData(0, Qt::UserRole, QVariant::fromValue(static_cast<void*>(thread->m_tree_item)));
+
+  QList<QTreeWidgetItem *> items;
+  for(size_t idx = 0; idx < diff.m_objects.size(); idx++)
+  {
+    const h5diff_object_t &object = diff.m_objects[idx];
+    if(object.m_status == DIFF_EQUAL)
+    {
+      continue;
+    }
+
+    QTreeWidgetItem *item_object = new QTreeWidgetItem;
+    item_object->setText(0, object.m_path_a.empty() ? object.m_path_b.c_str() : object.m_path_a.c_str());
+    switch(object.m_status)
+    {
+    case DIFF_ONLY_A:
+      str = tr("only in %1").arg(name_a);
+      break;
+    case DIFF_ONLY_B:
+      str = tr("only in %1").arg(name_b);
+      break;
+    case DIFF_METADATA:
+      str = tr("differs: %1").arg(object.m_note.c_str());
+      break;
+    default:
+      str = tr("%1 of %2 values differ").arg(object.m_nbr_diff).arg(object.m_nbr_elements);
+      if(!object.m_note.empty())
+        str += QString("; %1").arg(object.m_note.c_str());
+      break;
+    }
+    if(object.m_nbr_elements > 0 && object.m_max_coord.size() > 0)
+    {
+      QStringList sl;
+      for(size_t dmn = 0; dmn < object.m_max_coord.size(); dmn++)
+      {
+        sl.append(QString::number(object.m_max_coord[dmn]));
+      }
+      str += tr("; max error %1 at [%2], max relative error %3").arg(object.m_max_abs).arg(sl.join(", ")).arg(object.m_max_rel);
+    }
+    item_object->setText(1, str);
+    item_object->setToolTip(1, str);
+
+    //datasets whose values were compared have a difference grid
+    QStringList names;
+    if(object.m_nbr_elements > 0)
+    {
+      names << thread->m_file_a.c_str() << object.m_path_a.c_str() << thread->m_file_b.c_str() << object.m_path_b.c_str();
+    }
+    item_object->setData(0, difference_role, names);
+
+    for(size_t idx_location = 0; idx_location < object.m_locations.size(); idx_location++)
+    {
+      const h5diff_location_t &location = object.m_locations[idx_location];
+      QStringList sl;
+      QList<QVariant> coord;
+      for(size_t dmn = 0; dmn < location.m_coord.size(); dmn++)
+      {
+        sl.append(QString::number(location.m_coord[dmn]));
+        coord.append(static_cast<qulonglong>(location.m_coord[dmn]));
+      }
+      QTreeWidgetItem *item_location = new QTreeWidgetItem(item_object);
+      item_location->setText(0, "[" + sl.join(", ") + "]");
+      item_location->setText(1, str.sprintf("%g / %g", location.m_value_a, location.m_value_b));
+      item_location->setData(0, Qt::UserRole, coord);
+    }
+    items.append(item_object);
+  }
+  item_compare->addChildren(items);
+  item_compare->setExpanded(true);
+
+  m_search_dock->show();
+  statusBar()->showMessage(tr("Ready"));
+  thread->deleteLater();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//DifferenceThread::DifferenceThread
+///////////////////////////////////////////////////////////////////////////////////////
+
+DifferenceThread::DifferenceThread(QObject *parent, const QStringList &names, const std::vector<hsize_t> &coord) :
+ProgressThread(parent),
+m_names(names),
+m_coord(coord),
+m_buf(NULL)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//DifferenceThread::run
+///////////////////////////////////////////////////////////////////////////////////////
+
+void DifferenceThread::run()
+{
+  m_result = h5diff_t::difference(m_names.at(0).toStdString().c_str(), m_names.at(1).toStdString().c_str(),
+    m_names.at(2).toStdString().c_str(), m_names.at(3).toStdString().c_str(), m_dim, &m_buf, this);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//difference_name
+//item name of a difference grid, also used to find it
+///////////////////////////////////////////////////////////////////////////////////////
+
+static std::string difference_name(const QStringList &names)
+{
+  return QString("%1 - %2:%3").arg(names.at(1)).arg(last_component(names.at(2))).arg(names.at(3)).toStdString();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::show_difference
+///////////////////////////////////////////////////////////////////////////////////////
+
+void MainWindow::show_difference(const QStringList &names, const std::vector<hsize_t> &coord)
+{
+  std::string name = difference_name(names);
+  QList<QMdiSubWindow *> list = m_mdi_area->subWindowList();
+  for(int idx = 0; idx < list.size(); idx++)
+  {
+    ChildWindow *window = qobject_cast<ChildWindow *>(list.at(idx)->widget());
+    if(window && window->m_item_data->m_kind == ItemData::Difference &&
+      window->m_item_data->m_file_name == names.at(0).toStdString() && window->m_item_data->m_item_nm == name)
+    {
+      m_mdi_area->setActiveSubWindow(list.at(idx));
+      if(coord.size())
+        window->goto_cell(coord);
+      return;
+    }
+  }
+
+  DifferenceThread *thread = new DifferenceThread(this, names, coord);
+  start_thread(thread, tr("Computing difference..."), SLOT(difference_finished()));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::difference_finished
+//the grid owns an item data that is in no tree, deleted with the window
+///////////////////////////////////////////////////////////////////////////////////////
+
+void MainWindow::difference_finished()
+{
+  DifferenceThread *thread = qobject_cast<DifferenceThread *>(sender());
+  if(thread == NULL)
+  {
+    return;
+  }
+
+  if(thread->m_result == 0)
+  {
+    hdf_dataset_t *dataset = new hdf_dataset_t(thread->m_names.at(1).toStdString().c_str(), thread->m_dim,
+      sizeof(double), H5T_SGN_ERROR, H5T_FLOAT);
+    dataset->store(thread->m_buf);
+    ItemData *item_data = new ItemData(ItemData::Difference, thread->m_names.at(0).toStdString(),
+      difference_name(thread->m_names), dataset);
+    ChildWindow *window = add_table(item_data);
+    if(thread->m_coord.size())
+      window->goto_cell(thread->m_coord);
+    statusBar()->showMessage(tr("Ready"));
+  }
+  else
+  {
+    free(thread->m_buf);
+    if(thread->m_result < 0)
+    {
+      QMessageBox::warning(this, tr(app_name), tr("Cannot compute the difference of %1 and %2")
+        .arg(thread->m_names.at(1)).arg(thread->m_names.at(3)));
+    }
+    statusBar()->showMessage(tr("Ready"));
+  }
+  thread->deleteLater();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//PlotThread::PlotThread
+///////////////////////////////////////////////////////////////////////////////////////
+
+PlotThread::PlotThread(QObject *parent, const std::string &file_name, const std::string &path,
+  const std::vector<hsize_t> &start, size_t axis) :
+ProgressThread(parent),
+m_file_name(file_name),
+m_path(path),
+m_start(start),
+m_axis(axis),
+m_envelope(new h5envelope_t)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//PlotThread::run
+///////////////////////////////////////////////////////////////////////////////////////
+
+void PlotThread::run()
+{
+  m_result = m_envelope->build(m_file_name.c_str(), m_path.c_str(), m_start, m_axis, this);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::add_plot
+//plot the line of dataset 'path' along dimension 'axis' through 'start'
+///////////////////////////////////////////////////////////////////////////////////////
+
+void MainWindow::add_plot(const std::string &file_name, const std::string &path, const std::vector<hsize_t> &start, size_t axis)
+{
+  PlotThread *thread = new PlotThread(this, file_name, path, start, axis);
+  start_thread(thread, tr("Reading %1...").arg(path.c_str()), SLOT(plot_finished()));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::plot_finished
+///////////////////////////////////////////////////////////////////////////////////////
+
+void MainWindow::plot_finished()
+{
+  PlotThread *thread = qobject_cast<PlotThread *>(sender());
+  if(thread == NULL)
+  {
+    return;
+  }
+
+  if(thread->m_result == 0)
+  {
+    PlotWidget *plot = new PlotWidget(this, thread->m_envelope);
+    thread->m_envelope = NULL;
+
+    //title: path, and the fixed coordinates of the line for more than one dimension
+    QString title(thread->m_path.c_str());
+    if(thread->m_start.size() > 1)
+    {
+      QStringList coord;
+      for(size_t idx = 0; idx < thread->m_start.size(); idx++)
+      {
+        coord << (idx == thread->m_axis ? QString(":") : QString::number(static_cast<qulonglong>(thread->m_start[idx] + 1)));
+      }
+      title += QString(" [%1]").arg(coord.join(","));
+    }
+    plot->setWindowTitle(title);
+    m_mdi_area->addSubWindow(plot);
+    plot->show();
+  }
+  else if(thread->m_result < 0)
+  {
+    QMessageBox::warning(this, tr(app_name), tr("Cannot plot %1").arg(thread->m_path.c_str()));
+  }
+  delete thread->m_envelope;
+  statusBar()->showMessage(tr("Ready"));
+  thread->deleteLater();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//PlotWidget::PlotWidget
+///////////////////////////////////////////////////////////////////////////////////////
+
+PlotWidget::PlotWidget(QWidget *parent, h5envelope_t *envelope) :
+QWidget(parent),
+m_envelope(envelope),
+m_first(0),
+m_last(envelope->m_nbr_elements),
+m_pixels_first(0),
+m_pixels_last(0),
+m_nbr_pixels(0),
+m_read_error(false),
+m_drag_from(-1),
+m_drag_to(-1)
+{
+  setAttribute(Qt::WA_DeleteOnClose);
+  setMinimumSize(200, 120);
+  resize(640, 320);
+  setContextMenuPolicy(Qt::ActionsContextMenu);
+  QAction *action_reset = new QAction(tr("Reset zoom"), this);
+  connect(action_reset, SIGNAL(triggered()), this, SLOT(reset_zoom()));
+  addAction(action_reset);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//PlotWidget::~PlotWidget
+///////////////////////////////////////////////////////////////////////////////////////
+
+PlotWidget::~PlotWidget()
+{
+  delete m_envelope;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//PlotWidget::plot_area
+//the widget less the room for the axis labels
+///////////////////////////////////////////////////////////////////////////////////////
+
+QRect PlotWidget::plot_area() const
+{
+  int left = fontMetrics().width("-0.00000e+00") + 8;
+  int bottom = fontMetrics().height() + 8;
+  return QRect(left, 8, std::max(1, width() - left - 12), std::max(1, height() - bottom - 8));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//PlotWidget::element_at
+///////////////////////////////////////////////////////////////////////////////////////
+
+hsize_t PlotWidget::element_at(int x) const
+{
+  QRect area = plot_area();
+  double fraction = static_cast<double>(x - area.left()) / area.width();
+  fraction = std::min(1.0, std::max(0.0, fraction));
+  return m_first + static_cast<hsize_t>(fraction * static_cast<double>(m_last - m_first));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//PlotWidget::set_range
+//at least 2 elements
+///////////////////////////////////////////////////////////////////////////////////////
+
+void PlotWidget::set_range(hsize_t first, hsize_t last)
+{
+  hsize_t nbr_elements = m_envelope->m_nbr_elements;
+  last = std::min(last, nbr_elements);
+  if(last < first + 2)
+  {
+    last = std::min(first + 2, nbr_elements);
+    first = last > 2 ? last - 2 : 0;
+  }
+  m_first = first;
+  m_last = last;
+  update();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//PlotWidget::reset_zoom
+///////////////////////////////////////////////////////////////////////////////////////
+
+void PlotWidget::reset_zoom()
+{
+  set_range(0, m_envelope->m_nbr_elements);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//PlotWidget::paintEvent
+//one bar per pixel from the min to the max, joined to the bar before so that steep changes
+//show as a line; with fewer elements than pixels, the elements are joined by lines
+///////////////////////////////////////////////////////////////////////////////////////
+
+void PlotWidget::paintEvent(QPaintEvent *)
+{
+  QPainter painter(this);
+  QRect area = plot_area();
+  painter.fillRect(rect(), palette().base());
+  painter.setPen(palette().color(QPalette::Text));
+  painter.drawRect(area.adjusted(0, 0, -1, -1));
+
+  if(m_last <= m_first)
+  {
+    painter.drawText(area, Qt::AlignCenter, tr("No data"));
+    return;
+  }
+
+  //pixels of the range, read again only when the range or the width changed
+  size_t nbr_pixels = static_cast<size_t>(area.width());
+  if(m_first != m_pixels_first || m_last != m_pixels_last || nbr_pixels != m_nbr_pixels)
+  {
+    m_read_error = m_envelope->get(m_first, m_last, nbr_pixels, m_min, m_max) < 0;
+    m_pixels_first = m_first;
+    m_pixels_last = m_last;
+    m_nbr_pixels = nbr_pixels;
+  }
+  if(m_read_error)
+  {
+    painter.drawText(area, Qt::AlignCenter, tr("Cannot read %1").arg(m_envelope->m_path.c_str()));
+    return;
+  }
+
+  //vertical range of the pixels shown
+  double y_min = std::numeric_limits<double>::infinity();
+  double y_max = -std::numeric_limits<double>::infinity();
+  for(size_t idx = 0; idx < m_min.size(); idx++)
+  {
+    if(m_min[idx] <= m_max[idx])
+    {
+      y_min = std::min(y_min, m_min[idx]);
+      y_max = std::max(y_max, m_max[idx]);
+    }
+  }
+  if(y_min > y_max)
+  {
+    painter.drawText(area, Qt::AlignCenter, tr("No numbers"));
+    return;
+  }
+  if(y_min == y_max)
+  {
+    double margin = y_min == 0 ? 1 : std::fabs(y_min) / 2;
+    y_min -= margin;
+    y_max += margin;
+  }
+
+  //labels
+  int text_height = fontMetrics().height();
+  painter.drawText(QRect(0, area.top(), area.left() - 4, text_height), Qt::AlignRight, QString::number(y_max, 'g', 6));
+  painter.drawText(QRect(0, area.bottom() - text_height, area.left() - 4, text_height), Qt::AlignRight, QString::number(y_min, 'g', 6));
+  painter.drawText(QRect(area.left(), area.bottom() + 4, area.width(), text_height), Qt::AlignLeft,
+    QString::number(static_cast<qulonglong>(m_first + 1)));
+  painter.drawText(QRect(area.left(), area.bottom() + 4, area.width(), text_height), Qt::AlignRight,
+    QString::number(static_cast<qulonglong>(m_last)));
+
+  //curve
+  double scale = (area.height() - 1) / (y_max - y_min);
+  painter.save();
+  painter.setClipRect(area);
+  painter.setPen(palette().color(QPalette::Highlight));
+  size_t nbr = m_min.size();
+  bool points = nbr == m_last - m_first;
+  bool previous = false;
+  double x_previous = 0;
+  double y_previous = 0;
+  double y_previous_bottom = 0;
+  double y_previous_top = 0;
+  for(size_t idx = 0; idx < nbr; idx++)
+  {
+    if(m_min[idx] > m_max[idx])
+    {
+      previous = false;
+      continue;
+    }
+    double x = area.left() + (idx + 0.5) * area.width() / nbr;
+    double y_lo = area.bottom() - (m_min[idx] - y_min) * scale;
+    double y_hi = area.bottom() - (m_max[idx] - y_min) * scale;
+    if(points)
+    {
+      if(previous)
+      {
+        painter.drawLine(QPointF(x_previous, y_previous), QPointF(x, y_lo));
+      }
+      if(nbr < nbr_pixels / 4)
+      {
+        painter.drawEllipse(QPointF(x, y_lo), 2, 2);
+      }
+      x_previous = x;
+      y_previous = y_lo;
+    }
+    else
+    {
+      //bar, reaching the bar before
+      double top = y_hi;
+      double bottom = y_lo;
+      if(previous)
+      {
+        top = std::min(top, y_previous_bottom);
+        bottom = std::max(bottom, y_previous_top);
+      }
+      painter.drawLine(QPointF(x, top), QPointF(x, bottom));
+      y_previous_bottom = y_lo;
+      y_previous_top = y_hi;
+    }
+    previous = true;
+  }
+  painter.restore();
+
+  //zoom drag
+  if(m_drag_from >= 0)
+  {
+    QColor color = palette().color(QPalette::Highlight);
+    color.setAlpha(64);
+    painter.fillRect(QRect(QPoint(std::min(m_drag_from, m_drag_to), area.top()),
+      QPoint(std::max(m_drag_from, m_drag_to), area.bottom())), color);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//PlotWidget::mousePressEvent
+///////////////////////////////////////////////////////////////////////////////////////
+
+void PlotWidget::mousePressEvent(QMouseEvent *event)
+{
+  if(event->button() == Qt::LeftButton && plot_area().contains(event->pos()))
+  {
+    m_drag_from = m_drag_to = event->pos().x();
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//PlotWidget::mouseMoveEvent
+///////////////////////////////////////////////////////////////////////////////////////
+
+void PlotWidget::mouseMoveEvent(QMouseEvent *event)
+{
+  if(m_drag_from >= 0)
+  {
+    QRect area = plot_area();
+    m_drag_to = std::min(area.right(), std::max(area.left(), event->pos().x()));
+    update();
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//PlotWidget::mouseReleaseEvent
+//zoom to the range dragged
+///////////////////////////////////////////////////////////////////////////////////////
+
+void PlotWidget::mouseReleaseEvent(QMouseEvent *event)
+{
+  if(event->button() != Qt::LeftButton || m_drag_from < 0)
+  {
+    return;
+  }
+  int from = std::min(m_drag_from, m_drag_to);
+  int to = std::max(m_drag_from, m_drag_to);
+  m_drag_from = m_drag_to = -1;
+  if(to - from > 2)
+  {
+    set_range(element_at(from), element_at(to) + 1);
+  }
+  update();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//PlotWidget::mouseDoubleClickEvent
+///////////////////////////////////////////////////////////////////////////////////////
+
+void PlotWidget::mouseDoubleClickEvent(QMouseEvent *)
+{
+  reset_zoom();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//PlotWidget::wheelEvent
+//each step halves or doubles the range, keeping the element under the cursor in place
+///////////////////////////////////////////////////////////////////////////////////////
+
+void PlotWidget::wheelEvent(QWheelEvent *event)
+{
+#if QT_VERSION >= 0x050000
+  int delta = event->angleDelta().y();
+#else
+  int delta = event->delta();
+#endif
+  if(delta == 0)
+  {
+    return;
+  }
+  QRect area = plot_area();
+  double fraction = static_cast<double>(event->pos().x() - area.left()) / area.width();
+  fraction = std::min(1.0, std::max(0.0, fraction));
+  double range = static_cast<double>(m_last - m_first) * (delta > 0 ? 0.5 : 2.0);
+  range = std::min(range, static_cast<double>(m_envelope->m_nbr_elements));
+  double center = static_cast<double>(m_first) + fraction * static_cast<double>(m_last - m_first);
+  double first = std::max(0.0, center - fraction * range);
+  first = std::min(first, static_cast<double>(m_envelope->m_nbr_elements) - range);
+  set_range(static_cast<hsize_t>(first), static_cast<hsize_t>(first + range));
+  event->accept();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//HistogramThread::HistogramThread
+///////////////////////////////////////////////////////////////////////////////////////
+
+HistogramThread::HistogramThread(QObject *parent, const std::string &file_name, const std::string &path,
+  const std::vector<hsize_t> &start, const std::vector<hsize_t> &count) :
+ProgressThread(parent),
+m_file_name(file_name),
+m_path(path),
+m_start(start),
+m_count(count),
+m_histogram(new h5histogram_t)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//HistogramThread::run
+///////////////////////////////////////////////////////////////////////////////////////
+
+void HistogramThread::run()
+{
+  m_result = m_histogram->compute(m_file_name.c_str(), m_path.c_str(), m_start, m_count, this);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::add_histogram
+//histogram of the hyperslab 'start', 'count' of dataset 'path', empty for all of it
+///////////////////////////////////////////////////////////////////////////////////////
+
+void MainWindow::add_histogram(const std::string &file_name, const std::string &path, const std::vector<hsize_t> &start,
+  const std::vector<hsize_t> &count)
+{
+  HistogramThread *thread = new HistogramThread(this, file_name, path, start, count);
+  start_thread(thread, tr("Histogram of %1...").arg(path.c_str()), SLOT(histogram_finished()));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::histogram_finished
+///////////////////////////////////////////////////////////////////////////////////////
+
+void MainWindow::histogram_finished()
+{
+  HistogramThread *thread = qobject_cast<HistogramThread *>(sender());
+  if(thread == NULL)
+  {
+    return;
+  }
+
+  if(thread->m_result == 0)
+  {
+    HistogramWindow *window = new HistogramWindow(this, thread->m_histogram);
+    thread->m_histogram = NULL;
+
+    //title: path, and the hyperslab for a selection
+    QString title(thread->m_path.c_str());
+    if(thread->m_start.size())
+    {
+      QStringList slab;
+      for(size_t idx = 0; idx < thread->m_start.size(); idx++)
+      {
+        slab << QString("%1:%2").arg(static_cast<qulonglong>(thread->m_start[idx] + 1))
+          .arg(static_cast<qulonglong>(thread->m_start[idx] + thread->m_count[idx]));
+      }
+      title += QString(" [%1]").arg(slab.join(","));
+    }
+    window->setWindowTitle(title);
+    m_mdi_area->addSubWindow(window);
+    window->show();
+  }
+  else if(thread->m_result < 0)
+  {
+    QMessageBox::warning(this, tr(app_name), tr("Cannot make the histogram of %1").arg(thread->m_path.c_str()));
+  }
+  delete thread->m_histogram;
+  statusBar()->showMessage(tr("Ready"));
+  thread->deleteLater();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//SortThread::SortThread
+///////////////////////////////////////////////////////////////////////////////////////
+
+SortThread::SortThread(QObject *parent, ChildWindow *window, unsigned long id, hsize_t col, bool ascending) :
+ProgressThread(parent),
+m_window(window),
+m_id(id),
+m_col(col),
+m_ascending(ascending),
+m_file_name(window->m_item_data->m_file_name),
+m_path(window->m_item_data->m_dataset->m_path),
+m_physical(false),
+m_native(get_native(window->m_item_data->m_dataset->m_datatype_class, window->m_item_data->m_dataset->m_datatype_size,
+  window->m_item_data->m_dataset->m_datatype_sign))
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//SortThread::run
+///////////////////////////////////////////////////////////////////////////////////////
+
+void SortThread::run()
+{
+  if(m_values.empty())
+  {
+    m_result = m_sort.sort(m_file_name.c_str(), m_path.c_str(), m_start, m_count, m_physical, m_ascending, this);
+    return;
+  }
+  size_t nbr_rows = static_cast<size_t>(m_count[m_count.size() > 1 ? m_count.size() - 2 : 0]);
+  m_result = m_sort.sort(&m_values[0], m_native, nbr_rows, m_ascending, this);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::add_sort
+//sort the rows of the grid of 'window' by grid column 'col', the hyperslab 'start', 'count' of its
+//dataset; 'values' (taken) are the values of the column if the dataset is loaded, else empty
+///////////////////////////////////////////////////////////////////////////////////////
+
+void MainWindow::add_sort(ChildWindow *window, unsigned long id, hsize_t col, bool ascending, const std::vector<hsize_t> &start,
+  const std::vector<hsize_t> &count, bool physical, std::vector<char> &values)
+{
+  SortThread *thread = new SortThread(this, window, id, col, ascending);
+  thread->m_start = start;
+  thread->m_count = count;
+  thread->m_physical = physical;
+  thread->m_values.swap(values);
+  start_thread(thread, tr("Sorting %1...").arg(thread->m_path.c_str()), SLOT(sort_finished()));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::sort_finished
+//the window may have been closed meanwhile
+///////////////////////////////////////////////////////////////////////////////////////
+
+void MainWindow::sort_finished()
+{
+  SortThread *thread = qobject_cast<SortThread *>(sender());
+  if(thread == NULL)
+  {
+    return;
+  }
+
+  QList<QMdiSubWindow *> list = m_mdi_area->subWindowList();
+  for(int idx = 0; idx < list.size(); idx++)
+  {
+    if(list.at(idx)->widget() != thread->m_window)
+    {
+      continue;
+    }
+    if(thread->m_result == 0)
+    {
+      thread->m_window->set_order(thread->m_id, thread->m_col, thread->m_ascending, thread->m_sort.m_order, thread->m_sort.m_inverse);
+    }
+    else if(thread->m_result < 0)
+    {
+      QMessageBox::warning(this, tr(app_name), tr("Cannot sort %1").arg(thread->m_path.c_str()));
+    }
+    break;
+  }
+  statusBar()->showMessage(tr("Ready"));
+  thread->deleteLater();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//RangeThread::RangeThread
+///////////////////////////////////////////////////////////////////////////////////////
+
+RangeThread::RangeThread(QObject *parent, ChildWindow *window, const std::vector<hsize_t> &start, const std::vector<hsize_t> &count,
+  bool physical) :
+ProgressThread(parent),
+m_window(window),
+m_file_name(window->m_item_data->m_file_name),
+m_path(window->m_item_data->m_dataset->m_path),
+m_start(start),
+m_count(count),
+m_physical(physical)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//RangeThread::run
+///////////////////////////////////////////////////////////////////////////////////////
+
+void RangeThread::run()
+{
+  m_result = m_stats.compute(m_file_name.c_str(), m_path.c_str(), m_start, m_count, m_physical, this);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::add_range
+//range of the layer 'start', 'count' of the dataset of 'window', for its heat map
+///////////////////////////////////////////////////////////////////////////////////////
+
+void MainWindow::add_range(ChildWindow *window, const std::vector<hsize_t> &start, const std::vector<hsize_t> &count, bool physical)
+{
+  RangeThread *thread = new RangeThread(this, window, start, count, physical);
+  start_thread(thread, tr("Range of %1...").arg(thread->m_path.c_str()), SLOT(range_finished()));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::range_finished
+//the window may have been closed meanwhile
+///////////////////////////////////////////////////////////////////////////////////////
+
+void MainWindow::range_finished()
+{
+  RangeThread *thread = qobject_cast<RangeThread *>(sender());
+  if(thread == NULL)
+  {
+    return;
+  }
+
+  QList<QMdiSubWindow *> list = m_mdi_area->subWindowList();
+  for(int idx = 0; idx < list.size(); idx++)
+  {
+    if(list.at(idx)->widget() != thread->m_window)
+    {
+      continue;
+    }
+    thread->m_window->set_heat_range(thread->m_start, thread->m_physical, thread->m_result == 0 ? &thread->m_stats : NULL);
+    if(thread->m_result < 0)
+    {
+      QMessageBox::warning(this, tr(app_name), tr("Cannot read %1").arg(thread->m_path.c_str()));
+    }
+    break;
+  }
+  statusBar()->showMessage(tr("Ready"));
+  thread->deleteLater();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//StatsThread::StatsThread
+///////////////////////////////////////////////////////////////////////////////////////
+
+StatsThread::StatsThread(QObject *parent, ItemData *item_data) :
+ProgressThread(parent),
+m_id(0),
+m_file_name(item_data->m_file_name),
+m_path(item_data->m_dataset->m_path),
+m_derived(item_data->m_kind == ItemData::Derived),
+m_expr(item_data->m_expr),
+m_aggregated(item_data->m_kind == ItemData::Aggregate),
+m_aggregate(item_data->m_aggregate),
+m_physical(false),
+m_native(get_native(item_data->m_dataset->m_datatype_class, item_data->m_dataset->m_datatype_size,
+  item_data->m_dataset->m_datatype_sign)),
+m_buf(NULL),
+m_nbr_cols(0)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//StatsThread::start_job
+///////////////////////////////////////////////////////////////////////////////////////
+
+void StatsThread::start_job()
+{
+  m_cancel.store(0);
+  m_result = -1;
+  m_stats.clear();
+  start();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//StatsThread::run
+//a range of a loaded buffer is reduced in one pass on the thread pool; the rows of a range of a
+//sorted grid read by tiles are read in dataset order, which is that of the tiles
+///////////////////////////////////////////////////////////////////////////////////////
+
+void StatsThread::run()
+{
+  h5tiles_t tiles;
+  h5native_t native = m_native;
+  m_result = -1;
+  if(m_buf == NULL)
+  {
+    if(m_derived)
+    {
+      if(tiles.set_expression(m_file_name, m_expr) < 0)
+      {
+        return;
+      }
+    }
+    else if(m_aggregated)
+    {
+      tiles.set_aggregate(m_aggregate);
+    }
+    else
+    {
+      tiles.set_dataset(m_file_name, m_path);
+    }
+    if(m_physical && tiles.set_physical(true) < 0)
+    {
+      return;
+    }
+    native = tiles_native(tiles, m_native);
+  }
+  if(native == H5NATIVE_NONE)
+  {
+    return;
+  }
+
+  hsize_t nbr_total = 0;
+  for(size_t idx = 0; idx < m_ranges.size(); idx++)
+  {
+    nbr_total += (m_ranges[idx].bottom - m_ranges[idx].top + 1) * (m_ranges[idx].right - m_ranges[idx].left + 1);
+  }
+  hsize_t nbr_done = 0;
+  hsize_t nbr_reported = 0;
+  size_t idx_rows = 0;
+  for(size_t idx = 0; idx < m_ranges.size(); idx++)
+  {
+    const grid_range_t &range = m_ranges[idx];
+    hsize_t nbr_rows = range.bottom - range.top + 1;
+    hsize_t nbr_cols = range.right - range.left + 1;
+    if(m_buf != NULL)
+    {
+      m_stats.add_rows(m_buf, native, m_nbr_cols, m_rows.empty() ? NULL : &m_rows[idx_rows], static_cast<size_t>(range.top),
+        static_cast<size_t>(nbr_rows), static_cast<size_t>(range.left), static_cast<size_t>(nbr_cols));
+      nbr_done += nbr_rows * nbr_cols;
+      if(!progress(nbr_done, nbr_total))
+      {
+        m_result = 1;
+        return;
+      }
+    }
+    else
+    {
+      if(!m_rows.empty())
+      {
+        std::sort(m_rows.begin() + idx_rows, m_rows.begin() + idx_rows + static_cast<size_t>(nbr_rows));
+      }
+      for(hsize_t idx_row = 0; idx_row < nbr_rows; idx_row++)
+      {
+        hsize_t row = m_rows.empty() ? range.top + idx_row : m_rows[idx_rows + static_cast<size_t>(idx_row)];
+        if(!add_tile_row(tiles, native, m_coord, row, range.left, range.right, m_stats))
+        {
+          return;
+        }
+        nbr_done += nbr_cols;
+        if(nbr_done - nbr_reported >= 64 * 1024)
+        {
+          nbr_reported = nbr_done;
+          if(!progress(nbr_done, nbr_total))
+          {
+            m_result = 1;
+            return;
+          }
+        }
+      }
+    }
+    if(!m_rows.empty())
+    {
+      idx_rows += static_cast<size_t>(nbr_rows);
+    }
+  }
+  m_result = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::stop_stats
+//stop the statistics jobs of the windows of 'item_data', before its buffer is reallocated or freed
+///////////////////////////////////////////////////////////////////////////////////////
+
+void MainWindow::stop_stats(ItemData *item_data)
+{
+  QList<QMdiSubWindow *> list = m_mdi_area->subWindowList();
+  for(int idx = 0; idx < list.size(); idx++)
+  {
+    ChildWindow *window = qobject_cast<ChildWindow *>(list.at(idx)->widget());
+    if(window && window->m_item_data == item_data)
+    {
+      window->stop_stats();
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//DerivedDialog
+//name and expression of a derived variable
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class DerivedDialog : public QDialog
+{
+public:
+  DerivedDialog(QWidget *parent) : QDialog(parent)
+  {
+    setWindowTitle(tr("New derived variable"));
+    m_edit_name = new QLineEdit;
+    m_edit_expression = new QLineEdit;
+    m_edit_expression->setMinimumWidth(320);
+    m_edit_expression->setToolTip(tr("Datasets of the root group by name, others by path in braces: sqrt(u*u+v*v), {/grid/T} - 273.15"));
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+    connect(buttons, SIGNAL(accepted()), this, SLOT(accept()));
+    connect(buttons, SIGNAL(rejected()), this, SLOT(reject()));
+    QFormLayout *layout = new QFormLayout;
+    layout->addRow(tr("Name"), m_edit_name);
+    layout->addRow(tr("Expression"), m_edit_expression);
+    layout->addRow(buttons);
+    setLayout(layout);
+  }
+
+  QString name() const
+  {
+    return m_edit_name->text().trimmed();
+  }
+
+  QString expression() const
+  {
+    return m_edit_expression->text();
+  }
+
+private:
+  QLineEdit *m_edit_name;
+  QLineEdit *m_edit_expression;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::add_derived
+//a derived variable is a child of the file item, after the objects of the file; it has the
+//dimensions of its datasets and its values are double; nothing is read until a grid shows it
+///////////////////////////////////////////////////////////////////////////////////////
+
+void MainWindow::add_derived(QTreeWidgetItem *root_item)
+{
+  ItemData *root_data = get_item_data(root_item);
+  DerivedDialog dialog(this);
+  h5expr_t expr;
+  std::vector<hsize_t> dim;
+  QString name;
+
+  for(;;)
+  {
+    if(dialog.exec() != QDialog::Accepted)
+    {
+      return;
+    }
+    name = dialog.name();
+    std::string error;
+    if(name.isEmpty())
+    {
+      QMessageBox::warning(this, tr(app_name), tr("The derived variable has no name"));
+      continue;
+    }
+    bool exists = false;
+    for(int idx = 0; idx < root_item->childCount(); idx++)
+    {
+      if(root_item->child(idx)->text(0) == name)
+        exists = true;
+    }
+    if(exists)
+    {
+      QMessageBox::warning(this, tr(app_name), tr("%1 already exists").arg(name));
+      continue;
+    }
+    if(!expr.compile(dialog.expression().toStdString(), error))
+    {
+      QMessageBox::warning(this, tr(app_name), tr("Invalid expression: %1").arg(error.c_str()));
+      continue;
+    }
+    if(expr.m_variables.empty())
+    {
+      QMessageBox::warning(this, tr(app_name), tr("The expression has no dataset"));
+      continue;
+    }
+
+    //numeric datasets of the same dimensions
+    QString invalid;
+    for(size_t idx = 0; idx < expr.m_variables.size() && invalid.isEmpty(); idx++)
+    {
+      h5slab_t slab;
+      int result;
+      H5E_BEGIN_TRY
+      {
+        result = slab.open(root_data->m_file_name.c_str(), expr.m_variables[idx].c_str());
+      }
+      H5E_END_TRY;
+      if(result < 0 || slab.m_native == H5NATIVE_NONE)
+      {
+        invalid = tr("%1 is not a numeric dataset").arg(expr.m_variables[idx].c_str());
+      }
+      else if(idx == 0)
+      {
+        dim = slab.m_dim;
+      }
+      else if(slab.m_dim != dim)
+      {
+        invalid = tr("%1 and %2 have different dimensions").arg(expr.m_variables[0].c_str()).arg(expr.m_variables[idx].c_str());
+      }
+    }
+    if(invalid.isEmpty())
+    {
+      break;
+    }
+    QMessageBox::warning(this, tr(app_name), invalid);
+  }
+
+  hdf_dataset_t *dataset = new hdf_dataset_t(name.toStdString().c_str(), dim, sizeof(double), H5T_SGN_NONE, H5T_FLOAT);
+  ItemData *item_data = new ItemData(ItemData::Derived, root_data->m_file_name, name.toStdString(), dataset);
+  item_data->m_expr = expr;
+  QTreeWidgetItem *item = new QTreeWidgetItem();
+  QVariant data;
+  item->setText(0, name);
+  item->setToolTip(0, QString::fromStdString(expr.m_text));
+  item->setIcon(0, m_icon_dataset);
+  QFont font = item->font(0);
+  font.setItalic(true);
+  item->setFont(0, font);
+  data.setValue(item_data);
+  item->setData(0, Qt::UserRole, data);
+  root_item->addChild(item);
+  m_tree->setCurrentItem(item);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::remove_item
+///////////////////////////////////////////////////////////////////////////////////////
+
+void MainWindow::remove_item(QTreeWidgetItem *item)
+{
+  release_item(item);
+  delete item;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::resolve_link
+//lists the target of a link item: a group gets the items of its links, each group among them a
+//link item listed in turn when it is expanded; a dataset makes the item its own
+///////////////////////////////////////////////////////////////////////////////////////
+
+void MainWindow::resolve_link(QTreeWidgetItem *item)
+{
+  ItemData *item_data = get_item_data(item);
+  if(item_data == NULL || item_data->m_kind != ItemData::Link || item_data->m_resolved)
+  {
+    return;
+  }
+
+  h5scan_t scan;
+  std::string target_file;
+  QApplication::setOverrideCursor(Qt::WaitCursor);
+  int result = scan.resolve(item_data->m_file_name, item_data->m_link, target_file);
+  QApplication::restoreOverrideCursor();
+  item_data->m_resolved = true;
+  if(result < 0)
+  {
+    item->setChildIndicatorPolicy(QTreeWidgetItem::DontShowIndicator);
+    item->setText(0, tr("%1 (not found)").arg(item_data->m_item_nm.c_str()));
+    statusBar()->showMessage(tr("Cannot find the target of %1").arg(item_data->m_item_nm.c_str()));
+    return;
+  }
+
+  const h5entry_t &target = scan.m_entries[0];
+  if(target.m_kind == ENTRY_DATASET)
+  {
+    QTreeWidgetItem *target_item = new_item(target, target_file);
+    ItemData *target_data = get_item_data(target_item);
+    target_data->m_item_nm = item_data->m_item_nm;
+    target_data->m_linked = item_data->m_linked;
+    item->setData(0, Qt::UserRole, target_item->data(0, Qt::UserRole));
+    item->setIcon(0, target_item->icon(0));
+    target_item->setData(0, Qt::UserRole, QVariant());
+    delete target_item;
+    delete item_data;
+  }
+  else
+  {
+    item->setIcon(0, m_icon_group);
+    item_data->m_file_name = target_file;
+    item_data->m_link = h5link_t();
+    item_data->m_link.m_path = target.m_path;
+  }
+
+  QList<QTreeWidgetItem*> children;
+  for(size_t idx = 1; idx < scan.m_entries.size(); idx++)
+  {
+    h5entry_t entry = scan.m_entries[idx];
+    if(entry.m_kind == ENTRY_GROUP)
+    {
+      entry.m_kind = ENTRY_LINK;
+      entry.m_link = h5link_t();
+      entry.m_link.m_path = entry.m_path;
+    }
+    QTreeWidgetItem *child = new_item(entry, target_file);
+    get_item_data(child)->m_linked = true;
+    children.append(child);
+  }
+  item->setChildIndicatorPolicy(QTreeWidgetItem::DontShowIndicatorWhenChildless);
+  item->addChildren(children);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//AggregateDialog
+//files, dataset and dimension of an aggregate
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class AggregateDialog : public QDialog
+{
+public:
+  AggregateDialog(QWidget *parent, const QString &pattern) : QDialog(parent)
+  {
+    setWindowTitle(tr("Aggregate files"));
+    m_edit_pattern = new QLineEdit(pattern);
+    m_edit_pattern->setMinimumWidth(320);
+    m_edit_pattern->setToolTip(tr("A directory, for all its HDF files, or a wildcard such as /data/day_*.h5"));
+    m_edit_path = new QLineEdit;
+    m_combo_dim = new QComboBox;
+    m_combo_dim->addItem(tr("New first dimension, one index per file"));
+    m_combo_dim->addItem(tr("Existing first dimension, files end to end"));
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+    connect(buttons, SIGNAL(accepted()), this, SLOT(accept()));
+    connect(buttons, SIGNAL(rejected()), this, SLOT(reject()));
+    QFormLayout *layout = new QFormLayout;
+    layout->addRow(tr("Files"), m_edit_pattern);
+    layout->addRow(tr("Dataset"), m_edit_path);
+    layout->addRow(tr("Along"), m_combo_dim);
+    layout->addRow(buttons);
+    setLayout(layout);
+  }
+
+  QString pattern() const
+  {
+    return m_edit_pattern->text().trimmed();
+  }
+
+  QString path() const
+  {
+    return m_edit_path->text().trimmed();
+  }
+
+  bool stack() const
+  {
+    return m_combo_dim->currentIndex() == 0;
+  }
+
+private:
+  QLineEdit *m_edit_pattern;
+  QLineEdit *m_edit_path;
+  QComboBox *m_combo_dim;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////
+//AggregateThread::AggregateThread
+///////////////////////////////////////////////////////////////////////////////////////
+
+AggregateThread::AggregateThread(QObject *parent, const QString &pattern, const std::vector<std::string> &file_names,
+  const std::string &path, bool stack) :
+ProgressThread(parent),
+m_pattern(pattern),
+m_file_names(file_names),
+m_path(path),
+m_stack(stack)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//AggregateThread::run
+///////////////////////////////////////////////////////////////////////////////////////
+
+void AggregateThread::run()
+{
+  m_result = m_aggregate.open(m_file_names, m_path, m_stack, this);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::aggregate_files
+//the files of a directory, or matching a wildcard in the last component, in name order
+///////////////////////////////////////////////////////////////////////////////////////
+
+void MainWindow::aggregate_files()
+{
+  QString pattern = m_str_current_file.isEmpty() ? QString() : QFileInfo(m_str_current_file).absolutePath();
+  AggregateDialog dialog(this, pattern);
+  if(dialog.exec() != QDialog::Accepted || dialog.pattern().isEmpty() || dialog.path().isEmpty())
+  {
+    return;
+  }
+
+  pattern = dialog.pattern();
+  QFileInfo info(pattern);
+  QDir dir;
+  QStringList filters;
+  if(info.isDir())
+  {
+    dir = QDir(pattern);
+    filters << "*.h5" << "*.hdf5" << "*.he5" << "*.nc";
+  }
+  else
+  {
+    dir = info.dir();
+    filters << info.fileName();
+  }
+  QStringList names = dir.entryList(filters, QDir::Files, QDir::Name);
+  if(names.isEmpty())
+  {
+    QMessageBox::warning(this, tr(app_name), tr("No file matches %1").arg(pattern));
+    return;
+  }
+  std::vector<std::string> file_names;
+  for(int idx = 0; idx < names.size(); idx++)
+  {
+    file_names.push_back(dir.absoluteFilePath(names.at(idx)).toStdString());
+  }
+
+  std::string path = dialog.path().toStdString();
+  if(path[0] != '/')
+  {
+    path = "/" + path;
+  }
+  AggregateThread *thread = new AggregateThread(this, pattern, file_names, path, dialog.stack());
+  start_thread(thread, tr("Opening %1 files...").arg(names.size()), SLOT(aggregate_finished()));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//MainWindow::aggregate_finished
+//the aggregate is a top level item of the tree, and opens in a grid
+///////////////////////////////////////////////////////////////////////////////////////
+
+void MainWindow::aggregate_finished()
+{
+  AggregateThread *thread = qobject_cast<AggregateThread *>(sender());
+  if(thread == NULL)
+  {
+    return;
+  }
+
+  if(thread->m_result == 0)
+  {
+    const h5aggregate_t &aggregate = thread->m_aggregate;
+    hdf_dataset_t *dataset = new hdf_dataset_t(aggregate.m_path.c_str(), aggregate.m_dim, aggregate.m_datatype_size,
+      aggregate.m_datatype_sign, aggregate.m_datatype_class);
+    QString name = QString("%1 (%2 files)").arg(aggregate.m_path.c_str()).arg(aggregate.m_file_names.size());
+    ItemData *item_data = new ItemData(ItemData::Aggregate, thread->m_pattern.toStdString(), name.toStdString(), dataset);
+    item_data->m_aggregate = aggregate;
+
+    QTreeWidgetItem *item = new QTreeWidgetItem(m_tree);
+    QVariant data;
+    item->setText(0, name);
+    item->setToolTip(0, thread->m_pattern);
+    item->setIcon(0, m_icon_dataset);
+    QFont font = item->font(0);
+    font.setItalic(true);
+    item->setFont(0, font);
+    data.setValue(item_data);
+    item->setData(0, Qt::UserRole, data);
+    m_tree->setCurrentItem(item);
+    add_table(item_data);
+  }
+  else if(thread->m_result < 0)
+  {
+    QMessageBox::warning(this, tr(app_name), tr("Cannot aggregate %1 of %2: a file cannot be read, or its dataset differs from the first one")
+      .arg(thread->m_path.c_str()).arg(thread->m_pattern));
+  }
+  statusBar()->showMessage(tr("Ready"));
+  thread->deleteLater();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//HistogramChart
+//bars of the bins; the tooltip of a bar has its range and count
+///////////////////////////////////////////////////////////////////////////////////////
+
+class HistogramChart : public QWidget
+{
+public:
+  HistogramChart(QWidget *parent) :
+    QWidget(parent),
+    m_lo(0),
+    m_hi(0)
+  {
+    setMinimumSize(200, 120);
+    setMouseTracking(true);
+  }
+
+  std::vector<hsize_t> m_bins;
+  double m_lo;
+  double m_hi;
+
+protected:
+  QRect plot_area() const
+  {
+    int left = fontMetrics().width("000000000") + 8;
+    int bottom = fontMetrics().height() + 8;
+    return QRect(left, 8, std::max(1, width() - left - 12), std::max(1, height() - bottom - 8));
+  }
+
+  void paintEvent(QPaintEvent *)
+  {
+    QPainter painter(this);
+    QRect area = plot_area();
+    painter.fillRect(rect(), palette().base());
+    painter.setPen(palette().color(QPalette::Text));
+    painter.drawRect(area.adjusted(0, 0, -1, -1));
+    hsize_t max_count = 0;
+    for(size_t idx = 0; idx < m_bins.size(); idx++)
+    {
+      max_count = std::max(max_count, m_bins[idx]);
+    }
+    if(max_count == 0)
+    {
+      painter.drawText(area, Qt::AlignCenter, tr("No values"));
+      return;
+    }
+
+    int text_height = fontMetrics().height();
+    painter.drawText(QRect(0, area.top(), area.left() - 4, text_height), Qt::AlignRight,
+      QString::number(static_cast<qulonglong>(max_count)));
+    painter.drawText(QRect(0, area.bottom() - text_height, area.left() - 4, text_height), Qt::AlignRight, "0");
+    painter.drawText(QRect(area.left(), area.bottom() + 4, area.width(), text_height), Qt::AlignLeft, QString::number(m_lo, 'g', 6));
+    painter.drawText(QRect(area.left(), area.bottom() + 4, area.width(), text_height), Qt::AlignRight, QString::number(m_hi, 'g', 6));
+
+    double width = static_cast<double>(area.width()) / m_bins.size();
+    for(size_t idx = 0; idx < m_bins.size(); idx++)
+    {
+      double height = static_cast<double>(m_bins[idx]) / max_count * (area.height() - 1);
+      QRectF bar(area.left() + idx * width, area.bottom() - height, std::max(1.0, width - (width > 4 ? 1 : 0)), height);
+      painter.fillRect(bar, palette().color(QPalette::Highlight));
+    }
+  }
+
+  void mouseMoveEvent(QMouseEvent *event)
+  {
+    QRect area = plot_area();
+    if(m_bins.empty() || !area.contains(event->pos()))
+    {
+      QToolTip::hideText();
+      return;
+    }
+    size_t idx = static_cast<size_t>(static_cast<double>(event->pos().x() - area.left()) / area.width() * m_bins.size());
+    idx = std::min(idx, m_bins.size() - 1);
+    double width = (m_hi - m_lo) / m_bins.size();
+    QToolTip::showText(event->globalPos(), QString("[%1, %2]: %3").arg(m_lo + idx * width, 0, 'g', 6)
+      .arg(m_lo + (idx + 1) * width, 0, 'g', 6).arg(static_cast<qulonglong>(m_bins[idx])), this);
+  }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////
+//HistogramWindow::HistogramWindow
+///////////////////////////////////////////////////////////////////////////////////////
+
+HistogramWindow::HistogramWindow(QWidget *parent, h5histogram_t *histogram) :
+QMainWindow(parent),
+m_histogram(histogram)
+{
+  setAttribute(Qt::WA_DeleteOnClose);
+  m_chart = new HistogramChart(this);
+  setCentralWidget(m_chart);
+
+  QToolBar *tool_bar = addToolBar("Bins");
+  tool_bar->addWidget(new QLabel(tr("Bins ")));
+  m_spin_bins = new QSpinBox(this);
+  m_spin_bins->setRange(1, 4096);
+  m_spin_bins->setValue(m_histogram->m_integer ? std::min(100, static_cast<int>(m_histogram->m_max - m_histogram->m_min) + 1) : 100);
+  tool_bar->addWidget(m_spin_bins);
+  tool_bar->addWidget(new QLabel(tr(" Range ")));
+  m_edit_min = new QLineEdit(QString::number(m_histogram->m_min, 'g', 10), this);
+  m_edit_min->setValidator(new QDoubleValidator(this));
+  tool_bar->addWidget(m_edit_min);
+  m_edit_max = new QLineEdit(QString::number(m_histogram->m_max, 'g', 10), this);
+  m_edit_max->setValidator(new QDoubleValidator(this));
+  tool_bar->addWidget(m_edit_max);
+  connect(m_spin_bins, SIGNAL(valueChanged(int)), this, SLOT(rebin()));
+  connect(m_edit_min, SIGNAL(editingFinished()), this, SLOT(rebin()));
+  connect(m_edit_max, SIGNAL(editingFinished()), this, SLOT(rebin()));
+
+  QString counts = tr("%1 elements").arg(static_cast<qulonglong>(m_histogram->m_nbr_elements));
+  if(m_histogram->m_nbr_nan)
+  {
+    counts += tr(", %1 NaN").arg(static_cast<qulonglong>(m_histogram->m_nbr_nan));
+  }
+  if(m_histogram->m_has_fill)
+  {
+    counts += tr(", %1 fill (%2)").arg(static_cast<qulonglong>(m_histogram->m_nbr_fill)).arg(m_histogram->m_fill);
+  }
+  statusBar()->showMessage(counts);
+  resize(640, 360);
+  rebin();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//HistogramWindow::~HistogramWindow
+///////////////////////////////////////////////////////////////////////////////////////
+
+HistogramWindow::~HistogramWindow()
+{
+  delete m_histogram;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//HistogramWindow::rebin
+///////////////////////////////////////////////////////////////////////////////////////
+
+void HistogramWindow::rebin()
+{
+  bool ok_min;
+  bool ok_max;
+  double lo = m_edit_min->text().toDouble(&ok_min);
+  double hi = m_edit_max->text().toDouble(&ok_max);
+  if(!ok_min || !ok_max || hi < lo)
+  {
+    lo = m_histogram->m_min;
+    hi = m_histogram->m_max;
+  }
+  //integer bins are centered on the values
+  if(m_histogram->m_integer)
+  {
+    lo -= 0.5;
+    hi += 0.5;
+  }
+  m_histogram->rebin(lo, hi, static_cast<size_t>(m_spin_bins->value()), m_chart->m_bins);
+  m_chart->m_lo = lo;
+  m_chart->m_hi = hi;
+  m_chart->update();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//LayerModel
+//layers of one dimension for the toolbar combo: the index, and the dimension scale value
+//if there is one; items are made when the combo shows them, not for the whole dimension
+///////////////////////////////////////////////////////////////////////////////////////
+
+class LayerModel : public QAbstractListModel
+{
+public:
+  LayerModel(QObject *parent, ChildWindow *window, hdf_dataset_t *dataset, size_t dim) :
+    QAbstractListModel(parent),
+    m_window(window),
+    m_dataset(dataset),
+    m_dim(dim),
+    m_nbr_rows(static_cast<int>(dataset->m_dim[dim]))
+  {
+  }
+
+  int rowCount(const QModelIndex &parent = QModelIndex()) const
+  {
+    return parent.isValid() ? 0 : m_nbr_rows;
+  }
+
+  QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const
+  {
+    if(role != Qt::DisplayRole || !index.isValid())
+    {
+      return QVariant();
+    }
+    std::string label = m_window->m_scales.label(m_dim, index.row());
+    const ItemData *item_data = m_window->m_item_data;
+    if(m_dim == 0 && item_data->m_kind == ItemData::Aggregate)
+    {
+      //the file of the layer
+      const h5aggregate_t &aggregate = item_data->m_aggregate;
+      label = last_component(aggregate.m_file_names[aggregate.file_of(index.row())].c_str()).toStdString();
+    }
+    if(label.empty())
+    {
+      return QString::number(index.row() + 1);
+    }
+    return QString("%1 (%2)").arg(index.row() + 1).arg(QString::fromUtf8(label.c_str()));
+  }
+
+  //layers appended or removed (follow mode)
+  void extent_changed()
+  {
+    int nbr_rows = static_cast<int>(m_dataset->m_dim[m_dim]);
+    if(nbr_rows > m_nbr_rows)
+    {
+      beginInsertRows(QModelIndex(), m_nbr_rows, nbr_rows - 1);
+      m_nbr_rows = nbr_rows;
+      endInsertRows();
+    }
+    else if(nbr_rows < m_nbr_rows)
+    {
+      beginRemoveRows(QModelIndex(), nbr_rows, m_nbr_rows - 1);
+      m_nbr_rows = nbr_rows;
+      endRemoveRows();
+    }
+  }
+
+private:
+  ChildWindow *m_window;
+  hdf_dataset_t *m_dataset;
+  size_t m_dim;
+  int m_nbr_rows;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////
+//ChildWindow::ChildWindow
+///////////////////////////////////////////////////////////////////////////////////////
+
+ChildWindow::ChildWindow(QWidget *parent, ItemData *item_data) :
+QMainWindow(parent),
+m_item_data(item_data),
+m_main_window(qobject_cast<MainWindow *>(parent)),
+m_follow_timer(NULL),
+m_own_item_data(item_data->m_kind == ItemData::Difference),
+m_dataset(item_data->m_dataset)
+{
+  QString str;
   str.sprintf(" : %s", item_data->m_item_nm.c_str());
   this->setWindowTitle(last_component(item_data->m_file_name.c_str()) + str);
 
+  if((item_data->m_kind == ItemData::Variable || item_data->m_kind == ItemData::Difference) && m_dataset->m_dim.size() > 0)
+  {
+    m_scales.open(item_data->m_file_name.c_str(), m_dataset->m_path.c_str());
+  }
+  else if(item_data->m_kind == ItemData::Derived && m_dataset->m_dim.size() > 0)
+  {
+    //the scales of the first dataset of the expression, which all have its dimensions
+    m_scales.open(item_data->m_file_name.c_str(), item_data->m_expr.m_variables[0].c_str());
+  }
+
   //currently selected layers for dimensions greater than two are the first layer
   if(m_dataset->m_dim.size() > 2)
   {
@@ -1736,23 +6796,16 @@ m_dataset(item_data->m_dataset)
     m_tool_bar->addAction(action_previous);
 
     ///////////////////////////////////////////////////////////////////////////////////////
-    //add combo box with layers, fill with possible coordinate variables and store combo in vector 
+    //add combo box with layers, labeled with the dimension scale if any, and store combo in vector 
     ///////////////////////////////////////////////////////////////////////////////////////
 
     QComboBox *combo = new QComboBox;
     QFont font = combo->font();
     font.setPointSize(9);
     combo->setFont(font);
-    QStringList list;
-
-    for(unsigned int idx = 0; idx < m_dataset->m_dim[idx_dmn]; idx++)
-    {
-      str.sprintf("%u", idx + 1);
-      list.append(str);
-    }
-
-
-    combo->addItems(list);
+    combo->setModel(new LayerModel(combo, this, m_dataset, idx_dmn));
+    combo->setSizeAdjustPolicy(QComboBox::AdjustToMinimumContentsLength);
+    combo->setMinimumContentsLength(12);
     connect(combo, SIGNAL(currentIndexChanged(int)), signal_mapper_combo, SLOT(map()));
     signal_mapper_combo->setMapping(combo, idx_dmn);
     m_tool_bar->addWidget(combo);
@@ -1762,6 +6815,20 @@ m_dataset(item_data->m_dataset)
 
 }
 
+///////////////////////////////////////////////////////////////////////////////////////
+//ChildWindow::~ChildWindow
+///////////////////////////////////////////////////////////////////////////////////////
+
+ChildWindow::~ChildWindow()
+{
+  //the grid is deleted after the item data
+  stop_stats();
+  if(m_own_item_data)
+  {
+    delete m_item_data;
+  }
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////
 //ChildWindow::previous_layer
 ///////////////////////////////////////////////////////////////////////////////////////
@@ -1776,6 +6843,8 @@ void ChildWindow::previous_layer(int idx_layer)
   }
   QComboBox *combo = m_vec_combo.at(idx_layer);
   combo->setCurrentIndex(m_layer[idx_layer]);
+  m_model->clear_order();
+  update_heat_map();
   m_model->data_changed();
   update();
 
@@ -1795,6 +6864,8 @@ void ChildWindow::next_layer(int idx_layer)
   }
   QComboBox *combo = m_vec_combo.at(idx_layer);
   combo->setCurrentIndex(m_layer[idx_layer]);
+  m_model->clear_order();
+  update_heat_map();
   m_model->data_changed();
   update();
 
@@ -1808,8 +6879,468 @@ void ChildWindow::combo_layer(int idx_layer)
 {
   QComboBox *combo = m_vec_combo.at(idx_layer);
   m_layer[idx_layer] = combo->currentIndex();;
+  m_model->clear_order();
+  update_heat_map();
   m_model->data_changed();
   update();
 }
 
+///////////////////////////////////////////////////////////////////////////////////////
+//ChildWindow::goto_cell
+//layers are the dimensions before the last two
+///////////////////////////////////////////////////////////////////////////////////////
+
+void ChildWindow::goto_cell(const std::vector<hsize_t> &coord)
+{
+  for(size_t idx_layer = 0; idx_layer < m_layer.size() && idx_layer < coord.size(); idx_layer++)
+  {
+    //combo_layer updates m_layer and the model
+    m_vec_combo.at(idx_layer)->setCurrentIndex(static_cast<int>(coord[idx_layer]));
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//ChildWindow::get_selection
+///////////////////////////////////////////////////////////////////////////////////////
+
+void ChildWindow::get_selection(std::vector<hsize_t> &start, std::vector<hsize_t> &count)
+{
+  start.assign(m_dataset->m_dim.size(), 0);
+  count = m_dataset->m_dim;
+  for(size_t idx_layer = 0; idx_layer < m_layer.size(); idx_layer++)
+  {
+    start[idx_layer] = m_layer[idx_layer];
+    count[idx_layer] = 1;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//ChildWindow::export_selection
+///////////////////////////////////////////////////////////////////////////////////////
+
+void ChildWindow::export_selection()
+{
+  std::vector<hsize_t> start;
+  std::vector<hsize_t> count;
+  if(m_item_data->m_kind != ItemData::Variable || m_main_window == NULL)
+  {
+    return;
+  }
+  get_selection(start, count);
+  m_main_window->add_export(m_item_data, start, count);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//ChildWindow::copy_selection
+///////////////////////////////////////////////////////////////////////////////////////
+
+void ChildWindow::copy_selection()
+{
+  std::vector<hsize_t> start;
+  std::vector<hsize_t> count;
+  if(m_item_data->m_kind != ItemData::Variable || m_main_window == NULL)
+  {
+    return;
+  }
+  get_selection(start, count);
+  m_main_window->add_copy(m_item_data, start, count);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//ChildWindow::plot_row
+//the row of the first selected cell, in the current layer
+///////////////////////////////////////////////////////////////////////////////////////
+
+void ChildWindow::plot_row()
+{
+  std::vector<hsize_t> start;
+  std::vector<hsize_t> count;
+  if(m_item_data->m_kind != ItemData::Variable || m_main_window == NULL || m_dataset->m_dim.size() < 2)
+  {
+    return;
+  }
+  get_selection(start, count);
+  size_t axis = start.size() - 1;
+  start[axis] = 0;
+  m_main_window->add_plot(m_item_data->m_file_name, m_dataset->m_path, start, axis);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//ChildWindow::plot_column
+///////////////////////////////////////////////////////////////////////////////////////
+
+void ChildWindow::plot_column()
+{
+  std::vector<hsize_t> start;
+  std::vector<hsize_t> count;
+  if(m_item_data->m_kind != ItemData::Variable || m_main_window == NULL || m_dataset->m_dim.size() < 1)
+  {
+    return;
+  }
+  get_selection(start, count);
+  size_t axis = start.size() == 1 ? 0 : start.size() - 2;
+  start[axis] = 0;
+  m_main_window->add_plot(m_item_data->m_file_name, m_dataset->m_path, start, axis);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//ChildWindow::histogram_selection
+///////////////////////////////////////////////////////////////////////////////////////
+
+void ChildWindow::histogram_selection()
+{
+  std::vector<hsize_t> start;
+  std::vector<hsize_t> count;
+  if(m_item_data->m_kind != ItemData::Variable || m_main_window == NULL)
+  {
+    return;
+  }
+  get_selection(start, count);
+  m_main_window->add_histogram(m_item_data->m_file_name, m_dataset->m_path, start, count);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//ChildWindow::physical_values
+///////////////////////////////////////////////////////////////////////////////////////
+
+void ChildWindow::physical_values(bool on)
+{
+  int result = m_model->set_physical(on);
+
+  //the values shown changed, and so did their ranges
+  m_model->m_heat_ranges.clear();
+  update_heat_map();
+  if(result == 1)
+  {
+    return;
+  }
+  QAction *action = qobject_cast<QAction *>(sender());
+  if(action)
+  {
+    action->setChecked(false);
+  }
+  if(result == 0 && m_main_window)
+  {
+    m_main_window->statusBar()->showMessage(tr("%1 has no scale_factor, add_offset, fill or missing value").arg(m_dataset->m_path.c_str()));
+  }
+  else if(result < 0)
+  {
+    QMessageBox::warning(this, tr(app_name), tr("Cannot open %1").arg(m_dataset->m_path.c_str()));
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//ChildWindow::sort_column
+//the order is that of the current layer; changing the layer shows the rows in dataset order
+///////////////////////////////////////////////////////////////////////////////////////
+
+void ChildWindow::sort_column(hsize_t col)
+{
+  std::vector<hsize_t> start;
+  std::vector<hsize_t> count;
+  std::vector<char> values;
+  if(m_item_data->m_kind != ItemData::Variable || m_main_window == NULL || m_dataset->m_dim.size() == 0)
+  {
+    return;
+  }
+  if(get_native(m_dataset->m_datatype_class, m_dataset->m_datatype_size, m_dataset->m_datatype_sign) == H5NATIVE_NONE)
+  {
+    m_main_window->statusBar()->showMessage(tr("%1 is not numeric: it cannot be sorted").arg(m_dataset->m_path.c_str()));
+    return;
+  }
+  bool ascending = !(!m_model->m_order.empty() && m_model->m_sort_col == col && m_model->m_sort_ascending);
+  m_model->get_column(col, start, count, values);
+  m_main_window->add_sort(this, ++m_model->m_sort_id, col, ascending, start, count, m_model->m_tiles.m_physical, values);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//ChildWindow::set_order
+//rows sorted by SortThread 'id'; dropped if the layer, the values or the extent changed meanwhile,
+//or if another sort was started
+///////////////////////////////////////////////////////////////////////////////////////
+
+void ChildWindow::set_order(unsigned long id, hsize_t col, bool ascending, std::vector<hsize_t> &order, std::vector<hsize_t> &inverse)
+{
+  if(id != m_model->m_sort_id || order.size() != m_model->m_nbr_rows)
+  {
+    return;
+  }
+  m_model->set_order(col, ascending, order, inverse);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//ChildWindow::order_changed
+//a selection of a sorted grid is not a hyperslab of the dataset: copy, export and histogram of it
+//are disabled while the rows are sorted
+///////////////////////////////////////////////////////////////////////////////////////
+
+void ChildWindow::order_changed()
+{
+  bool sorted = !m_model->m_order.empty();
+  for(int idx = 0; idx < m_selection_actions.size(); idx++)
+  {
+    m_selection_actions.at(idx)->setEnabled(!sorted);
+    m_selection_actions.at(idx)->setStatusTip(sorted ? tr("Not available while the rows are sorted, see Original order") : QString());
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//ChildWindow::original_order
+///////////////////////////////////////////////////////////////////////////////////////
+
+void ChildWindow::original_order()
+{
+  m_model->clear_order();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//ChildWindow::heat_map
+///////////////////////////////////////////////////////////////////////////////////////
+
+void ChildWindow::heat_map(bool on)
+{
+  if(on && get_native(m_dataset->m_datatype_class, m_dataset->m_datatype_size, m_dataset->m_datatype_sign) == H5NATIVE_NONE)
+  {
+    QAction *action = qobject_cast<QAction *>(sender());
+    if(action)
+    {
+      action->setChecked(false);
+    }
+    if(m_main_window)
+    {
+      m_main_window->statusBar()->showMessage(tr("%1 is not numeric: it has no heat map").arg(m_dataset->m_path.c_str()));
+    }
+    return;
+  }
+  m_model->m_heat_map = on;
+  if(on)
+  {
+    update_heat_map();
+  }
+  m_model->repaint();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//ChildWindow::update_heat_map
+//the range of each layer is computed once, the first time the layer is shown: from the buffer of a
+//loaded dataset, else by a RangeThread, the cells having no color meanwhile
+///////////////////////////////////////////////////////////////////////////////////////
+
+void ChildWindow::update_heat_map()
+{
+  std::vector<hsize_t> start;
+  std::vector<hsize_t> count;
+  if(!m_model->m_heat_map)
+  {
+    return;
+  }
+  ChildWindow::get_selection(start, count);
+  std::map<std::vector<hsize_t>, h5stats_t>::const_iterator it = m_model->m_heat_ranges.find(start);
+  if(it != m_model->m_heat_ranges.end())
+  {
+    m_model->set_heat_range(it->second);
+    return;
+  }
+
+  h5stats_t stats;
+  if(m_model->layer_stats(stats))
+  {
+    m_model->m_heat_ranges[start] = stats;
+    m_model->set_heat_range(stats);
+    return;
+  }
+
+  //no values until the thread is done, so that it is started once
+  m_model->m_heat_ranges[start] = stats;
+  m_model->set_heat_range(stats);
+  if(m_main_window)
+  {
+    m_main_window->add_range(this, start, count, m_model->m_tiles.m_physical);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//ChildWindow::set_heat_range
+///////////////////////////////////////////////////////////////////////////////////////
+
+void ChildWindow::set_heat_range(const std::vector<hsize_t> &start, bool physical, const h5stats_t *stats)
+{
+  if(physical != m_model->m_tiles.m_physical)
+  {
+    return;
+  }
+  if(stats == NULL)
+  {
+    //computed again the next time the layer is shown
+    m_model->m_heat_ranges.erase(start);
+    return;
+  }
+  m_model->m_heat_ranges[start] = *stats;
+
+  std::vector<hsize_t> layer;
+  std::vector<hsize_t> count;
+  ChildWindow::get_selection(layer, count);
+  if(layer == start)
+  {
+    m_model->set_heat_range(*stats);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//ChildWindow::stop_stats
+///////////////////////////////////////////////////////////////////////////////////////
+
+void ChildWindow::stop_stats()
+{
+  if(m_model->m_view)
+  {
+    m_model->m_view->stop_stats();
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//ChildWindow::follow
+//follow mode: the dataset is polled for new data while the file is being written
+///////////////////////////////////////////////////////////////////////////////////////
+
+void ChildWindow::follow(bool on)
+{
+  if(!on)
+  {
+    if(m_follow_timer)
+    {
+      m_follow_timer->stop();
+    }
+    m_follow.close();
+    return;
+  }
+
+  if(m_follow.open(m_item_data->m_file_name.c_str(), m_dataset->m_path.c_str()) < 0)
+  {
+    QMessageBox::warning(this, tr(app_name), tr("Cannot open %1").arg(m_dataset->m_path.c_str()));
+    QAction *action = qobject_cast<QAction *>(sender());
+    if(action)
+    {
+      action->setChecked(false);
+    }
+    return;
+  }
+  if(m_follow_timer == NULL)
+  {
+    m_follow_timer = new QTimer(this);
+    connect(m_follow_timer, SIGNAL(timeout()), this, SLOT(poll_follow()));
+  }
+  m_follow_timer->start(follow_interval);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//ChildWindow::extent_changed
+//the layers past the new extent are dropped, and the current layer moves to the last one if it was
+//dropped
+///////////////////////////////////////////////////////////////////////////////////////
+
+void ChildWindow::extent_changed(const std::vector<hsize_t> &old_dim)
+{
+  for(size_t idx_dmn = 0; idx_dmn < m_vec_combo.size(); idx_dmn++)
+  {
+    hsize_t nbr_layers = m_dataset->m_dim[idx_dmn];
+    if(nbr_layers > 0 && static_cast<hsize_t>(m_layer[idx_dmn]) >= nbr_layers)
+    {
+      m_layer[idx_dmn] = static_cast<int>(nbr_layers - 1);
+    }
+    QComboBox *combo = m_vec_combo[idx_dmn];
+    combo->blockSignals(true);
+    static_cast<LayerModel*>(combo->model())->extent_changed();
+    combo->setCurrentIndex(m_layer[idx_dmn]);
+    combo->blockSignals(false);
+  }
+  m_model->extent_changed(old_dim);
+
+  //a loaded layer may have grown; the range of a layer read by tiles is kept, values past it get the end colors
+  if(m_dataset->m_buf != NULL && !m_model->m_tiles.m_physical)
+  {
+    m_model->m_heat_ranges.clear();
+    update_heat_map();
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//ChildWindow::poll_follow
+///////////////////////////////////////////////////////////////////////////////////////
+
+void ChildWindow::poll_follow()
+{
+  std::vector<hsize_t> dim = m_dataset->m_dim;
+  std::vector<hsize_t> old_dim = m_dataset->m_dim;
+  bool unloaded = false;
+  int result;
+
+  //the file is not kept open between polls, also for the tiles
+  m_model->m_tiles.close();
+
+  if((result = m_follow.poll(dim)) == 0)
+  {
+    return;
+  }
+  if(result > 0 && m_dataset->m_buf != NULL)
+  {
+    //the statistics jobs of the windows of the item may be reading the buffer
+    if(m_main_window)
+    {
+      m_main_window->stop_stats(m_item_data);
+    }
+    else
+    {
+      stop_stats();
+    }
+    hsize_t nbr_elements = 1;
+    for(size_t idx = 0; idx < dim.size(); idx++)
+    {
+      nbr_elements *= dim[idx];
+    }
+    if(m_dataset->m_datatype_size * nbr_elements > max_load_bytes)
+    {
+      //too large to stay loaded, as load_item would not have loaded it: the windows of the item
+      //read it by tiles from now on
+      free(m_dataset->m_buf);
+      m_dataset->m_buf = NULL;
+      unloaded = true;
+    }
+    else
+    {
+      result = m_follow.update(m_dataset->m_dim, dim, &m_dataset->m_buf);
+    }
+  }
+  if(result < 0)
+  {
+    m_follow_timer->stop();
+    m_follow.close();
+    if(m_main_window)
+    {
+      m_main_window->statusBar()->showMessage(tr("Follow of %1 stopped: cannot read").arg(m_dataset->m_path.c_str()));
+    }
+    return;
+  }
+  m_dataset->m_dim = dim;
+
+  //the dimensions and buffer are those of the item: all its windows show them
+  if(m_main_window)
+  {
+    m_main_window->extent_changed(m_item_data, old_dim);
+  }
+  else
+  {
+    extent_changed(old_dim);
+  }
 
+  if(m_main_window && unloaded)
+  {
+    m_main_window->statusBar()->showMessage(tr("%1 is now too large to be loaded: it is read by tiles")
+      .arg(m_dataset->m_path.c_str()));
+  }
+  else if(m_main_window)
+  {
+    m_main_window->statusBar()->showMessage(tr("%1: %2 elements read since follow started")
+      .arg(m_dataset->m_path.c_str()).arg(m_follow.m_nbr_read));
+  }
+}
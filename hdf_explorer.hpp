@@ -8,15 +8,43 @@
 #include <QtGui>
 #include <QIcon>
 #include <QMdiArea>
+#include <QElapsedTimer>
 #include <string>
 #include <vector>
 #include "hdf5.h"
-#include "visit.hpp"
+#include "scan.hpp"
+#include "search.hpp"
+#include "export.hpp"
+#include "layout.hpp"
+#include "report.hpp"
+#include "follow.hpp"
+#include "scales.hpp"
+#include "diff.hpp"
+#include "tile.hpp"
+#include "plot.hpp"
+#include "histogram.hpp"
+#include "http.hpp"
+#include "sort.hpp"
+#include "stats.hpp"
 
 class MainWindow;
 class ItemData;
 class hdf_dataset_t;
 class TableModel;
+class ChildWindow;
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//grid_range_t
+//rectangle of cells of a grid, in grid rows and columns, bounds included
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct grid_range_t
+{
+  hsize_t top;
+  hsize_t left;
+  hsize_t bottom;
+  hsize_t right;
+};
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 //FileTreeWidget
@@ -31,17 +59,391 @@ public:
   private slots:
   void show_context_menu(const QPoint &);
   void add_grid();
+  void add_search();
+  void add_export();
+  void add_properties();
+  void add_report();
+  void add_compare();
+  void add_plot();
+  void add_histogram();
+  void add_derived();
+  void remove_item();
+  void cancel_scan();
+  void reload_file();
+  void expand_item(QTreeWidgetItem *item);
 
 public:
   void set_main_window(MainWindow *p)
   {
     m_main_window = p;
   }
+  void load_item(QTreeWidgetItem *);
+  void load_item_attribute(QTreeWidgetItem *);
 
 private:
   MainWindow *m_main_window;
-  void load_item(QTreeWidgetItem *);
-  void load_item_attribute(QTreeWidgetItem *);
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//ProgressThread
+//base of the worker threads of long operations
+//progress() is called by the HDF5 code in the worker thread and forwards a percentage to the GUI;
+//cancel() is connected to the QProgressDialog shown by MainWindow::start_thread
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class ProgressThread : public QThread, public h5progress_t
+{
+  Q_OBJECT
+public:
+  ProgressThread(QObject *parent);
+  bool progress(hsize_t done, hsize_t total);
+  int m_result; // return of the HDF5 operation
+
+  public slots:
+  void cancel();
+
+signals:
+  void progress_changed(int);
+
+protected:
+  QAtomicInt m_cancel;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//SearchThread
+//runs a h5search_t in a worker thread; results are read by MainWindow when the thread finishes
+//the dataset is named by file and path, as its tree item can be deleted by a reload meanwhile
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class SearchThread : public ProgressThread
+{
+  Q_OBJECT
+public:
+  SearchThread(QObject *parent, ItemData *item_data, h5predicate_t predicate, double value, double value_hi);
+
+  std::string m_file_name; // dataset searched
+  std::string m_path;
+  std::string m_item_nm;
+  h5predicate_t m_predicate;
+  double m_value;
+  double m_value_hi;
+  h5search_t m_search;
+
+protected:
+  void run();
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//ExportThread
+//runs a h5export_t in a worker thread
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class ExportThread : public ProgressThread
+{
+  Q_OBJECT
+public:
+  ExportThread(QObject *parent, ItemData *item_data, const std::vector<hsize_t> &start, const std::vector<hsize_t> &count,
+    h5format_t format, const QString &out_name);
+
+  std::string m_file_name; // dataset exported
+  std::string m_path;
+  std::vector<hsize_t> m_start; // selection, empty for all
+  std::vector<hsize_t> m_count;
+  h5format_t m_format;
+  QString m_out_name;
+  h5export_t m_export;
+
+protected:
+  void run();
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//CopyThread
+//formats a grid selection as TSV text in a worker thread, for the clipboard
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class CopyThread : public ProgressThread
+{
+  Q_OBJECT
+public:
+  CopyThread(QObject *parent, ItemData *item_data, const std::vector<hsize_t> &start, const std::vector<hsize_t> &count);
+
+  std::string m_file_name; // dataset copied
+  std::string m_path;
+  std::vector<hsize_t> m_start;
+  std::vector<hsize_t> m_count;
+  std::string m_text;
+  h5export_t m_export;
+
+protected:
+  void run();
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//ReportThread
+//runs a h5report_t on a whole file in a worker thread
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class ReportThread : public ProgressThread
+{
+  Q_OBJECT
+public:
+  ReportThread(QObject *parent, const std::string &file_name);
+
+  std::string m_file_name;
+  h5report_t m_report;
+
+protected:
+  void run();
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//CompareThread
+//runs a h5diff_t in a worker thread, comparing a tree item with an object of another (or the same) file
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class CompareThread : public ProgressThread
+{
+  Q_OBJECT
+public:
+  CompareThread(QObject *parent, QTreeWidgetItem *tree_item, const std::string &file_a, const std::string &path_a,
+    const std::string &file_b, const std::string &path_b);
+
+  QTreeWidgetItem *m_tree_item; // item compared
+  std::string m_file_a;
+  std::string m_path_a;
+  std::string m_file_b;
+  std::string m_path_b;
+  h5diff_t m_diff;
+
+protected:
+  void run();
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//DifferenceThread
+//computes the difference grid of two datasets compared, in a worker thread
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class DifferenceThread : public ProgressThread
+{
+  Q_OBJECT
+public:
+  DifferenceThread(QObject *parent, const QStringList &names, const std::vector<hsize_t> &coord);
+
+  QStringList m_names; // file and path of both datasets
+  std::vector<hsize_t> m_coord; // cell to show, empty for none
+  std::vector<hsize_t> m_dim;
+  void *m_buf; // malloc'ed, owned by the grid when done
+
+protected:
+  void run();
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//PlotThread
+//builds the envelope of a line of a dataset for a plot
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class PlotThread : public ProgressThread
+{
+  Q_OBJECT
+public:
+  PlotThread(QObject *parent, const std::string &file_name, const std::string &path,
+    const std::vector<hsize_t> &start, size_t axis);
+
+  std::string m_file_name;
+  std::string m_path;
+  std::vector<hsize_t> m_start;
+  size_t m_axis;
+  h5envelope_t *m_envelope; // owned by the plot when done
+
+protected:
+  void run();
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//HistogramThread
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class HistogramThread : public ProgressThread
+{
+  Q_OBJECT
+public:
+  HistogramThread(QObject *parent, const std::string &file_name, const std::string &path,
+    const std::vector<hsize_t> &start, const std::vector<hsize_t> &count);
+
+  std::string m_file_name;
+  std::string m_path;
+  std::vector<hsize_t> m_start; // empty for the whole dataset
+  std::vector<hsize_t> m_count;
+  h5histogram_t *m_histogram; // owned by the window when done
+
+protected:
+  void run();
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//SortThread
+//order of the rows of a grid by a column; the values of a loaded dataset are sorted without
+//reading, others are read from the file
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class SortThread : public ProgressThread
+{
+  Q_OBJECT
+public:
+  SortThread(QObject *parent, ChildWindow *window, unsigned long id, hsize_t col, bool ascending);
+
+  ChildWindow *m_window; // grid sorted
+  unsigned long m_id; // sort of the grid, applied if still the last one
+  hsize_t m_col; // grid column
+  bool m_ascending;
+  std::string m_file_name;
+  std::string m_path;
+  std::vector<hsize_t> m_start; // column in the current layer
+  std::vector<hsize_t> m_count;
+  bool m_physical;
+  std::vector<char> m_values; // loaded dataset: values of the column; empty to read them
+  h5native_t m_native; // of the values
+  h5sort_t m_sort;
+
+protected:
+  void run();
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//RangeThread
+//range of the values of a layer of a dataset, for the heat map of its grid
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class RangeThread : public ProgressThread
+{
+  Q_OBJECT
+public:
+  RangeThread(QObject *parent, ChildWindow *window, const std::vector<hsize_t> &start, const std::vector<hsize_t> &count,
+    bool physical);
+
+  ChildWindow *m_window; // grid colored
+  std::string m_file_name;
+  std::string m_path;
+  std::vector<hsize_t> m_start; // layer
+  std::vector<hsize_t> m_count;
+  bool m_physical;
+  h5stats_t m_stats;
+
+protected:
+  void run();
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//StatsThread
+//statistics of a large selection of a grid, one per grid and reused for each job; a selection read by
+//tiles is read with tiles of its own, as the grid tiles are used from the GUI thread only
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class StatsThread : public ProgressThread
+{
+  Q_OBJECT
+public:
+  StatsThread(QObject *parent, ItemData *item_data);
+
+  //start a job on the inputs set, the previous one being finished: the statistics are cleared
+  void start_job();
+
+  unsigned long m_id; // statistics of the grid the job is for
+  std::string m_file_name;
+  std::string m_path;
+  bool m_derived;
+  h5expr_t m_expr; // derived variable
+  bool m_aggregated;
+  h5aggregate_t m_aggregate; // aggregate
+  bool m_physical;
+  h5native_t m_native; // of the stored values
+  std::vector<hsize_t> m_coord; // layer, then row and column as the rank allows
+  std::vector<grid_range_t> m_ranges; // selection, in the grid
+  std::vector<hsize_t> m_rows; // sorted grid: dataset rows of the rows of each range in turn; else empty
+  const void *m_buf; // loaded layer, rows of 'm_nbr_cols' values; NULL to read tiles
+  size_t m_nbr_cols;
+  h5stats_t m_stats;
+
+protected:
+  void run();
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//AggregateThread
+//runs h5aggregate_t::open in a worker thread
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class AggregateThread : public ProgressThread
+{
+  Q_OBJECT
+public:
+  AggregateThread(QObject *parent, const QString &pattern, const std::vector<std::string> &file_names,
+    const std::string &path, bool stack);
+
+  QString m_pattern; // directory or wildcard the files were found with
+  std::vector<std::string> m_file_names;
+  std::string m_path;
+  bool m_stack;
+  h5aggregate_t m_aggregate;
+
+protected:
+  void run();
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//ScanThread
+//runs a h5scan_t in a worker thread; the entries found are handed to the GUI thread in batches:
+//batch_ready() is emitted when entries are added to an empty batch, and the GUI takes all the
+//entries pending when it handles it, so a slow GUI gets fewer, larger batches
+//when the tree is already filled, from the catalog cache or by a previous run ('m_verify'), the
+//thread only checks that the file did not change; if it did, it rescans the file reusing the
+//entries of the objects not changed (h5scan_t::rescan), without batches, and sets 'm_changed'
+//the thread of a file is kept after its scan, and restarted in this mode to reload the file
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class ScanThread : public ProgressThread
+{
+  Q_OBJECT
+public:
+  ScanThread(QObject *parent, const std::string &file_name, QTreeWidgetItem *root_item);
+  bool progress(hsize_t done, hsize_t total);
+
+  //entries found since the last call; returns the index of the first one
+  size_t take(std::vector<h5entry_t> &entries);
+
+  //load the catalog cache of the file, if it matches the file size and time; its entries are
+  //then taken as one batch and the thread runs in verify mode
+  bool load_cache();
+
+  //make all the entries of the scan pending again, to rebuild the tree (GUI thread)
+  void reset();
+
+  //check the file again and rescan it if it changed
+  void restart();
+
+  std::string m_file_name;
+  std::string m_cache_name; // catalog cache, empty for none
+  QTreeWidgetItem *m_root_item;
+  std::vector<QTreeWidgetItem*> m_items; // tree item of each entry taken (GUI thread)
+  h5scan_t m_scan;
+  bool m_verify;
+  bool m_changed;
+  bool m_complete; // the entries are those of a whole scan, not canceled
+
+signals:
+  void batch_ready();
+
+protected:
+  void run();
+
+private:
+  QMutex m_mutex;
+  std::vector<h5entry_t> m_batch; // entries not taken yet
+  size_t m_first; // index of the first entry of m_batch
+  size_t m_nbr_done; // entries moved to m_batch (worker thread)
 };
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -53,14 +455,62 @@ class MainWindow : public QMainWindow
   Q_OBJECT
 public:
   MainWindow();
-  void add_table(ItemData *item_data);
+  ChildWindow* add_table(ItemData *item_data);
   void add_image(ItemData *item_data);
+  void add_search(QTreeWidgetItem *item);
+  void add_export(ItemData *item_data, const std::vector<hsize_t> &start, const std::vector<hsize_t> &count);
+  void add_copy(ItemData *item_data, const std::vector<hsize_t> &start, const std::vector<hsize_t> &count);
+  void add_properties(QTreeWidgetItem *item);
+  void add_report(const std::string &file_name);
+  void add_compare(QTreeWidgetItem *item);
+  void add_plot(const std::string &file_name, const std::string &path, const std::vector<hsize_t> &start, size_t axis);
+  void add_histogram(const std::string &file_name, const std::string &path, const std::vector<hsize_t> &start,
+    const std::vector<hsize_t> &count);
+  void add_sort(ChildWindow *window, unsigned long id, hsize_t col, bool ascending, const std::vector<hsize_t> &start,
+    const std::vector<hsize_t> &count, bool physical, std::vector<char> &values);
+  void add_range(ChildWindow *window, const std::vector<hsize_t> &start, const std::vector<hsize_t> &count, bool physical);
+  void stop_stats(ItemData *item_data);
+  void add_derived(QTreeWidgetItem *root_item);
+  void remove_item(QTreeWidgetItem *item);
+  void resolve_link(QTreeWidgetItem *item);
+  void cancel_scan(QTreeWidgetItem *root_item);
+  void reload_file(QTreeWidgetItem *root_item);
+  bool is_scanning(QTreeWidgetItem *root_item);
   int read_file(QString file_name);
 
+  //open 'file_names' once the window is shown; 'timer' started with the program
+  void startup(const QStringList &file_names, const QElapsedTimer &timer);
+
+  //statistics of the selection of 'window' in the status bar, if it is the active window
+  void show_stats(ChildWindow *window);
+
+  //the dimensions and buffer of 'item_data' changed from 'old_dim' (follow mode): update all its windows
+  void extent_changed(ItemData *item_data, const std::vector<hsize_t> &old_dim);
+
   private slots:
   void open_recent_file();
   void open_file();
+  void open_url();
   void about();
+  void search_finished();
+  void search_result_clicked(QTreeWidgetItem *, int);
+  void export_finished();
+  void copy_finished();
+  void show_properties(QTreeWidgetItem *);
+  void report_finished();
+  void compare_finished();
+  void difference_finished();
+  void plot_finished();
+  void histogram_finished();
+  void sort_finished();
+  void range_finished();
+  void aggregate_files();
+  void aggregate_finished();
+  void scan_batch();
+  void scan_finished();
+  void reload();
+  void startup_deferred();
+  void window_activated(QMdiSubWindow *sub_window);
 
 private:
 
@@ -73,14 +523,22 @@ private:
   QMenu *m_menu_windows;
   QToolBar *m_tool_bar;
   QMdiArea *m_mdi_area;
+  QLabel *m_label_stats;
   FileTreeWidget *m_tree;
   QDockWidget *m_tree_dock;
+  QTreeWidget *m_search_tree;
+  QDockWidget *m_search_dock;
+  QTreeWidget *m_properties_tree;
+  QDockWidget *m_properties_dock;
 
   ///////////////////////////////////////////////////////////////////////////////////////
   //actions
   ///////////////////////////////////////////////////////////////////////////////////////
 
   QAction *m_action_open;
+  QAction *m_action_open_url;
+  QAction *m_action_reload;
+  QAction *m_action_aggregate;
   QAction *m_action_exit;
   QAction *m_action_about;
   QAction *m_action_tile;
@@ -116,13 +574,193 @@ private:
 
 private:
 
-  h5visit_t m_visit;
+  QList<ScanThread*> m_scans; // scan of each file open, running or kept to reload the file
+
+  //startup: files of the command line, and their scans until they end, timed from the start
+  QStringList m_startup_files;
+  QList<ScanThread*> m_startup_scans;
+  QElapsedTimer m_startup_timer;
+  bool m_startup_painted; // first paint of the window seen
+  bool m_startup_opened; // files of the command line opened
+  qint64 m_startup_shown; // ms from the start to the window on screen; -1 if not painted first
+  bool eventFilter(QObject *object, QEvent *event);
+
+  //scan of file 'file_name', the last one if it was opened again; NULL if none
+  ScanThread* find_scan(const std::string &file_name);
+
+  //tree item for an entry of a scan
+  QTreeWidgetItem* new_item(const h5entry_t &entry, const std::string &file_name);
+
+  //add the entries taken from a scan to the tree, with one insertion per parent item
+  void insert_entries(ScanThread *thread);
+
+  //after a rescan, update the items of the file in place: items of the entries reused are kept
+  //(with their expanded state and windows), the others are deleted or made
+  void update_items(ScanThread *thread);
+
+  //close the windows and search results of an item that is going to be deleted, delete its data
+  void release_item(QTreeWidgetItem *item);
+
+  //tree item of dataset 'path' of file 'file_name', NULL if it is not in the tree
+  QTreeWidgetItem* find_item(const std::string &file_name, const std::string &path);
+
+  //find grid window already open for a tree item
+  ChildWindow* find_window(ItemData *item_data);
+
+  //show the difference grid of two datasets compared, computing it if it is not open
+  //'names' are the file and path of both
+  void show_difference(const QStringList &names, const std::vector<hsize_t> &coord);
+
+  //start a worker thread with a progress dialog; 'slot_finished' is called when it ends
+  void start_thread(ProgressThread *thread, const QString &label, const char *slot_finished);
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//GridView
+//table view of a TableModel, whose grid can have more than 2^31 rows or columns: the model exposes
+//a page of the grid, as many rows and columns as the view shows (all of the same size), and the
+//scrollbars here move the page, so that showing row 10^10 costs the same as showing row 10
+//the scrollbars have int positions; past 2^30 rows or columns, one position is several of them
+//the selection and current cell are kept here in grid cells, whatever the page: clicks and keys
+//change them, and the part in the page is given to the selection model of the table to be drawn
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class GridView : public QWidget
+{
+  Q_OBJECT
+public:
+  GridView(QWidget *parent, TableModel *model);
+  ~GridView();
+
+  //move the page to show cell 'row', 'col' of the grid and make it current
+  void goto_cell(hsize_t row, hsize_t col);
+
+  //selected cells, in grid rows and columns; false if none
+  bool get_selection(std::vector<grid_range_t> &ranges) const;
+
+  //the grid grew or shrank (follow mode)
+  void extent_changed();
+
+  //the rows were sorted, or put back in dataset order
+  void order_changed();
+
+  //the selection, or the values of its cells (layer, order, physical values), changed: statistics
+  //computed again, here or by the StatsThread for a large selection
+  void update_stats();
+
+  //the statistics job is canceled; one reading the loaded buffer is waited for, as the buffer is to be
+  //reallocated or freed
+  void stop_stats();
+
+  QTableView *m_table;
+
+protected:
+  bool eventFilter(QObject *object, QEvent *event);
+
+  private slots:
+  void scroll_rows(int value);
+  void scroll_cols(int value);
+  void sort_section(int section);
+  void select_row(int section);
+  void run_stats();
+  void stats_finished();
+
+private:
+  TableModel *m_model;
+  QScrollBar *m_scroll_rows;
+  QScrollBar *m_scroll_cols;
+  h5stats_t m_stats; // of the selected cells, but those of 'm_stats_todo' and of the running job
+  std::vector<grid_range_t> m_stats_todo; // selected cells not added yet
+  unsigned long m_stats_id; // counted at each full recompute: the result of an older job is ignored
+  StatsThread *m_stats_thread; // created for the first large selection, then reused
+  bool m_stats_running; // until its finished signal is handled
+  bool m_stats_stopped; // by stop_stats: unknown until the next update_stats
+  QTimer *m_stats_timer; // a large selection is computed once it stops changing
+  std::vector<grid_range_t> m_selection; // the last one is extended by shift
+  hsize_t m_anchor_row; // cell the selection is extended from
+  hsize_t m_anchor_col;
+  hsize_t m_current_row; // current cell, if 'm_has_current'
+  hsize_t m_current_col;
+  bool m_has_current;
+  void add_stats(const std::vector<grid_range_t> &ranges);
+  void schedule_stats();
+  void show_stats();
+  void visible(hsize_t &nbr_rows, hsize_t &nbr_cols) const;
+  void update_page();
+  void set_first(hsize_t first_row, hsize_t first_col);
+  void scroll_by(hssize_t nbr_rows, hssize_t nbr_cols);
+  void show_selection();
+  void select_cell(hsize_t row, hsize_t col, Qt::KeyboardModifiers modifiers);
+  void select_range(const grid_range_t &range, Qt::KeyboardModifiers modifiers);
+  void ensure_visible(hsize_t row, hsize_t col);
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//PlotWidget
+//line plot of a line of a dataset, drawn from its envelope with one min/max bar per pixel, or the
+//points themselves when there are fewer than pixels; dragging zooms to a range, the wheel zooms
+//around the cursor, and the envelope refines as the range narrows
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class PlotWidget : public QWidget
+{
+  Q_OBJECT
+public:
+  PlotWidget(QWidget *parent, h5envelope_t *envelope);
+  ~PlotWidget();
+
+protected:
+  void paintEvent(QPaintEvent *event);
+  void mousePressEvent(QMouseEvent *event);
+  void mouseMoveEvent(QMouseEvent *event);
+  void mouseReleaseEvent(QMouseEvent *event);
+  void mouseDoubleClickEvent(QMouseEvent *event);
+  void wheelEvent(QWheelEvent *event);
+
+  private slots:
+  void reset_zoom();
+
+private:
+  h5envelope_t *m_envelope;
+  hsize_t m_first; // range shown
+  hsize_t m_last;
+  std::vector<double> m_min; // per pixel, of the range 'm_pixels_first', 'm_pixels_last' in 'm_nbr_pixels' pixels
+  std::vector<double> m_max;
+  hsize_t m_pixels_first;
+  hsize_t m_pixels_last;
+  size_t m_nbr_pixels;
+  bool m_read_error;
+  int m_drag_from; // x of a zoom drag, -1 if none
+  int m_drag_to;
+  QRect plot_area() const;
+  hsize_t element_at(int x) const;
+  void set_range(hsize_t first, hsize_t last);
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//HistogramWindow
+//histogram of a dataset or selection; the number of bins and the range are changed in the toolbar,
+//and the bins made again from the fine bins of the h5histogram_t
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class HistogramChart;
+
+class HistogramWindow : public QMainWindow
+{
+  Q_OBJECT
+public:
+  HistogramWindow(QWidget *parent, h5histogram_t *histogram);
+  ~HistogramWindow();
 
-  int iterate(const std::string& file_name, const std::string& grp_name, const hid_t loc_id, QTreeWidgetItem *tree_item_parent);
-  int get_attributes(const std::string& file_name, const std::string& grp_name, const hid_t loc_id, QTreeWidgetItem *tree_item_parent);
+  private slots:
+  void rebin();
 
-  //find object in list 
-  H5O_info_added_t* find_object(haddr_t addr);
+private:
+  h5histogram_t *m_histogram;
+  HistogramChart *m_chart;
+  QSpinBox *m_spin_bins;
+  QLineEdit *m_edit_min;
+  QLineEdit *m_edit_max;
 };
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -134,19 +772,64 @@ class ChildWindow : public QMainWindow
   Q_OBJECT
 public:
   ChildWindow(QWidget *parent, ItemData *item_data);
+  ~ChildWindow();
   std::vector<int> m_layer;  // current selected layer of a dimension > 2 
+  ItemData *m_item_data; // the tree item that generated this window
+  MainWindow *m_main_window;
+  h5scales_t m_scales; // axis labels of the dataset, if it has dimension scales
+  QString m_stats; // statistics of the selected cells, shown in the status bar
+
+  //select layers and show the cell with full dataset coordinates 'coord'
+  virtual void goto_cell(const std::vector<hsize_t> &coord);
+
+  //hyperslab of the dataset selected in the window (the current layer by default)
+  virtual void get_selection(std::vector<hsize_t> &start, std::vector<hsize_t> &count);
+
+  //sort the rows by grid column 'col' on a worker thread, ascending or reversing the current order
+  void sort_column(hsize_t col);
+  void set_order(unsigned long id, hsize_t col, bool ascending, std::vector<hsize_t> &order, std::vector<hsize_t> &inverse);
+
+  //the rows were sorted or put back in dataset order: the actions on the selection as a hyperslab
+  //are enabled in dataset order only
+  void order_changed();
+
+  //the dimensions of the dataset changed from 'old_dim', by the follow mode of this or another window
+  //of the item
+  void extent_changed(const std::vector<hsize_t> &old_dim);
+
+  //range of layer 'start' for the heat map, computed by a RangeThread with physical values or not;
+  //NULL if it could not be
+  void set_heat_range(const std::vector<hsize_t> &start, bool physical, const h5stats_t *stats);
+
+  //the statistics job of the grid is canceled, and waited for if it reads the loaded buffer
+  void stop_stats();
 
   private slots:
   void previous_layer(int);
   void next_layer(int);
   void combo_layer(int);
+  void export_selection();
+  void copy_selection();
+  void follow(bool);
+  void poll_follow();
+  void plot_row();
+  void plot_column();
+  void histogram_selection();
+  void physical_values(bool);
+  void original_order();
+  void heat_map(bool);
 
 private:
   QToolBar *m_tool_bar;
   std::vector<QComboBox *> m_vec_combo;
+  h5follow_t m_follow;
+  QTimer *m_follow_timer;
+  bool m_own_item_data; // difference grids own their item data; tree items may be deleted before their windows
+  void update_heat_map();
 
 protected:
   TableModel *m_model;
+  QList<QAction *> m_selection_actions; // copy, export and histogram of the selection
   hdf_dataset_t *m_dataset; // HDF variable to display (convenience pointer to data in ItemData)
 };
 
@@ -1,13 +1,13 @@
 TARGET = "hdf-explorer"
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
-HEADERS = hdf_explorer.hpp visit.hpp iterate.hpp
-SOURCES = hdf_explorer.cpp visit.cpp iterate.cpp
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets concurrent
+HEADERS = hdf_explorer.hpp visit.hpp iterate.hpp kernel.hpp slab.hpp chunk.hpp search.hpp export.hpp layout.hpp report.hpp scan.hpp follow.hpp scales.hpp diff.hpp tile.hpp plot.hpp histogram.hpp cf.hpp expr.hpp aggregate.hpp vds.hpp link.hpp http.hpp sort.hpp stats.hpp
+SOURCES = hdf_explorer.cpp visit.cpp iterate.cpp slab.cpp chunk.cpp search.cpp export.cpp layout.cpp report.cpp scan.cpp follow.cpp scales.cpp diff.cpp tile.cpp plot.cpp histogram.cpp cf.cpp expr.cpp aggregate.cpp vds.cpp link.cpp http.cpp sort.cpp stats.cpp
 RESOURCES = hdf_explorer.qrc
 ICON = sample.icns
 RC_FILE = hdf_explorer.rc
 
 unix:!macx {
- LIBS += -lhdf5
+ LIBS += -lhdf5_hl -lhdf5 -lcurl -lz
 }
 
 macx: {
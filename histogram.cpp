@@ -0,0 +1,411 @@
+#include <QtDebug>
+#include <limits>
+#include <cstring>
+#include "histogram.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//range_kernel_t
+//first pass, per range: min and max of the values, NaNs and fill values
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+struct range_kernel_t
+{
+  const T *m_buf;
+  bool m_has_fill;
+  T m_fill;
+  std::vector<double> m_min; // per range
+  std::vector<double> m_max;
+  std::vector<hsize_t> m_nbr_nan;
+  std::vector<hsize_t> m_nbr_fill;
+
+  void run(const h5range_t &range)
+  {
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+    hsize_t nbr_nan = 0;
+    hsize_t nbr_fill = 0;
+    for(size_t idx = range.begin; idx < range.end; idx++)
+    {
+      T value = m_buf[idx];
+      if(value != value)
+      {
+        nbr_nan++;
+        continue;
+      }
+      if(m_has_fill && value == m_fill)
+      {
+        nbr_fill++;
+        continue;
+      }
+      double value_ = static_cast<double>(value);
+      min = value_ < min ? value_ : min;
+      max = value_ > max ? value_ : max;
+    }
+    m_min[range.idx] = min;
+    m_max[range.idx] = max;
+    m_nbr_nan[range.idx] = nbr_nan;
+    m_nbr_fill[range.idx] = nbr_fill;
+  }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//fine_kernel_t
+//second pass, per range: count the values in the fine bins of the range
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+struct fine_kernel_t
+{
+  const T *m_buf;
+  bool m_has_fill;
+  T m_fill;
+  double m_fine_min;
+  double m_inv_width;
+  size_t m_nbr_fine;
+  std::vector<std::vector<hsize_t> > *m_bins; // per range
+
+  void run(const h5range_t &range)
+  {
+    hsize_t *bins = &(*m_bins)[range.idx][0];
+    size_t last = m_nbr_fine - 1;
+    for(size_t idx = range.begin; idx < range.end; idx++)
+    {
+      T value = m_buf[idx];
+      if(value != value || (m_has_fill && value == m_fill))
+      {
+        continue;
+      }
+      size_t bin = static_cast<size_t>((static_cast<double>(value) - m_fine_min) * m_inv_width);
+      bins[bin < last ? bin : last]++;
+    }
+  }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//histogram_block_t
+//functor for dispatch(): one pass over a block on the thread pool
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct histogram_block_t
+{
+  int m_pass;
+  const void *m_buf;
+  size_t m_nbr_elements;
+  const std::vector<char> *m_fill; // empty if none
+
+  //first pass, merged in
+  double *m_min;
+  double *m_max;
+  hsize_t *m_nbr_nan;
+  hsize_t *m_nbr_fill;
+
+  //second pass
+  double m_fine_min;
+  double m_inv_width;
+  size_t m_nbr_fine;
+  std::vector<std::vector<hsize_t> > *m_bins;
+
+  template <typename T>
+  void apply()
+  {
+    std::vector<h5range_t> ranges = make_ranges(m_nbr_elements, 64 * 1024);
+    bool has_fill = m_fill->size() == sizeof(T);
+    T fill = 0;
+    if(has_fill)
+    {
+      memcpy(&fill, &(*m_fill)[0], sizeof(T));
+    }
+
+    if(m_pass == 0)
+    {
+      range_kernel_t<T> kernel;
+      kernel.m_buf = static_cast<const T*>(m_buf);
+      kernel.m_has_fill = has_fill;
+      kernel.m_fill = fill;
+      kernel.m_min.resize(ranges.size());
+      kernel.m_max.resize(ranges.size());
+      kernel.m_nbr_nan.resize(ranges.size());
+      kernel.m_nbr_fill.resize(ranges.size());
+      parallel_for(ranges, kernel);
+      for(size_t idx = 0; idx < ranges.size(); idx++)
+      {
+        *m_min = std::min(*m_min, kernel.m_min[idx]);
+        *m_max = std::max(*m_max, kernel.m_max[idx]);
+        *m_nbr_nan += kernel.m_nbr_nan[idx];
+        *m_nbr_fill += kernel.m_nbr_fill[idx];
+      }
+    }
+    else
+    {
+      //the bins of each range are kept for the whole stream, and merged at the end
+      while(m_bins->size() < ranges.size())
+      {
+        m_bins->push_back(std::vector<hsize_t>(m_nbr_fine, 0));
+      }
+      fine_kernel_t<T> kernel;
+      kernel.m_buf = static_cast<const T*>(m_buf);
+      kernel.m_has_fill = has_fill;
+      kernel.m_fill = fill;
+      kernel.m_fine_min = m_fine_min;
+      kernel.m_inv_width = m_inv_width;
+      kernel.m_nbr_fine = m_nbr_fine;
+      kernel.m_bins = m_bins;
+      parallel_for(ranges, kernel);
+    }
+  }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//fill_to_double_t
+//functor for dispatch(): the fill value as a double
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct fill_to_double_t
+{
+  const void *m_buf;
+  double m_value;
+
+  template <typename T>
+  void apply()
+  {
+    T value;
+    memcpy(&value, m_buf, sizeof(T));
+    m_value = static_cast<double>(value);
+  }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//get_fill
+//fill value of a dataset in memory type 'mtid': the _FillValue attribute (netCDF), or the fill
+//value set when the dataset was created; h5lock_t must be held
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static bool get_fill(hid_t did, hid_t mtid, std::vector<char> &fill)
+{
+  bool found = false;
+  fill.assign(H5Tget_size(mtid), 0);
+
+  H5E_BEGIN_TRY
+  {
+    if(H5Aexists(did, "_FillValue") > 0)
+    {
+      hid_t aid = H5Aopen(did, "_FillValue", H5P_DEFAULT);
+      if(aid >= 0)
+      {
+        hid_t sid = H5Aget_space(aid);
+        found = sid >= 0 && H5Sget_simple_extent_npoints(sid) == 1 && H5Aread(aid, mtid, &fill[0]) >= 0;
+        H5Sclose(sid);
+        H5Aclose(aid);
+      }
+    }
+    if(!found)
+    {
+      hid_t dcpl = H5Dget_create_plist(did);
+      H5D_fill_value_t fill_status;
+      if(dcpl >= 0 && H5Pfill_value_defined(dcpl, &fill_status) >= 0 && fill_status == H5D_FILL_VALUE_USER_DEFINED)
+      {
+        found = H5Pget_fill_value(dcpl, mtid, &fill[0]) >= 0;
+      }
+      H5Pclose(dcpl);
+    }
+  }
+  H5E_END_TRY;
+
+  if(!found)
+  {
+    fill.clear();
+  }
+  return found;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5histogram_t::h5histogram_t
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+h5histogram_t::h5histogram_t() :
+m_nbr_elements(0),
+m_nbr_nan(0),
+m_nbr_fill(0),
+m_has_fill(false),
+m_fill(0),
+m_min(0),
+m_max(0),
+m_integer(false),
+m_fine_min(0),
+m_fine_width(1)
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5histogram_t::compute
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5histogram_t::compute(const char* file_name, const char* path, const std::vector<hsize_t> &start, const std::vector<hsize_t> &count,
+  h5progress_t *progress)
+{
+  h5slab_t slab;
+  std::vector<char> fill;
+  int result;
+
+  m_path = path;
+  m_fine.clear();
+  m_nbr_nan = 0;
+  m_nbr_fill = 0;
+
+  if(slab.open(file_name, path) < 0 || slab.m_native == H5NATIVE_NONE)
+  {
+    return -1;
+  }
+  if(start.size() && slab.select(start, count) < 0)
+  {
+    return -1;
+  }
+  m_nbr_elements = slab.nbr_elements();
+
+  {
+    h5lock_t lock;
+    m_has_fill = get_fill(slab.m_did, slab.m_mtid, fill);
+  }
+  if(m_has_fill)
+  {
+    fill_to_double_t convert;
+    convert.m_value = 0;
+    convert.m_buf = &fill[0];
+    dispatch(slab.m_native, convert);
+    m_fill = convert.m_value;
+  }
+
+  //range
+  hsize_t nbr_done = 0;
+  m_min = std::numeric_limits<double>::infinity();
+  m_max = -std::numeric_limits<double>::infinity();
+  if((result = stream(slab, 0, fill, 2 * m_nbr_elements, nbr_done, progress)) != 0)
+  {
+    return result;
+  }
+  if(m_min > m_max)
+  {
+    //no values
+    m_min = m_max = 0;
+    return 0;
+  }
+
+  //fine bins
+  size_t nbr_fine = max_fine_bins;
+  m_integer = slab.m_datatype_class == H5T_INTEGER && m_max - m_min < max_fine_bins;
+  if(m_integer)
+  {
+    nbr_fine = static_cast<size_t>(m_max - m_min) + 1;
+    m_fine_min = m_min - 0.5;
+    m_fine_width = 1;
+  }
+  else if(m_max > m_min)
+  {
+    m_fine_min = m_min;
+    m_fine_width = (m_max - m_min) / nbr_fine;
+  }
+  else
+  {
+    nbr_fine = 1;
+    m_fine_min = m_min - 0.5;
+    m_fine_width = 1;
+  }
+  m_fine.assign(nbr_fine, 0);
+  if((result = stream(slab, 1, fill, 2 * m_nbr_elements, nbr_done, progress)) != 0)
+  {
+    m_fine.clear();
+    return result;
+  }
+  return 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5histogram_t::stream
+//one pass over the selection: 0 for the range, 1 for the fine bins
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5histogram_t::stream(h5slab_t &slab, int pass, const std::vector<char> &fill, hsize_t nbr_total, hsize_t &nbr_done, h5progress_t *progress)
+{
+  std::vector<std::vector<hsize_t> > bins;
+  int result = 0;
+
+  h5queue_t<h5block_t*> queue(2);
+  h5reader_t reader(&slab, &queue);
+  reader.start();
+
+  h5block_t *block;
+  while(queue.pop(block))
+  {
+    histogram_block_t histogram_block;
+    histogram_block.m_pass = pass;
+    histogram_block.m_buf = &block->m_buf[0];
+    histogram_block.m_nbr_elements = block->m_nbr_elements;
+    histogram_block.m_fill = &fill;
+    histogram_block.m_min = &m_min;
+    histogram_block.m_max = &m_max;
+    histogram_block.m_nbr_nan = &m_nbr_nan;
+    histogram_block.m_nbr_fill = &m_nbr_fill;
+    histogram_block.m_fine_min = m_fine_min;
+    histogram_block.m_inv_width = 1 / m_fine_width;
+    histogram_block.m_nbr_fine = m_fine.size();
+    histogram_block.m_bins = &bins;
+    if(block->m_nbr_elements > 0)
+    {
+      dispatch(slab.m_native, histogram_block);
+    }
+
+    nbr_done += block->m_nbr_elements;
+    delete block;
+    if(progress && !progress->progress(nbr_done, nbr_total))
+    {
+      result = 1;
+      break;
+    }
+  }
+
+  queue.close();
+  reader.wait();
+  while(queue.pop(block))
+  {
+    delete block;
+  }
+  if(reader.m_result < 0)
+  {
+    result = -1;
+  }
+
+  //merge the bins of the ranges
+  for(size_t idx_range = 0; result == 0 && idx_range < bins.size(); idx_range++)
+  {
+    for(size_t idx = 0; idx < m_fine.size(); idx++)
+    {
+      m_fine[idx] += bins[idx_range][idx];
+    }
+  }
+  return result;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5histogram_t::rebin
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void h5histogram_t::rebin(double lo, double hi, size_t nbr_bins, std::vector<hsize_t> &bins) const
+{
+  bins.assign(nbr_bins, 0);
+  if(nbr_bins == 0 || !(hi >= lo))
+  {
+    return;
+  }
+  double width = (hi - lo) / nbr_bins;
+  for(size_t idx = 0; idx < m_fine.size(); idx++)
+  {
+    double center = m_fine_min + (idx + 0.5) * m_fine_width;
+    if(m_fine[idx] == 0 || center < lo || center > hi)
+    {
+      continue;
+    }
+    size_t bin = width > 0 ? static_cast<size_t>((center - lo) / width) : 0;
+    bins[bin < nbr_bins ? bin : nbr_bins - 1] += m_fine[idx];
+  }
+}
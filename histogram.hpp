@@ -0,0 +1,54 @@
+#ifndef HISTOGRAM_HPP
+#define HISTOGRAM_HPP 1
+
+#include <string>
+#include <vector>
+#include "hdf5.h"
+#include "slab.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5histogram_t
+//histogram of a numeric dataset, or of a hyperslab of it
+//the values are streamed twice (h5slab_t blocks read ahead by a h5reader_t): once for the range,
+//once to count them in 'max_fine_bins' fine bins over that range (one bin per value for integers
+//with fewer values), so memory does not depend on the size of the dataset; each block is binned
+//on the thread pool, each range of the pool into its own bins, merged when the stream ends
+//rebin() then makes any number of bins over any range from the fine bins, without reading again
+//NaNs and the fill value (the _FillValue attribute, or else the fill value of the dataset if it
+//was set when it was created) are counted apart
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class h5histogram_t
+{
+public:
+  h5histogram_t();
+
+  //empty 'start' and 'count' for the whole dataset
+  //returns 0, 1 if canceled by progress, -1 on error or if the dataset is not numeric
+  int compute(const char* file_name, const char* path, const std::vector<hsize_t> &start, const std::vector<hsize_t> &count,
+    h5progress_t *progress);
+
+  //'nbr_bins' bins dividing ['lo', 'hi']; a fine bin is counted in the bin of its center,
+  //values out of the range are not counted
+  void rebin(double lo, double hi, size_t nbr_bins, std::vector<hsize_t> &bins) const;
+
+  std::string m_path;
+  hsize_t m_nbr_elements; // selected
+  hsize_t m_nbr_nan;
+  hsize_t m_nbr_fill;
+  bool m_has_fill;
+  double m_fill;
+  double m_min; // of the values counted
+  double m_max;
+  bool m_integer; // fine bins are one per value
+
+  static const size_t max_fine_bins = 1 << 16;
+
+private:
+  double m_fine_min; // lower edge of the first fine bin
+  double m_fine_width;
+  std::vector<hsize_t> m_fine;
+  int stream(h5slab_t &slab, int pass, const std::vector<char> &fill, hsize_t nbr_total, hsize_t &nbr_done, h5progress_t *progress);
+};
+
+#endif
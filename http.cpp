@@ -0,0 +1,578 @@
+#include <QtDebug>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <curl/curl.h>
+#include "http.hpp"
+#include "slab.hpp"
+#if H5_VERSION_GE(1,13,0)
+#include "H5FDdevelop.h"
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//curl callbacks
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static size_t write_cb(char *ptr, size_t size, size_t nmemb, void *userdata)
+{
+  std::vector<char> *data = static_cast<std::vector<char>*>(userdata);
+  data->insert(data->end(), ptr, ptr + size * nmemb);
+  return size * nmemb;
+}
+
+static size_t header_cb(char *buffer, size_t size, size_t nitems, void *userdata)
+{
+  std::vector<std::string> *headers = static_cast<std::vector<std::string>*>(userdata);
+  std::string line(buffer, size * nitems);
+  while(line.size() && (line[line.size() - 1] == '\r' || line[line.size() - 1] == '\n'))
+  {
+    line.erase(line.size() - 1);
+  }
+  //a redirect starts the headers of another response
+  if(line.compare(0, 5, "HTTP/") == 0)
+  {
+    headers->clear();
+  }
+  headers->push_back(line);
+  return size * nitems;
+}
+
+//value of header 'name' (lower case), empty if there is none
+static std::string header_value(const std::vector<std::string> &headers, const std::string &name)
+{
+  for(size_t idx = 0; idx < headers.size(); idx++)
+  {
+    const std::string &line = headers[idx];
+    if(line.size() <= name.size() || line[name.size()] != ':')
+    {
+      continue;
+    }
+    bool same = true;
+    for(size_t k = 0; same && k < name.size(); k++)
+    {
+      same = tolower(static_cast<unsigned char>(line[k])) == name[k];
+    }
+    if(same)
+    {
+      std::string::size_type first = line.find_first_not_of(" \t", name.size() + 1);
+      return first == std::string::npos ? std::string() : line.substr(first);
+    }
+  }
+  return std::string();
+}
+
+//copy the part of a block at 'block_start' that falls in the read of 'size' bytes at 'offset'
+static void copy_block(hsize_t offset, size_t size, char *out, hsize_t block_start, const char *data, size_t len)
+{
+  hsize_t first = std::max(offset, block_start);
+  hsize_t last = std::min(offset + size, block_start + len);
+  if(first < last)
+  {
+    memcpy(out + (first - offset), data + (first - block_start), static_cast<size_t>(last - first));
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5http_t::instance
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+h5http_t* h5http_t::instance()
+{
+  static h5http_t http;
+  return &http;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5http_t::h5http_t
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+h5http_t::h5http_t() :
+m_block_size(64 * 1024),
+m_max_blocks(1024),
+m_read_ahead(4),
+m_nbr_requests(0),
+m_nbr_fetched(0),
+m_clock(0),
+m_curl(NULL)
+{
+  curl_global_init(CURL_GLOBAL_DEFAULT);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5http_t::~h5http_t
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+h5http_t::~h5http_t()
+{
+  if(m_curl)
+  {
+    curl_easy_cleanup(static_cast<CURL*>(m_curl));
+  }
+  curl_global_cleanup();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5http_t::open
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5http_t::open(const std::string &url, hsize_t &size)
+{
+  h5lock_t lock;
+  std::map<std::string, remote_t>::iterator it = m_remotes.find(url);
+  if(it != m_remotes.end())
+  {
+    size = it->second.m_size;
+    return 0;
+  }
+
+  remote_t remote;
+  std::vector<char> data;
+  hsize_t start;
+  if(fetch(url, 0, 0, data, start, &remote) < 0 || start != 0)
+  {
+    return -1;
+  }
+  it = m_remotes.insert(std::make_pair(url, remote)).first;
+
+  //a server that ignores ranges sent all of it
+  for(hsize_t idx = 0; idx * m_block_size < data.size() && idx < m_max_blocks; idx++)
+  {
+    size_t len = static_cast<size_t>(std::min<hsize_t>(m_block_size, remote.m_size - idx * m_block_size));
+    if(idx * m_block_size + len <= data.size())
+    {
+      store(url, it->second, idx, &data[static_cast<size_t>(idx * m_block_size)], len);
+    }
+  }
+  size = remote.m_size;
+  return 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5http_t::read
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5http_t::read(const std::string &url, hsize_t offset, size_t size, void *buf)
+{
+  h5lock_t lock;
+  char *out = static_cast<char*>(buf);
+  hsize_t file_size;
+
+  if(open(url, file_size) < 0)
+  {
+    return -1;
+  }
+  const remote_t &remote = m_remotes[url];
+  memset(buf, 0, size);
+  if(size == 0 || offset >= file_size)
+  {
+    return 0;
+  }
+
+  hsize_t bs = m_block_size;
+  hsize_t end = std::min<hsize_t>(offset + size, file_size);
+  hsize_t last = (end - 1) / bs;
+  hsize_t nbr_blocks = (file_size + bs - 1) / bs;
+  hsize_t idx = offset / bs;
+  while(idx <= last)
+  {
+    const block_t *block = find(url, remote, idx);
+    if(block)
+    {
+      copy_block(offset, size, out, idx * bs, &block->m_data[0], block->m_data.size());
+      idx++;
+      continue;
+    }
+
+    //run of missing blocks, then read ahead if the run ends the read
+    hsize_t run_last = idx;
+    while(run_last < last && find(url, remote, run_last + 1) == NULL)
+    {
+      run_last++;
+    }
+    hsize_t fetch_last = run_last;
+    if(run_last == last)
+    {
+      while(fetch_last + 1 < nbr_blocks && fetch_last - run_last < m_read_ahead &&
+        m_blocks.find(key_t(url, fetch_last + 1)) == m_blocks.end())
+      {
+        fetch_last++;
+      }
+    }
+
+    std::vector<char> data;
+    hsize_t start;
+    if(fetch(url, idx, fetch_last, data, start, NULL) < 0)
+    {
+      return -1;
+    }
+    for(hsize_t k = idx; k <= fetch_last; k++)
+    {
+      hsize_t block_start = k * bs;
+      size_t len = static_cast<size_t>(std::min<hsize_t>(bs, file_size - block_start));
+      if(block_start < start || block_start - start + len > data.size())
+      {
+        qDebug() << "short response for" << url.c_str();
+        return -1;
+      }
+      const char *block_data = &data[static_cast<size_t>(block_start - start)];
+      if(k <= run_last)
+      {
+        copy_block(offset, size, out, block_start, block_data, len);
+      }
+      store(url, remote, k, block_data, len);
+    }
+    idx = run_last + 1;
+  }
+  return 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5http_t::clear
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void h5http_t::clear(const std::string &url)
+{
+  h5lock_t lock;
+  m_remotes.erase(url);
+  std::map<key_t, block_t>::iterator it = m_blocks.lower_bound(key_t(url, 0));
+  while(it != m_blocks.end() && it->first.first == url)
+  {
+    m_blocks.erase(it++);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5http_t::fetch
+//blocks 'first' to 'last' in 'data', which starts at byte 'start' of the file: a server that
+//ignores ranges sends the whole file; with 'remote', the size and tag of the file are read
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5http_t::fetch(const std::string &url, hsize_t first, hsize_t last, std::vector<char> &data, hsize_t &start, remote_t *remote)
+{
+  std::vector<std::string> headers;
+  char range[64];
+  long status = 0;
+
+  if(m_curl == NULL && (m_curl = curl_easy_init()) == NULL)
+  {
+    return -1;
+  }
+  CURL *curl = static_cast<CURL*>(m_curl);
+  snprintf(range, sizeof(range), "%llu-%llu", static_cast<unsigned long long>(first * m_block_size),
+    static_cast<unsigned long long>((last + 1) * m_block_size - 1));
+  data.clear();
+  curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+  curl_easy_setopt(curl, CURLOPT_RANGE, range);
+  curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+  curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_cb);
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &data);
+  curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, header_cb);
+  curl_easy_setopt(curl, CURLOPT_HEADERDATA, &headers);
+  CURLcode result = curl_easy_perform(curl);
+  curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+  m_nbr_requests++;
+  m_nbr_fetched += data.size();
+  if(result != CURLE_OK)
+  {
+    qDebug() << url.c_str() << curl_easy_strerror(result);
+    return -1;
+  }
+
+  hsize_t size;
+  if(status == 206)
+  {
+    unsigned long long range_first;
+    unsigned long long range_last;
+    unsigned long long total;
+    std::string content_range = header_value(headers, "content-range");
+    if(sscanf(content_range.c_str(), "bytes %llu-%llu/%llu", &range_first, &range_last, &total) != 3)
+    {
+      qDebug() << url.c_str() << "unexpected Content-Range" << content_range.c_str();
+      return -1;
+    }
+    start = range_first;
+    size = total;
+  }
+  else if(status == 200)
+  {
+    start = 0;
+    size = data.size();
+  }
+  else
+  {
+    qDebug() << url.c_str() << "HTTP status" << status;
+    return -1;
+  }
+
+  if(remote)
+  {
+    remote->m_size = size;
+    remote->m_tag = header_value(headers, "etag");
+    std::string modified = header_value(headers, "last-modified");
+    if(remote->m_tag.empty() && !modified.empty())
+    {
+      char str[32];
+      snprintf(str, sizeof(str), "%llu ", static_cast<unsigned long long>(size));
+      remote->m_tag = str + modified;
+    }
+  }
+  return 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5http_t::find
+//block 'idx' in memory, or read from the disk cache; NULL if it must be fetched
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const h5http_t::block_t* h5http_t::find(const std::string &url, const remote_t &remote, hsize_t idx)
+{
+  std::map<key_t, block_t>::iterator it = m_blocks.find(key_t(url, idx));
+  if(it != m_blocks.end())
+  {
+    it->second.m_used = ++m_clock;
+    return &it->second;
+  }
+  if(m_cache_dir.empty() || remote.m_tag.empty())
+  {
+    return NULL;
+  }
+
+  size_t len = static_cast<size_t>(std::min<hsize_t>(m_block_size, remote.m_size - idx * m_block_size));
+  std::vector<char> data(len);
+  FILE *fp = fopen(disk_name(url, remote, idx).c_str(), "rb");
+  if(fp == NULL)
+  {
+    return NULL;
+  }
+  bool ok = fread(&data[0], 1, len, fp) == len;
+  fclose(fp);
+  if(!ok)
+  {
+    return NULL;
+  }
+  store(url, remote, idx, &data[0], len);
+  return &m_blocks[key_t(url, idx)];
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5http_t::store
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void h5http_t::store(const std::string &url, const remote_t &remote, hsize_t idx, const char *data, size_t size)
+{
+  key_t key(url, idx);
+  std::map<key_t, block_t>::iterator it = m_blocks.find(key);
+  if(it == m_blocks.end())
+  {
+    while(!m_blocks.empty() && m_blocks.size() >= std::max<size_t>(m_max_blocks, 1))
+    {
+      std::map<key_t, block_t>::iterator oldest = m_blocks.begin();
+      for(std::map<key_t, block_t>::iterator it_block = m_blocks.begin(); it_block != m_blocks.end(); ++it_block)
+      {
+        if(it_block->second.m_used < oldest->second.m_used)
+          oldest = it_block;
+      }
+      m_blocks.erase(oldest);
+    }
+    it = m_blocks.insert(std::make_pair(key, block_t())).first;
+  }
+  it->second.m_data.assign(data, data + size);
+  it->second.m_used = ++m_clock;
+
+  //disk cache, written to a temporary file renamed at the end
+  if(m_cache_dir.empty() || remote.m_tag.empty())
+  {
+    return;
+  }
+  std::string name = disk_name(url, remote, idx);
+  std::string tmp_name = name + ".tmp";
+  FILE *fp = fopen(tmp_name.c_str(), "wb");
+  if(fp == NULL)
+  {
+    return;
+  }
+  bool ok = fwrite(data, 1, size, fp) == size;
+  if(fclose(fp) != 0 || !ok || rename(tmp_name.c_str(), name.c_str()) != 0)
+  {
+    remove(tmp_name.c_str());
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5http_t::disk_name
+//FNV-1a hash of the URL and the tag, and the block index
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::string h5http_t::disk_name(const std::string &url, const remote_t &remote, hsize_t idx) const
+{
+  std::string str = url + "\n" + remote.m_tag;
+  unsigned long long hash = 14695981039346656037ULL;
+  for(size_t k = 0; k < str.size(); k++)
+  {
+    hash ^= static_cast<unsigned char>(str[k]);
+    hash *= 1099511628211ULL;
+  }
+  char name[64];
+  snprintf(name, sizeof(name), "/%016llx.%llu", hash, static_cast<unsigned long long>(idx));
+  return m_cache_dir + name;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//HTTP virtual file driver
+//read only; the library reads a file through read(), which h5http_t serves from its blocks
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct h5http_file_t
+{
+  H5FD_t m_pub; // first, as for all drivers
+  std::string m_url;
+  haddr_t m_eoa;
+  haddr_t m_eof;
+};
+
+static H5FD_t* http_open(const char *name, unsigned flags, hid_t, haddr_t)
+{
+  hsize_t size;
+  if((flags & (H5F_ACC_RDWR | H5F_ACC_CREAT | H5F_ACC_TRUNC)) || h5http_t::instance()->open(name, size) < 0)
+  {
+    return NULL;
+  }
+  h5http_file_t *file = new h5http_file_t;
+  memset(&file->m_pub, 0, sizeof(file->m_pub));
+  file->m_url = name;
+  file->m_eoa = 0;
+  file->m_eof = size;
+  return &file->m_pub;
+}
+
+static herr_t http_close(H5FD_t *file)
+{
+  delete reinterpret_cast<h5http_file_t*>(file);
+  return 0;
+}
+
+static int http_cmp(const H5FD_t *f1, const H5FD_t *f2)
+{
+  int cmp = reinterpret_cast<const h5http_file_t*>(f1)->m_url.compare(reinterpret_cast<const h5http_file_t*>(f2)->m_url);
+  return cmp < 0 ? -1 : (cmp > 0 ? 1 : 0);
+}
+
+//the metadata accumulator and the sieve buffer gather small reads before they reach the driver
+static herr_t http_query(const H5FD_t *, unsigned long *flags)
+{
+  if(flags)
+  {
+    *flags = H5FD_FEAT_ACCUMULATE_METADATA | H5FD_FEAT_DATA_SIEVE;
+  }
+  return 0;
+}
+
+static haddr_t http_get_eoa(const H5FD_t *file, H5FD_mem_t)
+{
+  return reinterpret_cast<const h5http_file_t*>(file)->m_eoa;
+}
+
+static herr_t http_set_eoa(H5FD_t *file, H5FD_mem_t, haddr_t addr)
+{
+  reinterpret_cast<h5http_file_t*>(file)->m_eoa = addr;
+  return 0;
+}
+
+#if H5_VERSION_GE(1,10,0)
+static haddr_t http_get_eof(const H5FD_t *file, H5FD_mem_t)
+#else
+static haddr_t http_get_eof(const H5FD_t *file)
+#endif
+{
+  return reinterpret_cast<const h5http_file_t*>(file)->m_eof;
+}
+
+static herr_t http_read(H5FD_t *file, H5FD_mem_t, hid_t, haddr_t addr, size_t size, void *buf)
+{
+  return h5http_t::instance()->read(reinterpret_cast<h5http_file_t*>(file)->m_url, addr, size, buf);
+}
+
+static herr_t http_write(H5FD_t *, H5FD_mem_t, hid_t, haddr_t, size_t, const void *)
+{
+  return -1;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5http_is_url
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool h5http_is_url(const std::string &file_name)
+{
+  return file_name.compare(0, 7, "http://") == 0 || file_name.compare(0, 8, "https://") == 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5http_fapl
+//the driver is registered at the first call
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+hid_t h5http_fapl()
+{
+  static H5FD_class_t driver;
+  static hid_t driver_id = -1;
+  h5lock_t lock;
+
+  if(driver_id < 0)
+  {
+    memset(&driver, 0, sizeof(driver));
+#ifdef H5FD_CLASS_VERSION
+    driver.version = H5FD_CLASS_VERSION;
+    driver.value = static_cast<H5FD_class_value_t>(511);
+#endif
+    driver.name = "http";
+    driver.maxaddr = HADDR_MAX;
+    driver.fc_degree = H5F_CLOSE_WEAK;
+    driver.open = http_open;
+    driver.close = http_close;
+    driver.cmp = http_cmp;
+    driver.query = http_query;
+    driver.get_eoa = http_get_eoa;
+    driver.set_eoa = http_set_eoa;
+    driver.get_eof = http_get_eof;
+    driver.read = http_read;
+    driver.write = http_write;
+    for(int type = 0; type < H5FD_MEM_NTYPES; type++)
+    {
+      driver.fl_map[type] = type == H5FD_MEM_DRAW || type == H5FD_MEM_GHEAP ? H5FD_MEM_DRAW : H5FD_MEM_SUPER;
+    }
+    if((driver_id = H5FDregister(&driver)) < 0)
+    {
+      return -1;
+    }
+  }
+
+  hid_t fapl = H5Pcreate(H5P_FILE_ACCESS);
+  if(fapl >= 0 && H5Pset_driver(fapl, driver_id, NULL) < 0)
+  {
+    H5Pclose(fapl);
+    return -1;
+  }
+  return fapl;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5file_open
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+hid_t h5file_open(const char* file_name)
+{
+  if(!h5http_is_url(file_name))
+  {
+    return H5Fopen(file_name, H5F_ACC_RDONLY, H5P_DEFAULT);
+  }
+  h5lock_t lock;
+  hid_t fapl = h5http_fapl();
+  if(fapl < 0)
+  {
+    return -1;
+  }
+  hid_t fid = H5Fopen(file_name, H5F_ACC_RDONLY, fapl);
+  H5Pclose(fapl);
+  return fid;
+}
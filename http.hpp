@@ -0,0 +1,85 @@
+#ifndef HTTP_HPP
+#define HTTP_HPP 1
+
+#include <map>
+#include <string>
+#include <vector>
+#include "hdf5.h"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5http_t
+//read only access to HDF5 files served over HTTP(S), by byte range requests
+//a file is read by blocks of 'm_block_size' bytes, kept in a least recently used cache shared by
+//all the opens of the same URL: the many small metadata reads of HDF5 are mostly adjacent, so a
+//block serves several of them; a miss fetches the run of missing blocks a read needs in one
+//request, with up to 'm_read_ahead' more blocks after it
+//the first block is fetched when a URL is first opened, in the request that gets the size of the
+//file, so that the superblock and root group usually come with it
+//blocks are also kept on disk in 'm_cache_dir' when it is set, named after the URL and the ETag
+//(or the size and Last-Modified date) of the file, so that a changed file is read again
+//thread safe through h5lock_t, which the HDF5 calls that reach the driver already hold
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class h5http_t
+{
+public:
+  static h5http_t* instance();
+
+  //size of the file at 'url'; the first call fetches its first block
+  //returns 0, -1 if it cannot be read by ranges
+  int open(const std::string &url, hsize_t &size);
+
+  //'size' bytes at 'offset' of an open URL in 'buf'; bytes past the end of the file are zeros
+  int read(const std::string &url, hsize_t offset, size_t size, void *buf);
+
+  //forget the size and the blocks of 'url' kept in memory, to read a changed file again
+  void clear(const std::string &url);
+
+  size_t m_block_size;
+  size_t m_max_blocks; // in memory
+  size_t m_read_ahead; // blocks
+  std::string m_cache_dir; // empty for no disk cache
+  unsigned long m_nbr_requests; // since the start, for statistics
+  hsize_t m_nbr_fetched; // bytes
+
+private:
+  h5http_t();
+  ~h5http_t();
+
+  struct remote_t
+  {
+    hsize_t m_size;
+    std::string m_tag; // ETag, or size and Last-Modified; empty if the file has none
+  };
+
+  struct block_t
+  {
+    std::vector<char> m_data; // shorter than m_block_size for the last block
+    unsigned long m_used; // time of last use
+  };
+
+  typedef std::pair<std::string, hsize_t> key_t; // URL, block index
+  std::map<std::string, remote_t> m_remotes;
+  std::map<key_t, block_t> m_blocks;
+  unsigned long m_clock;
+  void *m_curl; // CURL handle, reused to keep the connection open
+
+  int fetch(const std::string &url, hsize_t first, hsize_t last, std::vector<char> &data, hsize_t &start, remote_t *remote);
+  const block_t* find(const std::string &url, const remote_t &remote, hsize_t idx);
+  void store(const std::string &url, const remote_t &remote, hsize_t idx, const char *data, size_t size);
+  std::string disk_name(const std::string &url, const remote_t &remote, hsize_t idx) const;
+
+  h5http_t(const h5http_t&);
+  h5http_t& operator=(const h5http_t&);
+};
+
+//true for http:// and https:// names
+bool h5http_is_url(const std::string &file_name);
+
+//file access property list of the HTTP driver, to H5Pclose after use; -1 on error
+hid_t h5http_fapl();
+
+//open file 'file_name' read only, through the HTTP driver for a URL
+hid_t h5file_open(const char* file_name);
+
+#endif
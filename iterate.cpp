@@ -1,6 +1,7 @@
 
 #include <QtDebug>
 #include "iterate.hpp"
+#include "http.hpp"
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 //h5iterate_t::iterate
@@ -10,7 +11,7 @@ int h5iterate_t::iterate(const char* file_name)
 {
   hid_t fid;
 
-  if((fid = H5Fopen(file_name, H5F_ACC_RDONLY, H5P_DEFAULT)) < 0)
+  if((fid = h5file_open(file_name)) < 0)
   {
     return -1;
   }
@@ -108,6 +109,15 @@ herr_t h5iterate_t::iterate_link_cb(hid_t loc_id, const char *name, const H5L_in
     }
 
   }
+  //soft or external link: keep its target, resolved when it is asked for
+  else if(linfo->type == H5L_TYPE_SOFT || linfo->type == H5L_TYPE_EXTERNAL)
+  {
+    h5link_t link;
+    if(link.get(loc_id, name) >= 0)
+    {
+      udata->iterate_links.push_back(std::make_pair(std::string(name), link));
+    }
+  }
 
   return(H5_ITER_CONT);
 }
@@ -1,8 +1,10 @@
 #ifndef ITERATE_HPP
 #define ITERATE_HPP 1
 
+#include <string>
 #include <vector>
 #include "hdf5.h"
+#include "link.hpp"
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 //h5iterate_t
@@ -21,6 +23,9 @@ public:
   // HDF5 object information
   std::vector < H5O_info_t > iterate_info;
 
+  // soft and external links, by name, not followed
+  std::vector < std::pair < std::string, h5link_t > > iterate_links;
+
 private:
   // callback function for H5Lvisit_by_name
   static herr_t iterate_link_cb(hid_t loc_id, const char *name, const H5L_info_t *linfo, void *_op_data);
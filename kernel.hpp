@@ -0,0 +1,176 @@
+#ifndef KERNEL_HPP
+#define KERNEL_HPP 1
+
+#include <QtGlobal>
+#include <QThread>
+#if QT_VERSION >= 0x050000
+#include <QtConcurrent>
+#else
+#include <QtCore>
+#endif
+#include <vector>
+#include <algorithm>
+#include "hdf5.h"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5native_t
+//native memory types a buffer read from HDF5 can have
+//defined from the (class, size, sign) triple stored in hdf_dataset_t, in the same order
+//the TableModel display code tests them
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+enum h5native_t
+{
+  H5NATIVE_NONE,
+  H5NATIVE_SCHAR,
+  H5NATIVE_UCHAR,
+  H5NATIVE_SHORT,
+  H5NATIVE_USHORT,
+  H5NATIVE_INT,
+  H5NATIVE_UINT,
+  H5NATIVE_LONG,
+  H5NATIVE_ULONG,
+  H5NATIVE_LLONG,
+  H5NATIVE_ULLONG,
+  H5NATIVE_FLOAT,
+  H5NATIVE_DOUBLE
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//get_native
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+inline h5native_t get_native(H5T_class_t datatype_class, size_t datatype_size, H5T_sign_t datatype_sign)
+{
+  bool is_unsigned = (H5T_SGN_NONE == datatype_sign);
+
+  if(datatype_class == H5T_FLOAT)
+  {
+    if(sizeof(float) == datatype_size)
+      return H5NATIVE_FLOAT;
+    else if(sizeof(double) == datatype_size)
+      return H5NATIVE_DOUBLE;
+  }
+  else if(datatype_class == H5T_INTEGER)
+  {
+    if(sizeof(char) == datatype_size)
+      return is_unsigned ? H5NATIVE_UCHAR : H5NATIVE_SCHAR;
+    else if(sizeof(short) == datatype_size)
+      return is_unsigned ? H5NATIVE_USHORT : H5NATIVE_SHORT;
+    else if(sizeof(int) == datatype_size)
+      return is_unsigned ? H5NATIVE_UINT : H5NATIVE_INT;
+    else if(sizeof(long) == datatype_size)
+      return is_unsigned ? H5NATIVE_ULONG : H5NATIVE_LONG;
+    else if(sizeof(long long) == datatype_size)
+      return is_unsigned ? H5NATIVE_ULLONG : H5NATIVE_LLONG;
+  }
+  return H5NATIVE_NONE;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//dispatch
+//calls the member template f.apply<T>() with T the C type of 'type'
+//this is the single place where a run time HDF5 type selects a compile time kernel
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <class F>
+bool dispatch(h5native_t type, F &f)
+{
+  switch(type)
+  {
+  case H5NATIVE_SCHAR: f.template apply<signed char>(); return true;
+  case H5NATIVE_UCHAR: f.template apply<unsigned char>(); return true;
+  case H5NATIVE_SHORT: f.template apply<short>(); return true;
+  case H5NATIVE_USHORT: f.template apply<unsigned short>(); return true;
+  case H5NATIVE_INT: f.template apply<int>(); return true;
+  case H5NATIVE_UINT: f.template apply<unsigned int>(); return true;
+  case H5NATIVE_LONG: f.template apply<long>(); return true;
+  case H5NATIVE_ULONG: f.template apply<unsigned long>(); return true;
+  case H5NATIVE_LLONG: f.template apply<long long>(); return true;
+  case H5NATIVE_ULLONG: f.template apply<unsigned long long>(); return true;
+  case H5NATIVE_FLOAT: f.template apply<float>(); return true;
+  case H5NATIVE_DOUBLE: f.template apply<double>(); return true;
+  default: break;
+  }
+  return false;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5range_t
+//a contiguous range [begin, end) of a buffer processed by one task of the thread pool
+//'idx' is the position of the range, used to store per task results that are merged in order
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct h5range_t
+{
+  size_t idx;
+  size_t begin;
+  size_t end;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//make_ranges
+//split [0, n) in ranges of at least 'grain' elements, at most a few per pool thread
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+inline std::vector<h5range_t> make_ranges(size_t n, size_t grain)
+{
+  std::vector<h5range_t> ranges;
+  size_t max_ranges = 4 * static_cast<size_t>(QThread::idealThreadCount() > 0 ? QThread::idealThreadCount() : 1);
+  size_t nbr_ranges = (grain > 0) ? (n + grain - 1) / grain : 1;
+  if(nbr_ranges > max_ranges)
+    nbr_ranges = max_ranges;
+  if(nbr_ranges == 0)
+    nbr_ranges = 1;
+  size_t size = (n + nbr_ranges - 1) / nbr_ranges;
+  for(size_t idx = 0; idx < nbr_ranges; idx++)
+  {
+    h5range_t range;
+    range.idx = idx;
+    range.begin = idx * size;
+    range.end = std::min(n, range.begin + size);
+    if(range.begin >= range.end && idx > 0)
+      break;
+    ranges.push_back(range);
+  }
+  return ranges;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//parallel_call_t
+//functor passed to QtConcurrent; the kernel object is shared by pointer so that
+//all tasks write into the same per range result slots
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <class F>
+struct parallel_call_t
+{
+  typedef void result_type;
+  parallel_call_t(F *f) : m_f(f)
+  {
+  }
+  void operator()(h5range_t &range) const
+  {
+    m_f->run(range);
+  }
+  F *m_f;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//parallel_for
+//runs f.run(range) for each range on the global thread pool and waits
+//a single range is run in the calling thread
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <class F>
+void parallel_for(std::vector<h5range_t> &ranges, F &f)
+{
+  if(ranges.size() == 1)
+  {
+    f.run(ranges[0]);
+    return;
+  }
+  QtConcurrent::blockingMap(ranges, parallel_call_t<F>(&f));
+}
+
+#endif
@@ -0,0 +1,292 @@
+#include <QtDebug>
+#include <cstdio>
+#include "layout.hpp"
+#include "http.hpp"
+#include "slab.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//format_size
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::string format_size(double nbr_bytes)
+{
+  static const char *unit[] = { "bytes", "KB", "MB", "GB", "TB", "PB" };
+  char tmp[64];
+  size_t idx = 0;
+  while(nbr_bytes >= 1024 && idx < 5)
+  {
+    nbr_bytes /= 1024;
+    idx++;
+  }
+  if(idx == 0)
+    snprintf(tmp, sizeof(tmp), "%.0f %s", nbr_bytes, unit[idx]);
+  else
+    snprintf(tmp, sizeof(tmp), "%.1f %s", nbr_bytes, unit[idx]);
+  return tmp;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5layout_t::h5layout_t
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+h5layout_t::h5layout_t() :
+m_layout(H5D_LAYOUT_ERROR),
+m_datatype_size(0),
+m_logical_size(0),
+m_storage_size(0),
+m_nbr_chunks(0),
+m_nbr_allocated(0),
+m_chunk_stats(false),
+m_min_chunk_bytes(0),
+m_max_chunk_bytes(0),
+m_cache_nbytes(0),
+m_cache_nslots(0),
+m_layer_chunks(0),
+m_layer_bytes(0),
+m_layer_amplification(1)
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5layout_t::get
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5layout_t::get(const char* file_name, const char* path)
+{
+  h5lock_t lock;
+  hid_t fid;
+  hid_t did;
+  hid_t sid;
+  hid_t ftid;
+  hid_t dcpl;
+  hid_t dapl;
+  hsize_t dims[H5S_MAX_RANK];
+  hsize_t chunk[H5S_MAX_RANK];
+  int rank;
+
+  m_filters.clear();
+  m_warnings.clear();
+  m_chunk.clear();
+
+  if((fid = h5file_open(file_name)) < 0)
+  {
+    return -1;
+  }
+
+  if((did = H5Dopen2(fid, path, H5P_DEFAULT)) < 0)
+  {
+    H5Fclose(fid);
+    return -1;
+  }
+
+  if((sid = H5Dget_space(did)) < 0)
+  {
+    H5Dclose(did);
+    H5Fclose(fid);
+    return -1;
+  }
+  rank = H5Sget_simple_extent_dims(sid, dims, NULL);
+  if(rank < 0)
+  {
+    H5Sclose(sid);
+    H5Dclose(did);
+    H5Fclose(fid);
+    return -1;
+  }
+  m_dim.assign(dims, dims + rank);
+
+  if((ftid = H5Dget_type(did)) >= 0)
+  {
+    m_datatype_size = H5Tget_size(ftid);
+    H5Tclose(ftid);
+  }
+
+  m_logical_size = m_datatype_size;
+  for(int idx = 0; idx < rank; idx++)
+  {
+    m_logical_size *= dims[idx];
+  }
+  m_storage_size = H5Dget_storage_size(did);
+
+  if((dapl = H5Dget_access_plist(did)) >= 0)
+  {
+    double w0;
+    H5Pget_chunk_cache(dapl, &m_cache_nslots, &m_cache_nbytes, &w0);
+    H5Pclose(dapl);
+  }
+
+  if((dcpl = H5Dget_create_plist(did)) >= 0)
+  {
+    m_layout = H5Pget_layout(dcpl);
+    if(m_layout == H5D_CHUNKED && H5Pget_chunk(dcpl, rank, chunk) == rank)
+    {
+      m_chunk.assign(chunk, chunk + rank);
+    }
+
+    int nbr_filters = H5Pget_nfilters(dcpl);
+    for(int idx = 0; idx < nbr_filters; idx++)
+    {
+      unsigned int flags;
+      unsigned int values[16];
+      size_t nbr_values = 16;
+      char name[256];
+      name[0] = '\0';
+      H5Z_filter_t id = H5Pget_filter2(dcpl, static_cast<unsigned>(idx), &flags, &nbr_values, values, sizeof(name), name, NULL);
+      std::string str = name[0] ? name : "unknown";
+      char tmp[64];
+      snprintf(tmp, sizeof(tmp), " (id %d", static_cast<int>(id));
+      str += tmp;
+      for(size_t k = 0; k < nbr_values && k < 16; k++)
+      {
+        snprintf(tmp, sizeof(tmp), "%s%u", k ? " " : ", parameters ", values[k]);
+        str += tmp;
+      }
+      str += ")";
+      m_filters.push_back(str);
+    }
+    H5Pclose(dcpl);
+  }
+
+  //chunk grid and allocated chunks
+  m_nbr_chunks = 0;
+  m_nbr_allocated = 0;
+  m_chunk_stats = false;
+  if(m_chunk.size())
+  {
+    m_nbr_chunks = 1;
+    for(int idx = 0; idx < rank; idx++)
+    {
+      m_nbr_chunks *= (m_dim[idx] + m_chunk[idx] - 1) / m_chunk[idx];
+    }
+    m_nbr_allocated = m_nbr_chunks;
+
+#if H5_VERSION_GE(1,10,5)
+    hsize_t nbr;
+    if(H5Dget_num_chunks(did, sid, &nbr) >= 0)
+    {
+      m_nbr_allocated = nbr;
+    }
+    //H5Dget_chunk_info looks the chunk up from the start of the index: limit the scan
+    if(m_nbr_allocated > 0 && m_nbr_allocated <= 4096)
+    {
+      hsize_t offset[H5S_MAX_RANK];
+      m_chunk_stats = true;
+      for(hsize_t idx = 0; idx < m_nbr_allocated; idx++)
+      {
+        unsigned filter_mask;
+        haddr_t addr;
+        hsize_t size;
+        if(H5Dget_chunk_info(did, sid, idx, offset, &filter_mask, &addr, &size) < 0)
+        {
+          m_chunk_stats = false;
+          break;
+        }
+        if(idx == 0 || size < m_min_chunk_bytes)
+          m_min_chunk_bytes = size;
+        if(idx == 0 || size > m_max_chunk_bytes)
+          m_max_chunk_bytes = size;
+      }
+    }
+#endif
+  }
+
+  H5Sclose(sid);
+  H5Dclose(did);
+  H5Fclose(fid);
+
+  check();
+  return 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5layout_t::check
+//a layer is one element of each dimension before the last two; reading it decompresses every
+//chunk that intersects it, whole
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void h5layout_t::check()
+{
+  size_t rank = m_dim.size();
+  char tmp[512];
+
+  m_layer_chunks = 0;
+  m_layer_bytes = 0;
+  m_layer_amplification = 1;
+
+  if(m_chunk.empty() || m_logical_size == 0)
+  {
+    return;
+  }
+
+  hsize_t chunk_bytes = m_datatype_size;
+  hsize_t shown_bytes = m_datatype_size;
+  m_layer_chunks = 1;
+  for(size_t idx = 0; idx < rank; idx++)
+  {
+    chunk_bytes *= m_chunk[idx];
+    if(idx + 2 >= rank)
+    {
+      m_layer_chunks *= (m_dim[idx] + m_chunk[idx] - 1) / m_chunk[idx];
+      shown_bytes *= m_dim[idx];
+    }
+  }
+  m_layer_bytes = m_layer_chunks * chunk_bytes;
+  m_layer_amplification = static_cast<double>(m_layer_bytes) / static_cast<double>(shown_bytes);
+
+  bool filtered = !m_filters.empty();
+
+  //chunks thicker than one layer
+  for(size_t idx = 0; idx + 2 < rank; idx++)
+  {
+    if(m_chunk[idx] > 1 && m_dim[idx] > 1)
+    {
+      if(m_chunk[idx] >= m_dim[idx])
+      {
+        snprintf(tmp, sizeof(tmp), "chunks span the whole dimension %u (%llu): reading one layer at a time reads "
+          "and decompresses all of it for every layer", static_cast<unsigned>(idx), static_cast<unsigned long long>(m_dim[idx]));
+      }
+      else
+      {
+        snprintf(tmp, sizeof(tmp), "chunks are %llu elements thick in dimension %u: reading one layer at a time reads "
+          "each chunk %llu times", static_cast<unsigned long long>(m_chunk[idx]), static_cast<unsigned>(idx),
+          static_cast<unsigned long long>(m_chunk[idx]));
+      }
+      m_warnings.push_back(tmp);
+    }
+  }
+
+  //chunk cache
+  if(filtered && chunk_bytes > m_cache_nbytes)
+  {
+    snprintf(tmp, sizeof(tmp), "a chunk (%s) is larger than the chunk cache (%s): it is not cached, "
+      "each partial read decompresses it again", format_size(static_cast<double>(chunk_bytes)).c_str(),
+      format_size(static_cast<double>(m_cache_nbytes)).c_str());
+    m_warnings.push_back(tmp);
+  }
+  else if(filtered && m_layer_chunks > 1 && m_layer_bytes > m_cache_nbytes)
+  {
+    snprintf(tmp, sizeof(tmp), "the chunks of one layer (%s) do not fit the chunk cache (%s): "
+      "reading a layer in pieces decompresses chunks several times", format_size(static_cast<double>(m_layer_bytes)).c_str(),
+      format_size(static_cast<double>(m_cache_nbytes)).c_str());
+    m_warnings.push_back(tmp);
+  }
+
+  //small chunks
+  if(m_nbr_chunks > 1 && chunk_bytes < 4096)
+  {
+    snprintf(tmp, sizeof(tmp), "chunks are small (%s, %llu chunks): index lookups and I/O calls per chunk dominate",
+      format_size(static_cast<double>(chunk_bytes)).c_str(), static_cast<unsigned long long>(m_nbr_chunks));
+    m_warnings.push_back(tmp);
+  }
+
+  //compression
+  if(filtered && m_storage_size > 0 && m_nbr_allocated == m_nbr_chunks)
+  {
+    double ratio = static_cast<double>(m_logical_size) / static_cast<double>(m_storage_size);
+    if(ratio < 1.1)
+    {
+      snprintf(tmp, sizeof(tmp), "compression ratio is %.2f: the filters cost decompression time for little space", ratio);
+      m_warnings.push_back(tmp);
+    }
+  }
+}
@@ -0,0 +1,54 @@
+#ifndef LAYOUT_HPP
+#define LAYOUT_HPP 1
+
+#include <string>
+#include <vector>
+#include "hdf5.h"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//format_size
+//byte count with a binary unit, "1.5 MB"
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::string format_size(double nbr_bytes);
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5layout_t
+//storage layout of a dataset: chunk shape, filter pipeline, allocated and logical size,
+//allocated chunks and how the chunks fit the chunk cache when the dataset is shown one layer
+//at a time (the grid shows the last two dimensions, one element of each dimension before them)
+//'m_warnings' lists the layouts that make such access slow
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class h5layout_t
+{
+public:
+  h5layout_t();
+
+  //returns 0, -1 on error
+  int get(const char* file_name, const char* path);
+
+  H5D_layout_t m_layout;
+  std::vector<hsize_t> m_dim;
+  std::vector<hsize_t> m_chunk; // empty if not chunked
+  size_t m_datatype_size; // file type
+  std::vector<std::string> m_filters; // name and parameters, in pipeline order
+  hsize_t m_logical_size; // bytes
+  hsize_t m_storage_size; // bytes allocated in the file
+  hsize_t m_nbr_chunks; // chunk grid
+  hsize_t m_nbr_allocated; // chunks written (m_nbr_chunks if unknown)
+  bool m_chunk_stats; // min, max of stored chunks are known
+  hsize_t m_min_chunk_bytes;
+  hsize_t m_max_chunk_bytes;
+  size_t m_cache_nbytes; // chunk cache of the dataset access property list
+  size_t m_cache_nslots;
+  hsize_t m_layer_chunks; // chunks intersecting one layer
+  hsize_t m_layer_bytes; // their uncompressed size
+  double m_layer_amplification; // bytes decompressed per byte shown, when reading one layer
+  std::vector<std::string> m_warnings;
+
+private:
+  void check();
+};
+
+#endif
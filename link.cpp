@@ -0,0 +1,228 @@
+#include <QtDebug>
+#include <cstdlib>
+#include "link.hpp"
+#include "http.hpp"
+#include "slab.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5link_t::h5link_t
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+h5link_t::h5link_t() :
+m_type(H5L_TYPE_HARD)
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5link_t::get
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5link_t::get(hid_t loc_id, const char *name)
+{
+  H5L_info_t linfo;
+
+  m_file_name.clear();
+  m_path.clear();
+  if(H5Lget_info(loc_id, name, &linfo, H5P_DEFAULT) < 0)
+  {
+    return -1;
+  }
+  m_type = linfo.type;
+  if(m_type == H5L_TYPE_HARD)
+  {
+    return 0;
+  }
+  if(m_type != H5L_TYPE_SOFT && m_type != H5L_TYPE_EXTERNAL)
+  {
+    return -1;
+  }
+
+  std::vector<char> buf(linfo.u.val_size + 1, '\0');
+  if(H5Lget_val(loc_id, name, &buf[0], linfo.u.val_size, H5P_DEFAULT) < 0)
+  {
+    return -1;
+  }
+  if(m_type == H5L_TYPE_SOFT)
+  {
+    m_path = &buf[0];
+    return 0;
+  }
+
+  const char *file_name;
+  const char *path;
+  unsigned flags;
+  if(H5Lunpack_elink_val(&buf[0], linfo.u.val_size, &flags, &file_name, &path) < 0)
+  {
+    return -1;
+  }
+  m_file_name = file_name;
+  m_path = path;
+  return 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5link_t::candidates
+//an absolute name that cannot be found is looked for in the directory of 'file_name'; the
+//directories of HDF5_EXT_PREFIX come first, as for the library
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void h5link_t::candidates(const std::string &file_name, std::vector<std::string> &names) const
+{
+  names.clear();
+  if(m_type != H5L_TYPE_EXTERNAL)
+  {
+    names.push_back(file_name);
+    return;
+  }
+
+  std::string dir;
+  std::string::size_type pos = file_name.find_last_of("/\\");
+  if(pos != std::string::npos)
+  {
+    dir = file_name.substr(0, pos + 1);
+  }
+  bool absolute = !m_file_name.empty() && (m_file_name[0] == '/' || m_file_name[0] == '\\' ||
+    (m_file_name.size() > 1 && m_file_name[1] == ':'));
+  std::string base = m_file_name;
+  if(absolute && (pos = m_file_name.find_last_of("/\\")) != std::string::npos)
+  {
+    base = m_file_name.substr(pos + 1);
+  }
+
+  const char *prefix = getenv("HDF5_EXT_PREFIX");
+  if(prefix != NULL && !absolute)
+  {
+    std::string list(prefix);
+    std::string::size_type first = 0;
+    while(first <= list.size())
+    {
+      std::string::size_type last = list.find(':', first);
+      if(last == std::string::npos)
+        last = list.size();
+      if(last > first)
+        names.push_back(list.substr(first, last - first) + "/" + m_file_name);
+      first = last + 1;
+    }
+  }
+  if(absolute)
+  {
+    names.push_back(m_file_name);
+    names.push_back(dir + base);
+  }
+  else
+  {
+    names.push_back(dir + m_file_name);
+    if(!dir.empty())
+      names.push_back(m_file_name);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5file_cache_t::instance
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+h5file_cache_t* h5file_cache_t::instance()
+{
+  static h5file_cache_t cache;
+  return &cache;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5file_cache_t::h5file_cache_t
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+h5file_cache_t::h5file_cache_t() :
+m_clock(0)
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5file_cache_t::acquire
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+hid_t h5file_cache_t::acquire(const std::string &file_name)
+{
+  h5lock_t lock;
+  std::map<std::string, file_t>::iterator it = m_files.find(file_name);
+  if(it != m_files.end())
+  {
+    it->second.m_nbr_refs++;
+    return it->second.m_fid;
+  }
+
+  hid_t fid;
+  H5E_BEGIN_TRY
+  {
+    fid = h5file_open(file_name.c_str());
+  }
+  H5E_END_TRY;
+  if(fid < 0)
+  {
+    return -1;
+  }
+
+  file_t file;
+  file.m_fid = fid;
+  file.m_nbr_refs = 1;
+  file.m_used = ++m_clock;
+  m_files.insert(std::make_pair(file_name, file));
+  return fid;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5file_cache_t::release
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void h5file_cache_t::release(hid_t fid)
+{
+  h5lock_t lock;
+  for(std::map<std::string, file_t>::iterator it = m_files.begin(); it != m_files.end(); ++it)
+  {
+    if(it->second.m_fid == fid)
+    {
+      if(it->second.m_nbr_refs > 0)
+        it->second.m_nbr_refs--;
+      it->second.m_used = ++m_clock;
+      break;
+    }
+  }
+  trim(max_idle);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5file_cache_t::close
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void h5file_cache_t::close()
+{
+  h5lock_t lock;
+  trim(0);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5file_cache_t::trim
+//close the least recently used idle files until at most 'max_files' are left
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void h5file_cache_t::trim(size_t max_files)
+{
+  for(;;)
+  {
+    std::map<std::string, file_t>::iterator oldest = m_files.end();
+    size_t nbr_idle = 0;
+    for(std::map<std::string, file_t>::iterator it = m_files.begin(); it != m_files.end(); ++it)
+    {
+      if(it->second.m_nbr_refs > 0)
+        continue;
+      nbr_idle++;
+      if(oldest == m_files.end() || it->second.m_used < oldest->second.m_used)
+        oldest = it;
+    }
+    if(nbr_idle <= max_files)
+    {
+      return;
+    }
+    H5Fclose(oldest->second.m_fid);
+    m_files.erase(oldest);
+  }
+}
@@ -0,0 +1,71 @@
+#ifndef LINK_HPP
+#define LINK_HPP 1
+
+#include <map>
+#include <string>
+#include <vector>
+#include "hdf5.h"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5link_t
+//target of a soft or external link, read from the link value without traversing it, so that a
+//file made of links to other files is listed without opening them
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct h5link_t
+{
+  h5link_t();
+
+  //link 'name' of location 'loc_id', with h5lock_t held
+  //returns 0, -1 on error or for a user defined link
+  int get(hid_t loc_id, const char *name);
+
+  //file names to try for the target of an external link of file 'file_name', as the library
+  //does: relative to the directory of 'file_name' first, then as stored
+  void candidates(const std::string &file_name, std::vector<std::string> &names) const;
+
+  H5L_type_t m_type;
+  std::string m_file_name; // external link: target file as stored
+  std::string m_path; // target object; for a hard link, the object itself
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5file_cache_t
+//files opened to resolve links, shared by reference count: the links of a file to the same
+//target file use one handle, opened at the first acquire()
+//a file no longer used is kept open, and the least recently used ones are closed above
+//'max_idle', so that expanding the links of a master file one after the other does not reopen
+//the same files
+//thread safe through h5lock_t
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class h5file_cache_t
+{
+public:
+  static h5file_cache_t* instance();
+
+  //file 'file_name' opened read only, -1 if it cannot be opened; release() it after use
+  hid_t acquire(const std::string &file_name);
+  void release(hid_t fid);
+
+  //close the files not in use
+  void close();
+
+  enum { max_idle = 16 };
+
+private:
+  h5file_cache_t();
+
+  struct file_t
+  {
+    hid_t m_fid;
+    int m_nbr_refs;
+    unsigned long m_used; // time of last release
+  };
+  std::map<std::string, file_t> m_files; // by file name
+  unsigned long m_clock;
+
+  void trim(size_t max_files);
+};
+
+#endif
@@ -0,0 +1,362 @@
+#include <QtDebug>
+#include <limits>
+#include "plot.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//bin_kernel_t
+//per range of buckets of level 0: min and max of the elements of a block in each bucket, merged with
+//those of the blocks before (a bucket can span two blocks); ranges hold whole buckets, so that
+//tasks write disjoint slots
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+struct bin_kernel_t
+{
+  const T *m_buf;
+  hsize_t m_first; // line index of the first element of the block
+  size_t m_nbr_elements;
+  hsize_t m_bucket;
+  hsize_t m_first_bucket; // bucket of the first element of the block
+  double *m_min; // level 0
+  double *m_max;
+
+  void run(const h5range_t &range)
+  {
+    for(size_t idx = range.begin; idx < range.end; idx++)
+    {
+      hsize_t bucket = m_first_bucket + idx;
+      hsize_t begin = std::max(bucket * m_bucket, m_first) - m_first;
+      hsize_t end = std::min((bucket + 1) * m_bucket, m_first + m_nbr_elements) - m_first;
+      double min = m_min[bucket];
+      double max = m_max[bucket];
+      for(hsize_t idx_elem = begin; idx_elem < end; idx_elem++)
+      {
+        double value = static_cast<double>(m_buf[idx_elem]);
+        if(value != value)
+        {
+          continue;
+        }
+        min = value < min ? value : min;
+        max = value > max ? value : max;
+      }
+      m_min[bucket] = min;
+      m_max[bucket] = max;
+    }
+  }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//bin_block_t
+//functor for dispatch(): bins a block on the thread pool
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct bin_block_t
+{
+  const void *m_buf;
+  hsize_t m_first;
+  size_t m_nbr_elements;
+  hsize_t m_bucket;
+  double *m_min;
+  double *m_max;
+
+  template <typename T>
+  void apply()
+  {
+    bin_kernel_t<T> kernel;
+    kernel.m_buf = static_cast<const T*>(m_buf);
+    kernel.m_first = m_first;
+    kernel.m_nbr_elements = m_nbr_elements;
+    kernel.m_bucket = m_bucket;
+    kernel.m_first_bucket = m_first / m_bucket;
+    kernel.m_min = m_min;
+    kernel.m_max = m_max;
+    size_t nbr_buckets = static_cast<size_t>((m_first + m_nbr_elements - 1) / m_bucket - kernel.m_first_bucket + 1);
+    size_t grain = static_cast<size_t>(std::max<hsize_t>(1, 64 * 1024 / m_bucket));
+    std::vector<h5range_t> ranges = make_ranges(nbr_buckets, grain);
+    parallel_for(ranges, kernel);
+  }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//to_double_t
+//functor for dispatch(): converts elements read by get() to double
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct to_double_t
+{
+  const void *m_buf;
+  size_t m_nbr_elements;
+  std::vector<double> *m_out;
+
+  template <typename T>
+  void apply()
+  {
+    const T *buf = static_cast<const T*>(m_buf);
+    m_out->resize(m_nbr_elements);
+    for(size_t idx = 0; idx < m_nbr_elements; idx++)
+    {
+      (*m_out)[idx] = static_cast<double>(buf[idx]);
+    }
+  }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//reduce
+//min and max of each pixel dividing elements ['first', 'last') from buckets of 'bucket' elements,
+//bucket 0 starting at element 'origin'; a pixel takes every bucket it overlaps
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void reduce(const std::vector<double> &bucket_min, const std::vector<double> &bucket_max, hsize_t bucket, hsize_t origin,
+  hsize_t first, hsize_t last, size_t nbr_pixels, std::vector<double> &min, std::vector<double> &max)
+{
+  hsize_t nbr_elements = last - first;
+  min.assign(nbr_pixels, std::numeric_limits<double>::infinity());
+  max.assign(nbr_pixels, -std::numeric_limits<double>::infinity());
+  for(size_t idx_pixel = 0; idx_pixel < nbr_pixels; idx_pixel++)
+  {
+    hsize_t begin = first + idx_pixel * nbr_elements / nbr_pixels;
+    hsize_t end = first + (idx_pixel + 1) * nbr_elements / nbr_pixels;
+    if(end <= begin)
+    {
+      end = begin + 1;
+    }
+    size_t idx_begin = static_cast<size_t>((begin - origin) / bucket);
+    size_t idx_end = std::min(static_cast<size_t>((end - 1 - origin) / bucket) + 1, bucket_min.size());
+    for(size_t idx = idx_begin; idx < idx_end; idx++)
+    {
+      min[idx_pixel] = std::min(min[idx_pixel], bucket_min[idx]);
+      max[idx_pixel] = std::max(max[idx_pixel], bucket_max[idx]);
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5envelope_t::h5envelope_t
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+h5envelope_t::h5envelope_t() :
+m_axis(0),
+m_nbr_elements(0),
+m_min(0),
+m_max(0),
+m_bucket(1)
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5envelope_t::build
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5envelope_t::build(const char* file_name, const char* path, const std::vector<hsize_t> &start, size_t axis, h5progress_t *progress)
+{
+  h5slab_t slab;
+  int result = 0;
+
+  m_file_name = file_name;
+  m_path = path;
+  m_start = start;
+  m_axis = axis;
+  m_levels.clear();
+
+  if(slab.open(file_name, path) < 0)
+  {
+    return -1;
+  }
+  size_t rank = slab.m_dim.size();
+  if(slab.m_native == H5NATIVE_NONE || axis >= rank || start.size() != rank)
+  {
+    return -1;
+  }
+
+  //the line
+  std::vector<hsize_t> count(rank, 1);
+  m_start[axis] = 0;
+  m_nbr_elements = count[axis] = slab.m_dim[axis];
+  if(m_nbr_elements == 0)
+  {
+    m_min = m_max = 0;
+    return 0;
+  }
+  for(size_t idx = 0; idx < rank; idx++)
+  {
+    if(m_start[idx] + count[idx] > slab.m_dim[idx])
+    {
+      return -1;
+    }
+  }
+  if(slab.select(m_start, count) < 0)
+  {
+    return -1;
+  }
+
+  m_bucket = 1;
+  while((m_nbr_elements + m_bucket - 1) / m_bucket > max_buckets)
+  {
+    m_bucket *= 2;
+  }
+  m_levels.resize(1);
+  level_t &level = m_levels[0];
+  size_t nbr_buckets = static_cast<size_t>((m_nbr_elements + m_bucket - 1) / m_bucket);
+  level.m_bucket = m_bucket;
+  level.m_min.assign(nbr_buckets, std::numeric_limits<double>::infinity());
+  level.m_max.assign(nbr_buckets, -std::numeric_limits<double>::infinity());
+
+  h5queue_t<h5block_t*> queue(2);
+  h5reader_t reader(&slab, &queue);
+  reader.start();
+
+  hsize_t nbr_done = 0;
+  h5block_t *block;
+  while(queue.pop(block))
+  {
+    bin_block_t bin;
+    bin.m_buf = &block->m_buf[0];
+    bin.m_first = block->m_start[axis];
+    bin.m_nbr_elements = block->m_nbr_elements;
+    bin.m_bucket = m_bucket;
+    bin.m_min = &level.m_min[0];
+    bin.m_max = &level.m_max[0];
+    if(bin.m_nbr_elements > 0)
+    {
+      dispatch(slab.m_native, bin);
+    }
+
+    nbr_done += block->m_nbr_elements;
+    delete block;
+    if(progress && !progress->progress(nbr_done, m_nbr_elements))
+    {
+      result = 1;
+      break;
+    }
+  }
+
+  queue.close();
+  reader.wait();
+  while(queue.pop(block))
+  {
+    delete block;
+  }
+  if(reader.m_result < 0)
+  {
+    result = -1;
+  }
+  if(result != 0)
+  {
+    m_levels.clear();
+    return result;
+  }
+
+  //coarser levels
+  while(m_levels.back().m_min.size() > min_buckets)
+  {
+    level_t coarse;
+    const level_t &fine = m_levels.back();
+    size_t nbr = (fine.m_min.size() + 3) / 4;
+    coarse.m_bucket = fine.m_bucket * 4;
+    coarse.m_min.assign(nbr, std::numeric_limits<double>::infinity());
+    coarse.m_max.assign(nbr, -std::numeric_limits<double>::infinity());
+    for(size_t idx = 0; idx < fine.m_min.size(); idx++)
+    {
+      coarse.m_min[idx / 4] = std::min(coarse.m_min[idx / 4], fine.m_min[idx]);
+      coarse.m_max[idx / 4] = std::max(coarse.m_max[idx / 4], fine.m_max[idx]);
+    }
+    m_levels.push_back(coarse);
+  }
+
+  m_min = std::numeric_limits<double>::infinity();
+  m_max = -std::numeric_limits<double>::infinity();
+  const level_t &coarsest = m_levels.back();
+  for(size_t idx = 0; idx < coarsest.m_min.size(); idx++)
+  {
+    m_min = std::min(m_min, coarsest.m_min[idx]);
+    m_max = std::max(m_max, coarsest.m_max[idx]);
+  }
+  return 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5envelope_t::get
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5envelope_t::get(hsize_t first, hsize_t last, size_t nbr_pixels, std::vector<double> &min, std::vector<double> &max)
+{
+  last = std::min(last, m_nbr_elements);
+  if(m_levels.empty() || first >= last || nbr_pixels == 0)
+  {
+    min.clear();
+    max.clear();
+    return 0;
+  }
+  hsize_t nbr_elements = last - first;
+  if(nbr_pixels > nbr_elements)
+  {
+    nbr_pixels = static_cast<size_t>(nbr_elements);
+  }
+
+  //coarsest level with buckets no wider than a pixel
+  hsize_t pixel = nbr_elements / nbr_pixels;
+  size_t idx_level = m_levels.size();
+  while(idx_level > 0 && m_levels[idx_level - 1].m_bucket > pixel)
+  {
+    idx_level--;
+  }
+  if(idx_level == 0 && nbr_elements <= max_read)
+  {
+    return read(first, last, nbr_pixels, min, max);
+  }
+
+  const level_t &level = m_levels[idx_level > 0 ? idx_level - 1 : 0];
+  reduce(level.m_min, level.m_max, level.m_bucket, 0, first, last, nbr_pixels, min, max);
+  return 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5envelope_t::read
+//pixels of a range zoomed in past level 0, from the elements read again
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5envelope_t::read(hsize_t first, hsize_t last, size_t nbr_pixels, std::vector<double> &min, std::vector<double> &max)
+{
+  h5slab_t slab;
+  if(slab.open(m_file_name.c_str(), m_path.c_str()) < 0 || slab.m_dim.size() != m_start.size())
+  {
+    return -1;
+  }
+
+  std::vector<hsize_t> start = m_start;
+  std::vector<hsize_t> count(start.size(), 1);
+  start[m_axis] = first;
+  count[m_axis] = last - first;
+  if(last > slab.m_dim[m_axis])
+  {
+    return -1;
+  }
+
+  std::vector<char> buf(static_cast<size_t>(last - first) * slab.m_datatype_size);
+  if(slab.read(start, count, &buf[0]) < 0)
+  {
+    return -1;
+  }
+  std::vector<double> values;
+  to_double_t convert;
+  convert.m_buf = &buf[0];
+  convert.m_nbr_elements = static_cast<size_t>(last - first);
+  convert.m_out = &values;
+  if(!dispatch(slab.m_native, convert))
+  {
+    return -1;
+  }
+
+  //NaNs are empty pixels
+  std::vector<double> values_min(values);
+  for(size_t idx = 0; idx < values.size(); idx++)
+  {
+    if(values[idx] != values[idx])
+    {
+      values_min[idx] = std::numeric_limits<double>::infinity();
+      values[idx] = -std::numeric_limits<double>::infinity();
+    }
+  }
+  reduce(values_min, values, 1, first, first, last, nbr_pixels, min, max);
+  return 0;
+}
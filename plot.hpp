@@ -0,0 +1,59 @@
+#ifndef PLOT_HPP
+#define PLOT_HPP 1
+
+#include <string>
+#include <vector>
+#include "hdf5.h"
+#include "slab.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5envelope_t
+//min/max envelope of a line of a dataset, the elements along dimension 'm_axis' through 'm_start',
+//to plot it at the resolution of the screen whatever its length
+//level 0 has the min and max of each bucket of 'm_bucket' elements (a power of 2, so that there are
+//at most 'max_buckets' buckets), each next level the min and max of 4 buckets of the one before,
+//down to a few hundred buckets; build() streams the line once (h5slab_t blocks read ahead by
+//a h5reader_t, each block binned on the thread pool), so memory is bounded by level 0
+//get() gives the min and max of each pixel of a range: from the coarsest level with buckets no wider
+//than a pixel, or from the elements themselves, read again from the file, when the range is zoomed in
+//past level 0 and has at most 'max_read' elements
+//NaNs are skipped; a bucket or pixel without numbers has min > max
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class h5envelope_t
+{
+public:
+  h5envelope_t();
+
+  //returns 0, 1 if canceled by progress, -1 on error or if the dataset is not numeric
+  int build(const char* file_name, const char* path, const std::vector<hsize_t> &start, size_t axis, h5progress_t *progress);
+
+  //min and max of each of 'nbr_pixels' pixels dividing elements ['first', 'last'); with as many pixels
+  //as elements, these are the elements; returns -1 if the range cannot be read
+  int get(hsize_t first, hsize_t last, size_t nbr_pixels, std::vector<double> &min, std::vector<double> &max);
+
+  std::string m_file_name;
+  std::string m_path;
+  std::vector<hsize_t> m_start; // the line, with 0 in dimension 'm_axis'
+  size_t m_axis;
+  hsize_t m_nbr_elements; // in the line
+  double m_min; // of the whole line
+  double m_max;
+  hsize_t m_bucket; // of level 0
+
+  static const size_t max_buckets = 1 << 20;
+  static const size_t min_buckets = 1024;
+  static const hsize_t max_read = 1 << 20;
+
+private:
+  struct level_t
+  {
+    hsize_t m_bucket;
+    std::vector<double> m_min;
+    std::vector<double> m_max;
+  };
+  std::vector<level_t> m_levels;
+  int read(hsize_t first, hsize_t last, size_t nbr_pixels, std::vector<double> &min, std::vector<double> &max);
+};
+
+#endif
@@ -0,0 +1,224 @@
+#include <QtDebug>
+#include "report.hpp"
+#include "http.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5report_t::h5report_t
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+h5report_t::h5report_t() :
+m_file_size(0),
+m_free_space(0),
+m_superblock_size(0),
+m_free_meta_size(0),
+m_sohm_size(0),
+m_storage_size(0),
+m_header_size(0),
+m_index_size(0),
+m_attribute_size(0),
+m_other_size(0)
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5report_t::run
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5report_t::run(const char* file_name, h5progress_t *progress)
+{
+  hid_t fid;
+  int result = 0;
+
+  m_objects.clear();
+  m_paths.clear();
+  m_seen.clear();
+
+  {
+    h5lock_t lock;
+
+    if((fid = h5file_open(file_name)) < 0)
+    {
+      return -1;
+    }
+
+    H5Fget_filesize(fid, &m_file_size);
+    hssize_t free_space = H5Fget_freespace(fid);
+    m_free_space = free_space > 0 ? static_cast<hsize_t>(free_space) : 0;
+
+#if H5_VERSION_GE(1,10,0)
+    H5F_info2_t finfo;
+    if(H5Fget_info2(fid, &finfo) >= 0)
+    {
+      m_superblock_size = finfo.super.super_size + finfo.super.super_ext_size;
+      m_free_meta_size = finfo.free.meta_size;
+      m_sohm_size = finfo.sohm.hdr_size + finfo.sohm.msgs_info.index_size + finfo.sohm.msgs_info.heap_size;
+    }
+#else
+    H5F_info_t finfo;
+    if(H5Fget_info(fid, &finfo) >= 0)
+    {
+      m_superblock_size = finfo.super_ext_size;
+      m_sohm_size = finfo.sohm.hdr_size + finfo.sohm.msgs_info.index_size + finfo.sohm.msgs_info.heap_size;
+    }
+#endif
+
+    //list the objects: the root group, then one path per object reachable by hard links
+    H5O_info_t oinfo;
+    if(H5Oget_info_by_name(fid, "/", &oinfo, H5P_DEFAULT) >= 0)
+    {
+      m_seen.insert(oinfo.addr);
+      m_paths.push_back("/");
+    }
+    if(H5Lvisit_by_name(fid, "/", H5_INDEX_NAME, H5_ITER_INC, visit_link_cb, this, H5P_DEFAULT) < 0)
+    {
+      H5Fclose(fid);
+      return -1;
+    }
+  }
+
+  for(size_t idx = 0; idx < m_paths.size(); idx++)
+  {
+    if(add_object(fid, m_paths[idx]) < 0)
+    {
+      qDebug() << "cannot measure" << m_paths[idx].c_str();
+    }
+    if(progress && !progress->progress(idx + 1, m_paths.size()))
+    {
+      result = 1;
+      break;
+    }
+  }
+
+  {
+    h5lock_t lock;
+    H5Fclose(fid);
+  }
+
+  m_storage_size = 0;
+  m_header_size = 0;
+  m_index_size = 0;
+  m_attribute_size = 0;
+  for(size_t idx = 0; idx < m_objects.size(); idx++)
+  {
+    m_storage_size += m_objects[idx].m_storage_size;
+    m_header_size += m_objects[idx].m_header_size;
+    m_index_size += m_objects[idx].m_index_size;
+    m_attribute_size += m_objects[idx].m_attribute_size;
+  }
+  hsize_t known = m_storage_size + m_header_size + m_index_size + m_attribute_size +
+    m_superblock_size + m_free_space + m_free_meta_size + m_sohm_size;
+  m_other_size = m_file_size > known ? m_file_size - known : 0;
+
+  return result;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5report_t::add_object
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5report_t::add_object(hid_t fid, const std::string &path)
+{
+  h5lock_t lock;
+  H5O_info_t oinfo;
+  h5object_size_t object;
+
+  if(H5Oget_info_by_name(fid, path.c_str(), &oinfo, H5P_DEFAULT) < 0)
+  {
+    return -1;
+  }
+
+  object.m_path = path;
+  object.m_type = oinfo.type;
+  object.m_layout = H5D_LAYOUT_ERROR;
+  object.m_nbr_filters = 0;
+  object.m_logical_size = 0;
+  object.m_storage_size = 0;
+  object.m_header_size = oinfo.hdr.space.total;
+  object.m_index_size = oinfo.meta_size.obj.index_size + oinfo.meta_size.obj.heap_size;
+  object.m_attribute_size = oinfo.meta_size.attr.index_size + oinfo.meta_size.attr.heap_size;
+  object.m_nbr_attributes = oinfo.num_attrs;
+
+  if(oinfo.type == H5O_TYPE_DATASET)
+  {
+    hid_t did;
+    if((did = H5Dopen2(fid, path.c_str(), H5P_DEFAULT)) >= 0)
+    {
+      hid_t sid;
+      hid_t ftid;
+      hid_t dcpl;
+      object.m_storage_size = H5Dget_storage_size(did);
+      if((sid = H5Dget_space(did)) >= 0 && (ftid = H5Dget_type(did)) >= 0)
+      {
+        hssize_t nbr_elements = H5Sget_simple_extent_npoints(sid);
+        object.m_logical_size = nbr_elements > 0 ? static_cast<hsize_t>(nbr_elements) * H5Tget_size(ftid) : 0;
+        H5Tclose(ftid);
+      }
+      if(sid >= 0)
+      {
+        H5Sclose(sid);
+      }
+      if((dcpl = H5Dget_create_plist(did)) >= 0)
+      {
+        object.m_layout = H5Pget_layout(dcpl);
+        object.m_nbr_filters = H5Pget_nfilters(dcpl);
+        H5Pclose(dcpl);
+      }
+      H5Dclose(did);
+    }
+  }
+
+  //attribute data
+  if(oinfo.num_attrs > 0)
+  {
+    hid_t oid;
+    if((oid = H5Oopen(fid, path.c_str(), H5P_DEFAULT)) >= 0)
+    {
+      hsize_t nbr_bytes = 0;
+      hsize_t idx = 0;
+      H5Aiterate2(oid, H5_INDEX_NAME, H5_ITER_INC, &idx, attribute_cb, &nbr_bytes);
+      object.m_attribute_size += nbr_bytes;
+      H5Oclose(oid);
+    }
+  }
+
+  m_objects.push_back(object);
+  return 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5report_t::visit_link_cb
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+herr_t h5report_t::visit_link_cb(hid_t loc_id, const char *name, const H5L_info_t *linfo, void *_op_data)
+{
+  h5report_t *udata = (h5report_t*)_op_data;
+
+  if(linfo->type == H5L_TYPE_HARD)
+  {
+    //an object linked more than once is counted once
+    if(udata->m_seen.insert(linfo->u.address).second)
+    {
+      udata->m_paths.push_back(std::string("/") + name);
+    }
+  }
+
+  (void)loc_id;
+  return(H5_ITER_CONT);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5report_t::attribute_cb
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+herr_t h5report_t::attribute_cb(hid_t loc_id, const char *name, const H5A_info_t *, void *_op_data)
+{
+  hsize_t *nbr_bytes = (hsize_t*)_op_data;
+  hid_t aid;
+
+  if((aid = H5Aopen(loc_id, name, H5P_DEFAULT)) >= 0)
+  {
+    *nbr_bytes += H5Aget_storage_size(aid);
+    H5Aclose(aid);
+  }
+  return(H5_ITER_CONT);
+}
@@ -0,0 +1,74 @@
+#ifndef REPORT_HPP
+#define REPORT_HPP 1
+
+#include <set>
+#include <string>
+#include <vector>
+#include "hdf5.h"
+#include "slab.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5object_size_t
+//storage of one object of a file, in bytes
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct h5object_size_t
+{
+  std::string m_path;
+  H5O_type_t m_type;
+  H5D_layout_t m_layout; // datasets
+  int m_nbr_filters;
+  hsize_t m_logical_size; // datasets: elements times type size
+  hsize_t m_storage_size; // datasets: raw data allocated (H5Dget_storage_size)
+  hsize_t m_header_size; // object header (H5Oget_info hdr)
+  hsize_t m_index_size; // group links or chunk index: B-trees and heaps (H5Oget_info meta_size.obj)
+  hsize_t m_attribute_size; // dense attribute storage and attribute data
+  hsize_t m_nbr_attributes;
+
+  hsize_t total() const
+  {
+    return m_storage_size + m_header_size + m_index_size + m_attribute_size;
+  }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5report_t
+//storage of a whole file: one entry per object (hard links to an object already seen are skipped),
+//and the file totals (H5Fget_info, H5Fget_freespace)
+//the links are walked once holding h5lock_t, then each object is measured taking the lock
+//for that object only, so that the GUI is not blocked for the whole walk
+//'m_other_size' is what the objects, the superblock and the free space do not account for
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class h5report_t
+{
+public:
+  h5report_t();
+
+  //returns 0, 1 if canceled by progress, -1 on error
+  int run(const char* file_name, h5progress_t *progress);
+
+  std::vector<h5object_size_t> m_objects;
+  hsize_t m_file_size;
+  hsize_t m_free_space;
+  hsize_t m_superblock_size; // superblock and its extension
+  hsize_t m_free_meta_size; // free space manager metadata
+  hsize_t m_sohm_size; // shared object header messages
+  hsize_t m_storage_size; // totals of the objects
+  hsize_t m_header_size;
+  hsize_t m_index_size;
+  hsize_t m_attribute_size;
+  hsize_t m_other_size;
+
+private:
+  std::vector<std::string> m_paths; // one path per object
+  std::set<haddr_t> m_seen;
+
+  int add_object(hid_t fid, const std::string &path);
+
+  // callbacks for H5Lvisit_by_name and H5Aiterate2
+  static herr_t visit_link_cb(hid_t loc_id, const char *name, const H5L_info_t *linfo, void *_op_data);
+  static herr_t attribute_cb(hid_t loc_id, const char *name, const H5A_info_t *ainfo, void *_op_data);
+};
+
+#endif
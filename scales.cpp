@@ -0,0 +1,320 @@
+#include <QtDebug>
+#include <cstdio>
+#include <cstring>
+#include "hdf5_hl.h"
+#include "scales.hpp"
+#include "http.hpp"
+#include "slab.hpp"
+
+//name given by NetCDF-4 to the scales of dimensions without coordinate variable
+static const char netcdf_dimension[] = "This is a netCDF dimension but not a netCDF variable";
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5scale_cache_t::instance
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+h5scale_cache_t* h5scale_cache_t::instance()
+{
+  static h5scale_cache_t cache;
+  return &cache;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5scale_cache_t::h5scale_cache_t
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+h5scale_cache_t::h5scale_cache_t() :
+m_clock(0)
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5scale_cache_t::get
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool h5scale_cache_t::get(const std::string &file_name, const std::string &path, hsize_t idx, std::string &label)
+{
+  hsize_t start = idx - idx % block_size;
+  key_t key(std::make_pair(file_name, path), start);
+  std::map<key_t, block_t>::iterator it = m_blocks.find(key);
+
+  //a last block that is too short is read again: the dataset may have grown
+  if(it == m_blocks.end() || idx - start >= it->second.m_labels.size())
+  {
+    std::vector<std::string> labels;
+    if(read(file_name, path, start, labels) < 0 || idx - start >= labels.size())
+    {
+      return false;
+    }
+
+    if(it == m_blocks.end() && m_blocks.size() >= max_blocks)
+    {
+      std::map<key_t, block_t>::iterator oldest = m_blocks.begin();
+      for(std::map<key_t, block_t>::iterator it_block = m_blocks.begin(); it_block != m_blocks.end(); ++it_block)
+      {
+        if(it_block->second.m_used < oldest->second.m_used)
+          oldest = it_block;
+      }
+      m_blocks.erase(oldest);
+    }
+    it = m_blocks.insert(std::make_pair(key, block_t())).first;
+    it->second.m_labels.swap(labels);
+  }
+
+  it->second.m_used = ++m_clock;
+  label = it->second.m_labels[static_cast<size_t>(idx - start)];
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5scale_cache_t::clear
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void h5scale_cache_t::clear(const std::string &file_name)
+{
+  std::map<key_t, block_t>::iterator it = m_blocks.begin();
+  while(it != m_blocks.end())
+  {
+    if(it->first.first.first == file_name)
+      m_blocks.erase(it++);
+    else
+      ++it;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5scale_cache_t::read
+//values 'start' to 'start' + block_size (or the end) of a 1-D dataset of numbers or strings
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5scale_cache_t::read(const std::string &file_name, const std::string &path, hsize_t start, std::vector<std::string> &labels)
+{
+  h5lock_t lock;
+  hid_t fid;
+  hid_t did = -1;
+  hid_t sid = -1;
+  hid_t msid = -1;
+  hid_t ftid = -1;
+  hid_t mtid = -1;
+  hsize_t dims[H5S_MAX_RANK];
+  hsize_t count;
+  int result = -1;
+  char str[64];
+
+  labels.clear();
+  if((fid = h5file_open(file_name.c_str())) < 0)
+  {
+    return -1;
+  }
+
+  if((did = H5Dopen2(fid, path.c_str(), H5P_DEFAULT)) < 0 ||
+    (sid = H5Dget_space(did)) < 0 ||
+    (ftid = H5Dget_type(did)) < 0 ||
+    H5Sget_simple_extent_ndims(sid) != 1 ||
+    H5Sget_simple_extent_dims(sid, dims, NULL) < 0 ||
+    start >= dims[0])
+  {
+    goto out;
+  }
+
+  count = dims[0] - start < block_size ? dims[0] - start : block_size;
+  if(H5Sselect_hyperslab(sid, H5S_SELECT_SET, &start, NULL, &count, NULL) < 0 ||
+    (msid = H5Screate_simple(1, &count, NULL)) < 0)
+  {
+    goto out;
+  }
+
+  switch(H5Tget_class(ftid))
+  {
+  case H5T_INTEGER:
+    {
+      std::vector<long long> buf(static_cast<size_t>(count));
+      if(H5Dread(did, H5T_NATIVE_LLONG, msid, sid, H5P_DEFAULT, &buf[0]) < 0)
+        goto out;
+      for(size_t idx = 0; idx < buf.size(); idx++)
+      {
+        snprintf(str, sizeof(str), "%lld", buf[idx]);
+        labels.push_back(str);
+      }
+      result = 0;
+    }
+    break;
+
+  case H5T_FLOAT:
+    {
+      std::vector<double> buf(static_cast<size_t>(count));
+      if(H5Dread(did, H5T_NATIVE_DOUBLE, msid, sid, H5P_DEFAULT, &buf[0]) < 0)
+        goto out;
+      for(size_t idx = 0; idx < buf.size(); idx++)
+      {
+        snprintf(str, sizeof(str), "%g", buf[idx]);
+        labels.push_back(str);
+      }
+      result = 0;
+    }
+    break;
+
+  case H5T_STRING:
+    if((mtid = H5Tcopy(H5T_C_S1)) < 0)
+      goto out;
+    if(H5Tis_variable_str(ftid) > 0)
+    {
+      std::vector<char*> buf(static_cast<size_t>(count), (char*)NULL);
+      if(H5Tset_size(mtid, H5T_VARIABLE) < 0 || H5Dread(did, mtid, msid, sid, H5P_DEFAULT, &buf[0]) < 0)
+        goto out;
+      for(size_t idx = 0; idx < buf.size(); idx++)
+      {
+        labels.push_back(buf[idx] ? buf[idx] : "");
+      }
+      H5Dvlen_reclaim(mtid, msid, H5P_DEFAULT, &buf[0]);
+    }
+    else
+    {
+      size_t size = H5Tget_size(ftid);
+      std::vector<char> buf(static_cast<size_t>(count) * size);
+      if(size == 0 || H5Tset_size(mtid, size) < 0 || H5Dread(did, mtid, msid, sid, H5P_DEFAULT, &buf[0]) < 0)
+        goto out;
+      for(size_t idx = 0; idx < static_cast<size_t>(count); idx++)
+      {
+        const char *value = &buf[idx * size];
+        labels.push_back(std::string(value, strnlen(value, size)));
+      }
+    }
+    result = 0;
+    break;
+
+  default:
+    break;
+  }
+
+out:
+  if(mtid >= 0)
+    H5Tclose(mtid);
+  if(ftid >= 0)
+    H5Tclose(ftid);
+  if(msid >= 0)
+    H5Sclose(msid);
+  if(sid >= 0)
+    H5Sclose(sid);
+  if(did >= 0)
+    H5Dclose(did);
+  H5Fclose(fid);
+  return result;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5scales_t::open
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5scales_t::open(const char* file_name, const char* path)
+{
+  h5lock_t lock;
+  hid_t fid;
+  hid_t did;
+  hid_t sid;
+  int rank;
+  int nbr_scales = 0;
+  char name[1024];
+
+  m_file_name = file_name;
+  m_axes.clear();
+
+  if((fid = h5file_open(file_name)) < 0)
+  {
+    return -1;
+  }
+  if((did = H5Dopen2(fid, path, H5P_DEFAULT)) < 0)
+  {
+    H5Fclose(fid);
+    return -1;
+  }
+  rank = -1;
+  if((sid = H5Dget_space(did)) >= 0)
+  {
+    rank = H5Sget_simple_extent_ndims(sid);
+    H5Sclose(sid);
+  }
+
+  for(int dim = 0; dim < rank; dim++)
+  {
+    h5axis_t axis;
+    int nbr;
+    H5E_BEGIN_TRY
+    {
+      nbr = H5DSget_num_scales(did, static_cast<unsigned int>(dim));
+      if(nbr > 0)
+      {
+        H5DSiterate_scales(did, static_cast<unsigned int>(dim), NULL, scale_cb, &axis);
+      }
+      if(!axis.m_path.empty() && H5DSget_label(did, static_cast<unsigned int>(dim), name, sizeof(name)) > 0)
+      {
+        axis.m_name = name;
+      }
+    }
+    H5E_END_TRY;
+    if(!axis.m_path.empty())
+    {
+      nbr_scales++;
+    }
+    m_axes.push_back(axis);
+  }
+
+  H5Dclose(did);
+  H5Fclose(fid);
+  return rank < 0 ? -1 : nbr_scales;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5scales_t::scale_cb
+//first scale of a dimension with values: 1-D, not a NetCDF-4 dimension without variable
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+herr_t h5scales_t::scale_cb(hid_t, unsigned, hid_t dsid, void *_op_data)
+{
+  h5axis_t *axis = (h5axis_t*)_op_data;
+  char name[1024];
+  hid_t sid;
+  int rank = -1;
+
+  if((sid = H5Dget_space(dsid)) >= 0)
+  {
+    rank = H5Sget_simple_extent_ndims(sid);
+    H5Sclose(sid);
+  }
+  if(rank != 1)
+  {
+    return 0;
+  }
+  if(H5DSget_scale_name(dsid, name, sizeof(name)) > 0)
+  {
+    if(strncmp(name, netcdf_dimension, strlen(netcdf_dimension)) == 0)
+    {
+      return 0;
+    }
+    axis->m_name = name;
+  }
+  if(H5Iget_name(dsid, name, sizeof(name)) <= 0)
+  {
+    return 0;
+  }
+  axis->m_path = name;
+  if(axis->m_name.empty())
+  {
+    axis->m_name = axis->m_path.substr(axis->m_path.rfind('/') + 1);
+  }
+  return 1;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5scales_t::label
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::string h5scales_t::label(size_t dim, hsize_t idx) const
+{
+  std::string str;
+  if(has_scale(dim))
+  {
+    h5scale_cache_t::instance()->get(m_file_name, m_axes[dim].m_path, idx, str);
+  }
+  return str;
+}
@@ -0,0 +1,85 @@
+#ifndef SCALES_HPP
+#define SCALES_HPP 1
+
+#include <map>
+#include <string>
+#include <vector>
+#include "hdf5.h"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5scale_cache_t
+//values of the 1-D datasets used as axis labels, formatted as text
+//they are read in blocks of 'block_size' values when first asked for, so that labeling the visible
+//part of a long axis does not read the whole axis; the blocks are shared by all the windows, and
+//the least recently used ones are dropped above 'max_blocks'
+//used from the GUI thread only
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class h5scale_cache_t
+{
+public:
+  static h5scale_cache_t* instance();
+
+  //label of value 'idx' of dataset 'path' of file 'file_name'; false if it cannot be read
+  bool get(const std::string &file_name, const std::string &path, hsize_t idx, std::string &label);
+
+  //drop the blocks of a file, after it changed
+  void clear(const std::string &file_name);
+
+  enum { block_size = 1024, max_blocks = 256 };
+
+private:
+  h5scale_cache_t();
+
+  struct block_t
+  {
+    std::vector<std::string> m_labels; // shorter than block_size for the last block
+    unsigned long m_used; // time of last use
+  };
+  typedef std::pair<std::pair<std::string, std::string>, hsize_t> key_t; // file, path, first index
+  std::map<key_t, block_t> m_blocks;
+  unsigned long m_clock;
+
+  int read(const std::string &file_name, const std::string &path, hsize_t start, std::vector<std::string> &labels);
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5axis_t
+//dimension scale attached to one dimension of a dataset
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct h5axis_t
+{
+  std::string m_path; // scale dataset, empty if the dimension has none
+  std::string m_name; // dimension label, or scale name
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5scales_t
+//axis labels of a dataset, from the dimension scales attached to it (H5DSiterate_scales)
+//NetCDF-4 coordinate variables are dimension scales; the scales NetCDF-4 makes for dimensions
+//without a coordinate variable hold no values and are skipped
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class h5scales_t
+{
+public:
+  //find the scales of dataset 'path'; returns the number of dimensions with one, -1 on error
+  int open(const char* file_name, const char* path);
+
+  bool has_scale(size_t dim) const
+  {
+    return dim < m_axes.size() && !m_axes[dim].m_path.empty();
+  }
+
+  //label of index 'idx' of dimension 'dim'; empty if there is none
+  std::string label(size_t dim, hsize_t idx) const;
+
+  std::string m_file_name;
+  std::vector<h5axis_t> m_axes; // one per dimension
+
+private:
+  static herr_t scale_cb(hid_t did, unsigned dim, hid_t dsid, void *_op_data);
+};
+
+#endif
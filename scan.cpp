@@ -0,0 +1,994 @@
+#include <QtDebug>
+#include <cstdio>
+#include <sys/stat.h>
+#include "scan.hpp"
+#include "http.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//get_type
+//dimensions and native type of a dataset or attribute, given its dataspace and file type
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void get_type(hid_t sid, hid_t ftid, h5entry_t &entry)
+{
+  hsize_t dims[H5S_MAX_RANK];
+  hid_t mtid;
+  int rank;
+
+  entry.m_datatype_size = 0;
+  entry.m_datatype_sign = H5T_SGN_ERROR;
+  entry.m_datatype_class = H5T_NO_CLASS;
+
+  if((rank = H5Sget_simple_extent_dims(sid, dims, NULL)) > 0)
+  {
+    entry.m_dim.assign(dims, dims + rank);
+  }
+
+  if((mtid = H5Tget_native_type(ftid, H5T_DIR_DEFAULT)) >= 0)
+  {
+    entry.m_datatype_size = H5Tget_size(mtid);
+    entry.m_datatype_sign = H5Tget_sign(mtid);
+    entry.m_datatype_class = H5Tget_class(mtid);
+    H5Tclose(mtid);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5header_t::h5header_t
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+h5header_t::h5header_t() :
+m_mtime(0),
+m_nbr_attributes(0),
+m_nbr_messages(0),
+m_header_size(0),
+m_message_size(0),
+m_index_size(0),
+m_attribute_size(0)
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5header_t::get
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void h5header_t::get(const H5O_info_t &oinfo)
+{
+  m_mtime = static_cast<long long>(oinfo.mtime);
+  m_nbr_attributes = oinfo.num_attrs;
+  m_nbr_messages = oinfo.hdr.nmesgs;
+  m_header_size = oinfo.hdr.space.total;
+  m_message_size = oinfo.hdr.space.mesg;
+  m_index_size = oinfo.meta_size.obj.index_size + oinfo.meta_size.obj.heap_size;
+  m_attribute_size = oinfo.meta_size.attr.index_size + oinfo.meta_size.attr.heap_size;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5header_t::operator==
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool h5header_t::operator==(const h5header_t &other) const
+{
+  return m_mtime == other.m_mtime &&
+    m_nbr_attributes == other.m_nbr_attributes &&
+    m_nbr_messages == other.m_nbr_messages &&
+    m_header_size == other.m_header_size &&
+    m_message_size == other.m_message_size &&
+    m_index_size == other.m_index_size &&
+    m_attribute_size == other.m_attribute_size;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5scan_t::scan
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const size_t h5scan_t::npos;
+
+int h5scan_t::scan(const char* file_name, h5progress_t *progress)
+{
+  m_prev = NULL;
+  m_previous.clear();
+  return walk(file_name, progress);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5scan_t::rescan
+//the new entries are made by another h5scan_t, which looks up the current ones
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5scan_t::rescan(const char* file_name, h5progress_t *progress)
+{
+  h5scan_t next;
+  int result;
+
+  next.m_prev = this;
+  next.m_prev_attr_first.assign(m_entries.size(), 0);
+  next.m_prev_attr_count.assign(m_entries.size(), 0);
+  next.m_prev_walked.assign(m_entries.size(), true);
+  for(size_t idx = 0; idx < m_pending.size(); idx++)
+  {
+    next.m_prev_walked[m_pending[idx]] = false;
+  }
+  for(size_t idx = 1; idx < m_entries.size(); idx++)
+  {
+    const h5entry_t &entry = m_entries[idx];
+    if(entry.m_kind == ENTRY_ATTRIBUTE)
+    {
+      if(next.m_prev_attr_count[entry.m_parent]++ == 0)
+      {
+        next.m_prev_attr_first[entry.m_parent] = idx;
+      }
+    }
+    else
+    {
+      next.m_prev_objects[std::make_pair(entry.m_parent, entry.m_name)] = idx;
+    }
+  }
+
+  if((result = next.walk(file_name, progress)) == 0)
+  {
+    m_entries.swap(next.m_entries);
+    m_previous.swap(next.m_previous);
+    m_pending.clear();
+    m_key = next.m_key;
+  }
+  return result;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5scan_t::resolve
+//the target file is shared with the other links to it through h5file_cache_t; a link to a link
+//is followed by the library
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5scan_t::resolve(const std::string &file_name, const h5link_t &link, std::string &target_file)
+{
+  h5file_cache_t *cache = h5file_cache_t::instance();
+  std::vector<std::string> names;
+  hid_t fid = -1;
+  int result = -1;
+
+  m_prev = NULL;
+  m_previous.clear();
+  m_entries.clear();
+  m_groups.clear();
+  m_pending.clear();
+  target_file.clear();
+
+  h5lock_t lock;
+  link.candidates(file_name, names);
+  for(size_t idx = 0; idx < names.size() && fid < 0; idx++)
+  {
+    if((fid = cache->acquire(names[idx])) >= 0)
+    {
+      target_file = names[idx];
+    }
+  }
+  if(fid < 0)
+  {
+    qDebug() << "cannot open" << link.m_file_name.c_str() << "linked from" << file_name.c_str();
+    return -1;
+  }
+
+  H5O_info_t oinfo;
+  herr_t status;
+  H5E_BEGIN_TRY
+  {
+    status = H5Oget_info_by_name(fid, link.m_path.c_str(), &oinfo, H5P_DEFAULT);
+  }
+  H5E_END_TRY;
+
+  h5entry_t target;
+  target.m_parent = 0;
+  target.m_path = link.m_path;
+  target.m_name = link.m_path.substr(link.m_path.find_last_of('/') + 1);
+  if(target.m_name.empty())
+    target.m_name = "/";
+  target.m_datatype_size = 0;
+  target.m_datatype_sign = H5T_SGN_ERROR;
+  target.m_datatype_class = H5T_NO_CLASS;
+  if(status >= 0)
+  {
+    target.m_addr = oinfo.addr;
+    target.m_header.get(oinfo);
+  }
+
+  if(status >= 0 && oinfo.type == H5O_TYPE_GROUP)
+  {
+    std::vector<size_t> groups;
+    hid_t gid;
+    target.m_kind = ENTRY_GROUP;
+    add_entry(target, npos);
+    m_groups.insert(oinfo.addr);
+    if((result = scan_group(fid, 0, groups)) == 0 && (gid = H5Gopen2(fid, link.m_path.c_str(), H5P_DEFAULT)) >= 0)
+    {
+      add_attributes(gid, 0, link.m_path);
+      H5Gclose(gid);
+    }
+  }
+  else if(status >= 0 && oinfo.type == H5O_TYPE_DATASET)
+  {
+    hid_t did;
+    hid_t sid;
+    hid_t ftid;
+    target.m_kind = ENTRY_DATASET;
+    if((did = H5Dopen2(fid, link.m_path.c_str(), H5P_DEFAULT)) >= 0)
+    {
+      if((sid = H5Dget_space(did)) >= 0)
+      {
+        if((ftid = H5Dget_type(did)) >= 0)
+        {
+          get_type(sid, ftid, target);
+          H5Tclose(ftid);
+        }
+        H5Sclose(sid);
+      }
+      add_entry(target, npos);
+      add_attributes(did, 0, link.m_path);
+      H5Dclose(did);
+      result = 0;
+    }
+  }
+  else
+  {
+    qDebug() << "cannot find" << link.m_path.c_str() << "in" << target_file.c_str();
+  }
+
+  cache->release(fid);
+  if(result < 0)
+  {
+    m_entries.clear();
+  }
+  return result;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5scan_t::walk
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5scan_t::walk(const char* file_name, h5progress_t *progress)
+{
+  hid_t fid;
+  int result = 0;
+  std::vector<size_t> groups; // groups to walk, the next one last
+
+  m_entries.clear();
+  m_groups.clear();
+  m_pending.clear();
+  m_key = h5scan_key_t();
+  m_key.stat(file_name);
+
+  {
+    h5lock_t lock;
+    H5O_info_t oinfo;
+
+    if((fid = h5file_open(file_name)) < 0)
+    {
+      return -1;
+    }
+    m_key.read(fid);
+
+    h5entry_t root;
+    root.m_kind = ENTRY_GROUP;
+    root.m_parent = 0;
+    root.m_name = "/";
+    root.m_path = "/";
+    root.m_datatype_size = 0;
+    root.m_datatype_sign = H5T_SGN_ERROR;
+    root.m_datatype_class = H5T_NO_CLASS;
+    root.m_addr = HADDR_UNDEF;
+    if(H5Oget_info(fid, &oinfo) >= 0)
+    {
+      root.m_addr = oinfo.addr;
+      root.m_header.get(oinfo);
+      m_groups.insert(oinfo.addr);
+    }
+    //the root is the same tree item, whatever changed
+    add_entry(root, 0);
+    groups.push_back(0);
+  }
+
+  while(groups.size())
+  {
+    size_t idx_group = groups.back();
+    groups.pop_back();
+    if(scan_group(fid, idx_group, groups) < 0)
+    {
+      qDebug() << "cannot walk" << m_entries[idx_group].m_path.c_str();
+    }
+    if(progress && !progress->progress(m_entries.size(), 0))
+    {
+      result = 1;
+      m_pending.swap(groups);
+      break;
+    }
+  }
+
+  {
+    h5lock_t lock;
+    H5Fclose(fid);
+  }
+
+  return result;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5scan_t::add_entry
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+size_t h5scan_t::add_entry(const h5entry_t &entry, size_t idx_prev)
+{
+  m_entries.push_back(entry);
+  if(m_prev)
+  {
+    m_previous.push_back(idx_prev);
+  }
+  return m_entries.size() - 1;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5scan_t::find_previous
+//entry of the previous scan for link 'name' of group 'idx_group': same parent, name and address;
+//a dataset must also have the same header
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+size_t h5scan_t::find_previous(size_t idx_group, const std::string &name, const H5O_info_t &oinfo) const
+{
+  if(m_prev == NULL || m_previous[idx_group] == npos)
+  {
+    return npos;
+  }
+  std::map<std::pair<size_t, std::string>, size_t>::const_iterator it;
+  if((it = m_prev_objects.find(std::make_pair(m_previous[idx_group], name))) == m_prev_objects.end())
+  {
+    return npos;
+  }
+  const h5entry_t &prev = m_prev->m_entries[it->second];
+  if(prev.m_addr != oinfo.addr)
+  {
+    return npos;
+  }
+  if(oinfo.type == H5O_TYPE_GROUP && prev.m_kind == ENTRY_GROUP)
+  {
+    return it->second;
+  }
+  h5header_t header;
+  header.get(oinfo);
+  if(oinfo.type == H5O_TYPE_DATASET && prev.m_kind == ENTRY_DATASET && prev.m_header == header)
+  {
+    return it->second;
+  }
+  return npos;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5scan_t::find_previous_link
+//entry of the previous scan for a soft or external link: same parent, name and target
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+size_t h5scan_t::find_previous_link(size_t idx_group, const h5entry_t &entry) const
+{
+  if(m_prev == NULL || m_previous[idx_group] == npos)
+  {
+    return npos;
+  }
+  std::map<std::pair<size_t, std::string>, size_t>::const_iterator it;
+  if((it = m_prev_objects.find(std::make_pair(m_previous[idx_group], entry.m_name))) == m_prev_objects.end())
+  {
+    return npos;
+  }
+  const h5entry_t &prev = m_prev->m_entries[it->second];
+  if(prev.m_kind == ENTRY_LINK && prev.m_link.m_type == entry.m_link.m_type &&
+    prev.m_link.m_file_name == entry.m_link.m_file_name && prev.m_link.m_path == entry.m_link.m_path)
+  {
+    return it->second;
+  }
+  return npos;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5scan_t::copy_attributes
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void h5scan_t::copy_attributes(size_t idx_prev, size_t idx_parent)
+{
+  size_t first = m_prev_attr_first[idx_prev];
+  size_t count = m_prev_attr_count[idx_prev];
+  for(size_t idx = first; idx < first + count; idx++)
+  {
+    h5entry_t entry = m_prev->m_entries[idx];
+    entry.m_parent = idx_parent;
+    entry.m_path = m_entries[idx_parent].m_path;
+    add_entry(entry, idx);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5scan_t::scan_group
+//adds the objects linked from group 'idx_group', then its attributes; the groups to walk
+//are pushed to 'groups' so that they are popped in link order
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5scan_t::scan_group(hid_t fid, size_t idx_group, std::vector<size_t> &groups)
+{
+  h5lock_t lock;
+  std::string grp_path = m_entries[idx_group].m_path;
+  std::vector<std::pair<std::string, H5L_type_t> > links;
+  std::vector<std::string> names;
+  std::vector<size_t> children;
+  hid_t gid;
+
+  if((gid = H5Gopen2(fid, grp_path.c_str(), H5P_DEFAULT)) < 0)
+  {
+    return -1;
+  }
+
+  if(H5Literate(gid, H5_INDEX_NAME, H5_ITER_INC, NULL, link_cb, &links) < 0)
+  {
+    H5Gclose(gid);
+    return -1;
+  }
+  for(size_t idx = 0; idx < links.size(); idx++)
+  {
+    names.push_back(links[idx].first);
+  }
+
+  for(size_t idx = 0; idx < names.size(); idx++)
+  {
+    h5entry_t entry;
+    entry.m_parent = idx_group;
+    entry.m_name = names[idx];
+    entry.m_path = grp_path;
+    if(grp_path != "/")
+      entry.m_path += "/";
+    entry.m_path += names[idx];
+    entry.m_datatype_size = 0;
+    entry.m_datatype_sign = H5T_SGN_ERROR;
+    entry.m_datatype_class = H5T_NO_CLASS;
+
+    //soft or external link: its value only, the target is resolved when it is expanded
+    if(links[idx].second != H5L_TYPE_HARD)
+    {
+      if(entry.m_link.get(gid, names[idx].c_str()) < 0)
+      {
+        continue;
+      }
+      if(entry.m_link.m_type == H5L_TYPE_SOFT && entry.m_link.m_path.size() && entry.m_link.m_path[0] != '/')
+      {
+        //relative to the group of the link
+        entry.m_link.m_path = (grp_path == "/" ? "/" : grp_path + "/") + entry.m_link.m_path;
+      }
+      entry.m_kind = ENTRY_LINK;
+      entry.m_addr = HADDR_UNDEF;
+      add_entry(entry, find_previous_link(idx_group, entry));
+      continue;
+    }
+
+    H5O_info_t oinfo;
+    if(H5Oget_info_by_name(gid, names[idx].c_str(), &oinfo, H5P_DEFAULT) < 0)
+    {
+      continue;
+    }
+    entry.m_addr = oinfo.addr;
+    entry.m_header.get(oinfo);
+    size_t idx_prev = find_previous(idx_group, names[idx], oinfo);
+
+    if(oinfo.type == H5O_TYPE_GROUP)
+    {
+      entry.m_kind = ENTRY_GROUP;
+      size_t idx_entry = add_entry(entry, idx_prev);
+      if(m_groups.insert(oinfo.addr).second)
+      {
+        children.push_back(idx_entry);
+      }
+      else
+      {
+        //already walked: avoid infinite recursion due to a circular path in the file
+        hid_t sub_gid;
+        if((sub_gid = H5Gopen2(gid, names[idx].c_str(), H5P_DEFAULT)) >= 0)
+        {
+          add_attributes(sub_gid, idx_entry, entry.m_path);
+          H5Gclose(sub_gid);
+        }
+      }
+    }
+    else if(oinfo.type == H5O_TYPE_DATASET)
+    {
+      hid_t did;
+      hid_t sid;
+      hid_t ftid;
+      entry.m_kind = ENTRY_DATASET;
+      if((did = H5Dopen2(gid, names[idx].c_str(), H5P_DEFAULT)) < 0)
+      {
+        continue;
+      }
+
+      //unchanged dataset: only its dimensions are read, to compare them
+      if(idx_prev != npos && (sid = H5Dget_space(did)) >= 0)
+      {
+        hsize_t dims[H5S_MAX_RANK];
+        int rank = H5Sget_simple_extent_dims(sid, dims, NULL);
+        H5Sclose(sid);
+        const h5entry_t &prev = m_prev->m_entries[idx_prev];
+        if(rank >= 0 && std::vector<hsize_t>(dims, dims + rank) == prev.m_dim)
+        {
+          entry.m_dim = prev.m_dim;
+          entry.m_datatype_size = prev.m_datatype_size;
+          entry.m_datatype_sign = prev.m_datatype_sign;
+          entry.m_datatype_class = prev.m_datatype_class;
+          copy_attributes(idx_prev, add_entry(entry, idx_prev));
+          H5Dclose(did);
+          continue;
+        }
+      }
+
+      if((sid = H5Dget_space(did)) >= 0)
+      {
+        if((ftid = H5Dget_type(did)) >= 0)
+        {
+          get_type(sid, ftid, entry);
+          H5Tclose(ftid);
+        }
+        H5Sclose(sid);
+      }
+      size_t idx_entry = add_entry(entry, npos);
+      add_attributes(did, idx_entry, entry.m_path);
+      H5Dclose(did);
+    }
+  }
+
+  //the attributes of the root group are not shown
+  if(idx_group != 0)
+  {
+    size_t idx_prev = m_prev ? m_previous[idx_group] : npos;
+    if(idx_prev != npos && m_prev_walked[idx_prev] && m_prev->m_entries[idx_prev].m_header == m_entries[idx_group].m_header)
+    {
+      copy_attributes(idx_prev, idx_group);
+    }
+    else
+    {
+      add_attributes(gid, idx_group, grp_path);
+    }
+  }
+
+  H5Gclose(gid);
+
+  for(size_t idx = children.size(); idx-- > 0;)
+  {
+    groups.push_back(children[idx]);
+  }
+  return 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5scan_t::add_attributes
+//in creation order when it is tracked, name order otherwise
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void h5scan_t::add_attributes(hid_t loc_id, size_t idx_parent, const std::string &path)
+{
+  H5O_info_t oinfo;
+  char name[1024];
+
+  if(H5Oget_info(loc_id, &oinfo) < 0)
+  {
+    return;
+  }
+
+  for(hsize_t idx = 0; idx < oinfo.num_attrs; idx++)
+  {
+    hid_t aid;
+    hid_t sid;
+    hid_t ftid;
+
+    H5E_BEGIN_TRY
+    {
+      aid = H5Aopen_by_idx(loc_id, ".", H5_INDEX_CRT_ORDER, H5_ITER_INC, idx, H5P_DEFAULT, H5P_DEFAULT);
+    }
+    H5E_END_TRY;
+    if(aid < 0 && (aid = H5Aopen_by_idx(loc_id, ".", H5_INDEX_NAME, H5_ITER_INC, idx, H5P_DEFAULT, H5P_DEFAULT)) < 0)
+    {
+      continue;
+    }
+
+    h5entry_t entry;
+    entry.m_kind = ENTRY_ATTRIBUTE;
+    entry.m_parent = idx_parent;
+    entry.m_path = path;
+    entry.m_addr = HADDR_UNDEF;
+    entry.m_datatype_size = 0;
+    entry.m_datatype_sign = H5T_SGN_ERROR;
+    entry.m_datatype_class = H5T_NO_CLASS;
+    if(H5Aget_name(aid, sizeof(name), name) >= 0)
+    {
+      entry.m_name = name;
+    }
+    if((sid = H5Aget_space(aid)) >= 0)
+    {
+      if((ftid = H5Aget_type(aid)) >= 0)
+      {
+        get_type(sid, ftid, entry);
+        H5Tclose(ftid);
+      }
+      H5Sclose(sid);
+    }
+    H5Aclose(aid);
+    add_entry(entry, npos);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5scan_t::link_cb
+//names and types of the hard, soft and external links of a group
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+herr_t h5scan_t::link_cb(hid_t, const char *name, const H5L_info_t *linfo, void *_op_data)
+{
+  std::vector<std::pair<std::string, H5L_type_t> > *links = (std::vector<std::pair<std::string, H5L_type_t> >*)_op_data;
+
+  if(linfo->type == H5L_TYPE_HARD || linfo->type == H5L_TYPE_SOFT || linfo->type == H5L_TYPE_EXTERNAL)
+  {
+    links->push_back(std::make_pair(std::string(name), linfo->type));
+  }
+  return(H5_ITER_CONT);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5scan_key_t::h5scan_key_t
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+h5scan_key_t::h5scan_key_t() :
+m_size(-1),
+m_mtime(-1),
+m_super_version(0),
+m_super_size(0),
+m_super_ext_size(0),
+m_root_addr(HADDR_UNDEF),
+m_root_nbr_links(0),
+m_root_header_size(0)
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5scan_key_t::stat
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5scan_key_t::stat(const char* file_name)
+{
+  struct ::stat st;
+
+  m_file_name = file_name;
+  if(::stat(file_name, &st) != 0)
+  {
+    return -1;
+  }
+  m_size = static_cast<long long>(st.st_size);
+  m_mtime = static_cast<long long>(st.st_mtime);
+  return 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5scan_key_t::read
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5scan_key_t::read(hid_t fid)
+{
+  H5O_info_t oinfo;
+  H5G_info_t ginfo;
+
+#if H5_VERSION_GE(1,10,0)
+  H5F_info2_t finfo;
+  if(H5Fget_info2(fid, &finfo) < 0)
+  {
+    return -1;
+  }
+  m_super_version = finfo.super.version;
+  m_super_size = finfo.super.super_size;
+  m_super_ext_size = finfo.super.super_ext_size;
+#else
+  H5F_info_t finfo;
+  if(H5Fget_info(fid, &finfo) < 0)
+  {
+    return -1;
+  }
+  m_super_ext_size = finfo.super_ext_size;
+#endif
+
+  if(H5Oget_info(fid, &oinfo) < 0 || H5Gget_info(fid, &ginfo) < 0)
+  {
+    return -1;
+  }
+  m_root_addr = oinfo.addr;
+  m_root_header_size = oinfo.hdr.space.total;
+  m_root_nbr_links = ginfo.nlinks;
+  return 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5scan_key_t::get
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5scan_key_t::get(const char* file_name)
+{
+  h5lock_t lock;
+  hid_t fid;
+  int result;
+
+  if(stat(file_name) < 0)
+  {
+    return -1;
+  }
+  H5E_BEGIN_TRY
+  {
+    fid = h5file_open(file_name);
+  }
+  H5E_END_TRY;
+  if(fid < 0)
+  {
+    return -1;
+  }
+  result = read(fid);
+  H5Fclose(fid);
+  return result;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5scan_key_t::same_stat
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool h5scan_key_t::same_stat(const h5scan_key_t &other) const
+{
+  return m_file_name == other.m_file_name &&
+    m_size == other.m_size &&
+    m_mtime == other.m_mtime;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5scan_key_t::operator==
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool h5scan_key_t::operator==(const h5scan_key_t &other) const
+{
+  return same_stat(other) &&
+    m_super_version == other.m_super_version &&
+    m_super_size == other.m_super_size &&
+    m_super_ext_size == other.m_super_ext_size &&
+    m_root_addr == other.m_root_addr &&
+    m_root_nbr_links == other.m_root_nbr_links &&
+    m_root_header_size == other.m_root_header_size;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//catalog file
+//native byte order (the cache is local); magic, version, key, number of entries, then per entry:
+//kind, parent, name, rank, dimensions, type size, sign, class, address, header information, and
+//for a link its type, target file and target path
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static const unsigned long long catalog_magic = 0x4c54414335484448ULL; // "HDH5CATL"
+static const unsigned long long catalog_version = 3;
+
+static bool write_u64(FILE *fp, unsigned long long value)
+{
+  return fwrite(&value, sizeof(value), 1, fp) == 1;
+}
+
+static bool write_string(FILE *fp, const std::string &str)
+{
+  return write_u64(fp, str.size()) && (str.empty() || fwrite(str.data(), 1, str.size(), fp) == str.size());
+}
+
+static bool read_u64(FILE *fp, unsigned long long &value)
+{
+  return fread(&value, sizeof(value), 1, fp) == 1;
+}
+
+static bool read_string(FILE *fp, std::string &str)
+{
+  unsigned long long len;
+  if(!read_u64(fp, len) || len > 1024 * 1024)
+  {
+    return false;
+  }
+  str.resize(static_cast<size_t>(len));
+  return len == 0 || fread(&str[0], 1, static_cast<size_t>(len), fp) == len;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5scan_t::save
+//written to a temporary file renamed at the end, so that a reader never sees a partial catalog
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5scan_t::save(const char* cache_name) const
+{
+  std::string tmp_name = std::string(cache_name) + ".tmp";
+  FILE *fp;
+  bool ok;
+
+  if((fp = fopen(tmp_name.c_str(), "wb")) == NULL)
+  {
+    return -1;
+  }
+  setvbuf(fp, NULL, _IOFBF, 1024 * 1024);
+
+  ok = write_u64(fp, catalog_magic) &&
+    write_u64(fp, catalog_version) &&
+    write_string(fp, m_key.m_file_name) &&
+    write_u64(fp, static_cast<unsigned long long>(m_key.m_size)) &&
+    write_u64(fp, static_cast<unsigned long long>(m_key.m_mtime)) &&
+    write_u64(fp, m_key.m_super_version) &&
+    write_u64(fp, m_key.m_super_size) &&
+    write_u64(fp, m_key.m_super_ext_size) &&
+    write_u64(fp, m_key.m_root_addr) &&
+    write_u64(fp, m_key.m_root_nbr_links) &&
+    write_u64(fp, m_key.m_root_header_size) &&
+    write_u64(fp, m_entries.size());
+
+  for(size_t idx = 0; ok && idx < m_entries.size(); idx++)
+  {
+    const h5entry_t &entry = m_entries[idx];
+    ok = write_u64(fp, static_cast<unsigned long long>(entry.m_kind)) &&
+      write_u64(fp, entry.m_parent) &&
+      write_string(fp, entry.m_name) &&
+      write_u64(fp, entry.m_dim.size());
+    for(size_t k = 0; ok && k < entry.m_dim.size(); k++)
+    {
+      ok = write_u64(fp, entry.m_dim[k]);
+    }
+    ok = ok &&
+      write_u64(fp, entry.m_datatype_size) &&
+      write_u64(fp, static_cast<unsigned long long>(static_cast<long long>(entry.m_datatype_sign))) &&
+      write_u64(fp, static_cast<unsigned long long>(static_cast<long long>(entry.m_datatype_class))) &&
+      write_u64(fp, entry.m_addr) &&
+      write_u64(fp, static_cast<unsigned long long>(entry.m_header.m_mtime)) &&
+      write_u64(fp, entry.m_header.m_nbr_attributes) &&
+      write_u64(fp, entry.m_header.m_nbr_messages) &&
+      write_u64(fp, entry.m_header.m_header_size) &&
+      write_u64(fp, entry.m_header.m_message_size) &&
+      write_u64(fp, entry.m_header.m_index_size) &&
+      write_u64(fp, entry.m_header.m_attribute_size);
+    if(ok && entry.m_kind == ENTRY_LINK)
+    {
+      ok = write_u64(fp, static_cast<unsigned long long>(static_cast<long long>(entry.m_link.m_type))) &&
+        write_string(fp, entry.m_link.m_file_name) &&
+        write_string(fp, entry.m_link.m_path);
+    }
+  }
+
+  if(fclose(fp) != 0)
+  {
+    ok = false;
+  }
+  if(ok)
+  {
+    remove(cache_name);
+    ok = rename(tmp_name.c_str(), cache_name) == 0;
+  }
+  if(!ok)
+  {
+    remove(tmp_name.c_str());
+    return -1;
+  }
+  return 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5scan_t::load
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5scan_t::load(const char* cache_name, const h5scan_key_t &key)
+{
+  FILE *fp;
+  unsigned long long magic;
+  unsigned long long version;
+  unsigned long long value[8];
+  unsigned long long header[7];
+  unsigned long long nbr_entries;
+  bool ok;
+
+  m_entries.clear();
+  m_pending.clear();
+
+  if((fp = fopen(cache_name, "rb")) == NULL)
+  {
+    return -1;
+  }
+  setvbuf(fp, NULL, _IOFBF, 1024 * 1024);
+
+  ok = read_u64(fp, magic) && magic == catalog_magic &&
+    read_u64(fp, version) && version == catalog_version &&
+    read_string(fp, m_key.m_file_name);
+  for(size_t idx = 0; ok && idx < 8; idx++)
+  {
+    ok = read_u64(fp, value[idx]);
+  }
+  if(ok)
+  {
+    m_key.m_size = static_cast<long long>(value[0]);
+    m_key.m_mtime = static_cast<long long>(value[1]);
+    m_key.m_super_version = static_cast<unsigned int>(value[2]);
+    m_key.m_super_size = value[3];
+    m_key.m_super_ext_size = value[4];
+    m_key.m_root_addr = value[5];
+    m_key.m_root_nbr_links = value[6];
+    m_key.m_root_header_size = value[7];
+    ok = m_key.same_stat(key) && read_u64(fp, nbr_entries);
+  }
+
+  for(unsigned long long idx = 0; ok && idx < nbr_entries; idx++)
+  {
+    h5entry_t entry;
+    unsigned long long kind;
+    unsigned long long parent;
+    unsigned long long rank;
+    ok = read_u64(fp, kind) && kind <= ENTRY_LINK &&
+      read_u64(fp, parent) && parent <= idx &&
+      read_string(fp, entry.m_name) &&
+      read_u64(fp, rank) && rank <= H5S_MAX_RANK;
+    for(unsigned long long k = 0; ok && k < rank; k++)
+    {
+      unsigned long long dim;
+      ok = read_u64(fp, dim);
+      entry.m_dim.push_back(dim);
+    }
+    for(size_t k = 0; ok && k < 4; k++)
+    {
+      ok = read_u64(fp, value[k]);
+    }
+    for(size_t k = 0; ok && k < 7; k++)
+    {
+      ok = read_u64(fp, header[k]);
+    }
+    if(ok && kind == ENTRY_LINK)
+    {
+      unsigned long long type;
+      ok = read_u64(fp, type) &&
+        read_string(fp, entry.m_link.m_file_name) &&
+        read_string(fp, entry.m_link.m_path);
+      if(ok)
+        entry.m_link.m_type = static_cast<H5L_type_t>(static_cast<long long>(type));
+    }
+    if(!ok)
+    {
+      break;
+    }
+    entry.m_kind = static_cast<h5entry_kind_t>(kind);
+    entry.m_parent = static_cast<size_t>(parent);
+    entry.m_datatype_size = static_cast<size_t>(value[0]);
+    entry.m_datatype_sign = static_cast<H5T_sign_t>(static_cast<long long>(value[1]));
+    entry.m_datatype_class = static_cast<H5T_class_t>(static_cast<long long>(value[2]));
+    entry.m_addr = value[3];
+    entry.m_header.m_mtime = static_cast<long long>(header[0]);
+    entry.m_header.m_nbr_attributes = header[1];
+    entry.m_header.m_nbr_messages = static_cast<unsigned int>(header[2]);
+    entry.m_header.m_header_size = header[3];
+    entry.m_header.m_message_size = header[4];
+    entry.m_header.m_index_size = header[5];
+    entry.m_header.m_attribute_size = header[6];
+
+    //paths: the root is "/", an object is its parent path and its name, an attribute has the
+    //path of its object
+    if(idx == 0)
+    {
+      entry.m_path = "/";
+    }
+    else if(entry.m_kind == ENTRY_ATTRIBUTE)
+    {
+      entry.m_path = m_entries[entry.m_parent].m_path;
+    }
+    else
+    {
+      const std::string &parent_path = m_entries[entry.m_parent].m_path;
+      entry.m_path = parent_path == "/" ? "/" + entry.m_name : parent_path + "/" + entry.m_name;
+    }
+    m_entries.push_back(entry);
+  }
+
+  fclose(fp);
+  if(!ok || m_entries.empty())
+  {
+    m_entries.clear();
+    return -1;
+  }
+  return 0;
+}
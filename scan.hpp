@@ -0,0 +1,160 @@
+#ifndef SCAN_HPP
+#define SCAN_HPP 1
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include "hdf5.h"
+#include "slab.hpp"
+#include "link.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5header_t
+//object header information of a group or dataset (H5Oget_info), compared by h5scan_t::rescan to
+//find the objects that changed
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct h5header_t
+{
+  h5header_t();
+  void get(const H5O_info_t &oinfo);
+  bool operator==(const h5header_t &other) const;
+
+  long long m_mtime; // 0 if times are not tracked
+  hsize_t m_nbr_attributes;
+  unsigned int m_nbr_messages;
+  hsize_t m_header_size; // allocated
+  hsize_t m_message_size; // used by messages
+  hsize_t m_index_size; // B-trees and heaps of links or chunks
+  hsize_t m_attribute_size; // B-trees and heaps of dense attributes
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5entry_t
+//one item of the tree of a file: a group, a dataset, an attribute, or a soft or external link
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+enum h5entry_kind_t
+{
+  ENTRY_GROUP,
+  ENTRY_DATASET,
+  ENTRY_ATTRIBUTE,
+  ENTRY_LINK
+};
+
+struct h5entry_t
+{
+  h5entry_kind_t m_kind;
+  size_t m_parent; // index of the parent entry; entry 0 is the root group, its own parent
+  std::string m_name; // link name, or attribute name
+  std::string m_path; // object path; for an attribute, path of the object that holds it
+  std::vector<hsize_t> m_dim; // datasets and attributes
+  size_t m_datatype_size; // native type
+  H5T_sign_t m_datatype_sign;
+  H5T_class_t m_datatype_class;
+  haddr_t m_addr; // object address (groups and datasets)
+  h5header_t m_header; // groups and datasets
+  h5link_t m_link; // (ENTRY_LINK) target, not followed
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5scan_key_t
+//identifies a version of a file: path, size and modification time (stat), then superblock and
+//root group information, which need the file to be opened
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct h5scan_key_t
+{
+  h5scan_key_t();
+
+  //fill the stat fields; returns -1 if the file cannot be found
+  int stat(const char* file_name);
+
+  //fill the fields read from the file, with h5lock_t held
+  int read(hid_t fid);
+
+  //stat, then open the file to read the other fields
+  int get(const char* file_name);
+
+  bool same_stat(const h5scan_key_t &other) const;
+  bool operator==(const h5scan_key_t &other) const;
+
+  std::string m_file_name;
+  long long m_size;
+  long long m_mtime;
+  unsigned int m_super_version;
+  hsize_t m_super_size;
+  hsize_t m_super_ext_size;
+  haddr_t m_root_addr;
+  hsize_t m_root_nbr_links;
+  hsize_t m_root_header_size;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5scan_t
+//lists the groups, datasets and attributes of a file, parents before children
+//groups are walked one at a time, each holding h5lock_t, so that several files can be scanned
+//at once and the GUI thread is never blocked for long; progress(), called after each group with
+//the number of entries so far, lets the caller show the entries as they come
+//a group reached again through another hard link is listed but not walked again (cycles)
+//soft and external links are listed with their target, but not followed: resolve() lists the
+//target of one of them when it is asked for, through h5file_cache_t
+//rescan() walks a changed file again, reusing the entries of the previous scan for the objects with
+//the same address and header: the links of every group are listed again, but the type, dimensions
+//and attributes of an unchanged dataset, and the attributes of an unchanged group, are not read
+//(the dimensions of a dataset are still compared, as an extent change need not alter its header)
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class h5scan_t
+{
+public:
+  h5scan_t() :
+    m_prev(NULL)
+  {
+  }
+
+  //returns 0, 1 if canceled by progress, -1 on error
+  int scan(const char* file_name, h5progress_t *progress);
+
+  //same as scan(), reusing the current entries; on error or cancel they are left unchanged
+  int rescan(const char* file_name, h5progress_t *progress);
+
+  //entries of the target of 'link' of file 'file_name', whose name is in 'target_file': the
+  //target object, then its links and attributes if it is a group (its groups are not walked)
+  //returns 0, -1 if the target cannot be found
+  int resolve(const std::string &file_name, const h5link_t &link, std::string &target_file);
+
+  //after rescan(), index of each entry in the previous scan, or 'npos' for a new entry
+  std::vector<size_t> m_previous;
+  static const size_t npos = static_cast<size_t>(-1);
+
+  //binary catalog of a scan: the key and the entries (paths are rebuilt from the names)
+  //load() fails unless the cached key has the stat fields of 'key'
+  int save(const char* cache_name) const;
+  int load(const char* cache_name, const h5scan_key_t &key);
+
+  std::vector<h5entry_t> m_entries;
+  h5scan_key_t m_key; // of the file scanned or loaded
+
+private:
+  std::set<haddr_t> m_groups; // groups walked
+  std::vector<size_t> m_pending; // groups not walked when the scan was canceled
+  int walk(const char* file_name, h5progress_t *progress);
+  int scan_group(hid_t fid, size_t idx_group, std::vector<size_t> &groups);
+  void add_attributes(hid_t loc_id, size_t idx_parent, const std::string &path);
+  size_t add_entry(const h5entry_t &entry, size_t idx_prev);
+
+  //previous scan, for rescan()
+  const h5scan_t *m_prev;
+  std::map<std::pair<size_t, std::string>, size_t> m_prev_objects; // (parent, name) to entry
+  std::vector<size_t> m_prev_attr_first; // attributes of each entry, contiguous
+  std::vector<size_t> m_prev_attr_count;
+  std::vector<bool> m_prev_walked; // groups whose children and attributes were listed
+  size_t find_previous(size_t idx_group, const std::string &name, const H5O_info_t &oinfo) const;
+  size_t find_previous_link(size_t idx_group, const h5entry_t &entry) const;
+  void copy_attributes(size_t idx_prev, size_t idx_parent);
+  static herr_t link_cb(hid_t loc_id, const char *name, const H5L_info_t *linfo, void *_op_data);
+};
+
+#endif
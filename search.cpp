@@ -0,0 +1,202 @@
+#include <QtDebug>
+#include "search.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//predicate operators
+//written without branches so that the count loop vectorizes
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct op_eq_t { template <typename C> static bool test(C v, C a, C) { return v == a; } };
+struct op_ne_t { template <typename C> static bool test(C v, C a, C) { return v != a; } };
+struct op_lt_t { template <typename C> static bool test(C v, C a, C) { return v < a; } };
+struct op_le_t { template <typename C> static bool test(C v, C a, C) { return v <= a; } };
+struct op_gt_t { template <typename C> static bool test(C v, C a, C) { return v > a; } };
+struct op_ge_t { template <typename C> static bool test(C v, C a, C) { return v >= a; } };
+struct op_range_t { template <typename C> static bool test(C v, C a, C b) { return (v >= a) & (v <= b); } };
+struct op_nan_t { template <typename C> static bool test(C v, C, C) { return v != v; } };
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//compare_t
+//type in which values are compared: float data is compared in float (so that '== 0.1' finds 0.1f),
+//everything else in double (so that '> 2.5' has its meaning on integers)
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename T> struct compare_t { typedef double type; };
+template <> struct compare_t<float> { typedef float type; };
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//search_kernel_t
+//per range: count matches, then, only if there are any, collect their block offsets
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename T, class OP>
+struct search_kernel_t
+{
+  typedef typename compare_t<T>::type C;
+
+  const T *m_buf;
+  C m_a;
+  C m_b;
+  size_t m_max_hits;
+  std::vector< std::vector<size_t> > m_offset; // per range
+  std::vector<size_t> m_count; // per range
+
+  void run(const h5range_t &range)
+  {
+    const T *buf = m_buf;
+    C a = m_a;
+    C b = m_b;
+    size_t nbr = 0;
+
+    for(size_t idx = range.begin; idx < range.end; idx++)
+    {
+      nbr += OP::test(static_cast<C>(buf[idx]), a, b);
+    }
+
+    m_count[range.idx] = nbr;
+    if(nbr == 0)
+    {
+      return;
+    }
+
+    std::vector<size_t> &offset = m_offset[range.idx];
+    for(size_t idx = range.begin; idx < range.end && offset.size() < m_max_hits; idx++)
+    {
+      if(OP::test(static_cast<C>(buf[idx]), a, b))
+      {
+        offset.push_back(idx);
+      }
+    }
+  }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//search_block_t
+//functor for dispatch(): runs the kernel of type T on one block and appends hits
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct search_block_t
+{
+  h5search_t *m_search;
+  h5predicate_t m_predicate;
+  double m_value;
+  double m_value_hi;
+  const void *m_buf;
+  size_t m_nbr_elements;
+  const std::vector<hsize_t> *m_start;
+  const std::vector<hsize_t> *m_count;
+
+  template <typename T, class OP>
+  void run_op()
+  {
+    typedef typename compare_t<T>::type C;
+    search_kernel_t<T, OP> kernel;
+    std::vector<h5range_t> ranges = make_ranges(m_nbr_elements, 64 * 1024);
+
+    kernel.m_buf = static_cast<const T*>(m_buf);
+    kernel.m_a = static_cast<C>(m_value);
+    kernel.m_b = static_cast<C>(m_value_hi);
+    kernel.m_max_hits = m_search->m_max_hits > m_search->m_hits.size() ? m_search->m_max_hits - m_search->m_hits.size() : 0;
+    kernel.m_offset.resize(ranges.size());
+    kernel.m_count.assign(ranges.size(), 0);
+
+    parallel_for(ranges, kernel);
+
+    //merge in range order, which is row major order inside the block
+    for(size_t idx_range = 0; idx_range < ranges.size(); idx_range++)
+    {
+      m_search->m_nbr_hits += kernel.m_count[idx_range];
+      const std::vector<size_t> &offset = kernel.m_offset[idx_range];
+      for(size_t idx = 0; idx < offset.size() && m_search->m_hits.size() < m_search->m_max_hits; idx++)
+      {
+        h5hit_t hit;
+        size_t off = offset[idx];
+        size_t rank = m_count->size();
+        hit.m_coord.resize(rank);
+        for(size_t dmn = rank; dmn-- > 0;)
+        {
+          size_t n = static_cast<size_t>((*m_count)[dmn]);
+          hit.m_coord[dmn] = (*m_start)[dmn] + off % n;
+          off /= n;
+        }
+        hit.m_value = static_cast<double>(kernel.m_buf[offset[idx]]);
+        m_search->m_hits.push_back(hit);
+      }
+    }
+  }
+
+  template <typename T>
+  void apply()
+  {
+    switch(m_predicate)
+    {
+    case PREDICATE_EQ: run_op<T, op_eq_t>(); break;
+    case PREDICATE_NE: run_op<T, op_ne_t>(); break;
+    case PREDICATE_LT: run_op<T, op_lt_t>(); break;
+    case PREDICATE_LE: run_op<T, op_le_t>(); break;
+    case PREDICATE_GT: run_op<T, op_gt_t>(); break;
+    case PREDICATE_GE: run_op<T, op_ge_t>(); break;
+    case PREDICATE_RANGE: run_op<T, op_range_t>(); break;
+    case PREDICATE_NAN: run_op<T, op_nan_t>(); break;
+    }
+  }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5search_t::search
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5search_t::search(const char* file_name, const char* path, h5predicate_t predicate, double value, double value_hi, h5progress_t *progress)
+{
+  h5slab_t slab;
+  std::vector<hsize_t> start;
+  std::vector<hsize_t> count;
+
+  m_hits.clear();
+  m_nbr_hits = 0;
+
+  if(slab.open(file_name, path) < 0)
+  {
+    return -1;
+  }
+
+  if(slab.m_native == H5NATIVE_NONE)
+  {
+    return -1;
+  }
+
+  size_t nbr_blocks = slab.nbr_blocks();
+  std::vector<char> buf(slab.max_block_elements() * slab.m_datatype_size);
+
+  for(size_t idx_block = 0; idx_block < nbr_blocks; idx_block++)
+  {
+    if(slab.read(idx_block, &buf[0], start, count) < 0)
+    {
+      return -1;
+    }
+
+    size_t nbr_elements = 1;
+    for(size_t idx = 0; idx < count.size(); idx++)
+    {
+      nbr_elements *= static_cast<size_t>(count[idx]);
+    }
+
+    search_block_t block;
+    block.m_search = this;
+    block.m_predicate = predicate;
+    block.m_value = value;
+    block.m_value_hi = value_hi;
+    block.m_buf = &buf[0];
+    block.m_nbr_elements = nbr_elements;
+    block.m_start = &start;
+    block.m_count = &count;
+    dispatch(slab.m_native, block);
+
+    if(progress && !progress->progress(idx_block + 1, nbr_blocks))
+    {
+      return 1;
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,60 @@
+#ifndef SEARCH_HPP
+#define SEARCH_HPP 1
+
+#include <vector>
+#include "hdf5.h"
+#include "slab.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5predicate_t
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+enum h5predicate_t
+{
+  PREDICATE_EQ,     // == value
+  PREDICATE_NE,     // != value
+  PREDICATE_LT,     // < value
+  PREDICATE_LE,     // <= value
+  PREDICATE_GT,     // > value
+  PREDICATE_GE,     // >= value
+  PREDICATE_RANGE,  // value <= x <= value_hi
+  PREDICATE_NAN     // isnan
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5hit_t
+//a cell where the predicate holds
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct h5hit_t
+{
+  std::vector<hsize_t> m_coord;
+  double m_value;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5search_t
+//finds the cells of a dataset where a predicate holds
+//the dataset is streamed in chunk aligned blocks (h5slab_t); each block is tested on the thread pool
+//by a kernel specialized for the datatype and the predicate
+//at most 'm_max_hits' coordinates are kept, 'm_nbr_hits' is the total count
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class h5search_t
+{
+public:
+  h5search_t() :
+    m_nbr_hits(0),
+    m_max_hits(100000)
+  {
+  }
+
+  //returns 0, 1 if canceled by progress, -1 on error
+  int search(const char* file_name, const char* path, h5predicate_t predicate, double value, double value_hi, h5progress_t *progress);
+
+  std::vector<h5hit_t> m_hits;
+  hsize_t m_nbr_hits;
+  size_t m_max_hits;
+};
+
+#endif
@@ -0,0 +1,505 @@
+#include <QtDebug>
+#include "slab.hpp"
+#include "http.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5lock_t
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+QMutex* h5lock_t::mutex()
+{
+  static QMutex mutex(QMutex::Recursive);
+  return &mutex;
+}
+
+h5lock_t::h5lock_t()
+{
+  mutex()->lock();
+}
+
+h5lock_t::~h5lock_t()
+{
+  mutex()->unlock();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5slab_t::h5slab_t
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+h5slab_t::h5slab_t() :
+m_fid(-1),
+m_did(-1),
+m_mtid(-1),
+m_datatype_size(0),
+m_datatype_sign(H5T_SGN_ERROR),
+m_datatype_class(H5T_NO_CLASS),
+m_native(H5NATIVE_NONE),
+m_block_size(8 * 1024 * 1024),
+m_row_major(false),
+m_chunked(false)
+{
+}
+
+h5slab_t::~h5slab_t()
+{
+  close();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5slab_t::open
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5slab_t::open(const char* file_name, const char* path)
+{
+  h5lock_t lock;
+  hid_t sid;
+  hid_t ftid;
+  hid_t dcpl;
+  hsize_t dims[H5S_MAX_RANK];
+  hsize_t chunk[H5S_MAX_RANK];
+  int rank;
+
+  close();
+  m_path = path;
+
+  if((m_fid = h5file_open(file_name)) < 0)
+  {
+    return -1;
+  }
+
+  if((m_did = H5Dopen2(m_fid, path, H5P_DEFAULT)) < 0)
+  {
+    close();
+    return -1;
+  }
+
+  if((sid = H5Dget_space(m_did)) < 0)
+  {
+    close();
+    return -1;
+  }
+
+  rank = H5Sget_simple_extent_dims(sid, dims, NULL);
+  H5Sclose(sid);
+  if(rank < 0)
+  {
+    close();
+    return -1;
+  }
+
+  if((ftid = H5Dget_type(m_did)) < 0)
+  {
+    close();
+    return -1;
+  }
+
+  m_mtid = H5Tget_native_type(ftid, H5T_DIR_DEFAULT);
+  H5Tclose(ftid);
+  if(m_mtid < 0)
+  {
+    close();
+    return -1;
+  }
+
+  m_datatype_size = H5Tget_size(m_mtid);
+  m_datatype_sign = H5Tget_sign(m_mtid);
+  m_datatype_class = H5Tget_class(m_mtid);
+  m_native = get_native(m_datatype_class, m_datatype_size, m_datatype_sign);
+
+  m_dim.assign(dims, dims + rank);
+
+  //contiguous and compact datasets have no chunks: use a chunk of one element,
+  //the block grid then splits the outer dimensions first
+  m_chunk.assign(rank, 1);
+  m_chunked = false;
+  if((dcpl = H5Dget_create_plist(m_did)) >= 0)
+  {
+    if(H5Pget_layout(dcpl) == H5D_CHUNKED && H5Pget_chunk(dcpl, rank, chunk) == rank)
+    {
+      m_chunk.assign(chunk, chunk + rank);
+      m_chunked = true;
+    }
+    H5Pclose(dcpl);
+  }
+  if(m_chunked)
+  {
+    m_direct.init(m_did);
+  }
+
+  m_start.assign(rank, 0);
+  m_count = m_dim;
+  make_blocks();
+  return 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5slab_t::close
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void h5slab_t::close()
+{
+  h5lock_t lock;
+
+  if(m_mtid >= 0)
+  {
+    H5Tclose(m_mtid);
+    m_mtid = -1;
+  }
+  if(m_did >= 0)
+  {
+    H5Dclose(m_did);
+    m_did = -1;
+  }
+  if(m_fid >= 0)
+  {
+    H5Fclose(m_fid);
+    m_fid = -1;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5slab_t::select
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5slab_t::select(const std::vector<hsize_t> &start, const std::vector<hsize_t> &count)
+{
+  if(start.size() != m_dim.size() || count.size() != m_dim.size())
+  {
+    return -1;
+  }
+
+  for(size_t idx = 0; idx < m_dim.size(); idx++)
+  {
+    if(start[idx] + count[idx] > m_dim[idx])
+    {
+      return -1;
+    }
+  }
+
+  m_start = start;
+  m_count = count;
+  make_blocks();
+  return 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5slab_t::set_block_size
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void h5slab_t::set_block_size(size_t nbr_bytes)
+{
+  m_block_size = nbr_bytes;
+  make_blocks();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5slab_t::set_row_major
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5slab_t::set_row_major(bool row_major)
+{
+  m_row_major = row_major;
+  make_blocks();
+
+  if(!m_row_major || !m_chunked)
+  {
+    return 0;
+  }
+
+  //bytes of the chunks that intersect one block, counting the whole chunk thickness
+  //in the dimensions walked one element at a time
+  size_t rank = m_dim.size();
+  double nbr_bytes = static_cast<double>(m_datatype_size);
+  double nbr_chunks = 1;
+  for(size_t idx = 0; idx < rank; idx++)
+  {
+    hsize_t extent = std::min(m_step[idx], m_count[idx]);
+    if(extent == 0)
+      return 0;
+    hsize_t nbr = (extent + m_chunk[idx] - 2) / m_chunk[idx] + 1; // chunks a misaligned range can touch
+    nbr_chunks *= static_cast<double>(nbr);
+    nbr_bytes *= static_cast<double>(nbr * m_chunk[idx]);
+  }
+
+  const double max_cache = 256.0 * 1024 * 1024;
+  size_t rdcc_nbytes = static_cast<size_t>(std::min(std::max(nbr_bytes, 1024.0 * 1024), max_cache));
+  size_t rdcc_nslots = static_cast<size_t>(std::min(nbr_chunks * 10, 1000003.0)) | 1;
+
+  h5lock_t lock;
+  hid_t dapl;
+  if((dapl = H5Pcreate(H5P_DATASET_ACCESS)) < 0)
+  {
+    return -1;
+  }
+  if(H5Pset_chunk_cache(dapl, rdcc_nslots, rdcc_nbytes, 1.0) < 0)
+  {
+    H5Pclose(dapl);
+    return -1;
+  }
+  H5Dclose(m_did);
+  m_did = H5Dopen2(m_fid, m_path.c_str(), dapl);
+  H5Pclose(dapl);
+  if(m_did < 0)
+  {
+    return -1;
+  }
+  return 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5slab_t::make_blocks
+//find the outermost dimension 'split' such that a block made of one chunk in the dimensions
+//before it, one chunk in it and the whole selection after it fits 'm_block_size';
+//the block is then grown along 'split' by a whole number of chunks
+//if not even one chunk fits, a block is one chunk
+//in row major order the dimensions before 'split' are one element thick instead of one chunk,
+//and the block along 'split' is a whole number of chunks only when at least one chunk fits
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void h5slab_t::make_blocks()
+{
+  size_t rank = m_dim.size();
+  size_t split = rank;
+  hsize_t unit = 0;
+
+  m_origin.assign(rank, 0);
+  m_step.assign(rank, 1);
+  m_first.assign(rank, 0);
+  m_nbr.assign(rank, 1);
+
+  if(rank == 0)
+  {
+    return;
+  }
+
+  for(size_t dmn = 0; dmn < rank; dmn++)
+  {
+    unit = m_datatype_size;
+    for(size_t idx = 0; idx < rank; idx++)
+    {
+      hsize_t extent = m_count[idx];
+      if(idx <= dmn)
+      {
+        extent = m_row_major ? 1 : std::min(m_chunk[idx], m_count[idx]);
+      }
+      unit *= extent;
+    }
+    if(unit <= m_block_size)
+    {
+      split = dmn;
+      break;
+    }
+  }
+
+  if(m_row_major && split == rank)
+  {
+    //an element does not fit
+    split = rank - 1;
+    unit = m_datatype_size;
+  }
+
+  for(size_t idx = 0; idx < rank; idx++)
+  {
+    if(split == rank || idx < split)
+    {
+      //one chunk, or one element in row major order
+      m_origin[idx] = 0;
+      m_step[idx] = m_row_major ? 1 : m_chunk[idx];
+    }
+    else if(idx == split)
+    {
+      //as many chunks (elements in row major order) as fit
+      hsize_t nbr = (unit > 0) ? m_block_size / unit : 1;
+      if(nbr == 0)
+        nbr = 1;
+      if(m_row_major)
+      {
+        if(nbr >= m_chunk[idx])
+          nbr -= nbr % m_chunk[idx];
+      }
+      else
+      {
+        nbr *= m_chunk[idx];
+      }
+      m_origin[idx] = 0;
+      m_step[idx] = nbr;
+    }
+    else
+    {
+      //whole selection
+      m_origin[idx] = m_start[idx];
+      m_step[idx] = m_count[idx] > 0 ? m_count[idx] : 1;
+    }
+
+    if(m_count[idx] == 0)
+    {
+      m_nbr[idx] = 0;
+      continue;
+    }
+    hsize_t first = (m_start[idx] - m_origin[idx]) / m_step[idx];
+    hsize_t last = (m_start[idx] + m_count[idx] - 1 - m_origin[idx]) / m_step[idx];
+    m_first[idx] = first;
+    m_nbr[idx] = last - first + 1;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5slab_t::nbr_blocks
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+size_t h5slab_t::nbr_blocks() const
+{
+  size_t nbr = 1;
+  for(size_t idx = 0; idx < m_nbr.size(); idx++)
+  {
+    nbr *= static_cast<size_t>(m_nbr[idx]);
+  }
+  return nbr;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5slab_t::max_block_elements
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+size_t h5slab_t::max_block_elements() const
+{
+  size_t nbr = 1;
+  for(size_t idx = 0; idx < m_step.size(); idx++)
+  {
+    nbr *= static_cast<size_t>(std::min(m_step[idx], m_count[idx]));
+  }
+  return nbr;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5slab_t::nbr_elements
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+hsize_t h5slab_t::nbr_elements() const
+{
+  hsize_t nbr = 1;
+  for(size_t idx = 0; idx < m_count.size(); idx++)
+  {
+    nbr *= m_count[idx];
+  }
+  return nbr;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5slab_t::get_block
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void h5slab_t::get_block(size_t idx_block, std::vector<hsize_t> &start, std::vector<hsize_t> &count) const
+{
+  size_t rank = m_dim.size();
+  start.resize(rank);
+  count.resize(rank);
+
+  //last dimension varies fastest, which is the chunk order
+  for(size_t idx = rank; idx-- > 0;)
+  {
+    hsize_t k = m_first[idx] + idx_block % m_nbr[idx];
+    idx_block /= static_cast<size_t>(m_nbr[idx]);
+    hsize_t lo = std::max(m_origin[idx] + k * m_step[idx], m_start[idx]);
+    hsize_t hi = std::min(m_origin[idx] + (k + 1) * m_step[idx], m_start[idx] + m_count[idx]);
+    start[idx] = lo;
+    count[idx] = hi - lo;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5slab_t::read
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5slab_t::read(size_t idx_block, void *buf, std::vector<hsize_t> &start, std::vector<hsize_t> &count)
+{
+  get_block(idx_block, start, count);
+  return read(start, count, buf);
+}
+
+int h5slab_t::read(const std::vector<hsize_t> &start, const std::vector<hsize_t> &count, void *buf)
+{
+  //chunk aligned blocks of a filtered dataset: decompress in parallel
+  //row major blocks are thinner than a chunk and are left to H5Dread and its chunk cache
+  if(m_direct.m_supported && !m_direct.m_filters.empty() && !m_row_major && m_dim.size())
+  {
+    return m_direct.read(m_did, start, count, buf);
+  }
+
+  h5lock_t lock;
+  hid_t fsid;
+  hid_t msid;
+  int ret = 0;
+
+  if(m_dim.size() == 0)
+  {
+    if(H5Dread(m_did, m_mtid, H5S_ALL, H5S_ALL, H5P_DEFAULT, buf) < 0)
+    {
+      return -1;
+    }
+    return 0;
+  }
+
+  if((fsid = H5Dget_space(m_did)) < 0)
+  {
+    return -1;
+  }
+
+  if(H5Sselect_hyperslab(fsid, H5S_SELECT_SET, &start[0], NULL, &count[0], NULL) < 0)
+  {
+    H5Sclose(fsid);
+    return -1;
+  }
+
+  if((msid = H5Screate_simple(static_cast<int>(count.size()), &count[0], NULL)) < 0)
+  {
+    H5Sclose(fsid);
+    return -1;
+  }
+
+  if(H5Dread(m_did, m_mtid, msid, fsid, H5P_DEFAULT, buf) < 0)
+  {
+    qDebug() << "H5Dread failed";
+    ret = -1;
+  }
+
+  H5Sclose(msid);
+  H5Sclose(fsid);
+  return ret;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5reader_t::run
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void h5reader_t::run()
+{
+  size_t nbr_blocks = m_slab->nbr_blocks();
+  size_t max_block_elements = m_slab->max_block_elements();
+
+  for(size_t idx_block = 0; idx_block < nbr_blocks; idx_block++)
+  {
+    h5block_t *block = new h5block_t;
+    block->m_idx = idx_block;
+    block->m_buf.resize(max_block_elements * m_slab->m_datatype_size);
+    if(m_slab->read(idx_block, &block->m_buf[0], block->m_start, block->m_count) < 0)
+    {
+      delete block;
+      m_result = -1;
+      break;
+    }
+    block->m_nbr_elements = 1;
+    for(size_t idx = 0; idx < block->m_count.size(); idx++)
+    {
+      block->m_nbr_elements *= static_cast<size_t>(block->m_count[idx]);
+    }
+    if(!m_queue->push(block))
+    {
+      //closed by the consumer
+      delete block;
+      break;
+    }
+  }
+
+  m_queue->close();
+}
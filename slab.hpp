@@ -0,0 +1,219 @@
+#ifndef SLAB_HPP
+#define SLAB_HPP 1
+
+#include <QMutex>
+#include <QWaitCondition>
+#include <QThread>
+#include <deque>
+#include <string>
+#include <vector>
+#include "hdf5.h"
+#include "kernel.hpp"
+#include "chunk.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5lock_t
+//the HDF5 library is not thread safe unless built with --enable-threadsafe
+//every HDF5 call made outside the GUI thread is done holding this (recursive) lock,
+//as is every GUI thread read that can run while a background task is active
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class h5lock_t
+{
+public:
+  h5lock_t();
+  ~h5lock_t();
+  static QMutex* mutex();
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5progress_t
+//callback for long operations running in a worker thread
+//progress() is called after each block; returning false cancels the operation
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class h5progress_t
+{
+public:
+  virtual ~h5progress_t()
+  {
+  }
+  virtual bool progress(hsize_t done, hsize_t total) = 0;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5slab_t
+//streams a selection of a dataset as a sequence of hyperslab blocks
+//blocks are aligned to the dataset chunks and follow the chunk order on disk, so that each chunk
+//is read (and decompressed) once; a block holds at most 'block_size' bytes when the chunk shape allows it
+//contiguous datasets are split along the outer dimensions first, which is their order on disk
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class h5slab_t
+{
+public:
+  h5slab_t();
+  ~h5slab_t();
+
+  //open dataset 'path' in file 'file_name' and select all of it
+  int open(const char* file_name, const char* path);
+  void close();
+
+  //restrict to the hyperslab 'start', 'count' (same rank as the dataset)
+  int select(const std::vector<hsize_t> &start, const std::vector<hsize_t> &count);
+
+  //upper bound of a block in bytes; call before nbr_blocks()
+  void set_block_size(size_t nbr_bytes);
+
+  //make blocks follow the row major order of the selection, as needed to write it sequentially;
+  //blocks are then one element thick in the dimensions before the split one, and the chunk cache
+  //is sized to hold the chunks shared by consecutive blocks so that they are still decompressed once
+  int set_row_major(bool row_major);
+
+  //number of blocks and largest block (in elements) of the current selection
+  size_t nbr_blocks() const;
+  size_t max_block_elements() const;
+  hsize_t nbr_elements() const;
+
+  //read block 'idx_block' in memory type m_mtid; returns its start and count in file coordinates
+  //blocks of compressed datasets are read with h5chunk_t, decompressing on the thread pool
+  int read(size_t idx_block, void *buf, std::vector<hsize_t> &start, std::vector<hsize_t> &count);
+
+  //same as read() with the block start and count given
+  int read(const std::vector<hsize_t> &start, const std::vector<hsize_t> &count, void *buf);
+
+  //block geometry without reading
+  void get_block(size_t idx_block, std::vector<hsize_t> &start, std::vector<hsize_t> &count) const;
+
+  std::string m_path;
+  hid_t m_fid;
+  hid_t m_did;
+  hid_t m_mtid; // native memory type
+  size_t m_datatype_size;
+  H5T_sign_t m_datatype_sign;
+  H5T_class_t m_datatype_class;
+  h5native_t m_native;
+  std::vector<hsize_t> m_dim; // dataset dimensions
+  std::vector<hsize_t> m_chunk; // chunk dimensions (all 1 if not chunked)
+  std::vector<hsize_t> m_start; // selection
+  std::vector<hsize_t> m_count;
+
+private:
+  size_t m_block_size;
+  bool m_row_major;
+  bool m_chunked;
+  h5chunk_t m_direct; // direct chunk reads
+  std::vector<hsize_t> m_origin; // block grid origin per dimension
+  std::vector<hsize_t> m_step; // block grid step per dimension
+  std::vector<hsize_t> m_first; // first block index per dimension
+  std::vector<hsize_t> m_nbr; // number of blocks per dimension
+  void make_blocks();
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5block_t
+//one block of a h5slab_t read in memory
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct h5block_t
+{
+  size_t m_idx;
+  std::vector<hsize_t> m_start;
+  std::vector<hsize_t> m_count;
+  std::vector<char> m_buf;
+  size_t m_nbr_elements;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5queue_t
+//bounded blocking queue between the stages of a pipeline
+//push() blocks while the queue is full, pop() while it is empty;
+//after close() push() fails and pop() returns the remaining items, then fails
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+class h5queue_t
+{
+public:
+  h5queue_t(size_t max_size) :
+    m_max_size(max_size),
+    m_closed(false)
+  {
+  }
+
+  bool push(const T &item)
+  {
+    QMutexLocker locker(&m_mutex);
+    while(m_queue.size() >= m_max_size && !m_closed)
+    {
+      m_not_full.wait(&m_mutex);
+    }
+    if(m_closed)
+    {
+      return false;
+    }
+    m_queue.push_back(item);
+    m_not_empty.wakeOne();
+    return true;
+  }
+
+  bool pop(T &item)
+  {
+    QMutexLocker locker(&m_mutex);
+    while(m_queue.empty() && !m_closed)
+    {
+      m_not_empty.wait(&m_mutex);
+    }
+    if(m_queue.empty())
+    {
+      return false;
+    }
+    item = m_queue.front();
+    m_queue.pop_front();
+    m_not_full.wakeOne();
+    return true;
+  }
+
+  void close()
+  {
+    QMutexLocker locker(&m_mutex);
+    m_closed = true;
+    m_not_full.wakeAll();
+    m_not_empty.wakeAll();
+  }
+
+private:
+  size_t m_max_size;
+  bool m_closed;
+  std::deque<T> m_queue;
+  QMutex m_mutex;
+  QWaitCondition m_not_full;
+  QWaitCondition m_not_empty;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5reader_t
+//first stage of a pipeline: reads the blocks of a h5slab_t in order in its own thread
+//and pushes them to 'queue', which it closes at the end (or on error, with m_result -1)
+//the consumer stops the reader early by closing the queue; blocks left in it are the consumer's to delete
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class h5reader_t : public QThread
+{
+public:
+  h5reader_t(h5slab_t *slab, h5queue_t<h5block_t*> *queue) :
+    m_slab(slab),
+    m_queue(queue),
+    m_result(0)
+  {
+  }
+
+  h5slab_t *m_slab;
+  h5queue_t<h5block_t*> *m_queue;
+  int m_result;
+
+protected:
+  void run();
+};
+
+#endif
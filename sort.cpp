@@ -0,0 +1,402 @@
+#include <QtDebug>
+#include <cstring>
+#include <limits>
+#include "sort.hpp"
+#include "cf.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//unsigned_of_t
+//unsigned integer type of 'size' bytes, the key of a value of that size
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <size_t size> struct unsigned_of_t;
+template <> struct unsigned_of_t<1> { typedef unsigned char type; };
+template <> struct unsigned_of_t<2> { typedef unsigned short type; };
+template <> struct unsigned_of_t<4> { typedef unsigned int type; };
+template <> struct unsigned_of_t<8> { typedef unsigned long long type; };
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//make_key
+//key whose unsigned order is the order of the values; NaN is the largest key
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename K, typename T>
+inline K make_key(T value, bool &nan)
+{
+  nan = false;
+  K key = static_cast<K>(value);
+  if(std::numeric_limits<T>::is_signed)
+  {
+    key ^= static_cast<K>(static_cast<K>(1) << (sizeof(K) * 8 - 1));
+  }
+  return key;
+}
+
+template <typename K, typename T>
+inline K make_float_key(T value, bool &nan)
+{
+  K key;
+  const K sign = static_cast<K>(1) << (sizeof(K) * 8 - 1);
+  nan = value != value;
+  if(nan)
+  {
+    return ~static_cast<K>(0);
+  }
+  if(value == 0)
+  {
+    //-0 and 0 are equal
+    value = 0;
+  }
+  memcpy(&key, &value, sizeof(K));
+  return (key & sign) ? ~key : (key | sign);
+}
+
+template <>
+inline unsigned int make_key<unsigned int, float>(float value, bool &nan)
+{
+  return make_float_key<unsigned int>(value, nan);
+}
+
+template <>
+inline unsigned long long make_key<unsigned long long, double>(double value, bool &nan)
+{
+  return make_float_key<unsigned long long>(value, nan);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//key_kernel_t
+//per range: keys of the values, inverted for a descending order except NaNs, and the identity order
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename T, typename K>
+struct key_kernel_t
+{
+  const T *m_buf;
+  bool m_ascending;
+  K *m_keys;
+  hsize_t *m_index;
+
+  void run(const h5range_t &range)
+  {
+    for(size_t idx = range.begin; idx < range.end; idx++)
+    {
+      bool nan;
+      K key = make_key<K>(m_buf[idx], nan);
+      m_keys[idx] = (m_ascending || nan) ? key : static_cast<K>(~key);
+      m_index[idx] = idx;
+    }
+  }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//count_kernel_t
+//per range: number of keys of each value of the byte of the pass
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename K>
+struct count_kernel_t
+{
+  const K *m_keys;
+  int m_shift;
+  hsize_t *m_counts; // 256 per range
+
+  void run(const h5range_t &range)
+  {
+    hsize_t *counts = m_counts + range.idx * 256;
+    for(size_t idx = range.begin; idx < range.end; idx++)
+    {
+      counts[(m_keys[idx] >> m_shift) & 0xff]++;
+    }
+  }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//scatter_kernel_t
+//per range: keys and indices moved to the offsets of their byte, which are the range's own
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename K>
+struct scatter_kernel_t
+{
+  const K *m_keys;
+  const hsize_t *m_index;
+  K *m_keys_out;
+  hsize_t *m_index_out;
+  int m_shift;
+  hsize_t *m_offsets; // 256 per range
+
+  void run(const h5range_t &range)
+  {
+    hsize_t *offsets = m_offsets + range.idx * 256;
+    for(size_t idx = range.begin; idx < range.end; idx++)
+    {
+      hsize_t pos = offsets[(m_keys[idx] >> m_shift) & 0xff]++;
+      m_keys_out[pos] = m_keys[idx];
+      m_index_out[pos] = m_index[idx];
+    }
+  }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//inverse_kernel_t
+//per range: position of each index of the order; each range writes other elements
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct inverse_kernel_t
+{
+  const hsize_t *m_order;
+  hsize_t *m_inverse;
+
+  void run(const h5range_t &range)
+  {
+    for(size_t idx = range.begin; idx < range.end; idx++)
+    {
+      m_inverse[m_order[idx]] = idx;
+    }
+  }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//radix_sort_t
+//functor for dispatch(): the order of a buffer of values
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct radix_sort_t
+{
+  const void *m_buf;
+  size_t m_nbr_elements;
+  bool m_ascending;
+  h5progress_t *m_progress;
+  std::vector<hsize_t> *m_order;
+  int m_result;
+
+  template <typename T>
+  void apply()
+  {
+    typedef typename unsigned_of_t<sizeof(T)>::type K;
+    size_t nbr_elements = m_nbr_elements;
+    std::vector<h5range_t> ranges = make_ranges(nbr_elements, 64 * 1024);
+    std::vector<K> keys(nbr_elements);
+    std::vector<K> keys_out(nbr_elements);
+    std::vector<hsize_t> index(nbr_elements);
+    std::vector<hsize_t> index_out(nbr_elements);
+    std::vector<hsize_t> counts(ranges.size() * 256);
+
+    m_result = 0;
+    if(nbr_elements == 0)
+    {
+      m_order->clear();
+      return;
+    }
+
+    key_kernel_t<T, K> key_kernel;
+    key_kernel.m_buf = static_cast<const T*>(m_buf);
+    key_kernel.m_ascending = m_ascending;
+    key_kernel.m_keys = &keys[0];
+    key_kernel.m_index = &index[0];
+    parallel_for(ranges, key_kernel);
+
+    for(size_t pass = 0; pass < sizeof(K); pass++)
+    {
+      int shift = static_cast<int>(pass * 8);
+      std::fill(counts.begin(), counts.end(), 0);
+      count_kernel_t<K> count_kernel;
+      count_kernel.m_keys = &keys[0];
+      count_kernel.m_shift = shift;
+      count_kernel.m_counts = &counts[0];
+      parallel_for(ranges, count_kernel);
+
+      //offsets in byte order, then range order, so that equal keys keep their order
+      hsize_t offset = 0;
+      bool same = false;
+      for(size_t digit = 0; digit < 256; digit++)
+      {
+        hsize_t nbr_digit = 0;
+        for(size_t idx_range = 0; idx_range < ranges.size(); idx_range++)
+        {
+          hsize_t count = counts[idx_range * 256 + digit];
+          counts[idx_range * 256 + digit] = offset;
+          offset += count;
+          nbr_digit += count;
+        }
+        same = same || nbr_digit == nbr_elements;
+      }
+
+      if(!same)
+      {
+        scatter_kernel_t<K> scatter_kernel;
+        scatter_kernel.m_keys = &keys[0];
+        scatter_kernel.m_index = &index[0];
+        scatter_kernel.m_keys_out = &keys_out[0];
+        scatter_kernel.m_index_out = &index_out[0];
+        scatter_kernel.m_shift = shift;
+        scatter_kernel.m_offsets = &counts[0];
+        parallel_for(ranges, scatter_kernel);
+        keys.swap(keys_out);
+        index.swap(index_out);
+      }
+
+      if(m_progress && !m_progress->progress(pass + 1, sizeof(K)))
+      {
+        m_result = 1;
+        return;
+      }
+    }
+    m_order->swap(index);
+  }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//scaled_progress_t
+//progress of a step that is the part ['first', 'first' + 'size'] of 'total'
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class scaled_progress_t : public h5progress_t
+{
+public:
+  scaled_progress_t(h5progress_t *progress, hsize_t first, hsize_t size, hsize_t total) :
+    m_progress(progress),
+    m_first(first),
+    m_size(size),
+    m_total(total)
+  {
+  }
+  bool progress(hsize_t done, hsize_t total)
+  {
+    if(m_progress == NULL)
+    {
+      return true;
+    }
+    double fraction = total ? static_cast<double>(done) / static_cast<double>(total) : 1;
+    return m_progress->progress(m_first + static_cast<hsize_t>(fraction * m_size), m_total);
+  }
+
+private:
+  h5progress_t *m_progress;
+  hsize_t m_first;
+  hsize_t m_size;
+  hsize_t m_total;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5sort_t::sort
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5sort_t::sort(const void *buf, h5native_t native, size_t nbr_elements, bool ascending, h5progress_t *progress)
+{
+  radix_sort_t radix_sort;
+  radix_sort.m_buf = buf;
+  radix_sort.m_nbr_elements = nbr_elements;
+  radix_sort.m_ascending = ascending;
+  radix_sort.m_progress = progress;
+  radix_sort.m_order = &m_order;
+  radix_sort.m_result = -1;
+  m_order.clear();
+  m_inverse.clear();
+  if(!dispatch(native, radix_sort))
+  {
+    return -1;
+  }
+  if(radix_sort.m_result != 0)
+  {
+    m_order.clear();
+    return radix_sort.m_result;
+  }
+
+  m_inverse.resize(m_order.size());
+  if(!m_order.empty())
+  {
+    inverse_kernel_t inverse_kernel;
+    inverse_kernel.m_order = &m_order[0];
+    inverse_kernel.m_inverse = &m_inverse[0];
+    std::vector<h5range_t> ranges = make_ranges(m_order.size(), 64 * 1024);
+    parallel_for(ranges, inverse_kernel);
+  }
+  return 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5sort_t::sort
+//the column is read by blocks into one buffer, in row order whatever the block order, then sorted;
+//reading is the first half of the progress
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5sort_t::sort(const char* file_name, const char* path, const std::vector<hsize_t> &start, const std::vector<hsize_t> &count,
+  bool physical, bool ascending, h5progress_t *progress)
+{
+  h5slab_t slab;
+  h5cf_t cf;
+  int result = 0;
+
+  m_order.clear();
+  m_inverse.clear();
+  if(start.size() == 0 || slab.open(file_name, path) < 0 || slab.m_native == H5NATIVE_NONE)
+  {
+    return -1;
+  }
+  if(slab.select(start, count) < 0)
+  {
+    return -1;
+  }
+  size_t dim = start.size() > 1 ? start.size() - 2 : 0;
+  size_t nbr_elements = static_cast<size_t>(count[dim]);
+
+  h5native_t native = slab.m_native;
+  size_t element_size = slab.m_datatype_size;
+  if(physical)
+  {
+    h5lock_t lock;
+    physical = cf.read(slab.m_did, slab.m_native);
+  }
+  if(physical)
+  {
+    native = cf.m_unpacked;
+    element_size = cf.unpacked_size();
+  }
+  std::vector<char> column(nbr_elements * element_size);
+
+  h5queue_t<h5block_t*> queue(2);
+  h5reader_t reader(&slab, &queue);
+  reader.start();
+
+  h5block_t *block;
+  hsize_t nbr_done = 0;
+  while(queue.pop(block))
+  {
+    char *out = &column[static_cast<size_t>(block->m_start[dim] - start[dim]) * element_size];
+    if(physical)
+    {
+      cf.unpack(&block->m_buf[0], block->m_nbr_elements, out);
+    }
+    else
+    {
+      memcpy(out, &block->m_buf[0], block->m_nbr_elements * element_size);
+    }
+
+    nbr_done += block->m_nbr_elements;
+    delete block;
+    if(progress && !progress->progress(nbr_done, 2 * static_cast<hsize_t>(nbr_elements)))
+    {
+      result = 1;
+      break;
+    }
+  }
+
+  queue.close();
+  reader.wait();
+  while(queue.pop(block))
+  {
+    delete block;
+  }
+  if(reader.m_result < 0)
+  {
+    result = -1;
+  }
+  if(result != 0)
+  {
+    return result;
+  }
+
+  scaled_progress_t scaled(progress, nbr_elements, nbr_elements, 2 * static_cast<hsize_t>(nbr_elements));
+  return sort(nbr_elements ? &column[0] : NULL, native, nbr_elements, ascending, &scaled);
+}
@@ -0,0 +1,41 @@
+#ifndef SORT_HPP
+#define SORT_HPP 1
+
+#include <string>
+#include <vector>
+#include "hdf5.h"
+#include "kernel.hpp"
+#include "slab.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5sort_t
+//order of the rows of a grid by the values of one column, as a permutation of row indices: the
+//grid shows row m_order[idx] at row 'idx', and the data is not moved
+//each value is made an unsigned key of its own size whose order is the order of the values
+//(sign bit flipped for signed integers, all bits flipped for negative floats), and the keys are
+//sorted by a stable least significant digit radix sort, one byte per pass; a pass counts the
+//digits of each range of the thread pool, then each range scatters its keys to its own offsets,
+//and a pass whose byte is the same for all keys is skipped
+//NaNs come last in both orders, in row order; equal values keep their row order
+//the inverse permutation is made with the order, so that the grid row of a dataset row is found
+//without a search
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class h5sort_t
+{
+public:
+  //order of 'nbr_elements' values of type 'native' in 'buf'
+  //returns 0, 1 if canceled by progress, -1 if the type cannot be sorted
+  int sort(const void *buf, h5native_t native, size_t nbr_elements, bool ascending, h5progress_t *progress);
+
+  //order of the column 'start', 'count' of dataset 'path': the count is 1 in all dimensions but the
+  //rows of the grid (the first for 1 dimension, the one before last otherwise)
+  //with 'physical', the values are unpacked first, as h5tiles_t::set_physical shows them
+  int sort(const char* file_name, const char* path, const std::vector<hsize_t> &start, const std::vector<hsize_t> &count,
+    bool physical, bool ascending, h5progress_t *progress);
+
+  std::vector<hsize_t> m_order;
+  std::vector<hsize_t> m_inverse; // grid row of dataset row 'idx': m_order[m_inverse[idx]] == idx
+};
+
+#endif
@@ -0,0 +1,313 @@
+#include <QtDebug>
+#include <cstring>
+#include <limits>
+#include "stats.hpp"
+#include "cf.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//stats_lanes_t
+//'nbr_lanes' interleaved partial results, merged at the end; a NaN fails the comparisons and is
+//masked out of the sum and count
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+struct stats_lanes_t
+{
+  static const size_t nbr_lanes = 8;
+  double sum[nbr_lanes];
+  double min[nbr_lanes];
+  double max[nbr_lanes];
+  hsize_t count[nbr_lanes];
+
+  stats_lanes_t()
+  {
+    for(size_t lane = 0; lane < nbr_lanes; lane++)
+    {
+      sum[lane] = 0;
+      min[lane] = std::numeric_limits<double>::infinity();
+      max[lane] = -std::numeric_limits<double>::infinity();
+      count[lane] = 0;
+    }
+  }
+
+  void add(const T *buf, size_t nbr_elements)
+  {
+    size_t idx = 0;
+    for(; idx + nbr_lanes <= nbr_elements; idx += nbr_lanes)
+    {
+      for(size_t lane = 0; lane < nbr_lanes; lane++)
+      {
+        double value = static_cast<double>(buf[idx + lane]);
+        bool valid = value == value;
+        sum[lane] += valid ? value : 0;
+        count[lane] += valid;
+        min[lane] = value < min[lane] ? value : min[lane];
+        max[lane] = value > max[lane] ? value : max[lane];
+      }
+    }
+    for(size_t lane = 0; idx < nbr_elements; idx++, lane++)
+    {
+      double value = static_cast<double>(buf[idx]);
+      bool valid = value == value;
+      sum[lane] += valid ? value : 0;
+      count[lane] += valid;
+      min[lane] = value < min[lane] ? value : min[lane];
+      max[lane] = value > max[lane] ? value : max[lane];
+    }
+  }
+
+  void merge_into(h5stats_t &stats) const
+  {
+    for(size_t lane = 0; lane < nbr_lanes; lane++)
+    {
+      stats.m_sum += sum[lane];
+      stats.m_count += count[lane];
+      stats.m_min = std::min(stats.m_min, min[lane]);
+      stats.m_max = std::max(stats.m_max, max[lane]);
+    }
+  }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//stats_kernel_t
+//per range of a buffer
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+struct stats_kernel_t
+{
+  const T *m_buf;
+  std::vector<h5stats_t> m_stats; // per range
+
+  void run(const h5range_t &range)
+  {
+    stats_lanes_t<T> lanes;
+    lanes.add(m_buf + range.begin, range.end - range.begin);
+    lanes.merge_into(m_stats[range.idx]);
+  }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//stats_block_t
+//functor for dispatch(): a buffer reduced on the thread pool; a short one in the calling thread
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct stats_block_t
+{
+  const void *m_buf;
+  size_t m_nbr_elements;
+  h5stats_t *m_stats;
+
+  template <typename T>
+  void apply()
+  {
+    std::vector<h5range_t> ranges = make_ranges(m_nbr_elements, 64 * 1024);
+    stats_kernel_t<T> kernel;
+    kernel.m_buf = static_cast<const T*>(m_buf);
+    kernel.m_stats.resize(ranges.size());
+    parallel_for(ranges, kernel);
+    for(size_t idx = 0; idx < ranges.size(); idx++)
+    {
+      m_stats->merge(kernel.m_stats[idx]);
+    }
+  }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//stats_rows_kernel_t
+//per range of rows of a rectangle
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+struct stats_rows_kernel_t
+{
+  const T *m_buf;
+  size_t m_stride;
+  const hsize_t *m_rows; // NULL for the rows from 'm_first_row'
+  size_t m_first_row;
+  size_t m_first_col;
+  size_t m_nbr_cols;
+  std::vector<h5stats_t> m_stats; // per range
+
+  void run(const h5range_t &range)
+  {
+    stats_lanes_t<T> lanes;
+    for(size_t idx = range.begin; idx < range.end; idx++)
+    {
+      size_t row = m_rows ? static_cast<size_t>(m_rows[idx]) : m_first_row + idx;
+      lanes.add(m_buf + row * m_stride + m_first_col, m_nbr_cols);
+    }
+    lanes.merge_into(m_stats[range.idx]);
+  }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//stats_rows_t
+//functor for dispatch(): a rectangle reduced on the thread pool, whole rows per range
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct stats_rows_t
+{
+  const void *m_buf;
+  size_t m_stride;
+  const hsize_t *m_rows;
+  size_t m_first_row;
+  size_t m_nbr_rows;
+  size_t m_first_col;
+  size_t m_nbr_cols;
+  h5stats_t *m_stats;
+
+  template <typename T>
+  void apply()
+  {
+    size_t grain = m_nbr_cols ? std::max(static_cast<size_t>(1), 64 * 1024 / m_nbr_cols) : m_nbr_rows;
+    std::vector<h5range_t> ranges = make_ranges(m_nbr_rows, grain);
+    stats_rows_kernel_t<T> kernel;
+    kernel.m_buf = static_cast<const T*>(m_buf);
+    kernel.m_stride = m_stride;
+    kernel.m_rows = m_rows;
+    kernel.m_first_row = m_first_row;
+    kernel.m_first_col = m_first_col;
+    kernel.m_nbr_cols = m_nbr_cols;
+    kernel.m_stats.resize(ranges.size());
+    parallel_for(ranges, kernel);
+    for(size_t idx = 0; idx < ranges.size(); idx++)
+    {
+      m_stats->merge(kernel.m_stats[idx]);
+    }
+  }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5stats_t::h5stats_t
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+h5stats_t::h5stats_t()
+{
+  clear();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5stats_t::clear
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void h5stats_t::clear()
+{
+  m_count = 0;
+  m_sum = 0;
+  m_min = std::numeric_limits<double>::infinity();
+  m_max = -std::numeric_limits<double>::infinity();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5stats_t::add
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool h5stats_t::add(const void *buf, h5native_t native, size_t nbr_elements)
+{
+  stats_block_t block;
+  block.m_buf = buf;
+  block.m_nbr_elements = nbr_elements;
+  block.m_stats = this;
+  return dispatch(native, block);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5stats_t::add_rows
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool h5stats_t::add_rows(const void *buf, h5native_t native, size_t stride, const hsize_t *rows, size_t first_row,
+  size_t nbr_rows, size_t first_col, size_t nbr_cols)
+{
+  stats_rows_t block;
+  block.m_buf = buf;
+  block.m_stride = stride;
+  block.m_rows = rows;
+  block.m_first_row = first_row;
+  block.m_nbr_rows = nbr_rows;
+  block.m_first_col = first_col;
+  block.m_nbr_cols = nbr_cols;
+  block.m_stats = this;
+  return dispatch(native, block);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5stats_t::merge
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void h5stats_t::merge(const h5stats_t &stats)
+{
+  m_count += stats.m_count;
+  m_sum += stats.m_sum;
+  m_min = std::min(m_min, stats.m_min);
+  m_max = std::max(m_max, stats.m_max);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5stats_t::compute
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5stats_t::compute(const char* file_name, const char* path, const std::vector<hsize_t> &start, const std::vector<hsize_t> &count,
+  bool physical, h5progress_t *progress)
+{
+  h5slab_t slab;
+  h5cf_t cf;
+  std::vector<char> unpacked;
+  int result = 0;
+
+  clear();
+  if(slab.open(file_name, path) < 0 || slab.m_native == H5NATIVE_NONE)
+  {
+    return -1;
+  }
+  if(start.size() && slab.select(start, count) < 0)
+  {
+    return -1;
+  }
+  if(physical)
+  {
+    h5lock_t lock;
+    physical = cf.read(slab.m_did, slab.m_native);
+  }
+  hsize_t nbr_total = slab.nbr_elements();
+
+  h5queue_t<h5block_t*> queue(2);
+  h5reader_t reader(&slab, &queue);
+  reader.start();
+
+  h5block_t *block;
+  hsize_t nbr_done = 0;
+  while(queue.pop(block))
+  {
+    if(physical)
+    {
+      unpacked.resize(block->m_nbr_elements * cf.unpacked_size());
+      cf.unpack(&block->m_buf[0], block->m_nbr_elements, unpacked.empty() ? NULL : &unpacked[0]);
+      add(unpacked.empty() ? NULL : &unpacked[0], cf.m_unpacked, block->m_nbr_elements);
+    }
+    else
+    {
+      add(&block->m_buf[0], slab.m_native, block->m_nbr_elements);
+    }
+
+    nbr_done += block->m_nbr_elements;
+    delete block;
+    if(progress && !progress->progress(nbr_done, nbr_total))
+    {
+      result = 1;
+      break;
+    }
+  }
+
+  queue.close();
+  reader.wait();
+  while(queue.pop(block))
+  {
+    delete block;
+  }
+  if(reader.m_result < 0)
+  {
+    result = -1;
+  }
+  return result;
+}
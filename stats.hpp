@@ -0,0 +1,49 @@
+#ifndef STATS_HPP
+#define STATS_HPP 1
+
+#include <vector>
+#include "hdf5.h"
+#include "kernel.hpp"
+#include "slab.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5stats_t
+//count, sum, minimum and maximum of values, accumulated run by run or rectangle by rectangle; NaNs
+//are not counted
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct h5stats_t
+{
+  h5stats_t();
+  void clear();
+
+  //add 'nbr_elements' contiguous values of type 'native'; returns false if the type is not numeric
+  //the loop keeps several partial results and has no branches, so that it vectorizes; a long
+  //buffer is split on the thread pool
+  bool add(const void *buf, h5native_t native, size_t nbr_elements);
+
+  //add the rectangle of 'nbr_rows' rows of 'nbr_cols' values from column 'first_col' of a buffer of
+  //rows of 'stride' values: rows 'rows[0]' to 'rows[nbr_rows - 1]', or from 'first_row' if 'rows' is
+  //NULL; the rows are split on the thread pool, so that the rectangle is one pass
+  bool add_rows(const void *buf, h5native_t native, size_t stride, const hsize_t *rows, size_t first_row,
+    size_t nbr_rows, size_t first_col, size_t nbr_cols);
+  void merge(const h5stats_t &stats);
+
+  //statistics of the hyperslab 'start', 'count' of dataset 'path' (empty for all of it), streamed by
+  //h5slab_t blocks; with 'physical', of the values unpacked by h5cf_t
+  //returns 0, 1 if canceled by progress, -1 on error or if the dataset is not numeric
+  int compute(const char* file_name, const char* path, const std::vector<hsize_t> &start, const std::vector<hsize_t> &count,
+    bool physical, h5progress_t *progress);
+
+  double mean() const
+  {
+    return m_count ? m_sum / static_cast<double>(m_count) : 0;
+  }
+
+  hsize_t m_count;
+  double m_sum;
+  double m_min; // inf if no values
+  double m_max; // -inf if no values
+};
+
+#endif
@@ -0,0 +1,489 @@
+#include <QtDebug>
+#include "tile.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//tile size, in elements, for contiguous datasets and datasets with chunks too large for a tile
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static const hsize_t tile_rows = 256;
+static const hsize_t tile_cols = 256;
+static const size_t max_tile_bytes = 4 * 1024 * 1024;
+static const hsize_t tile_files = 16;
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5tiles_t::h5tiles_t
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+h5tiles_t::h5tiles_t() :
+m_derived(false),
+m_aggregated(false),
+m_virtual(false),
+m_physical(false),
+m_max_bytes(64 * 1024 * 1024),
+m_open(false),
+m_nbr_bytes(0),
+m_clock(0)
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5tiles_t::~h5tiles_t
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+h5tiles_t::~h5tiles_t()
+{
+  close();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5tiles_t::set_dataset
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void h5tiles_t::set_dataset(const std::string &file_name, const std::string &path)
+{
+  close();
+  clear();
+  m_file_name = file_name;
+  m_path = path;
+  m_tile.clear();
+  m_physical = false;
+  m_derived = false;
+  m_inputs_cf.clear();
+  m_aggregated = false;
+  m_virtual = false;
+  m_vds = h5vds_t();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5tiles_t::set_aggregate
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void h5tiles_t::set_aggregate(const h5aggregate_t &aggregate)
+{
+  set_dataset(aggregate.m_file_names.empty() ? std::string() : aggregate.m_file_names[0], aggregate.m_path);
+  m_aggregate = aggregate;
+  m_aggregated = true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5tiles_t::set_expression
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5tiles_t::set_expression(const std::string &file_name, const h5expr_t &expr)
+{
+  if(expr.m_variables.empty())
+  {
+    set_dataset(file_name, std::string());
+    return -1;
+  }
+  set_dataset(file_name, expr.m_variables[0]);
+  m_expr = expr;
+  m_derived = true;
+  if(open() < 0)
+  {
+    m_path.clear();
+    m_derived = false;
+    return -1;
+  }
+  return 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5tiles_t::set_physical
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5tiles_t::set_physical(bool physical)
+{
+  if(physical == m_physical || m_derived || m_aggregated)
+  {
+    return 1;
+  }
+  clear();
+  m_physical = false;
+  if(!physical)
+  {
+    return 1;
+  }
+  if(open() < 0)
+  {
+    return -1;
+  }
+  h5lock_t lock;
+  if(!m_cf.read(m_slab.m_did, m_slab.m_native))
+  {
+    return 0;
+  }
+  m_physical = true;
+  return 1;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5tiles_t::open
+//open the file; the first time, define the tile shape
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5tiles_t::open()
+{
+  if(m_open)
+  {
+    return 0;
+  }
+  if(!m_aggregated && m_slab.open(m_file_name.c_str(), m_path.c_str()) < 0)
+  {
+    return -1;
+  }
+  m_open = true;
+
+  //the other datasets of a derived variable, of the same dimensions
+  if(m_derived)
+  {
+    bool valid = m_slab.m_native != H5NATIVE_NONE;
+    for(size_t idx = 1; valid && idx < m_expr.m_variables.size(); idx++)
+    {
+      h5slab_t *slab = new h5slab_t;
+      m_inputs.push_back(slab);
+      valid = slab->open(m_file_name.c_str(), m_expr.m_variables[idx].c_str()) >= 0 &&
+        slab->m_native != H5NATIVE_NONE && slab->m_dim == m_slab.m_dim;
+    }
+    if(!valid)
+    {
+      qDebug() << "cannot open the datasets of" << m_expr.m_text.c_str();
+      close();
+      return -1;
+    }
+    if(m_inputs_cf.size() != m_expr.m_variables.size())
+    {
+      h5lock_t lock;
+      m_inputs_cf.resize(m_expr.m_variables.size());
+      for(size_t idx = 0; idx < m_inputs_cf.size(); idx++)
+      {
+        const h5slab_t &slab = idx == 0 ? m_slab : *m_inputs[idx - 1];
+        m_inputs_cf[idx].read(slab.m_did, slab.m_native);
+        m_inputs_cf[idx].m_unpacked = H5NATIVE_DOUBLE;
+      }
+    }
+  }
+
+  //the files of an aggregate are opened by the pool when read
+  const std::vector<hsize_t> &chunk = m_aggregated ? m_aggregate.m_chunk : m_slab.m_chunk;
+  size_t datatype_size = m_aggregated ? m_aggregate.m_datatype_size : m_slab.m_datatype_size;
+  size_t rank = dim().size();
+  if(m_tile.size() == rank)
+  {
+    return 0;
+  }
+
+  //virtual dataset, the first time the dataset is opened
+  if(!m_aggregated && !m_derived)
+  {
+    h5lock_t lock;
+    m_virtual = m_vds.open(m_slab.m_did, m_file_name) > 0;
+  }
+
+  m_tile.assign(rank, 1);
+  if(rank == 0)
+  {
+    return 0;
+  }
+
+  size_t chunk_bytes = datatype_size * static_cast<size_t>(chunk[rank - 1]);
+  if(rank > 1)
+  {
+    chunk_bytes *= static_cast<size_t>(chunk[rank - 2]);
+  }
+  bool chunked = false;
+  for(size_t idx = 0; idx < rank; idx++)
+  {
+    if(chunk[idx] != 1)
+      chunked = true;
+  }
+
+  if(chunked && chunk_bytes <= max_tile_bytes)
+  {
+    //whole chunks: at least the default tile along each of the last two dimensions
+    hsize_t nbr = rank > 1 ? tile_cols : tile_rows * tile_cols;
+    m_tile[rank - 1] = ((nbr + chunk[rank - 1] - 1) / chunk[rank - 1]) * chunk[rank - 1];
+    if(rank > 1)
+    {
+      m_tile[rank - 2] = ((tile_rows + chunk[rank - 2] - 1) / chunk[rank - 2]) * chunk[rank - 2];
+    }
+  }
+  else if(rank > 1)
+  {
+    m_tile[rank - 2] = tile_rows;
+    m_tile[rank - 1] = tile_cols;
+  }
+  else
+  {
+    m_tile[0] = tile_rows * tile_cols;
+  }
+
+  //stacked files are rows of the grid when there are no layers: a tile spans a few files only
+  if(m_aggregated && m_aggregate.m_stack)
+  {
+    m_tile[0] = std::min<hsize_t>(m_tile[0], tile_files);
+  }
+  return 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5tiles_t::close
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void h5tiles_t::close()
+{
+  if(m_open)
+  {
+    m_slab.close();
+    m_pool.close();
+    for(size_t idx = 0; idx < m_inputs.size(); idx++)
+    {
+      delete m_inputs[idx];
+    }
+    m_inputs.clear();
+    m_open = false;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5tiles_t::clear
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void h5tiles_t::clear()
+{
+  m_tiles.clear();
+  m_nbr_bytes = 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5tiles_t::grown
+//a tile is cut when its count is less than the tile shape in a dimension
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void h5tiles_t::grown(const std::vector<hsize_t> &old_dim, const std::vector<hsize_t> &new_dim)
+{
+  size_t rank = new_dim.size();
+  bool shrank = old_dim.size() != rank || m_tile.size() != rank;
+  for(size_t idx = 0; !shrank && idx < rank; idx++)
+  {
+    shrank = new_dim[idx] < old_dim[idx];
+  }
+  if(shrank)
+  {
+    clear();
+    return;
+  }
+
+  std::map<std::vector<hsize_t>, tile_t>::iterator it = m_tiles.begin();
+  while(it != m_tiles.end())
+  {
+    bool cut = false;
+    for(size_t idx = 0; !cut && idx < rank; idx++)
+    {
+      cut = it->second.m_count[idx] < m_tile[idx];
+    }
+    if(cut)
+    {
+      m_nbr_bytes -= it->second.m_buf.size();
+      m_tiles.erase(it++);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5tiles_t::get
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const void* h5tiles_t::get(const std::vector<hsize_t> &coord, size_t *nbr_run)
+{
+  if(m_path.empty() || (m_tile.size() != coord.size() && open() < 0) || m_tile.size() != coord.size())
+  {
+    return NULL;
+  }
+
+  size_t rank = coord.size();
+  std::vector<hsize_t> start = tile_start(coord);
+
+  std::map<std::vector<hsize_t>, tile_t>::iterator it = m_tiles.find(start);
+  if(it == m_tiles.end())
+  {
+    if(open() < 0)
+    {
+      return NULL;
+    }
+    tile_t tile;
+    size_t nbr_elements = 1;
+    tile.m_count.resize(rank);
+    for(size_t idx = 0; idx < rank; idx++)
+    {
+      if(start[idx] >= dim()[idx])
+      {
+        return NULL;
+      }
+      tile.m_count[idx] = std::min(m_tile[idx], dim()[idx] - start[idx]);
+      nbr_elements *= static_cast<size_t>(tile.m_count[idx]);
+    }
+    if(m_derived)
+    {
+      if(read_derived(start, tile.m_count, nbr_elements, tile.m_buf) < 0)
+      {
+        qDebug() << "cannot compute tile of" << m_expr.m_text.c_str();
+        return NULL;
+      }
+    }
+    else if(m_aggregated)
+    {
+      tile.m_buf.resize(nbr_elements * m_aggregate.m_datatype_size);
+      if(m_aggregate.read(start, tile.m_count, &tile.m_buf[0], m_pool) < 0)
+      {
+        qDebug() << "cannot read tile of" << m_path.c_str() << "in" << m_file_name.c_str();
+        return NULL;
+      }
+    }
+    else
+    {
+      if(m_virtual)
+      {
+        std::vector<size_t> mappings;
+        m_vds.overlapping(start, tile.m_count, mappings);
+        for(size_t idx = 0; idx < mappings.size(); idx++)
+        {
+          if(!m_vds.check(mappings[idx], m_pool))
+            tile.m_missing.push_back(mappings[idx]);
+        }
+      }
+      tile.m_buf.resize(nbr_elements * m_slab.m_datatype_size);
+      if(m_slab.read(start, tile.m_count, &tile.m_buf[0]) < 0)
+      {
+        qDebug() << "cannot read tile of" << m_path.c_str();
+        return NULL;
+      }
+      if(m_physical)
+      {
+        std::vector<char> packed;
+        packed.swap(tile.m_buf);
+        tile.m_buf.resize(nbr_elements * m_cf.unpacked_size());
+        m_cf.unpack(&packed[0], nbr_elements, &tile.m_buf[0]);
+      }
+    }
+
+    //make room
+    while(!m_tiles.empty() && m_nbr_bytes + tile.m_buf.size() > m_max_bytes)
+    {
+      std::map<std::vector<hsize_t>, tile_t>::iterator oldest = m_tiles.begin();
+      for(std::map<std::vector<hsize_t>, tile_t>::iterator it_tile = m_tiles.begin(); it_tile != m_tiles.end(); ++it_tile)
+      {
+        if(it_tile->second.m_used < oldest->second.m_used)
+          oldest = it_tile;
+      }
+      m_nbr_bytes -= oldest->second.m_buf.size();
+      m_tiles.erase(oldest);
+    }
+
+    m_nbr_bytes += tile.m_buf.size();
+    it = m_tiles.insert(std::make_pair(start, tile_t())).first;
+    it->second.m_count.swap(tile.m_count);
+    it->second.m_buf.swap(tile.m_buf);
+    it->second.m_missing.swap(tile.m_missing);
+  }
+
+  tile_t &tile = it->second;
+  tile.m_used = ++m_clock;
+  size_t offset = 0;
+  for(size_t idx = 0; idx < rank; idx++)
+  {
+    if(coord[idx] - start[idx] >= tile.m_count[idx])
+    {
+      return NULL;
+    }
+    offset = offset * static_cast<size_t>(tile.m_count[idx]) + static_cast<size_t>(coord[idx] - start[idx]);
+  }
+  if(nbr_run)
+  {
+    *nbr_run = rank ? static_cast<size_t>(tile.m_count[rank - 1] - (coord[rank - 1] - start[rank - 1])) : 1;
+  }
+  return &tile.m_buf[offset * element_size()];
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5tiles_t::tile_start
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::vector<hsize_t> h5tiles_t::tile_start(const std::vector<hsize_t> &coord) const
+{
+  std::vector<hsize_t> start(coord.size());
+  for(size_t idx = 0; idx < coord.size(); idx++)
+  {
+    start[idx] = (coord[idx] / m_tile[idx]) * m_tile[idx];
+  }
+  return start;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5tiles_t::missing
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5tiles_t::missing(const std::vector<hsize_t> &coord) const
+{
+  if(!m_virtual || m_tile.size() != coord.size())
+  {
+    return -1;
+  }
+  std::map<std::vector<hsize_t>, tile_t>::const_iterator it = m_tiles.find(tile_start(coord));
+  if(it == m_tiles.end() || it->second.m_missing.empty())
+  {
+    return -1;
+  }
+  return m_vds.missing(coord, it->second.m_missing);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5tiles_t::element_size
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+size_t h5tiles_t::element_size() const
+{
+  if(m_derived)
+  {
+    return sizeof(double);
+  }
+  if(m_aggregated)
+  {
+    return m_aggregate.m_datatype_size;
+  }
+  return m_physical ? m_cf.unpacked_size() : m_slab.m_datatype_size;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5tiles_t::read_derived
+//the tile 'start', 'count' of each dataset, converted to double, then the expression on them
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5tiles_t::read_derived(const std::vector<hsize_t> &start, const std::vector<hsize_t> &count, size_t nbr_elements,
+  std::vector<char> &buf)
+{
+  std::vector<std::vector<double> > values(m_expr.m_variables.size());
+  std::vector<const double*> inputs(values.size());
+  std::vector<char> packed;
+
+  for(size_t idx = 0; idx < values.size(); idx++)
+  {
+    h5slab_t &slab = idx == 0 ? m_slab : *m_inputs[idx - 1];
+    packed.resize(nbr_elements * slab.m_datatype_size);
+    if(slab.read(start, count, &packed[0]) < 0)
+    {
+      return -1;
+    }
+    values[idx].resize(nbr_elements);
+    m_inputs_cf[idx].unpack(&packed[0], nbr_elements, &values[idx][0]);
+    inputs[idx] = &values[idx][0];
+  }
+
+  buf.resize(nbr_elements * sizeof(double));
+  m_expr.evaluate(inputs, nbr_elements, reinterpret_cast<double*>(&buf[0]));
+  return 0;
+}
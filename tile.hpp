@@ -0,0 +1,118 @@
+#ifndef TILE_HPP
+#define TILE_HPP 1
+
+#include <map>
+#include <string>
+#include <vector>
+#include "hdf5.h"
+#include "slab.hpp"
+#include "cf.hpp"
+#include "expr.hpp"
+#include "aggregate.hpp"
+#include "vds.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5tiles_t
+//elements of a dataset too large to be loaded whole, read by tiles when a grid shows them
+//a tile is one element thick in the dimensions before the last two, and covers whole chunks in the
+//last two (the tile shape is the chunk shape when it is not too large), so that a chunk is
+//decompressed once for all the cells it holds; the least recently used tiles are dropped
+//above 'm_max_bytes'
+//the file is opened when a tile is missing, and can be closed between reads (follow mode)
+//with physical values set, each tile is unpacked when it is read (h5cf_t), so elements are float
+//or double, NaN where missing
+//with an expression set, the tiles are those of a derived variable: the same hyperslab is read from
+//each dataset of the expression, as physical values in double, and the expression is evaluated on
+//them; only the tiles a grid shows are computed, and the result is what is cached
+//with an aggregate set, tiles are read from the files of a h5aggregate_t, through a pool of open files
+//a virtual dataset is read by tiles too, so that a read opens only the sources it overlaps; these
+//are checked (h5vds_t) before the tile is read, and the cells of a missing source are reported
+//used from the GUI thread only; reads take h5lock_t
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class h5tiles_t
+{
+public:
+  h5tiles_t();
+  ~h5tiles_t();
+
+  //dataset to read; nothing is read until get()
+  void set_dataset(const std::string &file_name, const std::string &path);
+  bool is_set() const
+  {
+    return !m_path.empty();
+  }
+
+  //derived variable 'expr' over datasets of 'file_name'; the tile shape is that of the first dataset
+  //returns -1 if a dataset cannot be opened, is not numeric, or has other dimensions than the first
+  int set_expression(const std::string &file_name, const h5expr_t &expr);
+  bool m_derived;
+  h5expr_t m_expr;
+
+  //virtual variable 'aggregate' over several files
+  void set_aggregate(const h5aggregate_t &aggregate);
+  bool m_aggregated;
+  h5aggregate_t m_aggregate;
+
+  //element at dataset coordinates 'coord', in the native memory type, 'm_cf.m_unpacked' with
+  //physical values, double for a derived variable; NULL if it cannot be read
+  //'nbr_run', if not NULL, is the number of elements that follow it in the tile along the last
+  //dimension, 'coord' included
+  const void* get(const std::vector<hsize_t> &coord, size_t *nbr_run = NULL);
+  size_t element_size() const;
+
+  //virtual dataset: mapping whose source is missing for element 'coord', read by get(), or -1
+  int missing(const std::vector<hsize_t> &coord) const;
+  bool m_virtual;
+  h5vds_t m_vds;
+
+  //show physical values or stored values; returns 1 if set, 0 if the dataset has no CF attributes
+  //(stored values are kept), -1 if it cannot be opened
+  int set_physical(bool physical);
+  bool m_physical;
+  h5cf_t m_cf;
+
+  //drop the tiles, after the dataset changed
+  void clear();
+
+  //the dataset went from 'old_dim' to 'new_dim' (follow mode): if it only grew, just the tiles cut by
+  //the old extent are dropped, as the others hold the same elements
+  void grown(const std::vector<hsize_t> &old_dim, const std::vector<hsize_t> &new_dim);
+
+  //close the file, keeping the tiles
+  void close();
+
+  size_t m_max_bytes;
+
+private:
+  struct tile_t
+  {
+    std::vector<hsize_t> m_count;
+    std::vector<char> m_buf;
+    std::vector<size_t> m_missing; // virtual dataset: mappings overlapping the tile whose source is missing
+    unsigned long m_used; // time of last use
+  };
+
+  std::string m_file_name;
+  std::string m_path;
+  h5slab_t m_slab;
+  std::vector<h5slab_t*> m_inputs; // derived variable: datasets after the first
+  std::vector<h5cf_t> m_inputs_cf; // derived variable: physical values of each dataset
+  h5pool_t m_pool; // aggregate: files open; virtual dataset: sources open
+  bool m_open;
+  std::vector<hsize_t> m_tile; // tile shape
+  std::map<std::vector<hsize_t>, tile_t> m_tiles; // by tile start
+  size_t m_nbr_bytes;
+  unsigned long m_clock;
+
+  int open();
+  std::vector<hsize_t> tile_start(const std::vector<hsize_t> &coord) const;
+  const std::vector<hsize_t>& dim() const
+  {
+    return m_aggregated ? m_aggregate.m_dim : m_slab.m_dim;
+  }
+  int read_derived(const std::vector<hsize_t> &start, const std::vector<hsize_t> &count, size_t nbr_elements,
+    std::vector<char> &buf);
+};
+
+#endif
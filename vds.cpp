@@ -0,0 +1,232 @@
+#include <QtDebug>
+#include <limits>
+#include "vds.hpp"
+#include "http.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5vds_t::h5vds_t
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+h5vds_t::h5vds_t() :
+m_nbr_missing(0)
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5vds_t::open
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5vds_t::open(const std::string &file_name, const std::string &path)
+{
+  h5lock_t lock;
+  hid_t fid;
+  hid_t did;
+  int result = -1;
+
+  if((fid = h5file_open(file_name.c_str())) < 0)
+  {
+    return -1;
+  }
+  if((did = H5Dopen2(fid, path.c_str(), H5P_DEFAULT)) >= 0)
+  {
+    result = open(did, file_name);
+    H5Dclose(did);
+  }
+  H5Fclose(fid);
+  return result;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5vds_t::open
+//a relative source file name is looked for in the directory of the VDS, then from the current one
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5vds_t::open(hid_t did, const std::string &file_name)
+{
+  m_mappings.clear();
+  m_nbr_missing = 0;
+
+#if H5_VERSION_GE(1,10,0)
+  hid_t dcpl;
+  size_t nbr_mappings = 0;
+
+  if((dcpl = H5Dget_create_plist(did)) < 0)
+  {
+    return -1;
+  }
+  if(H5Pget_layout(dcpl) != H5D_VIRTUAL)
+  {
+    H5Pclose(dcpl);
+    return 0;
+  }
+  if(H5Pget_virtual_count(dcpl, &nbr_mappings) < 0)
+  {
+    H5Pclose(dcpl);
+    return -1;
+  }
+
+  std::string dir;
+  std::string::size_type pos = file_name.find_last_of("/\\");
+  if(pos != std::string::npos)
+  {
+    dir = file_name.substr(0, pos + 1);
+  }
+
+  m_mappings.resize(nbr_mappings);
+  for(size_t idx = 0; idx < nbr_mappings; idx++)
+  {
+    mapping_t &mapping = m_mappings[idx];
+    mapping.m_source = source_unknown;
+    mapping.m_nbr_elements = -1;
+
+    //virtual selection; an unlimited one spans the whole extent
+    hid_t vspace = H5Pget_virtual_vspace(dcpl, idx);
+    int rank = vspace >= 0 ? H5Sget_simple_extent_ndims(vspace) : -1;
+    if(rank < 0)
+    {
+      if(vspace >= 0)
+        H5Sclose(vspace);
+      H5Pclose(dcpl);
+      m_mappings.clear();
+      return -1;
+    }
+    mapping.m_start.assign(rank, 0);
+    mapping.m_end.assign(rank, std::numeric_limits<hsize_t>::max());
+    herr_t status;
+    H5E_BEGIN_TRY
+    {
+      status = rank > 0 ? H5Sget_select_bounds(vspace, &mapping.m_start[0], &mapping.m_end[0]) : 0;
+      if(status >= 0)
+      {
+        mapping.m_nbr_elements = H5Sget_select_npoints(vspace);
+      }
+    }
+    H5E_END_TRY;
+    if(status < 0)
+    {
+      mapping.m_start.assign(rank, 0);
+      mapping.m_end.assign(rank, std::numeric_limits<hsize_t>::max());
+    }
+    H5Sclose(vspace);
+
+    //source
+    ssize_t size = H5Pget_virtual_filename(dcpl, idx, NULL, 0);
+    if(size > 0)
+    {
+      std::vector<char> buf(static_cast<size_t>(size) + 1);
+      H5Pget_virtual_filename(dcpl, idx, &buf[0], buf.size());
+      mapping.m_file_name = &buf[0];
+    }
+    size = H5Pget_virtual_dsetname(dcpl, idx, NULL, 0);
+    if(size > 0)
+    {
+      std::vector<char> buf(static_cast<size_t>(size) + 1);
+      H5Pget_virtual_dsetname(dcpl, idx, &buf[0], buf.size());
+      mapping.m_path = &buf[0];
+    }
+
+    if(mapping.m_file_name == ".")
+    {
+      mapping.m_resolved = file_name;
+    }
+    else if(!mapping.m_file_name.empty() && (mapping.m_file_name[0] == '/' || mapping.m_file_name[0] == '\\' ||
+      (mapping.m_file_name.size() > 1 && mapping.m_file_name[1] == ':')))
+    {
+      mapping.m_resolved = mapping.m_file_name;
+    }
+    else
+    {
+      mapping.m_resolved = dir + mapping.m_file_name;
+    }
+  }
+
+  H5Pclose(dcpl);
+  return 1;
+#else
+  (void)did;
+  (void)file_name;
+  return 0;
+#endif
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5vds_t::overlapping
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void h5vds_t::overlapping(const std::vector<hsize_t> &start, const std::vector<hsize_t> &count, std::vector<size_t> &mappings) const
+{
+  mappings.clear();
+  for(size_t idx = 0; idx < m_mappings.size(); idx++)
+  {
+    const mapping_t &mapping = m_mappings[idx];
+    bool overlap = mapping.m_start.size() == start.size();
+    for(size_t idx_dim = 0; overlap && idx_dim < start.size(); idx_dim++)
+    {
+      overlap = count[idx_dim] > 0 && start[idx_dim] <= mapping.m_end[idx_dim] &&
+        mapping.m_start[idx_dim] <= start[idx_dim] + count[idx_dim] - 1;
+    }
+    if(overlap)
+    {
+      mappings.push_back(idx);
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5vds_t::check
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool h5vds_t::check(size_t idx, h5pool_t &pool)
+{
+  mapping_t &mapping = m_mappings[idx];
+  if(mapping.m_source == source_unknown)
+  {
+    if(pool.get(mapping.m_resolved, mapping.m_path) != NULL)
+    {
+      mapping.m_source = source_found;
+    }
+    else if(mapping.m_resolved != mapping.m_file_name && pool.get(mapping.m_file_name, mapping.m_path) != NULL)
+    {
+      mapping.m_resolved = mapping.m_file_name;
+      mapping.m_source = source_found;
+    }
+    else
+    {
+      qDebug() << "missing source" << mapping.m_path.c_str() << "in" << mapping.m_resolved.c_str();
+      mapping.m_source = source_missing;
+      m_nbr_missing++;
+    }
+  }
+  else if(mapping.m_source == source_found)
+  {
+    //keep it open while it is read
+    pool.get(mapping.m_resolved, mapping.m_path);
+  }
+  return mapping.m_source == source_found;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5vds_t::missing
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int h5vds_t::missing(const std::vector<hsize_t> &coord, const std::vector<size_t> &mappings) const
+{
+  for(size_t idx = 0; idx < mappings.size(); idx++)
+  {
+    const mapping_t &mapping = m_mappings[mappings[idx]];
+    if(mapping.m_source != source_missing || mapping.m_start.size() != coord.size())
+    {
+      continue;
+    }
+    bool inside = true;
+    for(size_t idx_dim = 0; inside && idx_dim < coord.size(); idx_dim++)
+    {
+      inside = coord[idx_dim] >= mapping.m_start[idx_dim] && coord[idx_dim] <= mapping.m_end[idx_dim];
+    }
+    if(inside)
+    {
+      return static_cast<int>(mappings[idx]);
+    }
+  }
+  return -1;
+}
@@ -0,0 +1,63 @@
+#ifndef VDS_HPP
+#define VDS_HPP 1
+
+#include <string>
+#include <vector>
+#include "hdf5.h"
+#include "aggregate.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//h5vds_t
+//mappings of a virtual dataset (VDS): each maps a selection of the virtual dataset to a selection of
+//a source dataset, possibly in another file
+//a hyperslab read of a VDS only opens the sources whose mapping overlaps it, which a read of the
+//whole dataset (H5S_ALL) defeats; a missing source is read as the fill value without an error,
+//so the sources overlapping a read are checked first, through a h5pool_t that also keeps them
+//open: the HDF5 library then finds the source files already open when it reads them
+//overlap is tested on the bounding box of the virtual selection of each mapping
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class h5vds_t
+{
+public:
+  h5vds_t();
+
+  //mappings of dataset 'did' of file 'file_name', with h5lock_t held
+  //returns 1 if it is a VDS, 0 if it is not, -1 on error
+  int open(hid_t did, const std::string &file_name);
+
+  //same, opening dataset 'path'
+  int open(const std::string &file_name, const std::string &path);
+
+  //mappings overlapping the hyperslab 'start', 'count'
+  void overlapping(const std::vector<hsize_t> &start, const std::vector<hsize_t> &count, std::vector<size_t> &mappings) const;
+
+  //check the source of mapping 'idx' if not yet done; returns false if it cannot be opened
+  bool check(size_t idx, h5pool_t &pool);
+
+  //mapping of element 'coord' among 'mappings' whose source is missing, or -1
+  int missing(const std::vector<hsize_t> &coord, const std::vector<size_t> &mappings) const;
+
+  enum source_t
+  {
+    source_unknown,
+    source_found,
+    source_missing
+  };
+
+  struct mapping_t
+  {
+    std::string m_file_name; // source file, "." for the file of the VDS
+    std::string m_path; // source dataset
+    std::string m_resolved; // source file name to open
+    std::vector<hsize_t> m_start; // bounding box of the virtual selection
+    std::vector<hsize_t> m_end; // last element, inclusive
+    hssize_t m_nbr_elements; // in the virtual selection, -1 if unlimited
+    source_t m_source;
+  };
+
+  std::vector<mapping_t> m_mappings;
+  size_t m_nbr_missing; // sources checked and missing
+};
+
+#endif
@@ -1,8 +1,10 @@
 #ifndef VISIT_HPP
 #define VISIT_HPP 1
 
+#include <string>
 #include <vector>
 #include "hdf5.h"
+#include "link.hpp"
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 //h5visit_t
@@ -28,6 +30,9 @@ public:
   // HDF5 object information
   std::vector < H5O_info_added_t > visit_info;
 
+  // soft and external links, by name, not followed
+  std::vector < std::pair < std::string, h5link_t > > visit_links;
+
 private:
   // callback function for H5Lvisit_by_name
   static herr_t visit_link_cb(hid_t loc_id, const char *name, const H5L_info_t *linfo, void *_op_data);